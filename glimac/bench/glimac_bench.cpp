@@ -0,0 +1,864 @@
+// Micro-benchmarks of the glimac functions the scenes depend on.
+//
+// Results are written as JSON on stdout, one benchmark per line, so two runs can be diffed directly
+// or compared with --baseline. Progress and comparisons go to stderr.
+// The input images and OBJ files are generated in a temporary directory before the first run.
+// The GeometryBuffer::draw benchmarks render in a headless context and are skipped without GL 4.3.
+
+#include <glad/glad.h>
+#include <glimac/BBox.hpp>
+#include <glimac/BVH.hpp>
+#include <glimac/Cone.hpp>
+#include <glimac/FreeflyCamera.hpp>
+#include <glimac/Geometry.hpp>
+#include <glimac/GeometryBuffer.hpp>
+#include <glimac/HeadlessContext.hpp>
+#include <glimac/Image.hpp>
+#include <glimac/Log.hpp>
+#include <glimac/MaterialTable.hpp>
+#include <glimac/MeshSimplifier.hpp>
+#include <glimac/Meshlet.hpp>
+#include <glimac/Program.hpp>
+#include <glimac/Sphere.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace glimac;
+
+namespace {
+
+struct Options {
+    double m_fMinTime = 0.5;            // Seconds of measurement per benchmark
+    unsigned int m_nMinSamples = 3;
+    uint64_t m_nMaxTriangles = 10000000; // Largest generated OBJ
+    std::string m_sFilter;               // Only the benchmarks whose name contains it
+    std::string m_sBaseline;             // Previous output to compare with
+    std::filesystem::path m_TempDir = std::filesystem::temp_directory_path() / "glimac_bench";
+    std::vector<std::string> m_Images;   // Extra images, e.g. the JPEG faces of the skybox
+    std::filesystem::path m_ShaderDir = GLIMAC_BENCH_SHADER_DIR; // obj.vs.glsl and obj.fs.glsl
+};
+
+struct Result {
+    std::string m_sName;
+    uint64_t m_nIterations = 0;    // In total, over every sample
+    unsigned int m_nSamples = 0;
+    uint64_t m_nItems = 1;         // Processed by one iteration (boxes in a batch...)
+    std::string m_sRate;           // If not empty, the items are also reported per second under this name ("rays")
+    double m_fMedian = 0.;         // Nanoseconds per iteration
+    double m_fMean = 0.;
+    double m_fMin = 0.;
+    double m_fStdDev = 0.;
+};
+
+// Keeps the compiler from removing a computation whose result is not used
+template<typename T>
+void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class Runner {
+public:
+    explicit Runner(const Options& options): m_Options(options) {
+    }
+
+    // 'function(n)' runs n iterations. The number of iterations per sample is chosen so that a sample
+    // takes about a tenth of the minimum time, then samples are taken until both minimums are reached.
+    void run(const std::string& name, uint64_t items, const std::function<void(uint64_t)>& function, const std::string& rate = "") {
+        if(!isSelected(name)) {
+            return;
+        }
+        // The messages of glimac/Log.hpp are printed by another thread: flushed before each line of progress, so
+        // that the ones queued by the previous benchmark or by loading its inputs do not cut it
+        Log::flush();
+        std::cerr << name << "..." << std::endl;
+
+        const double sampleTime = m_Options.m_fMinTime / 10.;
+        uint64_t iterations = 1;
+        auto start = now();
+        function(1); // Warm up
+        auto elapsed = now() - start;
+        while(elapsed < sampleTime && iterations < (uint64_t(1) << 40)) {
+            iterations = elapsed > 0. ? std::max<uint64_t>(iterations * 2, uint64_t(iterations * sampleTime / elapsed * 1.2)) : iterations * 10;
+            start = now();
+            function(iterations);
+            elapsed = now() - start;
+        }
+
+        std::vector<double> samples;
+        double total = 0.;
+        while(total < m_Options.m_fMinTime || samples.size() < m_Options.m_nMinSamples) {
+            start = now();
+            function(iterations);
+            elapsed = now() - start;
+            total += elapsed;
+            samples.push_back(elapsed * 1e9 / iterations);
+        }
+
+        Result result;
+        result.m_sName = name;
+        result.m_nIterations = iterations * samples.size();
+        result.m_nSamples = samples.size();
+        result.m_nItems = items;
+        result.m_sRate = rate;
+        std::sort(samples.begin(), samples.end());
+        result.m_fMedian = samples[samples.size() / 2];
+        result.m_fMin = samples.front();
+        for(auto sample: samples) {
+            result.m_fMean += sample / samples.size();
+        }
+        for(auto sample: samples) {
+            result.m_fStdDev += (sample - result.m_fMean) * (sample - result.m_fMean) / samples.size();
+        }
+        result.m_fStdDev = std::sqrt(result.m_fStdDev);
+        m_Results.push_back(result);
+
+        Log::flush();
+        std::cerr << name << ": " << std::fixed << std::setprecision(1) << result.m_fMedian << " ns";
+        if(!rate.empty()) {
+            std::cerr << ", " << items * 1e3 / result.m_fMedian << " M" << rate << "/s";
+        }
+        std::cerr << std::endl;
+    }
+
+    bool isSelected(const std::string& name) const {
+        return m_Options.m_sFilter.empty() || name.find(m_Options.m_sFilter) != std::string::npos;
+    }
+
+    const std::vector<Result>& getResults() const {
+        return m_Results;
+    }
+
+private:
+    const Options& m_Options;
+    std::vector<Result> m_Results;
+};
+
+// ---Generated inputs---
+
+void writeU16(std::ostream& out, uint16_t value) {
+    out.put(char(value & 0xFF)).put(char(value >> 8));
+}
+
+void writeU32(std::ostream& out, uint32_t value) {
+    writeU16(out, uint16_t(value & 0xFFFF));
+    writeU16(out, uint16_t(value >> 16));
+}
+
+void writeU32BigEndian(std::ostream& out, uint32_t value) {
+    out.put(char(value >> 24)).put(char(value >> 16)).put(char(value >> 8)).put(char(value));
+}
+
+// Smooth gradients with some noise, RGBA
+std::vector<unsigned char> makePixels(unsigned int size) {
+    std::vector<unsigned char> pixels(size * size * 4);
+    std::mt19937 random(size);
+    for(auto y = 0u; y < size; ++y) {
+        for(auto x = 0u; x < size; ++x) {
+            auto pixel = &pixels[(y * size + x) * 4];
+            pixel[0] = (unsigned char) (x * 255 / size);
+            pixel[1] = (unsigned char) (y * 255 / size);
+            pixel[2] = (unsigned char) (random() & 0xFF);
+            pixel[3] = 255;
+        }
+    }
+    return pixels;
+}
+
+void writeBMP(const std::filesystem::path& path, unsigned int size, const std::vector<unsigned char>& pixels) {
+    std::ofstream out(path, std::ios::binary);
+    const uint32_t rowSize = (size * 3 + 3) & ~3u;
+    out.write("BM", 2);
+    writeU32(out, 54 + rowSize * size);
+    writeU32(out, 0);
+    writeU32(out, 54);
+    writeU32(out, 40);
+    writeU32(out, size);
+    writeU32(out, size);
+    writeU16(out, 1);
+    writeU16(out, 24);
+    for(auto i = 0; i < 6; ++i) {
+        writeU32(out, 0);
+    }
+    std::vector<char> row(rowSize, 0);
+    for(auto y = 0u; y < size; ++y) {
+        for(auto x = 0u; x < size; ++x) {
+            auto pixel = &pixels[((size - 1 - y) * size + x) * 4];
+            row[x * 3] = pixel[2];
+            row[x * 3 + 1] = pixel[1];
+            row[x * 3 + 2] = pixel[0];
+        }
+        out.write(row.data(), row.size());
+    }
+}
+
+void writeTGA(const std::filesystem::path& path, unsigned int size, const std::vector<unsigned char>& pixels) {
+    std::ofstream out(path, std::ios::binary);
+    const unsigned char header[12] = { 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    out.write((const char*) header, sizeof(header));
+    writeU16(out, size);
+    writeU16(out, size);
+    out.put(32).put(0x28); // 32 bits, top-left origin
+    std::vector<char> row(size * 4);
+    for(auto y = 0u; y < size; ++y) {
+        for(auto x = 0u; x < size; ++x) {
+            auto pixel = &pixels[(y * size + x) * 4];
+            row[x * 4] = pixel[2];
+            row[x * 4 + 1] = pixel[1];
+            row[x * 4 + 2] = pixel[0];
+            row[x * 4 + 3] = pixel[3];
+        }
+        out.write(row.data(), row.size());
+    }
+}
+
+uint32_t crc32(const unsigned char* data, size_t size, uint32_t crc = 0) {
+    static uint32_t table[256];
+    if(!table[1]) {
+        for(uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for(auto k = 0; k < 8; ++k) {
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+    }
+    crc = ~crc;
+    for(size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// PNG with uncompressed deflate blocks: stb_image still goes through zlib decoding and unfiltering
+void writePNG(const std::filesystem::path& path, unsigned int size, const std::vector<unsigned char>& pixels) {
+    std::vector<unsigned char> raw;
+    raw.reserve(size * (size * 4 + 1));
+    for(auto y = 0u; y < size; ++y) {
+        raw.push_back(0); // No filter
+        raw.insert(raw.end(), pixels.begin() + y * size * 4, pixels.begin() + (y + 1) * size * 4);
+    }
+
+    std::vector<unsigned char> zlib = { 0x78, 0x01 };
+    uint32_t a = 1, b = 0;
+    for(auto value: raw) {
+        a = (a + value) % 65521;
+        b = (b + a) % 65521;
+    }
+    for(size_t offset = 0; offset < raw.size(); offset += 65535) {
+        auto length = (uint16_t) std::min<size_t>(65535, raw.size() - offset);
+        zlib.push_back(offset + length == raw.size());
+        zlib.push_back(length & 0xFF);
+        zlib.push_back(length >> 8);
+        zlib.push_back(~length & 0xFF);
+        zlib.push_back((~length >> 8) & 0xFF);
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+    }
+    const uint32_t adler = (b << 16) | a;
+    for(auto shift = 24; shift >= 0; shift -= 8) {
+        zlib.push_back((adler >> shift) & 0xFF);
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    auto writeChunk = [&out](const char* type, const unsigned char* data, size_t length) {
+        writeU32BigEndian(out, length);
+        out.write(type, 4);
+        out.write((const char*) data, length);
+        writeU32BigEndian(out, crc32(data, length, crc32((const unsigned char*) type, 4)));
+    };
+    const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.write((const char*) signature, sizeof(signature));
+    unsigned char header[13] = { 0, 0, 0, 0, 0, 0, 0, 0, 8, 6, 0, 0, 0 }; // 8 bits RGBA
+    for(auto i = 0; i < 4; ++i) {
+        header[i] = (size >> (24 - 8 * i)) & 0xFF;
+        header[4 + i] = header[i];
+    }
+    writeChunk("IHDR", header, sizeof(header));
+    writeChunk("IDAT", zlib.data(), zlib.size());
+    writeChunk("IEND", nullptr, 0);
+}
+
+// Regular grid of 2 * n * n triangles, with normals and texture coordinates like exported models
+std::filesystem::path writeGridOBJ(const std::filesystem::path& directory, uint64_t triangleCount) {
+    auto path = directory / ("grid_" + std::to_string(triangleCount) + ".obj");
+    if(std::filesystem::exists(path)) {
+        return path;
+    }
+    std::cerr << "Generate " << path.string() << std::endl;
+
+    const auto n = (uint64_t) std::ceil(std::sqrt(triangleCount / 2.));
+    std::ofstream out(path);
+    out << std::fixed << std::setprecision(4);
+    for(uint64_t y = 0; y <= n; ++y) {
+        for(uint64_t x = 0; x <= n; ++x) {
+            const float u = float(x) / n, v = float(y) / n;
+            out << "v " << u << " " << 0.1f * std::sin(10.f * u) * std::cos(10.f * v) << " " << v << "\n";
+            out << "vt " << u << " " << v << "\n";
+        }
+    }
+    out << "vn 0 1 0\n";
+    for(uint64_t y = 0; y < n; ++y) {
+        for(uint64_t x = 0; x < n; ++x) {
+            const auto i = y * (n + 1) + x + 1;
+            const auto j = i + n + 1;
+            out << "f " << i << "/" << i << "/1 " << j << "/" << j << "/1 " << i + 1 << "/" << i + 1 << "/1\n";
+            out << "f " << i + 1 << "/" << i + 1 << "/1 " << j << "/" << j << "/1 " << j + 1 << "/" << j + 1 << "/1\n";
+        }
+    }
+    return path;
+}
+
+// Same grid cut in horizontal bands, each with its own material (and diffuse map): one mesh per band
+std::filesystem::path writeTiledOBJ(const std::filesystem::path& directory, uint64_t triangleCount, unsigned int tileCount) {
+    auto path = directory / ("tiles_" + std::to_string(triangleCount) + "_" + std::to_string(tileCount) + ".obj");
+    if(std::filesystem::exists(path)) {
+        return path;
+    }
+    std::cerr << "Generate " << path.string() << std::endl;
+
+    const auto mtlName = "tiles_" + std::to_string(tileCount) + ".mtl";
+    std::ofstream mtl(directory / mtlName);
+    for(auto tile = 0u; tile < tileCount; ++tile) {
+        const float t = float(tile) / tileCount;
+        mtl << "newmtl tile" << tile << "\n"
+            << "Ka 0.1 0.1 0.1\nKd " << t << " " << 1.f - t << " 0.5\nKs 0.5 0.5 0.5\nNs 32\n"
+            << "map_Kd tile" << tile % 2 << ".png\n";
+    }
+    for(auto map = 0u; map < 2; ++map) {
+        writePNG(directory / ("tile" + std::to_string(map) + ".png"), 64 << map, makePixels(64 << map));
+    }
+
+    const auto n = (uint64_t) std::ceil(std::sqrt(triangleCount / 2.));
+    std::ofstream out(path);
+    out << std::fixed << std::setprecision(4) << "mtllib " << mtlName << "\n";
+    for(uint64_t y = 0; y <= n; ++y) {
+        for(uint64_t x = 0; x <= n; ++x) {
+            const float u = float(x) / n, v = float(y) / n;
+            out << "v " << u << " " << 0.1f * std::sin(10.f * u) * std::cos(10.f * v) << " " << v << "\n";
+            out << "vt " << u << " " << v << "\n";
+        }
+    }
+    out << "vn 0 1 0\n";
+    for(uint64_t y = 0; y < n; ++y) {
+        const auto tile = y * tileCount / n;
+        if(y == 0 || tile != (y - 1) * tileCount / n) {
+            out << "g tile" << tile << "\nusemtl tile" << tile << "\n";
+        }
+        for(uint64_t x = 0; x < n; ++x) {
+            const auto i = y * (n + 1) + x + 1;
+            const auto j = i + n + 1;
+            out << "f " << i << "/" << i << "/1 " << j << "/" << j << "/1 " << i + 1 << "/" << i + 1 << "/1\n";
+            out << "f " << i + 1 << "/" << i + 1 << "/1 " << j << "/" << j << "/1 " << j + 1 << "/" << j + 1 << "/1\n";
+        }
+    }
+    return path;
+}
+
+std::string formatCount(uint64_t count) {
+    if(count >= 1000000 && count % 1000000 == 0) {
+        return std::to_string(count / 1000000) + "M";
+    }
+    if(count >= 1000 && count % 1000 == 0) {
+        return std::to_string(count / 1000) + "K";
+    }
+    return std::to_string(count);
+}
+
+// ---Benchmarks---
+
+void benchShapes(Runner& runner) {
+    const GLsizei tessellations[][2] = { { 8, 4 }, { 32, 16 }, { 128, 64 }, { 512, 256 } };
+    for(const auto& tessellation: tessellations) {
+        const auto suffix = "/" + std::to_string(tessellation[0]) + "x" + std::to_string(tessellation[1]);
+        runner.run("Sphere::build" + suffix, 1, [&tessellation](uint64_t iterations) {
+            for(uint64_t i = 0; i < iterations; ++i) {
+                Sphere sphere(1.f, tessellation[0], tessellation[1]);
+                doNotOptimize(sphere);
+            }
+        });
+        runner.run("Cone::build" + suffix, 1, [&tessellation](uint64_t iterations) {
+            for(uint64_t i = 0; i < iterations; ++i) {
+                Cone cone(2.f, 1.f, tessellation[0], tessellation[1]);
+                doNotOptimize(cone);
+            }
+        });
+    }
+}
+
+void benchImages(Runner& runner, const Options& options) {
+    typedef void (*Writer)(const std::filesystem::path&, unsigned int, const std::vector<unsigned char>&);
+    const std::pair<const char*, Writer> formats[] = {
+        { "png", writePNG }, { "bmp", writeBMP }, { "tga", writeTGA }
+    };
+
+    std::vector<std::pair<std::string, FilePath>> images;
+    for(auto size: { 256u, 1024u, 2048u }) {
+        auto pixels = makePixels(size);
+        for(const auto& format: formats) {
+            auto path = options.m_TempDir / ("image_" + std::to_string(size) + "." + format.first);
+            if(!std::filesystem::exists(path)) {
+                format.second(path, size, pixels);
+            }
+            images.emplace_back(std::string("loadImage/") + format.first + "/" + std::to_string(size), path.string());
+        }
+    }
+    for(const auto& image: options.m_Images) {
+        images.emplace_back("loadImage/" + std::filesystem::path(image).filename().string(), image);
+    }
+
+    for(const auto& image: images) {
+        if(!loadImage(image.second)) {
+            continue;
+        }
+        runner.run(image.first, 1, [&image](uint64_t iterations) {
+            for(uint64_t i = 0; i < iterations; ++i) {
+                auto pImage = loadImage(image.second);
+                doNotOptimize(pImage);
+            }
+        });
+    }
+}
+
+void benchOBJ(Runner& runner, const Options& options) {
+    // loadOBJ logs through glimac/Log.hpp: the measure includes queuing the messages, not printing them
+    for(uint64_t triangleCount = 10000; triangleCount <= options.m_nMaxTriangles; triangleCount *= 10) {
+        const FilePath path = writeGridOBJ(options.m_TempDir, triangleCount).string();
+
+        runner.run("Geometry::loadOBJ/" + formatCount(triangleCount), triangleCount, [&path](uint64_t iterations) {
+            for(uint64_t i = 0; i < iterations; ++i) {
+                Geometry geometry;
+                geometry.loadOBJ(path, path.dirPath(), false);
+                doNotOptimize(geometry);
+            }
+        });
+    }
+}
+
+// Meshes simplified when the scenes load, at most 100K triangles
+const uint64_t MAX_SIMPLIFIED_TRIANGLES = 100000;
+
+void benchLods(Runner& runner, const Options& options) {
+    const auto maxTriangles = std::min(options.m_nMaxTriangles, MAX_SIMPLIFIED_TRIANGLES);
+    for(uint64_t triangleCount = 10000; triangleCount <= maxTriangles; triangleCount *= 10) {
+        const FilePath path = writeGridOBJ(options.m_TempDir, triangleCount).string();
+        Geometry geometry;
+        if(!geometry.loadOBJ(path, path.dirPath(), false)) {
+            continue;
+        }
+
+        runner.run("simplifyMesh/" + formatCount(triangleCount) + "/50%", triangleCount, [&geometry](uint64_t iterations) {
+            for(uint64_t i = 0; i < iterations; ++i) {
+                auto indices = simplifyMesh(geometry.getVertexBuffer(), geometry.getIndexBuffer(), geometry.getIndexCount(),
+                                            geometry.getIndexCount() / 2);
+                doNotOptimize(indices);
+            }
+        });
+        // Includes the copy of the loaded geometry, small next to the simplification of the three levels
+        runner.run("Geometry::buildLods/" + formatCount(triangleCount), triangleCount, [&geometry](uint64_t iterations) {
+            for(uint64_t i = 0; i < iterations; ++i) {
+                Geometry lods = geometry;
+                lods.buildLods();
+                doNotOptimize(lods);
+            }
+        });
+    }
+}
+
+// Meshes split or traced at run time, at most 1M triangles
+const uint64_t MAX_PROCESSED_TRIANGLES = 1000000;
+
+void benchMeshlets(Runner& runner, const Options& options) {
+    // Camera above the near edge of the grid, looking at its middle: part of the meshlets is outside the frustum
+    const glm::vec3 cameraPosition(0.5f, 0.3f, 1.2f);
+    const Frustum frustum(glm::perspective(glm::radians(60.f), 1.f, 0.01f, 10.f)
+                          * glm::lookAt(cameraPosition, glm::vec3(0.5f, 0.f, 0.3f), glm::vec3(0.f, 1.f, 0.f)));
+
+    const auto maxTriangles = std::min(options.m_nMaxTriangles, MAX_PROCESSED_TRIANGLES);
+    for(uint64_t triangleCount = 10000; triangleCount <= maxTriangles; triangleCount *= 10) {
+        const FilePath path = writeGridOBJ(options.m_TempDir, triangleCount).string();
+        Geometry geometry;
+        if(!geometry.loadOBJ(path, path.dirPath(), false)) {
+            continue;
+        }
+
+        MeshletBuffer meshlets;
+        runner.run("MeshletBuffer::build/" + formatCount(triangleCount), triangleCount, [&geometry, &meshlets](uint64_t iterations) {
+            for(uint64_t i = 0; i < iterations; ++i) {
+                meshlets.clear();
+                for(unsigned int mesh = 0; mesh < geometry.getMeshCount(); ++mesh) {
+                    meshlets.build(geometry, mesh);
+                }
+                doNotOptimize(meshlets);
+            }
+        });
+
+        std::vector<DrawElementsIndirectCommand> commands;
+        commands.reserve(meshlets.getMeshletCount());
+        runner.run("MeshletBuffer::cull/" + formatCount(triangleCount), meshlets.getMeshletCount(), [&](uint64_t iterations) {
+            for(uint64_t i = 0; i < iterations; ++i) {
+                commands.clear();
+                auto visibleCount = meshlets.cull(frustum, cameraPosition, commands);
+                doNotOptimize(visibleCount);
+            }
+        });
+    }
+}
+
+// Drawn with the shaders of the OBJ meshes, through GeometryBuffer and MaterialTable, like a scene would. glFinish
+// waits for each frame: the measure includes the rasterization, of a 256 x 256 framebuffer
+void benchGeometryBuffer(Runner& runner, const Options& options) {
+    const unsigned int TILE_COUNT = 16;
+    const int FRAME_SIZE = 256;
+
+    const auto maxTriangles = std::min(options.m_nMaxTriangles, MAX_PROCESSED_TRIANGLES);
+    std::vector<uint64_t> triangleCounts;
+    for(uint64_t triangleCount = 10000; triangleCount <= maxTriangles; triangleCount *= 10) {
+        if(runner.isSelected("GeometryBuffer::draw/" + formatCount(triangleCount) + "/all")
+           || runner.isSelected("GeometryBuffer::draw/" + formatCount(triangleCount) + "/half")) {
+            triangleCounts.push_back(triangleCount);
+        }
+    }
+    if(triangleCounts.empty()) {
+        return;
+    }
+
+    HeadlessContext context;
+    if(!context.create(FRAME_SIZE, FRAME_SIZE) || !GLAD_GL_VERSION_4_3) {
+        std::cerr << "GeometryBuffer::draw skipped: no GL 4.3 headless context" << std::endl;
+        return;
+    }
+    Program program;
+    try {
+        program = loadProgram((options.m_ShaderDir / "obj.vs.glsl").string(), (options.m_ShaderDir / "obj.fs.glsl").string());
+    } catch(const std::exception& error) {
+        std::cerr << "GeometryBuffer::draw skipped: " << error.what() << std::endl;
+        return;
+    }
+
+    // Grid seen from above its near edge, lit by two lights
+    const glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.5f, 0.6f, 1.3f), glm::vec3(0.5f, 0.f, 0.4f), glm::vec3(0.f, 1.f, 0.f));
+    const glm::mat4 MVPMatrix = glm::perspective(glm::radians(60.f), 1.f, 0.01f, 10.f) * viewMatrix;
+    const glm::mat4 normalMatrix = glm::transpose(glm::inverse(viewMatrix));
+    const auto light1 = glm::vec3(viewMatrix * glm::vec4(0.2f, 0.5f, 0.2f, 1.f));
+    const auto light2 = glm::vec3(viewMatrix * glm::vec4(0.8f, 0.5f, 0.8f, 1.f));
+    const GLuint programId = program.getGLId();
+    program.use();
+    GL::uniformMatrix4fv(GL::getUniformLocation(programId, "uMVPMatrix"), 1, GL_FALSE, glm::value_ptr(MVPMatrix));
+    GL::uniformMatrix4fv(GL::getUniformLocation(programId, "uMVMatrix"), 1, GL_FALSE, glm::value_ptr(viewMatrix));
+    GL::uniformMatrix4fv(GL::getUniformLocation(programId, "uNormalMatrix"), 1, GL_FALSE, glm::value_ptr(normalMatrix));
+    GL::uniform3fv(GL::getUniformLocation(programId, "uAmbientLight"), 1, glm::value_ptr(glm::vec3(0.2f)));
+    GL::uniform3fv(GL::getUniformLocation(programId, "uLightPos1_vs"), 1, glm::value_ptr(light1));
+    GL::uniform3fv(GL::getUniformLocation(programId, "uLightIntensity1"), 1, glm::value_ptr(glm::vec3(1.f)));
+    GL::uniform3fv(GL::getUniformLocation(programId, "uLightPos2_vs"), 1, glm::value_ptr(light2));
+    GL::uniform3fv(GL::getUniformLocation(programId, "uLightIntensity2"), 1, glm::value_ptr(glm::vec3(0.5f)));
+    GL::uniform1i(GL::getUniformLocation(programId, "uMaps"), 0);
+    GL::enable(GL_DEPTH_TEST);
+    GL::viewport(0, 0, FRAME_SIZE, FRAME_SIZE);
+
+    // Every other band, as left by a culling pass
+    std::vector<bool> halfMeshes(TILE_COUNT);
+    for(auto tile = 0u; tile < TILE_COUNT; tile += 2) {
+        halfMeshes[tile] = true;
+    }
+
+    for(auto triangleCount: triangleCounts) {
+        const FilePath path = writeTiledOBJ(options.m_TempDir, triangleCount, TILE_COUNT).string();
+        Geometry geometry;
+        if(!geometry.loadOBJ(path, path.dirPath())) {
+            continue;
+        }
+        GeometryBuffer geometryBuffer;
+        geometryBuffer.upload(geometry);
+        MaterialTable materials;
+        materials.upload(geometry, 128);
+
+        auto drawFrames = [&](const std::vector<bool>& visibleMeshes) {
+            return [&geometryBuffer, &materials, &visibleMeshes](uint64_t iterations) {
+                for(uint64_t i = 0; i < iterations; ++i) {
+                    GL::clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                    materials.bind(0);
+                    auto drawn = geometryBuffer.draw(visibleMeshes);
+                    glFinish();
+                    doNotOptimize(drawn);
+                }
+            };
+        };
+        const auto name = "GeometryBuffer::draw/" + formatCount(triangleCount);
+        runner.run(name + "/all", triangleCount, drawFrames({}), "triangles");
+        runner.run(name + "/half", triangleCount / 2, drawFrames(halfMeshes), "triangles");
+    }
+}
+
+void benchBVH(Runner& runner, const Options& options) {
+    // Rays from above the grid, towards random points of it: most hit, some leave by the sides
+    const size_t rayCount = 4096;
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> coordinate(-0.1f, 1.1f);
+    std::vector<Ray> rays(rayCount);
+    for(auto& ray: rays) {
+        const glm::vec3 origin(coordinate(random), 1.f, coordinate(random));
+        const glm::vec3 target(coordinate(random), 0.f, coordinate(random));
+        ray = Ray(origin, glm::normalize(target - origin));
+    }
+    std::vector<RayHit> hits(rayCount);
+
+    const auto maxTriangles = std::min(options.m_nMaxTriangles, MAX_PROCESSED_TRIANGLES);
+    for(uint64_t triangleCount = 10000; triangleCount <= maxTriangles; triangleCount *= 10) {
+        const FilePath path = writeGridOBJ(options.m_TempDir, triangleCount).string();
+        Geometry geometry;
+        if(!geometry.loadOBJ(path, path.dirPath(), false)) {
+            continue;
+        }
+
+        BVH bvh;
+        runner.run("BVH::build/" + formatCount(triangleCount), triangleCount, [&geometry, &bvh](uint64_t iterations) {
+            for(uint64_t i = 0; i < iterations; ++i) {
+                bvh.clear();
+                bvh.addGeometry(geometry);
+                bvh.build();
+                doNotOptimize(bvh);
+            }
+        });
+
+        const auto suffix = "/" + formatCount(triangleCount) + "/" + std::to_string(rayCount);
+        runner.run("BVH::intersect" + suffix, rayCount, [&](uint64_t iterations) {
+            for(uint64_t i = 0; i < iterations; ++i) {
+                for(size_t j = 0; j < rayCount; ++j) {
+                    hits[j] = RayHit();
+                    bvh.intersect(rays[j], hits[j]);
+                }
+                doNotOptimize(hits);
+            }
+        }, "rays");
+        runner.run("BVH::occluded" + suffix, rayCount, [&](uint64_t iterations) {
+            for(uint64_t i = 0; i < iterations; ++i) {
+                size_t occludedCount = 0;
+                for(const auto& ray: rays) {
+                    occludedCount += bvh.occluded(ray);
+                }
+                doNotOptimize(occludedCount);
+            }
+        }, "rays");
+        // Batch spread over the threads: the rate depends on the "threads" of the context
+        runner.run("BVH::intersectBatch" + suffix, rayCount, [&](uint64_t iterations) {
+            for(uint64_t i = 0; i < iterations; ++i) {
+                auto stats = bvh.intersect(rays.data(), hits.data(), rayCount);
+                doNotOptimize(stats);
+            }
+        }, "rays");
+    }
+}
+
+void benchBBoxes(Runner& runner) {
+    const size_t count = 4096;
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-10.f, 10.f), extent(0.f, 2.f);
+    std::vector<BBox3f> boxes(count), others(count), results(count);
+    for(size_t i = 0; i < count; ++i) {
+        const glm::vec3 a(position(random), position(random), position(random));
+        const glm::vec3 b(position(random), position(random), position(random));
+        boxes[i] = BBox3f(a, a + glm::vec3(extent(random), extent(random), extent(random)));
+        others[i] = BBox3f(b, b + glm::vec3(extent(random), extent(random), extent(random)));
+    }
+
+    runner.run("BBox3f::merge/" + std::to_string(count), count, [&](uint64_t iterations) {
+        for(uint64_t i = 0; i < iterations; ++i) {
+            BBox3f bounds = boxes[0];
+            for(const auto& box: boxes) {
+                bounds = merge(bounds, box);
+            }
+            doNotOptimize(bounds);
+        }
+    });
+    runner.run("BBox3f::intersect/" + std::to_string(count), count, [&](uint64_t iterations) {
+        for(uint64_t i = 0; i < iterations; ++i) {
+            for(size_t j = 0; j < count; ++j) {
+                results[j] = intersect(boxes[j], others[j]);
+            }
+            doNotOptimize(results);
+        }
+    });
+    runner.run("BBox3f::disjoint/" + std::to_string(count), count, [&](uint64_t iterations) {
+        for(uint64_t i = 0; i < iterations; ++i) {
+            size_t disjointCount = 0;
+            for(size_t j = 0; j < count; ++j) {
+                disjointCount += disjoint(boxes[j], others[j]);
+            }
+            doNotOptimize(disjointCount);
+        }
+    });
+}
+
+void benchCamera(Runner& runner) {
+    std::vector<FreeflyCamera> cameras(64);
+    for(size_t i = 0; i < cameras.size(); ++i) {
+        cameras[i].rotateLeft(i * 5.f);
+        cameras[i].rotateUp(float(i % 8) * 10.f - 40.f);
+        cameras[i].moveFront(i * 0.1f);
+    }
+    runner.run("FreeflyCamera::getViewMatrix", 1, [&cameras](uint64_t iterations) {
+        for(uint64_t i = 0; i < iterations; ++i) {
+            auto viewMatrix = cameras[i % cameras.size()].getViewMatrix();
+            doNotOptimize(viewMatrix);
+        }
+    });
+}
+
+// ---Output---
+
+void writeJSON(std::ostream& out, const std::vector<Result>& results) {
+    char date[32];
+    auto time = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&time));
+
+    out << "{\"context\": {\"date\": \"" << date << "\""
+        << ", \"threads\": " << std::thread::hardware_concurrency()
+#ifdef __VERSION__
+        << ", \"compiler\": \"" << __VERSION__ << "\""
+#endif
+#ifdef __OPTIMIZE__
+        << ", \"optimized\": true"
+#else
+        << ", \"optimized\": false"
+#endif
+        << "},\n\"benchmarks\": [";
+    out << std::fixed << std::setprecision(2);
+    for(size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        out << (i ? "," : "") << "\n{\"name\": \"" << result.m_sName << "\""
+            << ", \"iterations\": " << result.m_nIterations
+            << ", \"samples\": " << result.m_nSamples
+            << ", \"items\": " << result.m_nItems
+            << ", \"median_ns\": " << result.m_fMedian
+            << ", \"mean_ns\": " << result.m_fMean
+            << ", \"min_ns\": " << result.m_fMin
+            << ", \"stddev_ns\": " << result.m_fStdDev
+            << ", \"ns_per_item\": " << result.m_fMedian / result.m_nItems;
+        if(!result.m_sRate.empty()) {
+            out << ", \"" << result.m_sRate << "_per_s\": " << result.m_nItems * 1e9 / result.m_fMedian;
+        }
+        out << "}";
+    }
+    out << "\n]}" << std::endl;
+}
+
+// Reads the median of each benchmark from a previous output (one benchmark per line)
+std::map<std::string, double> readBaseline(const std::string& path) {
+    std::map<std::string, double> medians;
+    std::ifstream in(path);
+    if(!in) {
+        std::cerr << "Unable to open " << path << std::endl;
+        return medians;
+    }
+    const std::string nameKey = "{\"name\": \"", medianKey = "\"median_ns\": ";
+    std::string line;
+    while(std::getline(in, line)) {
+        auto name = line.find(nameKey), median = line.find(medianKey);
+        if(name == std::string::npos || median == std::string::npos) {
+            continue;
+        }
+        name += nameKey.size();
+        medians[line.substr(name, line.find('"', name) - name)] = std::atof(line.c_str() + median + medianKey.size());
+    }
+    return medians;
+}
+
+void compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline) {
+    std::cerr << std::endl << std::left << std::setw(36) << "benchmark" << std::right
+              << std::setw(14) << "baseline ns" << std::setw(14) << "current ns" << std::setw(10) << "change" << std::endl;
+    for(const auto& result: results) {
+        auto it = baseline.find(result.m_sName);
+        if(it == baseline.end() || it->second <= 0.) {
+            continue;
+        }
+        std::cerr << std::left << std::setw(36) << result.m_sName << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << it->second << std::setw(14) << result.m_fMedian
+                  << std::setw(9) << std::showpos << (result.m_fMedian / it->second - 1.) * 100. << std::noshowpos << "%" << std::endl;
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for(auto i = 1; i < argc; ++i) {
+        if(!std::strcmp(argv[i], "--min-time") && i + 1 < argc) {
+            options.m_fMinTime = std::atof(argv[++i]);
+        } else if(!std::strcmp(argv[i], "--max-triangles") && i + 1 < argc) {
+            options.m_nMaxTriangles = std::strtoull(argv[++i], nullptr, 10);
+        } else if(!std::strcmp(argv[i], "--filter") && i + 1 < argc) {
+            options.m_sFilter = argv[++i];
+        } else if(!std::strcmp(argv[i], "--baseline") && i + 1 < argc) {
+            options.m_sBaseline = argv[++i];
+        } else if(!std::strcmp(argv[i], "--temp-dir") && i + 1 < argc) {
+            options.m_TempDir = argv[++i];
+        } else if(!std::strcmp(argv[i], "--image") && i + 1 < argc) {
+            options.m_Images.push_back(argv[++i]);
+        } else if(!std::strcmp(argv[i], "--shaders") && i + 1 < argc) {
+            options.m_ShaderDir = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--filter TEXT] [--min-time SECONDS] [--max-triangles N]"
+                      << " [--temp-dir DIR] [--image FILE]... [--shaders DIR] [--baseline FILE]" << std::endl;
+            return -1;
+        }
+    }
+    if(options.m_fMinTime <= 0.) {
+        std::cerr << "Invalid options" << std::endl;
+        return -1;
+    }
+
+#ifndef __OPTIMIZE__
+    std::cerr << "Warning: benchmarks built without optimizations (use -DCMAKE_BUILD_TYPE=Release)" << std::endl;
+#endif
+
+    std::error_code error;
+    std::filesystem::create_directories(options.m_TempDir, error);
+    if(error) {
+        std::cerr << "Unable to create " << options.m_TempDir.string() << ": " << error.message() << std::endl;
+        return -1;
+    }
+
+    Runner runner(options);
+    benchShapes(runner);
+    benchImages(runner, options);
+    benchOBJ(runner, options);
+    benchLods(runner, options);
+    benchMeshlets(runner, options);
+    benchBVH(runner, options);
+    benchBBoxes(runner);
+    benchCamera(runner);
+    benchGeometryBuffer(runner, options);
+
+    writeJSON(std::cout, runner.getResults());
+
+    if(!options.m_sBaseline.empty()) {
+        compare(runner.getResults(), readBaseline(options.m_sBaseline));
+    }
+
+    return 0;
+}
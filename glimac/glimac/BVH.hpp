@@ -0,0 +1,119 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include "glm.hpp"
+#include "BBox.hpp"
+#include "Geometry.hpp"
+
+namespace glimac {
+
+struct Ray {
+    glm::vec3 origin;
+    float tMin = 0.f;
+    glm::vec3 direction;
+    float tMax = std::numeric_limits<float>::infinity();
+
+    Ray() { }
+    Ray(const glm::vec3& origin, const glm::vec3& direction, float tMin = 0.f, float tMax = std::numeric_limits<float>::infinity()):
+        origin(origin), tMin(tMin), direction(direction), tMax(tMax) {
+    }
+};
+
+struct RayHit {
+    static const unsigned int INVALID = ~0u;
+
+    float t = std::numeric_limits<float>::infinity();
+    float u = 0.f, v = 0.f; // Barycentric coordinates in the triangle
+    unsigned int triangle = INVALID; // In the order the triangles were added
+    unsigned int objectId = INVALID;
+
+    bool hit() const {
+        return triangle != INVALID;
+    }
+};
+
+struct RayQueryStats {
+    size_t rayCount = 0;
+    size_t hitCount = 0;
+    double seconds = 0.;
+    double raysPerSecond = 0.;
+};
+
+// Bounding volume hierarchy over world space triangles, for picking, visibility and collision rays
+class BVH {
+public:
+    // 32 bytes, two nodes per cache line
+    struct Node {
+        glm::vec3 lower;
+        unsigned int leftOrFirst; // Left child index for inner nodes (the right child follows it), first triangle for leaves
+        glm::vec3 upper;
+        unsigned int count; // Number of triangles for leaves, 0 for inner nodes
+
+        bool isLeaf() const {
+            return count > 0;
+        }
+    };
+
+    BVH();
+
+    // Adds the triangles of every mesh of the geometry, transformed by 'transform'
+    void addGeometry(const Geometry& geometry, const glm::mat4& transform = glm::mat4(1.f), unsigned int objectId = 0);
+
+    // Adds a non indexed triangle list (e.g. ShapeVertex or Vertex3DColor arrays), the position is read at the
+    // beginning of each vertex
+    void addTriangles(const void* vertices, size_t stride, size_t vertexCount, const glm::mat4& transform, unsigned int objectId);
+
+    void addTriangle(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, unsigned int objectId);
+
+    // Binned SAH build, large subtrees are built in parallel
+    void build(unsigned int maxLeafSize = 4);
+
+    // Closest hit, returns true if something was hit
+    bool intersect(const Ray& ray, RayHit& hit) const;
+
+    // Any hit between ray.tMin and ray.tMax (line of sight)
+    bool occluded(const Ray& ray) const;
+
+    // Closest hit of a batch of rays, spread over the available threads
+    RayQueryStats intersect(const Ray* rays, RayHit* hits, size_t count) const;
+
+    const Node* getNodeBuffer() const {
+        return m_Nodes.data();
+    }
+
+    size_t getNodeCount() const {
+        return m_Nodes.size();
+    }
+
+    size_t getTriangleCount() const {
+        return m_Triangles.size();
+    }
+
+    // Empty box until a build with triangles
+    const BBox3f& getBoundingBox() const {
+        return m_BBox;
+    }
+
+    void clear();
+
+private:
+    struct Triangle {
+        glm::vec3 p0, e1, e2; // First vertex and edges, as needed by the intersection test
+        unsigned int objectId;
+        unsigned int index; // Insertion order, reported by RayHit::triangle
+    };
+
+    struct BuildContext;
+    void buildNode(BuildContext& context, unsigned int nodeIndex, unsigned int first, unsigned int count, unsigned int depth);
+
+    bool intersectTriangle(unsigned int index, const Ray& ray, float tMax, RayHit& hit) const;
+    template<bool ANY_HIT>
+    bool traverse(const Ray& ray, RayHit& hit) const;
+
+    std::vector<Triangle> m_Triangles;
+    std::vector<Node> m_Nodes;
+    BBox3f m_BBox;
+};
+
+}
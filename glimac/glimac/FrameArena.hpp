@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace glimac {
+
+// Linear allocator for the transient data of a frame (sorted lists, draw lists, staging):
+//
+//     arena.beginFrame();
+//     FrameVector<TransparentObject> objects(arena);
+//     objects.reserve(count);
+//
+// Allocating bumps an offset in the region of the current frame and freeing does nothing: the region
+// is reset as a whole when it is reused, FRAMES frames later, so what a frame built stays valid while
+// the next ones are recorded. A frame that needs more than its region gets its extra blocks from the
+// heap (counted as overflows and freed with the region): raise the capacity to the peak.
+// Not thread-safe: one arena per thread that builds frame data.
+class FrameArena {
+public:
+    static const size_t FRAMES = 3; // Regions in rotation
+
+    explicit FrameArena(size_t capacityPerFrame);
+
+    // Starts the next frame: its region is reset
+    void beginFrame();
+
+    // 'alignment' is a power of two
+    void* allocate(size_t size, size_t alignment);
+
+    size_t getCapacity() const {
+        return m_nCapacity;
+    }
+
+    // Bytes allocated by the current frame, alignment padding and overflow blocks included
+    size_t getUsedBytes() const {
+        return m_nUsedBytes;
+    }
+
+    // Largest getUsedBytes() so far
+    size_t getPeakBytes() const {
+        return m_nPeakBytes;
+    }
+
+    // Allocations that did not fit in their region, since the creation of the arena
+    size_t getOverflowCount() const {
+        return m_nOverflowCount;
+    }
+
+private:
+    FrameArena(const FrameArena&);
+    FrameArena& operator =(const FrameArena&);
+
+    struct Region {
+        std::unique_ptr<unsigned char[]> m_pMemory;
+        std::vector<std::unique_ptr<unsigned char[]>> m_Overflows;
+    };
+
+    Region m_Regions[FRAMES];
+    size_t m_nCapacity;
+    size_t m_nFrame = FRAMES - 1; // The first beginFrame() starts with region 0
+    size_t m_nOffset = 0;
+    size_t m_nUsedBytes = 0;
+    size_t m_nPeakBytes = 0;
+    size_t m_nOverflowCount = 0;
+};
+
+// STL allocator drawing from a FrameArena; deallocate() is a no-op.
+// Containers must not outlive the region they were filled in (FrameArena::FRAMES frames), and should
+// reserve their size up front: the blocks left behind when they grow are only reclaimed with the region.
+template<typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    FrameAllocator(FrameArena& arena): m_pArena(&arena) {
+    }
+
+    template<typename U>
+    FrameAllocator(const FrameAllocator<U>& other): m_pArena(other.getArena()) {
+    }
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(m_pArena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) {
+    }
+
+    FrameArena* getArena() const {
+        return m_pArena;
+    }
+
+private:
+    FrameArena* m_pArena;
+};
+
+template<typename T, typename U>
+bool operator ==(const FrameAllocator<T>& a, const FrameAllocator<U>& b) {
+    return a.getArena() == b.getArena();
+}
+
+template<typename T, typename U>
+bool operator !=(const FrameAllocator<T>& a, const FrameAllocator<U>& b) {
+    return a.getArena() != b.getArena();
+}
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <ostream>
+
+namespace glimac {
+
+// Collects per-frame times and draw counts, and summarizes them (mean, percentiles, max)
+class FrameStats {
+public:
+    struct Summary {
+        double m_fMean = 0.;
+        double m_fP50 = 0.;
+        double m_fP95 = 0.;
+        double m_fP99 = 0.;
+        double m_fMax = 0.;
+    };
+
+    void reserve(size_t frameCount);
+
+    void clear();
+
+    void addFrame(double milliseconds, unsigned int drawCalls, unsigned int triangles);
+
+    size_t getFrameCount() const {
+        return m_FrameTimes.size();
+    }
+
+    Summary getFrameTimeSummary() const;
+    Summary getDrawCallSummary() const;
+    Summary getTriangleSummary() const;
+
+    // {"frames": N, "frame_ms": {...}, "draw_calls": {...}, "triangles": {...}}
+    void writeJSON(std::ostream& out) const;
+
+private:
+    std::vector<double> m_FrameTimes;
+    std::vector<double> m_DrawCalls;
+    std::vector<double> m_Triangles;
+};
+
+}
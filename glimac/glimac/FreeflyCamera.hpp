@@ -55,11 +55,30 @@ namespace glimac
             return m_Position;
         }
 
+        float getPhi() const
+        {
+            return m_fPhi;
+        }
+
+        float getTheta() const
+        {
+            return m_fTheta;
+        }
+
         void setCameraPositionY(float y)
         {
             m_Position.y = y;
         }
 
+        // Place la caméra directement, sans vérifier les murs (poses fixes des tests)
+        void setPose(const glm::vec3 &position, float phi, float theta)
+        {
+            m_Position = position;
+            m_fPhi = phi;
+            m_fTheta = theta;
+            computeDirectionVectors();
+        }
+
     private:
         glm::vec3 m_Position;
         float m_fPhi;
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "glm.hpp"
+#include "BBox.hpp"
+
+namespace glimac {
+
+/*! view frustum as six planes (left, right, bottom, top, near, far) pointing inwards */
+struct Frustum
+{
+    glm::vec4 planes[6];
+
+    Frustum() { }
+
+    /*! extracts the planes of a projection * view (* model) matrix, the planes are expressed in the space
+        transformed by the matrix (world space for ProjMatrix * ViewMatrix) */
+    explicit Frustum(const glm::mat4& m)
+    {
+        const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+        planes[0] = row3 + row0;
+        planes[1] = row3 - row0;
+        planes[2] = row3 + row1;
+        planes[3] = row3 - row1;
+        planes[4] = row3 + row2;
+        planes[5] = row3 - row2;
+
+        for (auto& plane : planes) plane /= glm::length(glm::vec3(plane));
+    }
+
+    /*! tests if a sphere is (at least partially) inside */
+    bool intersects(const glm::vec3& center, float radius) const
+    {
+        for (const auto& plane : planes) if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+        return true;
+    }
+
+    /*! tests if a box is (at least partially) inside */
+    bool intersects(const BBox3f& box) const
+    {
+        for (const auto& plane : planes) {
+            /* the box corner furthest along the plane normal */
+            const glm::vec3 p(plane.x >= 0.f ? box.upper.x : box.lower.x,
+                              plane.y >= 0.f ? box.upper.y : box.lower.y,
+                              plane.z >= 0.f ? box.upper.z : box.lower.z);
+            if (glm::dot(glm::vec3(plane), p) + plane.w < 0.f) return false;
+        }
+        return true;
+    }
+};
+
+}
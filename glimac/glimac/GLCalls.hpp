@@ -0,0 +1,988 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "GLExtensions.hpp"
+#include "GLCapture.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Thin layer over the GL calls of the renderer: GL::drawArrays(...) instead of glDrawArrays(...).
+// What it does besides the call is chosen at compile time (CMake option GLIMAC_GL_POLICY):
+//  - GLPassthroughPolicy: nothing, every wrapper inlines to the bare GL call;
+//  - GLCountingPolicy: per-frame counts of draws, binds, state changes, uniform and upload bytes;
+//  - GLValidatingPolicy: counting, plus glGetError after every call and a check of the object names
+//    given to deletes, glUseProgram and glBindFramebuffer, reported once per source location on std::cerr.
+// The counting and validating policies also feed GLCapture (glimac/GLCapture.hpp) while a capture runs.
+#if !defined(GLIMAC_GL_POLICY_PASSTHROUGH) && !defined(GLIMAC_GL_POLICY_COUNTING) && !defined(GLIMAC_GL_POLICY_VALIDATING)
+#define GLIMAC_GL_POLICY_COUNTING
+#endif
+
+namespace glimac {
+
+// GL calls of one frame
+struct GLFrameCounters {
+    unsigned int m_nDrawCalls = 0;
+    unsigned int m_nDispatches = 0; // Compute dispatches
+    uint64_t m_nVertices = 0; // Vertices or indices of the direct draws, times their instances
+    unsigned int m_nProgramBinds = 0;
+    unsigned int m_nVertexArrayBinds = 0;
+    unsigned int m_nBufferBinds = 0;
+    unsigned int m_nTextureBinds = 0;
+    unsigned int m_nFramebufferBinds = 0;
+    unsigned int m_nStateChanges = 0; // Enable / disable, blending, depth test, polygon mode, viewport, active texture
+    uint64_t m_nUniformBytes = 0;
+    uint64_t m_nBufferBytes = 0; // Uploaded to buffers and textures, bound or by name
+    uint64_t m_nMappedBytes = 0; // Written straight into persistently mapped buffers
+    unsigned int m_nErrors = 0;  // Caught by the validating policy
+
+    unsigned int getBindCount() const {
+        return m_nProgramBinds + m_nVertexArrayBinds + m_nBufferBinds + m_nTextureBinds + m_nFramebufferBinds;
+    }
+};
+
+namespace detail {
+
+inline GLFrameCounters g_CurrentGLFrame;
+
+}
+
+// Counters of the frame being recorded
+inline GLFrameCounters& getGLFrameCounters() {
+    return detail::g_CurrentGLFrame;
+}
+
+// Counters of the last frame closed by endGLFrame()
+const GLFrameCounters& getLastGLFrameCounters();
+
+// Closes the current frame, once per frame after the last GL call (before the swap)
+void endGLFrame();
+
+// "12 draws, 40 binds, 2.1 KB uniforms, 0 B uploads", then ", 9.0 KB mapped" if the frame wrote into mapped buffers
+// and ", 3 dispatches" if it ran compute shaders
+std::string getGLFrameSummary(const GLFrameCounters& counters);
+
+// Call site of a wrapper, filled by the compiler through the default argument
+struct GLSourceLocation {
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1927)
+    GLSourceLocation(const char* file = __builtin_FILE(), int line = __builtin_LINE()): m_pFile(file), m_nLine(line) {
+    }
+#else
+    GLSourceLocation(const char* file = "?", int line = 0): m_pFile(file), m_nLine(line) {
+    }
+#endif
+
+    const char* m_pFile;
+    int m_nLine;
+};
+
+// Reports the pending GL errors raised by 'function', once per call site
+void checkGLErrors(const char* function, const GLSourceLocation& where);
+
+// Reports a name that is not an object of the expected kind ("buffer", "vertex array", ...)
+void reportInvalidGLName(const char* function, const char* kind, GLuint name, const GLSourceLocation& where);
+
+// A generated framebuffer name only becomes a framebuffer when first bound, so glIsFramebuffer does not know it yet:
+// the validating policy keeps the names generated through GL:: to accept them
+void trackGeneratedFramebuffers(GLsizei n, const GLuint* framebuffers, bool created);
+bool isFramebufferName(GLuint framebuffer);
+
+// Bytes of a width x height image in the given format and type
+size_t getGLImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type);
+
+struct GLPassthroughPolicy {
+    static constexpr bool COUNTS = false;
+    static constexpr bool VALIDATES = false;
+    static constexpr bool CAPTURES = false;
+};
+
+struct GLCountingPolicy {
+    static constexpr bool COUNTS = true;
+    static constexpr bool VALIDATES = false;
+    static constexpr bool CAPTURES = true;
+};
+
+struct GLValidatingPolicy {
+    static constexpr bool COUNTS = true;
+    static constexpr bool VALIDATES = true;
+    static constexpr bool CAPTURES = true;
+};
+
+template<typename Policy>
+class GLCalls {
+public:
+    /* Programs */
+
+    static GLuint createProgram(GLSourceLocation where = {}) {
+        GLuint program = glCreateProgram();
+        track(GLObjectType::PROGRAM, 1, &program, true);
+        check("glCreateProgram", where);
+        return program;
+    }
+
+    static void deleteProgram(GLuint program, GLSourceLocation where = {}) {
+        glDeleteProgram(program);
+        track(GLObjectType::PROGRAM, 1, &program, false);
+        check("glDeleteProgram", where);
+    }
+
+    /* Binds */
+
+    static void useProgram(GLuint program, GLSourceLocation where = {}) {
+        if constexpr(Policy::VALIDATES) {
+            if(program && !glIsProgram(program)) {
+                reportInvalidGLName("glUseProgram", "program", program, where);
+            }
+        }
+        if(capturing()) {
+            record(GLOp::USE_PROGRAM, where) << program;
+        }
+        glUseProgram(program);
+        count(&GLFrameCounters::m_nProgramBinds);
+        check("glUseProgram", where);
+    }
+
+    // A generated name only becomes a vertex array when first bound: unknown names are left to glGetError
+    static void bindVertexArray(GLuint array, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::BIND_VERTEX_ARRAY, where) << array;
+        }
+        glBindVertexArray(array);
+        count(&GLFrameCounters::m_nVertexArrayBinds);
+        check("glBindVertexArray", where);
+    }
+
+    static void bindBuffer(GLenum target, GLuint buffer, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::BIND_BUFFER, where) << target << buffer;
+        }
+        glBindBuffer(target, buffer);
+        count(&GLFrameCounters::m_nBufferBinds);
+        check("glBindBuffer", where);
+    }
+
+    static void bindTexture(GLenum target, GLuint texture, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::BIND_TEXTURE, where) << target << texture;
+        }
+        glBindTexture(target, texture);
+        count(&GLFrameCounters::m_nTextureBinds);
+        check("glBindTexture", where);
+    }
+
+    static void activeTexture(GLenum texture, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::ACTIVE_TEXTURE, where) << texture;
+        }
+        glActiveTexture(texture);
+        count(&GLFrameCounters::m_nStateChanges);
+        check("glActiveTexture", where);
+    }
+
+    /* Uniforms */
+
+    static GLint getUniformLocation(GLuint program, const GLchar* name, GLSourceLocation where = {}) {
+        GLint location = glGetUniformLocation(program, name);
+        if(capturing() && location >= 0) {
+            GLCapture::Record call = record(GLOp::UNIFORM_LOCATION, where);
+            call << program << location;
+            call.string(name);
+        }
+        check("glGetUniformLocation", where);
+        return location;
+    }
+
+    static GLuint getUniformBlockIndex(GLuint program, const GLchar* name, GLSourceLocation where = {}) {
+        GLuint index = glGetUniformBlockIndex(program, name);
+        check("glGetUniformBlockIndex", where);
+        return index;
+    }
+
+    // Captured with the name of the block, which the replay looks up in its own program
+    static void uniformBlockBinding(GLuint program, GLuint blockIndex, GLuint binding, GLSourceLocation where = {}) {
+        if(capturing()) {
+            char name[256] = "";
+            glGetActiveUniformBlockName(program, blockIndex, sizeof(name), nullptr, name);
+            GLCapture::Record call = record(GLOp::UNIFORM_BLOCK_BINDING, where);
+            call << program << binding;
+            call.string(name);
+        }
+        glUniformBlockBinding(program, blockIndex, binding);
+        check("glUniformBlockBinding", where);
+    }
+
+    static void uniform1i(GLint location, GLint value, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::UNIFORM_1I, where) << location << value;
+        }
+        glUniform1i(location, value);
+        countBytes(&GLFrameCounters::m_nUniformBytes, sizeof(GLint));
+        check("glUniform1i", where);
+    }
+
+    static void uniform1f(GLint location, GLfloat value, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::UNIFORM_1F, where) << location << value;
+        }
+        glUniform1f(location, value);
+        countBytes(&GLFrameCounters::m_nUniformBytes, sizeof(GLfloat));
+        check("glUniform1f", where);
+    }
+
+    static void uniform3fv(GLint location, GLsizei count, const GLfloat* value, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::UNIFORM_3FV, where);
+            call << location << count;
+            call.data(value, 3 * count * sizeof(GLfloat));
+        }
+        glUniform3fv(location, count, value);
+        countBytes(&GLFrameCounters::m_nUniformBytes, 3 * count * sizeof(GLfloat));
+        check("glUniform3fv", where);
+    }
+
+    static void uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::UNIFORM_MATRIX_4FV, where);
+            call << location << count << transpose;
+            call.data(value, 16 * count * sizeof(GLfloat));
+        }
+        glUniformMatrix4fv(location, count, transpose, value);
+        countBytes(&GLFrameCounters::m_nUniformBytes, 16 * count * sizeof(GLfloat));
+        check("glUniformMatrix4fv", where);
+    }
+
+    /* Buffers */
+
+    static void genBuffers(GLsizei n, GLuint* buffers, GLSourceLocation where = {}) {
+        glGenBuffers(n, buffers);
+        track(GLObjectType::BUFFER, n, buffers, true);
+        if(capturing()) {
+            recordNames(GLOp::GEN_BUFFERS, n, buffers, where);
+        }
+        check("glGenBuffers", where);
+    }
+
+    static void deleteBuffers(GLsizei n, const GLuint* buffers, GLSourceLocation where = {}) {
+        if constexpr(Policy::VALIDATES) {
+            for(GLsizei i = 0; i < n; ++i) {
+                if(buffers[i] && !glIsBuffer(buffers[i])) {
+                    reportInvalidGLName("glDeleteBuffers", "buffer", buffers[i], where);
+                }
+            }
+        }
+        if(capturing()) {
+            recordNames(GLOp::DELETE_BUFFERS, n, buffers, where);
+        }
+        glDeleteBuffers(n, buffers);
+        track(GLObjectType::BUFFER, n, buffers, false);
+        check("glDeleteBuffers", where);
+    }
+
+    static void bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::BUFFER_DATA, where);
+            call << target << int64_t(size) << usage;
+            call.data(data, size);
+        }
+        glBufferData(target, size, data, usage);
+        countBytes(&GLFrameCounters::m_nBufferBytes, data ? size : 0);
+        check("glBufferData", where);
+    }
+
+    static void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::BUFFER_SUB_DATA, where);
+            call << target << int64_t(offset) << int64_t(size);
+            call.data(data, size);
+        }
+        glBufferSubData(target, offset, size, data);
+        countBytes(&GLFrameCounters::m_nBufferBytes, size);
+        check("glBufferSubData", where);
+    }
+
+    // Immutable storage (GL_ARB_buffer_storage, check GLAD_GL_ARB_buffer_storage first).
+    // Captured as glBufferData: the replay does not need the storage to be immutable
+    static void bufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::BUFFER_DATA, where);
+            call << target << int64_t(size) << GLenum(GL_DYNAMIC_DRAW);
+            call.data(data, size);
+        }
+        glBufferStorage(target, size, data, flags);
+        countBytes(&GLFrameCounters::m_nBufferBytes, data ? size : 0);
+        check("glBufferStorage", where);
+    }
+
+    // Not captured: what is written through the mapping is recorded by mappedWrite()
+    static void* mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access, GLSourceLocation where = {}) {
+        void* pointer = glMapBufferRange(target, offset, length, access);
+        check("glMapBufferRange", where);
+        return pointer;
+    }
+
+    // No GL call: counts 'size' bytes written at 'offset' through a persistent mapping of 'buffer', recorded in
+    // the captures as the glBufferSubData that reproduces them
+    static void mappedWrite(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::BIND_BUFFER, where) << GLenum(GL_COPY_WRITE_BUFFER) << buffer;
+            GLCapture::Record call = record(GLOp::BUFFER_SUB_DATA, where);
+            call << GLenum(GL_COPY_WRITE_BUFFER) << int64_t(offset) << int64_t(size);
+            call.data(data, size);
+        }
+        countBytes(&GLFrameCounters::m_nMappedBytes, size);
+    }
+
+    static void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::BIND_BUFFER_RANGE, where) << target << index << buffer << int64_t(offset) << int64_t(size);
+        }
+        glBindBufferRange(target, index, buffer, offset, size);
+        count(&GLFrameCounters::m_nBufferBinds);
+        check("glBindBufferRange", where);
+    }
+
+    static void bindBufferBase(GLenum target, GLuint index, GLuint buffer, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::BIND_BUFFER_BASE, where) << target << index << buffer;
+        }
+        glBindBufferBase(target, index, buffer);
+        count(&GLFrameCounters::m_nBufferBinds);
+        check("glBindBufferBase", where);
+    }
+
+    // Reads back buffer data, waiting for the GPU: not for the frame loop
+    static void getBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void* data, GLSourceLocation where = {}) {
+        glGetBufferSubData(target, offset, size, data);
+        check("glGetBufferSubData", where);
+    }
+
+    /* Vertex arrays */
+
+    static void genVertexArrays(GLsizei n, GLuint* arrays, GLSourceLocation where = {}) {
+        glGenVertexArrays(n, arrays);
+        track(GLObjectType::VERTEX_ARRAY, n, arrays, true);
+        if(capturing()) {
+            recordNames(GLOp::GEN_VERTEX_ARRAYS, n, arrays, where);
+        }
+        check("glGenVertexArrays", where);
+    }
+
+    static void deleteVertexArrays(GLsizei n, const GLuint* arrays, GLSourceLocation where = {}) {
+        if constexpr(Policy::VALIDATES) {
+            for(GLsizei i = 0; i < n; ++i) {
+                if(arrays[i] && !glIsVertexArray(arrays[i])) {
+                    reportInvalidGLName("glDeleteVertexArrays", "vertex array", arrays[i], where);
+                }
+            }
+        }
+        if(capturing()) {
+            recordNames(GLOp::DELETE_VERTEX_ARRAYS, n, arrays, where);
+        }
+        glDeleteVertexArrays(n, arrays);
+        track(GLObjectType::VERTEX_ARRAY, n, arrays, false);
+        check("glDeleteVertexArrays", where);
+    }
+
+    static void enableVertexAttribArray(GLuint index, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::ENABLE_VERTEX_ATTRIB_ARRAY, where) << index;
+        }
+        glEnableVertexAttribArray(index);
+        check("glEnableVertexAttribArray", where);
+    }
+
+    static void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer,
+                                    GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::VERTEX_ATTRIB_POINTER, where) << index << size << type << uint8_t(normalized) << stride
+                                                       << uint64_t(reinterpret_cast<uintptr_t>(pointer));
+        }
+        glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+        check("glVertexAttribPointer", where);
+    }
+
+    // Integer attributes, read by the shaders without conversion
+    static void vertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer,
+                                     GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::VERTEX_ATTRIB_I_POINTER, where) << index << size << type << stride
+                                                         << uint64_t(reinterpret_cast<uintptr_t>(pointer));
+        }
+        glVertexAttribIPointer(index, size, type, stride, pointer);
+        check("glVertexAttribIPointer", where);
+    }
+
+    static void vertexAttribDivisor(GLuint index, GLuint divisor, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::VERTEX_ATTRIB_DIVISOR, where) << index << divisor;
+        }
+        glVertexAttribDivisor(index, divisor);
+        check("glVertexAttribDivisor", where);
+    }
+
+    static void vertexAttrib4fv(GLuint index, const GLfloat* value, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::VERTEX_ATTRIB_4FV, where);
+            call << index;
+            call.data(value, 4 * sizeof(GLfloat));
+        }
+        glVertexAttrib4fv(index, value);
+        check("glVertexAttrib4fv", where);
+    }
+
+    /* Separate attribute formats and buffer bindings (GL 4.3) */
+
+    static void vertexAttribFormat(GLuint index, GLint size, GLenum type, GLboolean normalized, GLuint relativeOffset,
+                                   GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::VERTEX_ATTRIB_FORMAT, where) << index << size << type << uint8_t(normalized) << relativeOffset;
+        }
+        glVertexAttribFormat(index, size, type, normalized, relativeOffset);
+        check("glVertexAttribFormat", where);
+    }
+
+    static void vertexAttribBinding(GLuint index, GLuint binding, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::VERTEX_ATTRIB_BINDING, where) << index << binding;
+        }
+        glVertexAttribBinding(index, binding);
+        check("glVertexAttribBinding", where);
+    }
+
+    static void vertexBindingDivisor(GLuint binding, GLuint divisor, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::VERTEX_BINDING_DIVISOR, where) << binding << divisor;
+        }
+        glVertexBindingDivisor(binding, divisor);
+        check("glVertexBindingDivisor", where);
+    }
+
+    static void bindVertexBuffer(GLuint binding, GLuint buffer, GLintptr offset, GLsizei stride, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::BIND_VERTEX_BUFFER, where) << binding << buffer << int64_t(offset) << stride;
+        }
+        glBindVertexBuffer(binding, buffer, offset, stride);
+        count(&GLFrameCounters::m_nBufferBinds);
+        check("glBindVertexBuffer", where);
+    }
+
+    /* Textures */
+
+    static void genTextures(GLsizei n, GLuint* textures, GLSourceLocation where = {}) {
+        glGenTextures(n, textures);
+        track(GLObjectType::TEXTURE, n, textures, true);
+        if(capturing()) {
+            recordNames(GLOp::GEN_TEXTURES, n, textures, where);
+        }
+        check("glGenTextures", where);
+    }
+
+    static void deleteTextures(GLsizei n, const GLuint* textures, GLSourceLocation where = {}) {
+        if constexpr(Policy::VALIDATES) {
+            for(GLsizei i = 0; i < n; ++i) {
+                if(textures[i] && !glIsTexture(textures[i])) {
+                    reportInvalidGLName("glDeleteTextures", "texture", textures[i], where);
+                }
+            }
+        }
+        if(capturing()) {
+            recordNames(GLOp::DELETE_TEXTURES, n, textures, where);
+        }
+        glDeleteTextures(n, textures);
+        track(GLObjectType::TEXTURE, n, textures, false);
+        check("glDeleteTextures", where);
+    }
+
+    static void texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border,
+                           GLenum format, GLenum type, const void* pixels, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::TEX_IMAGE_2D, where);
+            call << target << level << internalFormat << width << height << border << format << type;
+            call.data(pixels, getGLImageSize(width, height, format, type));
+        }
+        glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+        if constexpr(Policy::CAPTURES) {
+            GLCapture::trackTextureImage(target);
+        }
+        if constexpr(Policy::COUNTS) {
+            if(pixels) {
+                getGLFrameCounters().m_nBufferBytes += getGLImageSize(width, height, format, type);
+            }
+        }
+        check("glTexImage2D", where);
+    }
+
+    static void texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type,
+                              const void* pixels, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::TEX_SUB_IMAGE_2D, where);
+            call << target << level << x << y << width << height << format << type;
+            call.data(pixels, getGLImageSize(width, height, format, type));
+        }
+        glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+        if constexpr(Policy::COUNTS) {
+            getGLFrameCounters().m_nBufferBytes += getGLImageSize(width, height, format, type);
+        }
+        check("glTexSubImage2D", where);
+    }
+
+    // Texture arrays: the layers are the depth
+    static void texImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border,
+                           GLenum format, GLenum type, const void* pixels, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::TEX_IMAGE_3D, where);
+            call << target << level << internalFormat << width << height << depth << border << format << type;
+            call.data(pixels, getGLImageSize(width, height, format, type) * depth);
+        }
+        glTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, pixels);
+        if constexpr(Policy::CAPTURES) {
+            GLCapture::trackTextureImage(target);
+        }
+        if constexpr(Policy::COUNTS) {
+            if(pixels) {
+                getGLFrameCounters().m_nBufferBytes += getGLImageSize(width, height, format, type) * depth;
+            }
+        }
+        check("glTexImage3D", where);
+    }
+
+    static void texSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height, GLsizei depth,
+                              GLenum format, GLenum type, const void* pixels, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::TEX_SUB_IMAGE_3D, where);
+            call << target << level << x << y << z << width << height << depth << format << type;
+            call.data(pixels, getGLImageSize(width, height, format, type) * depth);
+        }
+        glTexSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels);
+        if constexpr(Policy::COUNTS) {
+            getGLFrameCounters().m_nBufferBytes += getGLImageSize(width, height, format, type) * depth;
+        }
+        check("glTexSubImage3D", where);
+    }
+
+    static void generateMipmap(GLenum target, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::GENERATE_MIPMAP, where) << target;
+        }
+        glGenerateMipmap(target);
+        check("glGenerateMipmap", where);
+    }
+
+    static void texParameteri(GLenum target, GLenum name, GLint param, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::TEX_PARAMETERI, where) << target << name << param;
+        }
+        glTexParameteri(target, name, param);
+        check("glTexParameteri", where);
+    }
+
+    /* Framebuffers */
+
+    static void genFramebuffers(GLsizei n, GLuint* framebuffers, GLSourceLocation where = {}) {
+        glGenFramebuffers(n, framebuffers);
+        track(GLObjectType::FRAMEBUFFER, n, framebuffers, true);
+        if constexpr(Policy::VALIDATES) {
+            trackGeneratedFramebuffers(n, framebuffers, true);
+        }
+        if(capturing()) {
+            recordNames(GLOp::GEN_FRAMEBUFFERS, n, framebuffers, where);
+        }
+        check("glGenFramebuffers", where);
+    }
+
+    static void deleteFramebuffers(GLsizei n, const GLuint* framebuffers, GLSourceLocation where = {}) {
+        if constexpr(Policy::VALIDATES) {
+            for(GLsizei i = 0; i < n; ++i) {
+                if(framebuffers[i] && !isFramebufferName(framebuffers[i])) {
+                    reportInvalidGLName("glDeleteFramebuffers", "framebuffer", framebuffers[i], where);
+                }
+            }
+            trackGeneratedFramebuffers(n, framebuffers, false);
+        }
+        if(capturing()) {
+            recordNames(GLOp::DELETE_FRAMEBUFFERS, n, framebuffers, where);
+        }
+        glDeleteFramebuffers(n, framebuffers);
+        track(GLObjectType::FRAMEBUFFER, n, framebuffers, false);
+        check("glDeleteFramebuffers", where);
+    }
+
+    // Names not created through GL:: (the default framebuffer of a headless context) are replayed as the replay's own
+    static void bindFramebuffer(GLenum target, GLuint framebuffer, GLSourceLocation where = {}) {
+        if constexpr(Policy::VALIDATES) {
+            if(framebuffer && !isFramebufferName(framebuffer)) {
+                reportInvalidGLName("glBindFramebuffer", "framebuffer", framebuffer, where);
+            }
+        }
+        if(capturing()) {
+            record(GLOp::BIND_FRAMEBUFFER, where) << target << framebuffer;
+        }
+        glBindFramebuffer(target, framebuffer);
+        count(&GLFrameCounters::m_nFramebufferBinds);
+        check("glBindFramebuffer", where);
+    }
+
+    static void framebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level,
+                                     GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::FRAMEBUFFER_TEXTURE_2D, where) << target << attachment << textureTarget << texture << level;
+        }
+        glFramebufferTexture2D(target, attachment, textureTarget, texture, level);
+        check("glFramebufferTexture2D", where);
+    }
+
+    static void blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
+                                GLbitfield mask, GLenum filter, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::BLIT_FRAMEBUFFER, where) << srcX0 << srcY0 << srcX1 << srcY1 << dstX0 << dstY0 << dstX1 << dstY1 << mask << filter;
+        }
+        glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+        check("glBlitFramebuffer", where);
+    }
+
+    /* State */
+
+    static void enable(GLenum capability, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::ENABLE, where) << capability;
+        }
+        glEnable(capability);
+        count(&GLFrameCounters::m_nStateChanges);
+        check("glEnable", where);
+    }
+
+    static void disable(GLenum capability, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::DISABLE, where) << capability;
+        }
+        glDisable(capability);
+        count(&GLFrameCounters::m_nStateChanges);
+        check("glDisable", where);
+    }
+
+    static void blendFunc(GLenum sfactor, GLenum dfactor, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::BLEND_FUNC, where) << sfactor << dfactor;
+        }
+        glBlendFunc(sfactor, dfactor);
+        count(&GLFrameCounters::m_nStateChanges);
+        check("glBlendFunc", where);
+    }
+
+    static void depthFunc(GLenum func, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::DEPTH_FUNC, where) << func;
+        }
+        glDepthFunc(func);
+        count(&GLFrameCounters::m_nStateChanges);
+        check("glDepthFunc", where);
+    }
+
+    static void polygonMode(GLenum face, GLenum mode, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::POLYGON_MODE, where) << face << mode;
+        }
+        glPolygonMode(face, mode);
+        count(&GLFrameCounters::m_nStateChanges);
+        check("glPolygonMode", where);
+    }
+
+    static void viewport(GLint x, GLint y, GLsizei width, GLsizei height, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::VIEWPORT, where) << x << y << width << height;
+        }
+        glViewport(x, y, width, height);
+        count(&GLFrameCounters::m_nStateChanges);
+        check("glViewport", where);
+    }
+
+    static void clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::CLEAR_COLOR, where) << red << green << blue << alpha;
+        }
+        glClearColor(red, green, blue, alpha);
+        check("glClearColor", where);
+    }
+
+    static void clear(GLbitfield mask, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::CLEAR, where) << mask;
+        }
+        glClear(mask);
+        check("glClear", where);
+    }
+
+    /* Draws */
+
+    static void drawArrays(GLenum mode, GLint first, GLsizei count, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::DRAW_ARRAYS, where) << mode << first << count;
+        }
+        glDrawArrays(mode, first, count);
+        countDraw(count);
+        check("glDrawArrays", where);
+    }
+
+    static void drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::DRAW_ELEMENTS, where) << mode << count << type << uint64_t(reinterpret_cast<uintptr_t>(indices));
+        }
+        glDrawElements(mode, count, type, indices);
+        countDraw(count);
+        check("glDrawElements", where);
+    }
+
+    static void drawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount, GLuint baseInstance,
+                                                GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::DRAW_ARRAYS_INSTANCED_BASE_INSTANCE, where) << mode << first << count << instanceCount << baseInstance;
+        }
+        glDrawArraysInstancedBaseInstance(mode, first, count, instanceCount, baseInstance);
+        countDraw(uint64_t(count) * instanceCount);
+        check("glDrawArraysInstancedBaseInstance", where);
+    }
+
+    // The commands stay on the GPU: counted as one draw call, without vertices
+    static void multiDrawArraysIndirect(GLenum mode, const void* indirect, GLsizei drawCount, GLsizei stride, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::MULTI_DRAW_ARRAYS_INDIRECT, where) << mode << uint64_t(reinterpret_cast<uintptr_t>(indirect)) << drawCount << stride;
+        }
+        glMultiDrawArraysIndirect(mode, indirect, drawCount, stride);
+        countDraw(0);
+        check("glMultiDrawArraysIndirect", where);
+    }
+
+    // Same, with the indices of each command (DrawElementsIndirectCommand)
+    static void multiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride,
+                                          GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::MULTI_DRAW_ELEMENTS_INDIRECT, where) << mode << type << uint64_t(reinterpret_cast<uintptr_t>(indirect)) << drawCount
+                                                              << stride;
+        }
+        glMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+        countDraw(0);
+        check("glMultiDrawElementsIndirect", where);
+    }
+
+    /* Compute (GL 4.3) */
+
+    static void dispatchCompute(GLuint groupsX, GLuint groupsY, GLuint groupsZ, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::DISPATCH_COMPUTE, where) << groupsX << groupsY << groupsZ;
+        }
+        glDispatchCompute(groupsX, groupsY, groupsZ);
+        count(&GLFrameCounters::m_nDispatches);
+        check("glDispatchCompute", where);
+    }
+
+    static void memoryBarrier(GLbitfield barriers, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::MEMORY_BARRIER, where) << barriers;
+        }
+        glMemoryBarrier(barriers);
+        check("glMemoryBarrier", where);
+    }
+
+    static void bindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format,
+                                 GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::BIND_IMAGE_TEXTURE, where) << unit << texture << level << uint8_t(layered) << layer << access << format;
+        }
+        glBindImageTexture(unit, texture, level, layered, layer, access, format);
+        count(&GLFrameCounters::m_nTextureBinds);
+        check("glBindImageTexture", where);
+    }
+
+    /* Direct state access (GL 4.5, GL_ARB_direct_state_access): edits by object name, without binding */
+
+    // The objects exist as soon as they are created, before any bind
+    static void createBuffers(GLsizei n, GLuint* buffers, GLSourceLocation where = {}) {
+        glCreateBuffers(n, buffers);
+        track(GLObjectType::BUFFER, n, buffers, true);
+        if(capturing()) {
+            recordNames(GLOp::CREATE_BUFFERS, n, buffers, where);
+        }
+        check("glCreateBuffers", where);
+    }
+
+    static void namedBufferData(GLuint buffer, GLsizeiptr size, const void* data, GLenum usage, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::NAMED_BUFFER_DATA, where);
+            call << buffer << int64_t(size) << usage;
+            call.data(data, size);
+        }
+        glNamedBufferData(buffer, size, data, usage);
+        countBytes(&GLFrameCounters::m_nBufferBytes, data ? size : 0);
+        check("glNamedBufferData", where);
+    }
+
+    static void namedBufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::NAMED_BUFFER_SUB_DATA, where);
+            call << buffer << int64_t(offset) << int64_t(size);
+            call.data(data, size);
+        }
+        glNamedBufferSubData(buffer, offset, size, data);
+        countBytes(&GLFrameCounters::m_nBufferBytes, size);
+        check("glNamedBufferSubData", where);
+    }
+
+    // Captured as glNamedBufferData, like bufferStorage()
+    static void namedBufferStorage(GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::NAMED_BUFFER_DATA, where);
+            call << buffer << int64_t(size) << GLenum(GL_DYNAMIC_DRAW);
+            call.data(data, size);
+        }
+        glNamedBufferStorage(buffer, size, data, flags);
+        countBytes(&GLFrameCounters::m_nBufferBytes, data ? size : 0);
+        check("glNamedBufferStorage", where);
+    }
+
+    // Not captured, as mapBufferRange()
+    static void* mapNamedBufferRange(GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access, GLSourceLocation where = {}) {
+        void* pointer = glMapNamedBufferRange(buffer, offset, length, access);
+        check("glMapNamedBufferRange", where);
+        return pointer;
+    }
+
+    static void createTextures(GLenum target, GLsizei n, GLuint* textures, GLSourceLocation where = {}) {
+        glCreateTextures(target, n, textures);
+        track(GLObjectType::TEXTURE, n, textures, true);
+        if constexpr(Policy::CAPTURES) {
+            GLCapture::trackTextureTarget(n, textures, target);
+        }
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::CREATE_TEXTURES, where);
+            call << target << n;
+            for(GLsizei i = 0; i < n; ++i) {
+                call << textures[i];
+            }
+        }
+        check("glCreateTextures", where);
+    }
+
+    static void textureStorage2D(GLuint texture, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height,
+                                 GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::TEXTURE_STORAGE_2D, where) << texture << levels << internalFormat << width << height;
+        }
+        glTextureStorage2D(texture, levels, internalFormat, width, height);
+        check("glTextureStorage2D", where);
+    }
+
+    static void textureStorage3D(GLuint texture, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height, GLsizei depth,
+                                 GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::TEXTURE_STORAGE_3D, where) << texture << levels << internalFormat << width << height << depth;
+        }
+        glTextureStorage3D(texture, levels, internalFormat, width, height, depth);
+        check("glTextureStorage3D", where);
+    }
+
+    static void textureSubImage2D(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format,
+                                  GLenum type, const void* pixels, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::TEXTURE_SUB_IMAGE_2D, where);
+            call << texture << level << x << y << width << height << format << type;
+            call.data(pixels, getGLImageSize(width, height, format, type));
+        }
+        glTextureSubImage2D(texture, level, x, y, width, height, format, type, pixels);
+        if constexpr(Policy::COUNTS) {
+            getGLFrameCounters().m_nBufferBytes += getGLImageSize(width, height, format, type);
+        }
+        check("glTextureSubImage2D", where);
+    }
+
+    // The faces of a cube map and the layers of an array are its z
+    static void textureSubImage3D(GLuint texture, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height, GLsizei depth,
+                                  GLenum format, GLenum type, const void* pixels, GLSourceLocation where = {}) {
+        if(capturing()) {
+            GLCapture::Record call = record(GLOp::TEXTURE_SUB_IMAGE_3D, where);
+            call << texture << level << x << y << z << width << height << depth << format << type;
+            call.data(pixels, getGLImageSize(width, height, format, type) * depth);
+        }
+        glTextureSubImage3D(texture, level, x, y, z, width, height, depth, format, type, pixels);
+        if constexpr(Policy::COUNTS) {
+            getGLFrameCounters().m_nBufferBytes += getGLImageSize(width, height, format, type) * depth;
+        }
+        check("glTextureSubImage3D", where);
+    }
+
+    static void textureParameteri(GLuint texture, GLenum name, GLint param, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::TEXTURE_PARAMETERI, where) << texture << name << param;
+        }
+        glTextureParameteri(texture, name, param);
+        check("glTextureParameteri", where);
+    }
+
+    static void generateTextureMipmap(GLuint texture, GLSourceLocation where = {}) {
+        if(capturing()) {
+            record(GLOp::GENERATE_TEXTURE_MIPMAP, where) << texture;
+        }
+        glGenerateTextureMipmap(texture);
+        check("glGenerateTextureMipmap", where);
+    }
+
+private:
+    static bool capturing() {
+        if constexpr(Policy::CAPTURES) {
+            return GLCapture::isRecording();
+        }
+        return false;
+    }
+
+    static GLCapture::Record record(GLOp op, const GLSourceLocation& where) {
+        return GLCapture::Record(op, where.m_pFile, where.m_nLine);
+    }
+
+    static void recordNames(GLOp op, GLsizei n, const GLuint* names, const GLSourceLocation& where) {
+        GLCapture::Record call = record(op, where);
+        call << n;
+        for(GLsizei i = 0; i < n; ++i) {
+            call << names[i];
+        }
+    }
+
+    static void track(GLObjectType type, GLsizei n, const GLuint* names, bool created) {
+        if constexpr(Policy::CAPTURES) {
+            GLCapture::trackObjects(type, n, names, created);
+        }
+    }
+
+    static void count(unsigned int GLFrameCounters::* counter) {
+        if constexpr(Policy::COUNTS) {
+            ++(getGLFrameCounters().*counter);
+        }
+    }
+
+    static void countBytes(uint64_t GLFrameCounters::* counter, uint64_t bytes) {
+        if constexpr(Policy::COUNTS) {
+            getGLFrameCounters().*counter += bytes;
+        }
+    }
+
+    static void countDraw(uint64_t vertices) {
+        if constexpr(Policy::COUNTS) {
+            ++getGLFrameCounters().m_nDrawCalls;
+            getGLFrameCounters().m_nVertices += vertices;
+        }
+    }
+
+    static void check(const char* function, const GLSourceLocation& where) {
+        if constexpr(Policy::VALIDATES) {
+            checkGLErrors(function, where);
+        }
+    }
+};
+
+#if defined(GLIMAC_GL_POLICY_PASSTHROUGH)
+using GL = GLCalls<GLPassthroughPolicy>;
+#elif defined(GLIMAC_GL_POLICY_VALIDATING)
+using GL = GLCalls<GLValidatingPolicy>;
+#else
+using GL = GLCalls<GLCountingPolicy>;
+#endif
+
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace glimac {
+
+// Binary trace of the GL calls made through GL:: (glimac/GLCalls.hpp) during a span of frames,
+// replayed without the application by glimac_replay.
+//
+// File layout: a GLTraceHeader, then records { uint32 op, uint32 source location, uint32 payload size, payload }.
+// The trace starts with a snapshot of the live objects and of the GL state (programs with their sources and uniform
+// block bindings, buffer and texture contents read back from the GPU, vertex array layouts, framebuffer attachments,
+// uniform values), closed by SNAPSHOT_END, followed by the calls of each frame, each frame closed by FRAME_END.
+// Object names are the application's; the replay maps them to its own. Uniform locations are mapped by name through
+// UNIFORM_LOCATION records. Writes through persistent mappings are recorded as the glBufferSubData that reproduces them.
+// Data blocks are { uint8 compressed, uint64 size, uint64 stored size, bytes }, zlib-compressed when it pays off.
+
+static const char GL_TRACE_MAGIC[4] = {'G', 'L', 'T', 'R'};
+static const uint32_t GL_TRACE_VERSION = 7;
+
+struct GLTraceHeader {
+    char m_Magic[4];
+    uint32_t m_nVersion;
+    uint32_t m_nWidth; // Viewport when the capture started
+    uint32_t m_nHeight;
+    uint32_t m_nFrameCount;
+};
+
+enum class GLOp : uint32_t {
+    // Structure
+    SOURCE_LOCATION = 1, // uint32 id, string "file:line"
+    SNAPSHOT_END,
+    FRAME_END,
+
+    // Snapshot
+    CREATE_PROGRAM,     // uint32 program, uint32 shader count, { uint32 type, string source }...
+    UNIFORM_LOCATION,   // uint32 program, int32 location, string name (also recorded by glGetUniformLocation)
+    SET_UNIFORM,        // uint32 program, int32 location, uint32 type, uint32 count, data
+    DISABLE_VERTEX_ATTRIB_ARRAY, // uint32 index
+    VERTEX_ATTRIB_I_POINTER,     // uint32 index, int32 size, uint32 type, int32 stride, uint64 offset (also recorded by glVertexAttribIPointer)
+
+    // GL:: calls, arguments in the order of the GL function, pointers to data as data blocks
+    USE_PROGRAM,
+    BIND_VERTEX_ARRAY,
+    BIND_BUFFER,
+    BIND_TEXTURE,
+    ACTIVE_TEXTURE,
+    UNIFORM_1I,
+    UNIFORM_1F,
+    UNIFORM_3FV,
+    UNIFORM_MATRIX_4FV,
+    GEN_BUFFERS,
+    DELETE_BUFFERS,
+    BUFFER_DATA,
+    BUFFER_SUB_DATA,
+    GEN_VERTEX_ARRAYS,
+    DELETE_VERTEX_ARRAYS,
+    ENABLE_VERTEX_ATTRIB_ARRAY,
+    VERTEX_ATTRIB_POINTER, // uint32 index, int32 size, uint32 type, uint8 normalized, int32 stride, uint64 offset
+    VERTEX_ATTRIB_DIVISOR,
+    VERTEX_ATTRIB_4FV,
+    GEN_TEXTURES,
+    DELETE_TEXTURES,
+    TEX_IMAGE_2D,
+    TEX_PARAMETERI,
+    GEN_FRAMEBUFFERS,
+    DELETE_FRAMEBUFFERS,
+    BIND_FRAMEBUFFER,
+    FRAMEBUFFER_TEXTURE_2D, // uint32 target, uint32 attachment, uint32 texture target, uint32 texture, int32 level
+    ENABLE,
+    DISABLE,
+    BLEND_FUNC,
+    DEPTH_FUNC,
+    POLYGON_MODE,
+    VIEWPORT,
+    CLEAR_COLOR,
+    CLEAR,
+    DRAW_ARRAYS,
+    DRAW_ELEMENTS,
+    DRAW_ARRAYS_INSTANCED_BASE_INSTANCE,
+    MULTI_DRAW_ARRAYS_INDIRECT,
+    BIND_BUFFER_RANGE,     // uint32 target, uint32 index, uint32 buffer, int64 offset, int64 size
+    UNIFORM_BLOCK_BINDING, // uint32 program, uint32 binding, string block name (also in the snapshot)
+    BIND_BUFFER_BASE,
+    BLIT_FRAMEBUFFER,
+    DISPATCH_COMPUTE,
+    MEMORY_BARRIER,
+    BIND_IMAGE_TEXTURE, // uint32 unit, uint32 texture, int32 level, uint8 layered, int32 layer, uint32 access, uint32 format
+    VERTEX_ATTRIB_FORMAT, // uint32 index, int32 size, uint32 type, uint8 normalized, uint32 relative offset (also in the snapshot)
+    VERTEX_ATTRIB_I_FORMAT, // Snapshot only: uint32 index, int32 size, uint32 type, uint32 relative offset
+    VERTEX_ATTRIB_BINDING,
+    VERTEX_BINDING_DIVISOR,
+    BIND_VERTEX_BUFFER, // uint32 binding, uint32 buffer, int64 offset, int32 stride
+    TEX_SUB_IMAGE_2D, // uint32 target, int32 level, int32 x, int32 y, int32 width, int32 height, uint32 format, uint32 type, data
+    CREATE_BUFFERS,
+    NAMED_BUFFER_DATA,     // uint32 buffer, int64 size, uint32 usage, data
+    NAMED_BUFFER_SUB_DATA, // uint32 buffer, int64 offset, int64 size, data
+    CREATE_TEXTURES,       // uint32 target, int32 n, uint32 names...
+    TEXTURE_STORAGE_2D,    // uint32 texture, int32 levels, uint32 internal format, int32 width, int32 height
+    TEXTURE_SUB_IMAGE_2D,  // uint32 texture, then as TEX_SUB_IMAGE_2D without the target
+    TEXTURE_SUB_IMAGE_3D,  // uint32 texture, int32 level, int32 x, y, z, width, height, depth, uint32 format, uint32 type, data
+    TEXTURE_PARAMETERI,
+    TEX_IMAGE_3D,          // uint32 target, int32 level, int32 internal format, int32 width, height, depth, border, uint32 format, uint32 type, data
+    TEX_SUB_IMAGE_3D,      // uint32 target, int32 level, int32 x, y, z, width, height, depth, uint32 format, uint32 type, data
+    GENERATE_MIPMAP,
+    TEXTURE_STORAGE_3D,    // uint32 texture, int32 levels, uint32 internal format, int32 width, int32 height, int32 depth
+    GENERATE_TEXTURE_MIPMAP,
+    MULTI_DRAW_ELEMENTS_INDIRECT, // uint32 mode, uint32 type, uint64 offset, int32 draw count, int32 stride
+
+    COUNT
+};
+
+// "glDrawArrays", "snapshot: program"...
+const char* getGLOpName(GLOp op);
+
+// GL objects followed by the capture, to snapshot them when it starts
+enum class GLObjectType {
+    BUFFER,
+    VERTEX_ARRAY,
+    TEXTURE,
+    PROGRAM,
+    FRAMEBUFFER
+};
+
+class GLCapture {
+public:
+    // Starts recording the next 'frameCount' frames into 'path'. To be called between two frames,
+    // with the context current: the snapshot is taken right away.
+    static bool start(const std::string& path, unsigned int frameCount);
+
+    // Closes the trace before the end of its frames
+    static void stop();
+
+    static bool isRecording() {
+        return s_bRecording;
+    }
+
+    // Called by endGLFrame(); the trace is closed after its last frame
+    static void endFrame();
+
+    // Object names created and deleted through GL::, followed whether or not a capture is running
+    static void trackObjects(GLObjectType type, GLsizei n, const GLuint* names, bool created);
+    // Target of the texture bound to 'target' (a cube map for its faces), given an image
+    static void trackTextureImage(GLenum target);
+    // Target of textures created with it (glCreateTextures)
+    static void trackTextureTarget(GLsizei n, const GLuint* textures, GLenum target);
+
+    // One record: GLCapture::Record(GLOp::DRAW_ARRAYS, file, line) << mode << first << count;
+    // written to the trace when destroyed
+    class Record {
+    public:
+        Record(GLOp op, const char* file, int line);
+        ~Record();
+
+        template<typename T>
+        Record& operator <<(const T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "Record values are copied as bytes");
+            const auto bytes = reinterpret_cast<const unsigned char*>(&value);
+            m_Payload.insert(m_Payload.end(), bytes, bytes + sizeof(T));
+            return *this;
+        }
+
+        Record& data(const void* data, size_t size);
+        Record& string(const char* text);
+
+    private:
+        Record(const Record&);
+        Record& operator =(const Record&);
+
+        GLOp m_Op;
+        uint32_t m_nLocation;
+        std::vector<unsigned char>& m_Payload;
+    };
+
+private:
+    inline static bool s_bRecording = false;
+};
+
+}
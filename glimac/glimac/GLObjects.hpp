@@ -0,0 +1,342 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "GLCalls.hpp"
+#include <cstddef>
+#include <ostream>
+
+// Owning wrappers of the GL objects of the renderer, created and deleted through GL:: (glimac/GLCalls.hpp).
+// Each live object is recorded in a registry with a usage category, a label and its allocated size, so the
+// GPU memory of the application can be reported by category and checked for leaks at shutdown.
+// The registry is not thread-safe: objects are created and deleted on the thread of the GL context.
+
+namespace glimac {
+
+enum class GLMemoryCategory {
+    VERTICES,       // Static vertex buffers
+    INDICES,        // Element buffers
+    STREAMING,      // Buffers rewritten every frame (instance data)
+    COMMANDS,       // Indirect draw commands
+    TEXTURES,       // Sampled textures
+    RENDER_TARGETS, // Textures attached to framebuffers
+    COUNT
+};
+
+// "vertices", "indices", "streaming", "commands", "textures", "render targets"
+const char* getGLMemoryCategoryName(GLMemoryCategory category);
+
+// Live and peak bytes of the registered objects
+struct GLMemoryUsage {
+    size_t m_nBytes[size_t(GLMemoryCategory::COUNT)] = {};
+    size_t m_nPeakBytes[size_t(GLMemoryCategory::COUNT)] = {};
+    size_t m_nTotalBytes = 0;
+    size_t m_nPeakTotalBytes = 0; // Peak of the sum, not the sum of the peaks
+    size_t m_nObjects = 0;
+};
+
+const GLMemoryUsage& getGLMemoryUsage();
+
+// Writes one line per registered object still alive (kind, name, label, size and where it was created)
+// and returns their count: at shutdown, after the GL objects of the application are destroyed, these are leaks
+size_t reportGLLeaks(std::ostream& out);
+
+// Bytes of a width x height image stored with 'internalFormat' (not the format of the uploaded pixels)
+size_t getGLTextureSize(GLsizei width, GLsizei height, GLint internalFormat);
+
+// Buffers and textures are created and edited by name (glCreateBuffers, glNamedBufferData, glTextureStorage2D...)
+// when the context has direct state access (GL 4.5, GL_ARB_direct_state_access): their edits then leave every bind
+// point alone. Otherwise they are bound to be edited. Disabling it forces the bind-to-edit path, to compare the two;
+// to be set before the buffers and textures are created
+bool isDirectStateAccessSupported();
+void setDirectStateAccessEnabled(bool enabled);
+bool isDirectStateAccessEnabled(); // Supported and not disabled
+
+namespace detail {
+
+void registerGLObject(GLObjectType type, GLuint name, GLMemoryCategory category, const char* label, const GLSourceLocation& where);
+void resizeGLObject(GLObjectType type, GLuint name, size_t bytes);
+void unregisterGLObject(GLObjectType type, GLuint name);
+
+}
+
+class Buffer {
+public:
+    // No object: assign a created one before use
+    Buffer() = default;
+
+    Buffer(GLMemoryCategory category, const char* label, GLSourceLocation where = {}) {
+        if(isDirectStateAccessEnabled()) {
+            GL::createBuffers(1, &m_nGLId, where);
+        } else {
+            GL::genBuffers(1, &m_nGLId, where);
+        }
+        detail::registerGLObject(GLObjectType::BUFFER, m_nGLId, category, label, where);
+    }
+
+    ~Buffer() {
+        release();
+    }
+
+    Buffer(Buffer&& rvalue): m_nGLId(rvalue.m_nGLId) {
+        rvalue.m_nGLId = 0;
+    }
+
+    Buffer& operator =(Buffer&& rvalue) {
+        if(this != &rvalue) {
+            release();
+            m_nGLId = rvalue.m_nGLId;
+            rvalue.m_nGLId = 0;
+        }
+        return *this;
+    }
+
+    GLuint getGLId() const {
+        return m_nGLId;
+    }
+
+    void bind(GLenum target, GLSourceLocation where = {}) const {
+        GL::bindBuffer(target, m_nGLId, where);
+    }
+
+    // The edits below go through the name of the buffer with direct state access. Otherwise the buffer is bound to
+    // GL_COPY_WRITE_BUFFER, which no draw reads (an element buffer bound to GL_ELEMENT_ARRAY_BUFFER would also be
+    // attached to the bound vertex array), and left there
+
+    // (Re)allocates the storage of the buffer, recording the new size
+    void setData(GLsizeiptr size, const void* data, GLenum usage, GLSourceLocation where = {}) {
+        if(isDirectStateAccessEnabled()) {
+            GL::namedBufferData(m_nGLId, size, data, usage, where);
+        } else {
+            GL::bindBuffer(GL_COPY_WRITE_BUFFER, m_nGLId, where);
+            GL::bufferData(GL_COPY_WRITE_BUFFER, size, data, usage, where);
+        }
+        detail::resizeGLObject(GLObjectType::BUFFER, m_nGLId, size_t(size));
+    }
+
+    // Allocates the immutable storage of the buffer (GL_ARB_buffer_storage), recording the size
+    void setStorage(GLsizeiptr size, const void* data, GLbitfield flags, GLSourceLocation where = {}) {
+        if(isDirectStateAccessEnabled()) {
+            GL::namedBufferStorage(m_nGLId, size, data, flags, where);
+        } else {
+            GL::bindBuffer(GL_COPY_WRITE_BUFFER, m_nGLId, where);
+            GL::bufferStorage(GL_COPY_WRITE_BUFFER, size, data, flags, where);
+        }
+        detail::resizeGLObject(GLObjectType::BUFFER, m_nGLId, size_t(size));
+    }
+
+    void setSubData(GLintptr offset, GLsizeiptr size, const void* data, GLSourceLocation where = {}) {
+        if(isDirectStateAccessEnabled()) {
+            GL::namedBufferSubData(m_nGLId, offset, size, data, where);
+        } else {
+            GL::bindBuffer(GL_COPY_WRITE_BUFFER, m_nGLId, where);
+            GL::bufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data, where);
+        }
+    }
+
+    void* map(GLintptr offset, GLsizeiptr length, GLbitfield access, GLSourceLocation where = {}) {
+        if(isDirectStateAccessEnabled()) {
+            return GL::mapNamedBufferRange(m_nGLId, offset, length, access, where);
+        }
+        GL::bindBuffer(GL_COPY_WRITE_BUFFER, m_nGLId, where);
+        return GL::mapBufferRange(GL_COPY_WRITE_BUFFER, offset, length, access, where);
+    }
+
+private:
+    Buffer(const Buffer&);
+    Buffer& operator =(const Buffer&);
+
+    void release() {
+        if(m_nGLId) {
+            detail::unregisterGLObject(GLObjectType::BUFFER, m_nGLId);
+            GL::deleteBuffers(1, &m_nGLId);
+            m_nGLId = 0;
+        }
+    }
+
+    GLuint m_nGLId = 0;
+};
+
+// Vertex arrays own no storage: they are registered for the leak check only
+class VertexArray {
+public:
+    VertexArray() = default;
+
+    explicit VertexArray(const char* label, GLSourceLocation where = {}) {
+        GL::genVertexArrays(1, &m_nGLId, where);
+        detail::registerGLObject(GLObjectType::VERTEX_ARRAY, m_nGLId, GLMemoryCategory::VERTICES, label, where);
+    }
+
+    ~VertexArray() {
+        release();
+    }
+
+    VertexArray(VertexArray&& rvalue): m_nGLId(rvalue.m_nGLId) {
+        rvalue.m_nGLId = 0;
+    }
+
+    VertexArray& operator =(VertexArray&& rvalue) {
+        if(this != &rvalue) {
+            release();
+            m_nGLId = rvalue.m_nGLId;
+            rvalue.m_nGLId = 0;
+        }
+        return *this;
+    }
+
+    GLuint getGLId() const {
+        return m_nGLId;
+    }
+
+    void bind(GLSourceLocation where = {}) const {
+        GL::bindVertexArray(m_nGLId, where);
+    }
+
+private:
+    VertexArray(const VertexArray&);
+    VertexArray& operator =(const VertexArray&);
+
+    void release() {
+        if(m_nGLId) {
+            detail::unregisterGLObject(GLObjectType::VERTEX_ARRAY, m_nGLId);
+            GL::deleteVertexArrays(1, &m_nGLId);
+            m_nGLId = 0;
+        }
+    }
+
+    GLuint m_nGLId = 0;
+};
+
+class Texture {
+public:
+    Texture() = default;
+
+    // 'target' is the bind target: GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP or GL_TEXTURE_2D_ARRAY
+    Texture(GLenum target, GLMemoryCategory category, const char* label, GLSourceLocation where = {}): m_Target(target) {
+        if(isDirectStateAccessEnabled()) {
+            GL::createTextures(target, 1, &m_nGLId, where);
+        } else {
+            GL::genTextures(1, &m_nGLId, where);
+        }
+        detail::registerGLObject(GLObjectType::TEXTURE, m_nGLId, category, label, where);
+    }
+
+    ~Texture() {
+        release();
+    }
+
+    Texture(Texture&& rvalue): m_nGLId(rvalue.m_nGLId), m_Target(rvalue.m_Target) {
+        rvalue.m_nGLId = 0;
+    }
+
+    Texture& operator =(Texture&& rvalue) {
+        if(this != &rvalue) {
+            release();
+            m_nGLId = rvalue.m_nGLId;
+            m_Target = rvalue.m_Target;
+            rvalue.m_nGLId = 0;
+        }
+        return *this;
+    }
+
+    GLuint getGLId() const {
+        return m_nGLId;
+    }
+
+    GLenum getTarget() const {
+        return m_Target;
+    }
+
+    void bind(GLSourceLocation where = {}) const {
+        GL::bindTexture(m_Target, m_nGLId, where);
+    }
+
+    // The edits below go through the name of the texture with direct state access. Otherwise the texture is bound to
+    // its target on the active unit for the edit, then unbound
+
+    // Allocates 'levels' levels of width x height, halved down to 1 x 1, for every face of a cube map. With direct
+    // state access the storage is immutable: a texture is resized by replacing it with a new one.
+    // Only level 0 is counted in the registry
+    void setStorage2D(GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height, GLSourceLocation where = {});
+
+    // Uploads a level allocated by setStorage2D, of one face (0 to 5, +X -X +Y -Y +Z -Z) of a cube map
+    void setSubImage2D(GLint level, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels, GLint face = 0,
+                       GLSourceLocation where = {});
+
+    // Same for the 'layers' layers of a GL_TEXTURE_2D_ARRAY, each uploaded by setSubImage3D
+    void setStorage3D(GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height, GLsizei layers, GLSourceLocation where = {});
+
+    void setSubImage3D(GLint level, GLint layer, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels,
+                       GLSourceLocation where = {});
+
+    // Computes the levels below level 0 from it
+    void generateMipmap(GLSourceLocation where = {});
+
+    void setParameter(GLenum name, GLint value, GLSourceLocation where = {});
+
+private:
+    Texture(const Texture&);
+    Texture& operator =(const Texture&);
+
+    void release() {
+        if(m_nGLId) {
+            detail::unregisterGLObject(GLObjectType::TEXTURE, m_nGLId);
+            GL::deleteTextures(1, &m_nGLId);
+            m_nGLId = 0;
+        }
+    }
+
+    GLuint m_nGLId = 0;
+    GLenum m_Target = GL_TEXTURE_2D;
+};
+
+// Framebuffers own no storage: their attachments are counted as textures
+class Framebuffer {
+public:
+    Framebuffer() = default;
+
+    explicit Framebuffer(const char* label, GLSourceLocation where = {}) {
+        GL::genFramebuffers(1, &m_nGLId, where);
+        detail::registerGLObject(GLObjectType::FRAMEBUFFER, m_nGLId, GLMemoryCategory::RENDER_TARGETS, label, where);
+    }
+
+    ~Framebuffer() {
+        release();
+    }
+
+    Framebuffer(Framebuffer&& rvalue): m_nGLId(rvalue.m_nGLId) {
+        rvalue.m_nGLId = 0;
+    }
+
+    Framebuffer& operator =(Framebuffer&& rvalue) {
+        if(this != &rvalue) {
+            release();
+            m_nGLId = rvalue.m_nGLId;
+            rvalue.m_nGLId = 0;
+        }
+        return *this;
+    }
+
+    GLuint getGLId() const {
+        return m_nGLId;
+    }
+
+    void bind(GLenum target, GLSourceLocation where = {}) const {
+        GL::bindFramebuffer(target, m_nGLId, where);
+    }
+
+private:
+    Framebuffer(const Framebuffer&);
+    Framebuffer& operator =(const Framebuffer&);
+
+    void release() {
+        if(m_nGLId) {
+            detail::unregisterGLObject(GLObjectType::FRAMEBUFFER, m_nGLId);
+            GL::deleteFramebuffers(1, &m_nGLId);
+            m_nGLId = 0;
+        }
+    }
+
+    GLuint m_nGLId = 0;
+};
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace glimac {
+
+// Measures the GPU and CPU time of named scopes (render passes) with GL_TIMESTAMP queries.
+// Queries go round a ring of FRAME_LATENCY frames: the results of a frame are read back when its slot
+// is reused, FRAME_LATENCY frames later, and only if the GPU is done with them, so nothing ever stalls.
+// Scopes can be nested; the whole frame is measured as the "frame" scope.
+class GPUProfiler {
+public:
+    static const unsigned int FRAME_LATENCY = 3;
+
+    // Smoothed timings of a scope, in milliseconds
+    struct Timing {
+        std::string m_sName;
+        unsigned int m_nDepth = 0; // Nesting level, 0 for "frame"
+        double m_fGPUTime = 0.;
+        double m_fCPUTime = 0.;
+        double m_fLastGPUTime = 0.; // Last frame read back
+        double m_fLastCPUTime = 0.;
+        uint64_t m_nSampleCount = 0;
+    };
+
+    // RAII helper: GPUProfiler::Scope scope(profiler, "skybox");
+    class Scope {
+    public:
+        Scope(GPUProfiler& profiler, const char* name): m_Profiler(profiler) {
+            m_Profiler.beginScope(name);
+        }
+
+        ~Scope() {
+            m_Profiler.endScope();
+        }
+
+    private:
+        GPUProfiler& m_Profiler;
+    };
+
+    GPUProfiler() = default;
+
+    ~GPUProfiler() {
+        release();
+    }
+
+    void release();
+
+    void beginFrame();
+    void endFrame();
+
+    // Reads back every pending frame, waiting for the GPU (end of a benchmark)
+    void flush();
+
+    // Scopes are identified by their name; the time of a scope entered several times in a frame is summed
+    void beginScope(const char* name);
+    void endScope();
+
+    // Weight of the last frame in the exponential moving average
+    void setSmoothing(double factor) {
+        m_fSmoothing = factor;
+    }
+
+    // In order of first appearance
+    const std::vector<Timing>& getTimings() const {
+        return m_Timings;
+    }
+
+    // "frame 2.10/1.30 ms | skybox 0.20/0.05 ms | ..." (GPU/CPU)
+    std::string getSummary() const;
+
+    // Number of frames whose queries were not ready when their slot was reused
+    uint64_t getDroppedFrameCount() const {
+        return m_nDroppedFrames;
+    }
+
+    // Appends "frame,scope,depth,gpu_ms,cpu_ms" rows for every frame read back
+    bool openCSV(const std::string& path);
+
+private:
+    struct Record {
+        unsigned int m_nTiming;
+        unsigned int m_nBeginQuery, m_nEndQuery;
+        double m_fCPUBegin, m_fCPUEnd;
+    };
+
+    struct Frame {
+        std::vector<GLuint> m_Queries; // Pool, grows as needed
+        unsigned int m_nUsedQueries = 0;
+        std::vector<Record> m_Records;
+        std::vector<unsigned int> m_Stack; // Open records
+        uint64_t m_nFrameIndex = 0;
+        bool m_bPending = false;
+    };
+
+    unsigned int timestamp(Frame& frame);
+    void resolve(Frame& frame, bool wait);
+    unsigned int findTiming(const char* name, unsigned int depth);
+
+    Frame m_Frames[FRAME_LATENCY];
+    unsigned int m_nCurrentFrame = 0;
+    uint64_t m_nFrameIndex = 0;
+    uint64_t m_nDroppedFrames = 0;
+    bool m_bInFrame = false;
+    double m_fSmoothing = 0.1;
+    std::vector<Timing> m_Timings;
+    std::vector<double> m_GPUTimes, m_CPUTimes; // Per-frame sums, kept to avoid reallocating them
+    std::vector<bool> m_Seen;
+    std::ofstream m_CSV;
+};
+
+}
@@ -17,11 +17,18 @@ public:
         glm::vec2 m_TexCoords;
     };
 
+    struct Lod {
+        unsigned int m_nIndexOffset; // Offset in the index buffer
+        unsigned int m_nIndexCount; // Number of indices
+        float m_fError; // Geometric error compared to the full resolution mesh, in object space units
+    };
+
     struct Mesh {
         std::string m_sName;
         unsigned int m_nIndexOffset; // Offset in the index buffer
         unsigned int m_nIndexCount; // Number of indices
         int m_nMaterialIndex; // -1 if no material assigned
+        std::vector<Lod> m_Lods; // Level 0 is the full resolution mesh, empty until buildLods() is called
 
         Mesh(std::string name, unsigned int indexOffset, unsigned int indexCount, int materialIndex):
             m_sName(move(name)), m_nIndexOffset(indexOffset), m_nIndexCount(indexCount), m_nMaterialIndex(materialIndex) {
@@ -77,8 +84,23 @@ public:
         return m_MeshBuffer.size();
     }
 
+    const Material* getMaterialBuffer() const {
+        return m_Materials.data();
+    }
+
+    size_t getMaterialCount() const {
+        return m_Materials.size();
+    }
+
     bool loadOBJ(const FilePath& filepath, const FilePath& mtlBasePath, bool loadTextures = true);
 
+    // Simplifies every mesh down to each ratio of its triangle count and appends the levels to the index buffer
+    void buildLods(const std::vector<float>& ratios = { 0.5f, 0.25f, 0.125f });
+
+    // Returns the coarsest level whose error projected at 'distance' stays below maxPixelError
+    // (projectionScale comes from lodProjectionScale())
+    unsigned int selectLod(unsigned int meshIndex, float distance, float projectionScale, float maxPixelError = 1.f) const;
+
     const BBox3f& getBoundingBox() const {
         return m_BBox;
     }
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <vector>
+#include "common.hpp"
+#include "Geometry.hpp"
+#include "GLObjects.hpp"
+
+namespace glimac {
+
+// GPU copy of a Geometry: every mesh (and LOD level) lives in a single VBO / IBO pair behind one VAO,
+// so any subset of the meshes is drawn with a single glMultiDrawElementsIndirect. Requires GL 4.3, like
+// the shaders it feeds (obj.vs.glsl)
+class GeometryBuffer {
+public:
+    // Attribute locations, matching the room shaders
+    static const GLuint ATTR_POSITION = 0;
+    static const GLuint ATTR_NORMAL = 1;
+    static const GLuint ATTR_TEXCOORDS = 3;
+    static const GLuint ATTR_MATERIAL = 4; // Per mesh (instanced, fetched through the base instance)
+
+    GeometryBuffer() = default;
+
+    GeometryBuffer(GeometryBuffer&& rvalue) = default;
+    GeometryBuffer& operator =(GeometryBuffer&& rvalue) = default;
+
+    void upload(const Geometry& geometry);
+
+    void release();
+
+    // Draws the meshes whose flag is set in 'visibleMeshes' (meshes past its end are drawn, so an empty mask
+    // draws everything), at the given LOD levels (level 0 if null, else one level per mesh). The mesh index is
+    // passed as base instance so that the ATTR_MATERIAL instanced attribute delivers the material of each mesh.
+    // Returns the number of meshes drawn.
+    size_t draw(const std::vector<bool>& visibleMeshes = {}, const unsigned int* lodLevels = nullptr) const;
+
+    GLuint getVAO() const {
+        return m_VAO.getGLId();
+    }
+
+    size_t getMeshCount() const {
+        return m_Meshes.size();
+    }
+
+private:
+    GeometryBuffer(const GeometryBuffer&);
+    GeometryBuffer& operator =(const GeometryBuffer&);
+
+    Buffer m_VBO;
+    Buffer m_IBO;
+    Buffer m_MaterialVBO; // Material index of each mesh
+    mutable Buffer m_CommandBuffer; // Rewritten by each draw
+    VertexArray m_VAO;
+    std::vector<Geometry::Mesh> m_Meshes;
+
+    // Commands, kept between frames to avoid reallocating them
+    mutable std::vector<DrawElementsIndirectCommand> m_Commands;
+};
+
+}
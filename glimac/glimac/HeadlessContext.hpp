@@ -0,0 +1,63 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "GLExtensions.hpp"
+#include <string>
+
+struct GLFWwindow;
+
+namespace glimac {
+
+// OpenGL context without any display, rendering into an offscreen framebuffer.
+// Uses a surfaceless EGL display when glimac is built with EGL (Mesa llvmpipe on machines without GPU),
+// otherwise an OSMesa context created by GLFW in a hidden window.
+class HeadlessContext {
+public:
+    HeadlessContext() = default;
+
+    ~HeadlessContext() {
+        release();
+    }
+
+    // Creates the context, makes it current, loads the GL functions and binds a width x height
+    // framebuffer (RGBA8 color, 24 bits depth). Returns false if no backend is available.
+    bool create(int width, int height);
+
+    void release();
+
+    GLuint getFramebuffer() const {
+        return m_nFBO;
+    }
+
+    int getWidth() const {
+        return m_nWidth;
+    }
+
+    int getHeight() const {
+        return m_nHeight;
+    }
+
+    // "egl" or "osmesa"
+    const std::string& getBackend() const {
+        return m_sBackend;
+    }
+
+private:
+    HeadlessContext(const HeadlessContext&);
+    HeadlessContext& operator =(const HeadlessContext&);
+
+    bool createEGL();
+    bool createOSMesa();
+
+    void* m_pDisplay = nullptr; // EGLDisplay
+    void* m_pContext = nullptr; // EGLContext
+    GLFWwindow* m_pWindow = nullptr;
+    GLuint m_nFBO = 0;
+    GLuint m_nColorBuffer = 0;
+    GLuint m_nDepthBuffer = 0;
+    int m_nWidth = 0;
+    int m_nHeight = 0;
+    std::string m_sBackend;
+};
+
+}
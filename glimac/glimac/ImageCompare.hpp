@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace glimac {
+
+// Perceptual difference between two images, measured per pixel as the CIE76 colour distance (Delta E)
+// in L*a*b*: about 1 is barely visible, 2.3 is the usual "just noticeable difference".
+struct ImageDifference {
+    double m_fMaxDeltaE = 0.;
+    double m_fMeanDeltaE = 0.;
+    size_t m_nDifferentPixels = 0; // Delta E above the threshold given to compareImages
+    size_t m_nPixelCount = 0;
+
+    double getDifferentRatio() const {
+        return m_nPixelCount ? double(m_nDifferentPixels) / m_nPixelCount : 0.;
+    }
+};
+
+// 'reference' and 'image' are RGBA8 (sRGB), 'width' * 'height' pixels. If 'diffImage' is not null,
+// it receives an RGBA8 visualisation: the reference darkened in grey, differing pixels in red.
+ImageDifference compareImages(const unsigned char* reference, const unsigned char* image, size_t width, size_t height,
+                              double threshold, std::vector<unsigned char>* diffImage = nullptr);
+
+}
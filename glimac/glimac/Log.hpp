@@ -0,0 +1,178 @@
+#pragma once
+
+#include "FilePath.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// Asynchronous log for the loading paths:
+//
+//     GLIMAC_LOG_INFO("Load OBJ {} ({} meshes)", filepath, shapes.size());
+//
+// The caller only copies the format address and the arguments (integers, floats, bools, strings,
+// FilePath) into a record of a lock-free ring buffer shared by every thread; a background thread
+// formats the records ("{}" is replaced by the next argument) and writes them to std::clog
+// (DEBUG, INFO) or std::cerr (WARNING, ERROR). When the ring is full the record is dropped and
+// counted instead of waiting for the terminal. Arguments that do not fit a record are cut short.
+// Levels below the CMake option GLIMAC_LOG_LEVEL (DEBUG, INFO, WARNING, ERROR or OFF, INFO by
+// default) are compiled out: their arguments are not even evaluated.
+
+#if defined(GLIMAC_LOG_LEVEL_DEBUG)
+#define GLIMAC_LOG_MIN_LEVEL 0
+#elif defined(GLIMAC_LOG_LEVEL_WARNING)
+#define GLIMAC_LOG_MIN_LEVEL 2
+#elif defined(GLIMAC_LOG_LEVEL_ERROR)
+#define GLIMAC_LOG_MIN_LEVEL 3
+#elif defined(GLIMAC_LOG_LEVEL_OFF)
+#define GLIMAC_LOG_MIN_LEVEL 4
+#else
+#define GLIMAC_LOG_MIN_LEVEL 1
+#endif
+
+#define GLIMAC_LOG(level, ...) \
+    do { \
+        if constexpr(int(level) >= GLIMAC_LOG_MIN_LEVEL) { \
+            ::glimac::Log::write(level, __VA_ARGS__); \
+        } \
+    } while(0)
+
+#define GLIMAC_LOG_DEBUG(...) GLIMAC_LOG(::glimac::LogLevel::DEBUG, __VA_ARGS__)
+#define GLIMAC_LOG_INFO(...) GLIMAC_LOG(::glimac::LogLevel::INFO, __VA_ARGS__)
+#define GLIMAC_LOG_WARNING(...) GLIMAC_LOG(::glimac::LogLevel::WARNING, __VA_ARGS__)
+#define GLIMAC_LOG_ERROR(...) GLIMAC_LOG(::glimac::LogLevel::ERROR, __VA_ARGS__)
+
+namespace glimac {
+
+enum class LogLevel {
+    DEBUG,
+    INFO,
+    WARNING,
+    ERROR
+};
+
+namespace detail {
+
+enum class LogArgument: unsigned char {
+    SIGNED,
+    UNSIGNED,
+    FLOATING,
+    BOOLEAN,
+    STRING // uint16_t length, then the characters
+};
+
+// Copies the arguments of a record in its fixed-size payload
+class LogEncoder {
+public:
+    LogEncoder(unsigned char* data, size_t capacity): m_pData(data), m_nCapacity(capacity) {
+    }
+
+    template<typename T>
+    std::enable_if_t<std::is_integral<T>::value> add(T value) {
+        if constexpr(std::is_signed<T>::value) {
+            put(LogArgument::SIGNED, int64_t(value));
+        } else {
+            put(LogArgument::UNSIGNED, uint64_t(value));
+        }
+    }
+
+    void add(bool value) {
+        put(LogArgument::BOOLEAN, value);
+    }
+
+    void add(double value) {
+        put(LogArgument::FLOATING, value);
+    }
+
+    void add(const char* text) {
+        addString(text, std::strlen(text));
+    }
+
+    void add(const std::string& text) {
+        addString(text.data(), text.size());
+    }
+
+    void add(const FilePath& filepath) {
+        addString(filepath.c_str(), filepath.str().size());
+    }
+
+    size_t getSize() const {
+        return m_nSize;
+    }
+
+    bool isTruncated() const {
+        return m_bTruncated;
+    }
+
+private:
+    template<typename T>
+    void put(LogArgument tag, T value) {
+        if(m_nSize + 1 + sizeof(T) > m_nCapacity) {
+            m_bTruncated = true;
+            return;
+        }
+        m_pData[m_nSize++] = static_cast<unsigned char>(tag);
+        std::memcpy(m_pData + m_nSize, &value, sizeof(T));
+        m_nSize += sizeof(T);
+    }
+
+    void addString(const char* text, size_t length);
+
+    unsigned char* m_pData;
+    size_t m_nCapacity;
+    size_t m_nSize = 0;
+    bool m_bTruncated = false;
+};
+
+}
+
+class Log {
+public:
+    static const uint64_t CAPACITY = 1 << 12;  // Records in the ring, power of two
+    static const size_t ARGUMENT_BYTES = 232; // Encoded arguments per record
+
+    struct Record {
+        std::atomic<uint64_t> m_nSequence; // Position + 1 once written, position + CAPACITY once printed
+        uint64_t m_nPosition;
+        LogLevel m_Level;
+        bool m_bTruncated;
+        uint16_t m_nSize;
+        const char* m_pFormat;
+        int64_t m_nTime; // std::chrono::steady_clock, in nanoseconds
+        unsigned char m_Arguments[ARGUMENT_BYTES];
+    };
+
+    // Use the GLIMAC_LOG_* macros, which compile out the disabled levels.
+    // The format must be a string literal: only its address is stored.
+    template<size_t N, typename... Args>
+    static void write(LogLevel level, const char (&format)[N], const Args&... args) {
+        Record* record = acquire();
+        if(!record) {
+            return;
+        }
+        record->m_Level = level;
+        record->m_pFormat = format;
+        record->m_nTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        detail::LogEncoder encoder(record->m_Arguments, ARGUMENT_BYTES);
+        (encoder.add(args), ...);
+        record->m_nSize = uint16_t(encoder.getSize());
+        record->m_bTruncated = encoder.isTruncated();
+        publish(record);
+    }
+
+    // Waits until the records written so far are printed
+    static void flush();
+
+    // Records lost because the ring was full
+    static uint64_t getDroppedCount();
+
+private:
+    // Reserves the next record of the ring, nullptr (and one more dropped record) if it is full
+    static Record* acquire();
+    static void publish(Record* record);
+};
+
+}
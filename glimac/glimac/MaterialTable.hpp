@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <vector>
+#include "glm.hpp"
+#include "Geometry.hpp"
+#include "GLObjects.hpp"
+
+namespace glimac {
+
+// Every material of a Geometry packed in a shader storage buffer, and every map in one texture array,
+// so that all the meshes are shaded in a single pass without per-material uniforms or texture binds.
+// Shaders index the table with the per-mesh material of GeometryBuffer (see obj.fs.glsl).
+class MaterialTable {
+public:
+    static const GLuint MATERIAL_BINDING = 0; // Shader storage block binding
+
+    // std430 layout of the Materials block
+    struct GPUMaterial {
+        glm::vec4 m_Ka; // rgb: ambient
+        glm::vec4 m_Kd; // rgb: diffuse, a: dissolve
+        glm::vec4 m_Ks; // rgb: specular, a: shininess
+        glm::vec4 m_Le; // rgb: emission
+        glm::ivec4 m_Maps; // Layers of the Ka, Kd, Ks and normal maps in the texture array, -1 if absent
+    };
+
+    MaterialTable() = default;
+
+    // Requires GL 4.3 (shader storage buffers). Maps of different sizes are resampled to mapSize x mapSize.
+    // A default material is appended after the ones of the geometry, for meshes without material.
+    void upload(const Geometry& geometry, unsigned int mapSize = 512);
+
+    void release();
+
+    // Binds the table to MATERIAL_BINDING and the texture array to the given texture unit
+    void bind(GLuint textureUnit = 0) const;
+
+    size_t getMaterialCount() const {
+        return m_nMaterialCount;
+    }
+
+    size_t getMapCount() const {
+        return m_nMapCount;
+    }
+
+private:
+    MaterialTable(const MaterialTable&);
+    MaterialTable& operator =(const MaterialTable&);
+
+    Buffer m_MaterialBuffer;
+    Texture m_MapArray;
+    size_t m_nMaterialCount = 0;
+    size_t m_nMapCount = 0;
+};
+
+}
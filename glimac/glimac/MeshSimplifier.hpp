@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include "Geometry.hpp"
+
+namespace glimac {
+
+/**
+ * @brief Simplifies an indexed triangle list with quadric error metrics (edge collapse)
+ *
+ * Vertices are never moved nor created: each collapse merges a vertex into one of its neighbours,
+ * so the returned indices still address the original vertex buffer.
+ * Border vertices, non-manifold vertices and vertices lying on an attribute seam (same position,
+ * different normal or texture coordinates) are locked.
+ *
+ * @param targetIndexCount number of indices to reach (the result can be larger if the mesh can't be simplified further)
+ * @param outError if not null, receives the geometric error of the result (in object space units)
+ */
+std::vector<unsigned int> simplifyMesh(const Geometry::Vertex* vertices,
+                                       const unsigned int* indices, size_t indexCount,
+                                       size_t targetIndexCount, float* outError = nullptr);
+
+/**
+ * @brief Returns the factor converting an object space error seen at distance 1 into pixels
+ */
+inline float lodProjectionScale(float fovy, float viewportHeight) {
+    return viewportHeight / (2.f * std::tan(fovy * 0.5f));
+}
+
+}
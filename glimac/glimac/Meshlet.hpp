@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include "common.hpp"
+#include "Geometry.hpp"
+#include "Frustum.hpp"
+
+namespace glimac {
+
+// Splits the meshes of a Geometry into small clusters of triangles (meshlets) which can be culled
+// independently against the view frustum and by orientation
+class MeshletBuffer {
+public:
+    struct Meshlet {
+        unsigned int m_nIndexOffset; // Offset in the index buffer of the MeshletBuffer
+        unsigned int m_nIndexCount; // Number of indices
+        unsigned int m_nVertexOffset; // Offset in the vertex list of the MeshletBuffer
+        unsigned int m_nVertexCount; // Number of unique vertices
+        unsigned int m_nMeshIndex; // Mesh of the Geometry this meshlet comes from
+        glm::vec3 m_Center; // Bounding sphere
+        float m_fRadius;
+        glm::vec3 m_ConeAxis; // Average direction of the triangle normals
+        float m_fConeCutoff; // Sine of the cone half angle, 1 when the normals are too spread to be culled
+    };
+
+    // Splits a mesh of the geometry and appends its meshlets to the buffer
+    void build(const Geometry& geometry, unsigned int meshIndex,
+               unsigned int maxVertices = 64, unsigned int maxTriangles = 124);
+
+    // Appends the indices of the visible meshlets to outIndices and returns the number of visible meshlets.
+    // The frustum and the camera position must be expressed in the object space of the geometry.
+    size_t cull(const Frustum& frustum, const glm::vec3& cameraPosition, std::vector<unsigned int>& outIndices) const;
+
+    // Same as above but emits one glMultiDrawElementsIndirect command per visible meshlet,
+    // addressing the index buffer returned by getIndexBuffer()
+    size_t cull(const Frustum& frustum, const glm::vec3& cameraPosition, std::vector<DrawElementsIndirectCommand>& outCommands) const;
+
+    bool isVisible(const Meshlet& meshlet, const Frustum& frustum, const glm::vec3& cameraPosition) const {
+        if(!frustum.intersects(meshlet.m_Center, meshlet.m_fRadius)) {
+            return false;
+        }
+        // Backface cone test: every triangle faces away from the camera (only valid when back faces are culled)
+        glm::vec3 d = meshlet.m_Center - cameraPosition;
+        return glm::dot(d, meshlet.m_ConeAxis) < meshlet.m_fConeCutoff * glm::length(d) + meshlet.m_fRadius;
+    }
+
+    const Meshlet* getMeshletBuffer() const {
+        return m_Meshlets.data();
+    }
+
+    size_t getMeshletCount() const {
+        return m_Meshlets.size();
+    }
+
+    // Indices in the vertex buffer of the geometry, meshlet after meshlet
+    const unsigned int* getIndexBuffer() const {
+        return m_Indices.data();
+    }
+
+    size_t getIndexCount() const {
+        return m_Indices.size();
+    }
+
+    // Unique vertices of each meshlet (indices in the vertex buffer of the geometry)
+    const unsigned int* getVertexBuffer() const {
+        return m_Vertices.data();
+    }
+
+    size_t getVertexCount() const {
+        return m_Vertices.size();
+    }
+
+    void clear() {
+        m_Meshlets.clear();
+        m_Indices.clear();
+        m_Vertices.clear();
+    }
+
+private:
+    void computeBounds(const Geometry& geometry, Meshlet& meshlet) const;
+
+    std::vector<Meshlet> m_Meshlets;
+    std::vector<unsigned int> m_Indices;
+    std::vector<unsigned int> m_Vertices;
+};
+
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+// Nuklear immediate mode GUI and its GLFW / OpenGL 2 binding (third-party/glfw/deps), implemented in
+// glimac/src/Nuklear.cpp. nuklear.h must see the same configuration everywhere: include this header
+// rather than nuklear.h.
+//
+// The binding draws with the fixed-function pipeline and client-side arrays: call nk_glfw3_render()
+// with no program in use and no vertex array or array buffer bound.
+
+#include <glad/glad.h>
+
+#define NK_INCLUDE_FIXED_TYPES
+#define NK_INCLUDE_STANDARD_VARARGS
+#define NK_INCLUDE_DEFAULT_ALLOCATOR
+#define NK_INCLUDE_VERTEX_BUFFER_OUTPUT
+#define NK_INCLUDE_FONT_BAKING
+#define NK_INCLUDE_DEFAULT_FONT
+#define NK_BUTTON_TRIGGER_ON_RELEASE
+#include <third-party/glfw/deps/nuklear.h>
+#include <third-party/glfw/deps/nuklear_glfw_gl2.h>
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// CPU zones, written to a chrome://tracing / Perfetto JSON file:
+//
+//     void build() {
+//         GLIMAC_PROFILE_ZONE("build mesh");
+//         ...
+//     }
+//
+// Each thread records begin/end events in its own ring buffer, without locks: the oldest events are
+// overwritten when a thread records more than EVENT_CAPACITY of them between two dumps.
+// Zone names must be string literals, only their address is stored.
+// Without GLIMAC_PROFILER (CMake option of the same name) the macros expand to nothing.
+
+#ifdef GLIMAC_PROFILER
+
+#define GLIMAC_PROFILE_CONCAT_(a, b) a##b
+#define GLIMAC_PROFILE_CONCAT(a, b) GLIMAC_PROFILE_CONCAT_(a, b)
+// "" name "" only compiles with a string literal
+#define GLIMAC_PROFILE_ZONE(name) ::glimac::ProfileZone GLIMAC_PROFILE_CONCAT(glimacProfileZone, __LINE__)("" name "")
+#define GLIMAC_PROFILE_THREAD(name) ::glimac::Profiler::setThreadName("" name "")
+
+#else
+
+#define GLIMAC_PROFILE_ZONE(name) ((void)0)
+#define GLIMAC_PROFILE_THREAD(name) ((void)0)
+
+#endif
+
+namespace glimac {
+
+class Profiler {
+public:
+    static const uint64_t EVENT_CAPACITY = 1 << 14; // Per thread, power of two
+
+    static constexpr bool isEnabled() {
+#ifdef GLIMAC_PROFILER
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static void beginZone(const char* name);
+    static void endZone();
+
+    // Shown instead of the thread number in the trace
+    static void setThreadName(const char* name);
+
+    // Writes the zones closed so far by every thread, including the threads that have exited.
+    // Can be called at any time from any thread; zones still open are left out.
+    static bool writeChromeTrace(const std::string& path);
+};
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name) {
+        Profiler::beginZone(name);
+    }
+
+    ~ProfileZone() {
+        Profiler::endZone();
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+}
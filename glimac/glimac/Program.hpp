@@ -4,16 +4,17 @@
 #include <GLFW/glfw3.h>
 #include "Shader.hpp"
 #include "FilePath.hpp"
+#include "GLCalls.hpp"
 
 namespace glimac {
 
 class Program {
 public:
-	Program(): m_nGLId(glCreateProgram()) {
+	Program(): m_nGLId(GL::createProgram()) {
 	}
 
 	~Program() {
-		glDeleteProgram(m_nGLId);
+		GL::deleteProgram(m_nGLId);
 	}
 
 	Program(Program&& rvalue): m_nGLId(rvalue.m_nGLId) {
@@ -39,7 +40,7 @@ public:
 	const std::string getInfoLog() const;
 
 	void use() const {
-		glUseProgram(m_nGLId);
+		GL::useProgram(m_nGLId);
 	}
 
 private:
@@ -55,5 +56,8 @@ Program buildProgram(const GLchar* vsSrc, const GLchar* fsSrc);
 // Load source code from files and build a GLSL program
 Program loadProgram(const FilePath& vsFile, const FilePath& fsFile);
 
+// Load a compute shader from a file and build its program (GL 4.3)
+Program loadComputeProgram(const FilePath& csFile);
+
 
 }
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "GLExtensions.hpp"
+#include <cstddef>
+#include <memory>
+#include "GLObjects.hpp"
+
+namespace glimac {
+
+// Buffer of per-draw data rewritten every frame (matrices of a uniform block...), split in REGIONS regions
+// used in turn:
+//
+//     stream.beginFrame();
+//     GLintptr offset;
+//     auto matrices = static_cast<glm::mat4*>(stream.allocate(3 * sizeof(glm::mat4), alignment, offset));
+//     ... // Fill the matrices
+//     stream.commit(offset, 3 * sizeof(glm::mat4));
+//     GL::bindBufferRange(GL_UNIFORM_BUFFER, 0, stream.getGLId(), offset, 3 * sizeof(glm::mat4));
+//     ... // Draw
+//     stream.endFrame();
+//
+// With GL_ARB_buffer_storage the buffer is mapped once, persistent and coherent: allocate() returns a pointer
+// into the mapping and commit() uploads nothing. Otherwise allocate() points into a copy in client memory and
+// commit() uploads the range with glBufferSubData.
+// A fence follows the last draw reading a region (endFrame(), or allocate() when the region is full); a region
+// is only written again once its fence is signaled, which waits when the GPU is REGIONS regions behind.
+class StreamBuffer {
+public:
+    static const size_t REGIONS = 3;
+
+    struct Stats {
+        size_t m_nPeakBytes = 0; // Largest frame, alignment padding included
+        size_t m_nWaits = 0;     // Regions reused before the GPU was done with them
+        double m_fWaitTime = 0.; // Milliseconds spent in these waits, in total
+        size_t m_nOverflows = 0; // Frames that did not fit in one region
+    };
+
+    // No buffer: assign a created one before use
+    StreamBuffer() = default;
+
+    // 'regionSize' is a multiple of the alignments given to allocate()
+    StreamBuffer(size_t regionSize, const char* label, GLSourceLocation where = {});
+
+    ~StreamBuffer() {
+        release();
+    }
+
+    StreamBuffer(StreamBuffer&& rvalue);
+    StreamBuffer& operator =(StreamBuffer&& rvalue);
+
+    // Whether new stream buffers are persistently mapped
+    static bool isPersistent() {
+        return GLAD_GL_ARB_buffer_storage != 0;
+    }
+
+    GLuint getGLId() const {
+        return m_Buffer.getGLId();
+    }
+
+    // Starts the next region, waiting for its fence if needed
+    void beginFrame();
+
+    // Fences the region used by the frame
+    void endFrame();
+
+    // 'size' bytes at an offset of the buffer multiple of 'alignment' (a power of two), nullptr if 'size' is
+    // larger than a region. Valid until commit().
+    void* allocate(size_t size, size_t alignment, GLintptr& offset);
+
+    // Makes the bytes written at 'offset' visible to the next draws
+    void commit(GLintptr offset, size_t size, GLSourceLocation where = {});
+
+    // Bytes allocated by the current frame, alignment padding included
+    size_t getFrameBytes() const {
+        return m_nFrameBytes;
+    }
+
+    size_t getRegionSize() const {
+        return m_nRegionSize;
+    }
+
+    const Stats& getStats() const {
+        return m_Stats;
+    }
+
+private:
+    StreamBuffer(const StreamBuffer&);
+    StreamBuffer& operator =(const StreamBuffer&);
+
+    void fenceRegion();
+    void nextRegion();
+    void release();
+
+    Buffer m_Buffer;
+    size_t m_nRegionSize = 0;
+    unsigned char* m_pData = nullptr;          // Persistent mapping, or m_pCopy
+    std::unique_ptr<unsigned char[]> m_pCopy; // Without GL_ARB_buffer_storage
+    GLsync m_Fences[REGIONS] = {};
+    size_t m_nRegion = REGIONS - 1; // The first beginFrame() starts with region 0
+    size_t m_nOffset = 0;           // In the current region
+    size_t m_nFrameBytes = 0;
+    bool m_bFrameOverflowed = false;
+    Stats m_Stats;
+};
+
+}
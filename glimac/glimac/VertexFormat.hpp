@@ -0,0 +1,180 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "glm.hpp"
+#include "GLObjects.hpp"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace glimac {
+
+// Layout of the vertex attributes read from one or more vertex buffers, built at compile time from the vertex structs:
+//
+//     constexpr VertexFormat SHAPE_FORMAT = VertexFormat()
+//         .buffer<ShapeVertex>()
+//         .attribute(0, GLIMAC_VERTEX_MEMBER(ShapeVertex, position))
+//         .attribute(1, GLIMAC_VERTEX_MEMBER(ShapeVertex, normal));
+//
+// Each buffer() starts a buffer binding (0, 1...) read by the attributes that follow it. With GL 4.3 the format is
+// described once per VAO (glVertexAttribFormat / glVertexAttribBinding): the meshes that share a format share the VAO
+// of a VertexArrayCache and only attach their buffers with glBindVertexBuffer. Without it, apply(buffers) builds a VAO
+// per mesh with glVertexAttribPointer from the same description.
+
+// Size, type and locations of a float attribute, deduced from the type of the vertex member
+template<typename T>
+struct VertexAttributeType;
+
+template<>
+struct VertexAttributeType<float> {
+    static constexpr GLint SIZE = 1;
+    static constexpr GLenum TYPE = GL_FLOAT;
+    static constexpr GLuint COLUMNS = 1;
+};
+
+template<>
+struct VertexAttributeType<glm::vec2> {
+    static constexpr GLint SIZE = 2;
+    static constexpr GLenum TYPE = GL_FLOAT;
+    static constexpr GLuint COLUMNS = 1;
+};
+
+template<>
+struct VertexAttributeType<glm::vec3> {
+    static constexpr GLint SIZE = 3;
+    static constexpr GLenum TYPE = GL_FLOAT;
+    static constexpr GLuint COLUMNS = 1;
+};
+
+template<>
+struct VertexAttributeType<glm::vec4> {
+    static constexpr GLint SIZE = 4;
+    static constexpr GLenum TYPE = GL_FLOAT;
+    static constexpr GLuint COLUMNS = 1;
+};
+
+// One location per column
+template<>
+struct VertexAttributeType<glm::mat4> {
+    static constexpr GLint SIZE = 4;
+    static constexpr GLenum TYPE = GL_FLOAT;
+    static constexpr GLuint COLUMNS = 4;
+};
+
+// Member of a vertex struct: its type and its offset
+template<typename T>
+struct VertexMember {
+    size_t m_nOffset;
+};
+
+#define GLIMAC_VERTEX_MEMBER(Vertex, member) glimac::VertexMember<decltype(Vertex::member)>{offsetof(Vertex, member)}
+
+struct VertexAttribute {
+    GLuint m_nLocation;
+    GLuint m_nBinding;
+    GLint m_nSize;
+    GLenum m_Type;
+    bool m_bNormalized;
+    GLuint m_nOffset; // Relative to the start of the vertex
+};
+
+struct VertexBufferBinding {
+    GLsizei m_nStride;
+    GLuint m_nDivisor; // 0 per vertex, 1 per instance
+};
+
+class VertexFormat {
+public:
+    static const size_t MAX_ATTRIBUTES = 16;
+    static const size_t MAX_BUFFERS = 4;
+
+    constexpr VertexFormat() = default;
+
+    // Starts the next buffer binding, holding 'Vertex' structs
+    template<typename Vertex>
+    constexpr VertexFormat buffer(GLuint divisor = 0) const {
+        VertexFormat format = *this;
+        format.m_Buffers[format.m_nBufferCount++] = {GLsizei(sizeof(Vertex)), divisor};
+        return format;
+    }
+
+    // Attribute read from the last buffer binding
+    template<typename T>
+    constexpr VertexFormat attribute(GLuint location, VertexMember<T> member, bool normalized = false) const {
+        VertexFormat format = *this;
+        for(GLuint column = 0; column < VertexAttributeType<T>::COLUMNS; ++column) {
+            format.m_Attributes[format.m_nAttributeCount++] = {
+                location + column, GLuint(m_nBufferCount - 1), VertexAttributeType<T>::SIZE, VertexAttributeType<T>::TYPE,
+                normalized, GLuint(member.m_nOffset + column * VertexAttributeType<T>::SIZE * sizeof(float))};
+        }
+        return format;
+    }
+
+    size_t getAttributeCount() const {
+        return m_nAttributeCount;
+    }
+
+    const VertexAttribute& getAttribute(size_t index) const {
+        return m_Attributes[index];
+    }
+
+    size_t getBufferCount() const {
+        return m_nBufferCount;
+    }
+
+    GLsizei getStride(size_t binding) const {
+        return m_Buffers[binding].m_nStride;
+    }
+
+    // Enables and describes the attributes in the bound VAO, with their buffer bindings (GL 4.3).
+    // Buffers are attached afterwards with glBindVertexBuffer
+    void apply() const;
+
+    // Without GL 4.3: enables and points the attributes at 'buffers' (one per binding) in the bound VAO
+    void apply(const GLuint buffers[]) const;
+
+    bool operator ==(const VertexFormat& other) const;
+
+    bool operator !=(const VertexFormat& other) const {
+        return !(*this == other);
+    }
+
+private:
+    VertexAttribute m_Attributes[MAX_ATTRIBUTES] = {};
+    VertexBufferBinding m_Buffers[MAX_BUFFERS] = {};
+    size_t m_nAttributeCount = 0;
+    size_t m_nBufferCount = 0;
+};
+
+// glVertexAttribFormat, glVertexAttribBinding and glBindVertexBuffer
+bool isVertexAttribBindingSupported();
+
+// One VAO per distinct format, created on first use. Needs isVertexAttribBindingSupported()
+class VertexArrayCache {
+public:
+    VertexArrayCache() = default;
+
+    // 'label' names the VAO in the GL object registry when it is created
+    const VertexArray& get(const VertexFormat& format, const char* label);
+
+    size_t getCount() const {
+        return m_Entries.size();
+    }
+
+    void clear() {
+        m_Entries.clear();
+    }
+
+private:
+    VertexArrayCache(const VertexArrayCache&);
+    VertexArrayCache& operator =(const VertexArrayCache&);
+
+    struct Entry {
+        VertexFormat m_Format;
+        VertexArray m_VertexArray;
+    };
+
+    std::vector<std::unique_ptr<Entry>> m_Entries; // Stable addresses for the returned references
+};
+
+}
@@ -11,4 +11,21 @@ struct ShapeVertex {
     glm::vec2 texCoords;
 };
 
+// Layout of the commands read by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Layout of the commands read by glMultiDrawArraysIndirect
+struct DrawArraysIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint first;
+    GLuint baseInstance;
+};
+
 }
@@ -0,0 +1,186 @@
+#include "glimac/AllocationTracker.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace glimac {
+
+namespace {
+
+// Trivially destructible and constant-initialized: usable from operator new at any time, on any thread
+struct ThreadAllocations {
+    AllocationReport m_Report;
+    const char* m_pCurrentTag = nullptr;
+};
+
+thread_local ThreadAllocations t_Allocations;
+
+AllocationCounters& getTagCounters(ThreadAllocations& allocations) {
+    AllocationReport& report = allocations.m_Report;
+    const char* name = allocations.m_pCurrentTag ? allocations.m_pCurrentTag : "untagged";
+    for(size_t i = 0; i < report.m_nTagCount; ++i) {
+        if(report.m_Tags[i].m_pName == name) {
+            return report.m_Tags[i].m_Counters;
+        }
+    }
+    if(report.m_nTagCount == AllocationReport::TAG_CAPACITY) {
+        return report.m_Tags[AllocationReport::TAG_CAPACITY - 1].m_Counters;
+    }
+    auto& tag = report.m_Tags[report.m_nTagCount++];
+    tag.m_pName = report.m_nTagCount == AllocationReport::TAG_CAPACITY ? "other tags" : name;
+    tag.m_Counters = AllocationCounters();
+    return tag.m_Counters;
+}
+
+void appendBytes(std::string& text, uint64_t bytes) {
+    char buffer[32];
+    if(bytes < 1024) {
+        std::snprintf(buffer, sizeof(buffer), "%llu B", static_cast<unsigned long long>(bytes));
+    } else if(bytes < 1024 * 1024) {
+        std::snprintf(buffer, sizeof(buffer), "%.1f KB", bytes / 1024.);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.1f MB", bytes / (1024. * 1024.));
+    }
+    text += buffer;
+}
+
+}
+
+std::string AllocationReport::getSummary() const {
+    std::string summary = std::to_string(m_Total.m_nAllocations) + " allocations (";
+    appendBytes(summary, m_Total.m_nBytes);
+    summary += "), " + std::to_string(m_Total.m_nFrees) + " frees";
+    const char* separator = ": ";
+    for(size_t i = 0; i < m_nTagCount; ++i) {
+        if(!m_Tags[i].m_Counters.m_nAllocations) {
+            continue;
+        }
+        summary += separator;
+        summary += m_Tags[i].m_pName;
+        summary += " " + std::to_string(m_Tags[i].m_Counters.m_nAllocations) + " (";
+        appendBytes(summary, m_Tags[i].m_Counters.m_nBytes);
+        summary += ")";
+        separator = ", ";
+    }
+    return summary;
+}
+
+void AllocationTracker::beginFrame() {
+    t_Allocations.m_Report.m_Total = AllocationCounters();
+    t_Allocations.m_Report.m_nTagCount = 0;
+}
+
+AllocationReport AllocationTracker::endFrame() {
+    return t_Allocations.m_Report;
+}
+
+const char* AllocationTracker::setTag(const char* name) {
+    const char* previous = t_Allocations.m_pCurrentTag;
+    t_Allocations.m_pCurrentTag = name;
+    return previous;
+}
+
+#ifdef GLIMAC_ALLOCATION_TRACKING
+
+namespace detail {
+
+void recordAllocation(size_t size) {
+    auto& allocations = t_Allocations;
+    ++allocations.m_Report.m_Total.m_nAllocations;
+    allocations.m_Report.m_Total.m_nBytes += size;
+    auto& counters = getTagCounters(allocations);
+    ++counters.m_nAllocations;
+    counters.m_nBytes += size;
+}
+
+void recordFree(void* pointer) {
+    if(!pointer) {
+        return;
+    }
+    auto& allocations = t_Allocations;
+    ++allocations.m_Report.m_Total.m_nFrees;
+    ++getTagCounters(allocations).m_nFrees;
+}
+
+void* allocate(size_t size) {
+    recordAllocation(size);
+    if(size == 0) {
+        size = 1;
+    }
+    for(;;) {
+        if(void* pointer = std::malloc(size)) {
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if(!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+}
+
+#endif
+
+}
+
+#ifdef GLIMAC_ALLOCATION_TRACKING
+
+// Replaceable global allocation functions (the over-aligned forms keep the default implementation)
+
+void* operator new(std::size_t size) {
+    return glimac::detail::allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return glimac::detail::allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return glimac::detail::allocate(size);
+    } catch(const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return glimac::detail::allocate(size);
+    } catch(const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* pointer) noexcept {
+    glimac::detail::recordFree(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    glimac::detail::recordFree(pointer);
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    glimac::detail::recordFree(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    glimac::detail::recordFree(pointer);
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    glimac::detail::recordFree(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    glimac::detail::recordFree(pointer);
+    std::free(pointer);
+}
+
+#endif
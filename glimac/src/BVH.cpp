@@ -0,0 +1,440 @@
+#include "glimac/BVH.hpp"
+#include "glimac/Profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64)
+#define GLIMAC_BVH_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace glimac {
+
+static_assert(sizeof(BVH::Node) == 32, "BVH nodes must stay 32 bytes wide");
+
+namespace {
+
+const unsigned int BIN_COUNT = 16;
+const unsigned int PARALLEL_MIN_TRIANGLES = 4096;
+const unsigned int STACK_SIZE = 64;
+const unsigned int MAX_DEPTH = STACK_SIZE - 1; // The traversal stack holds at most one node per level
+
+float halfArea(const BBox3f& box) {
+    glm::vec3 d = box.size();
+    return d.x * d.y + d.y * d.z + d.z * d.x;
+}
+
+BBox3f emptyBox() {
+    return BBox3f(glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max()));
+}
+
+struct RayData {
+#ifdef GLIMAC_BVH_SSE
+    __m128 origin;
+    __m128 invDirection;
+#else
+    glm::vec3 origin;
+    glm::vec3 invDirection;
+#endif
+
+    explicit RayData(const Ray& ray) {
+        glm::vec3 inv;
+        for(auto i = 0; i < 3; ++i) {
+            // Avoid 0 * inf = NaN in the slab test for axis aligned rays
+            float d = ray.direction[i];
+            inv[i] = 1.f / (std::fabs(d) > 1e-20f ? d : std::copysign(1e-20f, d));
+        }
+#ifdef GLIMAC_BVH_SSE
+        origin = _mm_set_ps(0.f, ray.origin.z, ray.origin.y, ray.origin.x);
+        invDirection = _mm_set_ps(0.f, inv.z, inv.y, inv.x);
+#else
+        origin = ray.origin;
+        invDirection = inv;
+#endif
+    }
+};
+
+// Slab test, tEntry receives the distance where the ray enters the box
+inline bool intersectBox(const BVH::Node& node, const RayData& ray, float tMin, float tMax, float& tEntry) {
+#ifdef GLIMAC_BVH_SSE
+    // The fourth lane holds leftOrFirst / count and is ignored by the reductions
+    __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.lower.x), ray.origin), ray.invDirection);
+    __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.upper.x), ray.origin), ray.invDirection);
+    __m128 tNear = _mm_min_ps(t1, t2);
+    __m128 tFar = _mm_max_ps(t1, t2);
+    __m128 enter = _mm_max_ss(_mm_max_ss(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(3, 3, 3, 1))),
+                              _mm_max_ss(_mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(3, 3, 3, 2)), _mm_set_ss(tMin)));
+    __m128 exit = _mm_min_ss(_mm_min_ss(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(3, 3, 3, 1))),
+                             _mm_min_ss(_mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(3, 3, 3, 2)), _mm_set_ss(tMax)));
+    tEntry = _mm_cvtss_f32(enter);
+    return _mm_comile_ss(enter, exit);
+#else
+    glm::vec3 t1 = (node.lower - ray.origin) * ray.invDirection;
+    glm::vec3 t2 = (node.upper - ray.origin) * ray.invDirection;
+    glm::vec3 tNear = glm::min(t1, t2), tFar = glm::max(t1, t2);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, tMin));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    tEntry = enter;
+    return enter <= exit;
+#endif
+}
+
+}
+
+struct BVH::BuildContext {
+    std::vector<BBox3f> bounds;
+    std::vector<glm::vec3> centroids;
+    std::vector<unsigned int> indices;
+    std::vector<Node> nodes;
+    std::atomic<unsigned int> nodeCount;
+    unsigned int maxLeafSize;
+    unsigned int parallelDepth;
+};
+
+void BVH::addTriangle(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, unsigned int objectId) {
+    m_Triangles.push_back({ p0, p1 - p0, p2 - p0, objectId, (unsigned int) m_Triangles.size() });
+}
+
+void BVH::addGeometry(const Geometry& geometry, const glm::mat4& transform, unsigned int objectId) {
+    const auto* vertices = geometry.getVertexBuffer();
+    const auto* indices = geometry.getIndexBuffer();
+    const auto* meshes = geometry.getMeshBuffer();
+    auto position = [&](unsigned int index) {
+        return glm::vec3(transform * glm::vec4(vertices[index].m_Position, 1.f));
+    };
+    // Only the full resolution ranges: the LOD levels are stored after them in the index buffer
+    for(auto m = 0u; m < geometry.getMeshCount(); ++m) {
+        for(auto i = meshes[m].m_nIndexOffset; i + 2 < meshes[m].m_nIndexOffset + meshes[m].m_nIndexCount; i += 3) {
+            addTriangle(position(indices[i]), position(indices[i + 1]), position(indices[i + 2]), objectId);
+        }
+    }
+}
+
+void BVH::addTriangles(const void* vertices, size_t stride, size_t vertexCount, const glm::mat4& transform, unsigned int objectId) {
+    auto position = [&](size_t index) {
+        const auto* p = reinterpret_cast<const glm::vec3*>(static_cast<const char*>(vertices) + index * stride);
+        return glm::vec3(transform * glm::vec4(*p, 1.f));
+    };
+    for(size_t i = 0; i + 2 < vertexCount; i += 3) {
+        addTriangle(position(i), position(i + 1), position(i + 2), objectId);
+    }
+}
+
+BVH::BVH(): m_BBox(emptyBox()) {
+}
+
+void BVH::clear() {
+    m_Triangles.clear();
+    m_Nodes.clear();
+    m_BBox = emptyBox();
+}
+
+void BVH::build(unsigned int maxLeafSize) {
+    GLIMAC_PROFILE_ZONE("build BVH");
+    m_Nodes.clear();
+    m_BBox = emptyBox();
+    const auto triangleCount = (unsigned int) m_Triangles.size();
+    if(triangleCount == 0) {
+        return;
+    }
+
+    BuildContext context;
+    context.bounds.resize(triangleCount);
+    context.centroids.resize(triangleCount);
+    context.indices.resize(triangleCount);
+    for(auto i = 0u; i < triangleCount; ++i) {
+        const auto& tri = m_Triangles[i];
+        BBox3f box(tri.p0);
+        box.grow(tri.p0 + tri.e1);
+        box.grow(tri.p0 + tri.e2);
+        context.bounds[i] = box;
+        context.centroids[i] = center(box);
+        context.indices[i] = i;
+    }
+    context.nodes.resize(2 * triangleCount);
+    context.nodeCount = 1;
+    context.maxLeafSize = std::max(maxLeafSize, 1u);
+    // Spawn tasks until there are a few per hardware thread
+    context.parallelDepth = 2;
+    for(auto threads = std::max(std::thread::hardware_concurrency(), 1u); threads > 1; threads >>= 1) {
+        ++context.parallelDepth;
+    }
+
+    buildNode(context, 0, 0, triangleCount, 0);
+
+    // Flatten in depth first order (siblings stay adjacent) and store the triangles in leaf order
+    std::vector<Triangle> triangles;
+    triangles.reserve(triangleCount);
+    m_Nodes.reserve(context.nodeCount);
+    m_Nodes.push_back(context.nodes[0]);
+    std::vector<std::pair<unsigned int, unsigned int>> stack = { { 0u, 0u } }; // (build node, flat node)
+    while(!stack.empty()) {
+        auto current = stack.back();
+        stack.pop_back();
+        const auto& node = context.nodes[current.first];
+        if(node.isLeaf()) {
+            m_Nodes[current.second].leftOrFirst = triangles.size();
+            for(auto i = 0u; i < node.count; ++i) {
+                triangles.push_back(m_Triangles[context.indices[node.leftOrFirst + i]]);
+            }
+        } else {
+            auto left = (unsigned int) m_Nodes.size();
+            m_Nodes[current.second].leftOrFirst = left;
+            m_Nodes.push_back(context.nodes[node.leftOrFirst]);
+            m_Nodes.push_back(context.nodes[node.leftOrFirst + 1]);
+            stack.push_back({ node.leftOrFirst + 1, left + 1 });
+            stack.push_back({ node.leftOrFirst, left });
+        }
+    }
+    m_Triangles = std::move(triangles);
+    m_BBox = BBox3f(m_Nodes[0].lower, m_Nodes[0].upper);
+}
+
+void BVH::buildNode(BuildContext& context, unsigned int nodeIndex, unsigned int first, unsigned int count, unsigned int depth) {
+    auto& node = context.nodes[nodeIndex];
+
+    BBox3f bounds = emptyBox(), centroidBounds = emptyBox();
+    for(auto i = first; i < first + count; ++i) {
+        bounds.grow(context.bounds[context.indices[i]]);
+        centroidBounds.grow(context.centroids[context.indices[i]]);
+    }
+    node.lower = bounds.lower;
+    node.upper = bounds.upper;
+    node.leftOrFirst = first;
+    node.count = count;
+
+    if(count <= context.maxLeafSize || depth >= MAX_DEPTH) {
+        return;
+    }
+
+    // Binned SAH: evaluate BIN_COUNT - 1 split planes on each axis
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    unsigned int bestSplit = 0;
+    const glm::vec3 extent = centroidBounds.size();
+    auto binOf = [&](const glm::vec3& centroid, int axis) {
+        auto bin = (unsigned int) (BIN_COUNT * (centroid[axis] - centroidBounds.lower[axis]) / extent[axis]);
+        return std::min(bin, BIN_COUNT - 1);
+    };
+    for(auto axis = 0; axis < 3; ++axis) {
+        if(extent[axis] <= 0.f) {
+            continue;
+        }
+        BBox3f binBounds[BIN_COUNT];
+        unsigned int binCounts[BIN_COUNT] = {};
+        for(auto& box: binBounds) {
+            box = emptyBox();
+        }
+        for(auto i = first; i < first + count; ++i) {
+            auto triangle = context.indices[i];
+            auto bin = binOf(context.centroids[triangle], axis);
+            binBounds[bin].grow(context.bounds[triangle]);
+            ++binCounts[bin];
+        }
+
+        // Sweep from the right then from the left
+        float rightAreas[BIN_COUNT];
+        unsigned int rightCounts[BIN_COUNT];
+        BBox3f right = emptyBox();
+        unsigned int rightCount = 0;
+        for(auto b = BIN_COUNT - 1; b > 0; --b) {
+            right.grow(binBounds[b]);
+            rightCount += binCounts[b];
+            rightAreas[b] = rightCount ? halfArea(right) : 0.f;
+            rightCounts[b] = rightCount;
+        }
+        BBox3f left = emptyBox();
+        unsigned int leftCount = 0;
+        for(auto b = 1u; b < BIN_COUNT; ++b) {
+            left.grow(binBounds[b - 1]);
+            leftCount += binCounts[b - 1];
+            if(leftCount == 0 || rightCounts[b] == 0) {
+                continue;
+            }
+            float cost = leftCount * halfArea(left) + rightCounts[b] * rightAreas[b];
+            if(cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b;
+            }
+        }
+    }
+
+    // Stop when splitting isn't cheaper than intersecting every triangle (traversal cost = 1 triangle test)
+    const float leafCost = count * halfArea(bounds);
+    if(bestAxis < 0 || (bestCost + halfArea(bounds) >= leafCost && count <= 4 * context.maxLeafSize)) {
+        return;
+    }
+
+    auto middle = std::partition(context.indices.begin() + first, context.indices.begin() + first + count,
+        [&](unsigned int triangle) {
+            return binOf(context.centroids[triangle], bestAxis) < bestSplit;
+        });
+    auto leftCount = (unsigned int) (middle - (context.indices.begin() + first));
+    if(leftCount == 0 || leftCount == count) {
+        return;
+    }
+
+    auto left = context.nodeCount.fetch_add(2);
+    node.leftOrFirst = left;
+    node.count = 0;
+
+    if(depth < context.parallelDepth && count >= PARALLEL_MIN_TRIANGLES) {
+        auto task = std::async(std::launch::async, [&context, this, left, first, leftCount, depth]() {
+            GLIMAC_PROFILE_ZONE("build BVH subtree");
+            buildNode(context, left, first, leftCount, depth + 1);
+        });
+        buildNode(context, left + 1, first + leftCount, count - leftCount, depth + 1);
+        task.get();
+    } else {
+        buildNode(context, left, first, leftCount, depth + 1);
+        buildNode(context, left + 1, first + leftCount, count - leftCount, depth + 1);
+    }
+}
+
+bool BVH::intersectTriangle(unsigned int index, const Ray& ray, float tMax, RayHit& hit) const {
+    // Möller-Trumbore
+    const auto& tri = m_Triangles[index];
+    glm::vec3 p = glm::cross(ray.direction, tri.e2);
+    float det = glm::dot(tri.e1, p);
+    if(det == 0.f) {
+        return false;
+    }
+    float invDet = 1.f / det;
+    glm::vec3 s = ray.origin - tri.p0;
+    float u = glm::dot(s, p) * invDet;
+    if(u < 0.f || u > 1.f) {
+        return false;
+    }
+    glm::vec3 q = glm::cross(s, tri.e1);
+    float v = glm::dot(ray.direction, q) * invDet;
+    if(v < 0.f || u + v > 1.f) {
+        return false;
+    }
+    float t = glm::dot(tri.e2, q) * invDet;
+    if(t < ray.tMin || t >= tMax) {
+        return false;
+    }
+    hit.t = t;
+    hit.u = u;
+    hit.v = v;
+    hit.triangle = tri.index;
+    hit.objectId = tri.objectId;
+    return true;
+}
+
+template<bool ANY_HIT>
+bool BVH::traverse(const Ray& ray, RayHit& hit) const {
+    if(m_Nodes.empty()) {
+        return false;
+    }
+
+    const RayData rayData(ray);
+    float tMax = ray.tMax;
+    float tEntry;
+    if(!intersectBox(m_Nodes[0], rayData, ray.tMin, tMax, tEntry)) {
+        return false;
+    }
+
+    struct Entry {
+        unsigned int node;
+        float tEntry;
+    };
+    Entry stack[STACK_SIZE];
+    unsigned int stackSize = 0;
+    unsigned int current = 0;
+    bool found = false;
+
+    while(true) {
+        const auto& node = m_Nodes[current];
+        if(node.isLeaf()) {
+            for(auto i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+                if(intersectTriangle(i, ray, tMax, hit)) {
+                    if(ANY_HIT) {
+                        return true;
+                    }
+                    found = true;
+                    tMax = hit.t;
+                }
+            }
+        } else {
+            float t0, t1;
+            bool hit0 = intersectBox(m_Nodes[node.leftOrFirst], rayData, ray.tMin, tMax, t0);
+            bool hit1 = intersectBox(m_Nodes[node.leftOrFirst + 1], rayData, ray.tMin, tMax, t1);
+            if(hit0 && hit1) {
+                // Visit the closest child first
+                unsigned int nearNode = node.leftOrFirst, farNode = node.leftOrFirst + 1;
+                if(t1 < t0) {
+                    std::swap(nearNode, farNode);
+                    std::swap(t0, t1);
+                }
+                if(stackSize < STACK_SIZE) {
+                    stack[stackSize++] = { farNode, t1 };
+                }
+                current = nearNode;
+                continue;
+            } else if(hit0 || hit1) {
+                current = hit0 ? node.leftOrFirst : node.leftOrFirst + 1;
+                continue;
+            }
+        }
+
+        // Pop the next node, skipping the ones behind the closest hit found so far
+        do {
+            if(stackSize == 0) {
+                return found;
+            }
+            --stackSize;
+        } while(stack[stackSize].tEntry > tMax);
+        current = stack[stackSize].node;
+    }
+}
+
+bool BVH::intersect(const Ray& ray, RayHit& hit) const {
+    return traverse<false>(ray, hit);
+}
+
+bool BVH::occluded(const Ray& ray) const {
+    RayHit hit;
+    return traverse<true>(ray, hit);
+}
+
+RayQueryStats BVH::intersect(const Ray* rays, RayHit* hits, size_t count) const {
+    auto start = std::chrono::steady_clock::now();
+
+    auto trace = [this, rays, hits](size_t begin, size_t end) {
+        GLIMAC_PROFILE_ZONE("trace rays");
+        size_t hitCount = 0;
+        for(auto i = begin; i < end; ++i) {
+            hits[i] = RayHit();
+            hitCount += traverse<false>(rays[i], hits[i]);
+        }
+        return hitCount;
+    };
+
+    RayQueryStats stats;
+    stats.rayCount = count;
+    const size_t threadCount = count < 1024 ? 1 : std::max(std::thread::hardware_concurrency(), 1u);
+    if(threadCount == 1) {
+        stats.hitCount = trace(0, count);
+    } else {
+        std::vector<std::future<size_t>> tasks;
+        const size_t chunk = (count + threadCount - 1) / threadCount;
+        for(size_t begin = 0; begin < count; begin += chunk) {
+            tasks.push_back(std::async(std::launch::async, trace, begin, std::min(begin + chunk, count)));
+        }
+        for(auto& task: tasks) {
+            stats.hitCount += task.get();
+        }
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.raysPerSecond = stats.seconds > 0. ? count / stats.seconds : 0.;
+    return stats;
+}
+
+}
@@ -3,10 +3,12 @@
 #include <iostream>
 #include "glimac/common.hpp"
 #include "glimac/Cone.hpp"
+#include "glimac/Profiler.hpp"
 
 namespace glimac {
 
 void Cone::build(GLfloat height, GLfloat r, GLsizei discLat, GLsizei discHeight) {
+    GLIMAC_PROFILE_ZONE("build cone");
     // Equation paramétrique en (r, phi, h) du cone
     // avec r >= 0, -PI / 2 <= theta <= PI / 2, 0 <= h <= height
     //
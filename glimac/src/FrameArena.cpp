@@ -0,0 +1,42 @@
+#include "glimac/FrameArena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace glimac {
+
+FrameArena::FrameArena(size_t capacityPerFrame): m_nCapacity(capacityPerFrame) {
+    for(auto& region: m_Regions) {
+        region.m_pMemory.reset(new unsigned char[m_nCapacity]);
+    }
+}
+
+void FrameArena::beginFrame() {
+    m_nFrame = (m_nFrame + 1) % FRAMES;
+    m_Regions[m_nFrame].m_Overflows.clear();
+    m_nOffset = 0;
+    m_nUsedBytes = 0;
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    auto base = reinterpret_cast<uintptr_t>(m_Regions[m_nFrame].m_pMemory.get());
+    size_t offset = ((base + m_nOffset + alignment - 1) & ~uintptr_t(alignment - 1)) - base;
+    if(offset + size <= m_nCapacity) {
+        m_nUsedBytes += offset + size - m_nOffset;
+        m_nOffset = offset + size;
+        m_nPeakBytes = std::max(m_nPeakBytes, m_nUsedBytes);
+        return m_Regions[m_nFrame].m_pMemory.get() + offset;
+    }
+
+    // operator new[] aligns on __STDCPP_DEFAULT_NEW_ALIGNMENT__ only: pad for the larger alignments
+    size_t padding = alignment > alignof(std::max_align_t) ? alignment : 0;
+    auto& overflows = m_Regions[m_nFrame].m_Overflows;
+    overflows.emplace_back(new unsigned char[size + padding]);
+    ++m_nOverflowCount;
+    m_nUsedBytes += size;
+    m_nPeakBytes = std::max(m_nPeakBytes, m_nUsedBytes);
+
+    auto block = reinterpret_cast<uintptr_t>(overflows.back().get());
+    return reinterpret_cast<void*>((block + alignment - 1) & ~uintptr_t(alignment - 1));
+}
+
+}
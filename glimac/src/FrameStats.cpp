@@ -0,0 +1,80 @@
+#include "glimac/FrameStats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace glimac {
+
+namespace {
+
+FrameStats::Summary summarize(std::vector<double> values) {
+    FrameStats::Summary summary;
+    if(values.empty()) {
+        return summary;
+    }
+    std::sort(values.begin(), values.end());
+    // Nearest-rank percentile
+    auto percentile = [&](double p) {
+        size_t rank = (size_t) std::ceil(p * values.size());
+        return values[std::min(std::max(rank, size_t(1)), values.size()) - 1];
+    };
+    summary.m_fMean = std::accumulate(values.begin(), values.end(), 0.) / values.size();
+    summary.m_fP50 = percentile(0.5);
+    summary.m_fP95 = percentile(0.95);
+    summary.m_fP99 = percentile(0.99);
+    summary.m_fMax = values.back();
+    return summary;
+}
+
+void writeSummary(std::ostream& out, const char* name, const FrameStats::Summary& summary) {
+    out << "\"" << name << "\": {"
+        << "\"mean\": " << summary.m_fMean
+        << ", \"p50\": " << summary.m_fP50
+        << ", \"p95\": " << summary.m_fP95
+        << ", \"p99\": " << summary.m_fP99
+        << ", \"max\": " << summary.m_fMax << "}";
+}
+
+}
+
+void FrameStats::reserve(size_t frameCount) {
+    m_FrameTimes.reserve(frameCount);
+    m_DrawCalls.reserve(frameCount);
+    m_Triangles.reserve(frameCount);
+}
+
+void FrameStats::clear() {
+    m_FrameTimes.clear();
+    m_DrawCalls.clear();
+    m_Triangles.clear();
+}
+
+void FrameStats::addFrame(double milliseconds, unsigned int drawCalls, unsigned int triangles) {
+    m_FrameTimes.push_back(milliseconds);
+    m_DrawCalls.push_back(drawCalls);
+    m_Triangles.push_back(triangles);
+}
+
+FrameStats::Summary FrameStats::getFrameTimeSummary() const {
+    return summarize(m_FrameTimes);
+}
+
+FrameStats::Summary FrameStats::getDrawCallSummary() const {
+    return summarize(m_DrawCalls);
+}
+
+FrameStats::Summary FrameStats::getTriangleSummary() const {
+    return summarize(m_Triangles);
+}
+
+void FrameStats::writeJSON(std::ostream& out) const {
+    out << "{\"frames\": " << getFrameCount() << ", ";
+    writeSummary(out, "frame_ms", getFrameTimeSummary());
+    out << ", ";
+    writeSummary(out, "draw_calls", getDrawCallSummary());
+    out << ", ";
+    writeSummary(out, "triangles", getTriangleSummary());
+    out << "}";
+}
+
+}
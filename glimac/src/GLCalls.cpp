@@ -0,0 +1,142 @@
+#include "glimac/GLCalls.hpp"
+#include <cstdio>
+#include <iostream>
+#include <set>
+#include <tuple>
+
+namespace glimac {
+
+namespace {
+
+GLFrameCounters g_LastGLFrame;
+
+// Call sites already reported, so that a faulty call in the render loop is printed once
+std::set<std::tuple<const char*, int, GLenum>> g_ReportedErrors;
+
+// Framebuffers generated through GL:: and not deleted yet (validating policy)
+std::set<GLuint> g_GeneratedFramebuffers;
+
+const char* getGLErrorName(GLenum error) {
+    switch(error) {
+    case GL_INVALID_ENUM:
+        return "GL_INVALID_ENUM";
+    case GL_INVALID_VALUE:
+        return "GL_INVALID_VALUE";
+    case GL_INVALID_OPERATION:
+        return "GL_INVALID_OPERATION";
+    case GL_INVALID_FRAMEBUFFER_OPERATION:
+        return "GL_INVALID_FRAMEBUFFER_OPERATION";
+    case GL_OUT_OF_MEMORY:
+        return "GL_OUT_OF_MEMORY";
+    case GL_STACK_UNDERFLOW:
+        return "GL_STACK_UNDERFLOW";
+    case GL_STACK_OVERFLOW:
+        return "GL_STACK_OVERFLOW";
+    default:
+        return "unknown GL error";
+    }
+}
+
+}
+
+const GLFrameCounters& getLastGLFrameCounters() {
+    return g_LastGLFrame;
+}
+
+void endGLFrame() {
+    g_LastGLFrame = detail::g_CurrentGLFrame;
+    detail::g_CurrentGLFrame = GLFrameCounters();
+    GLCapture::endFrame();
+}
+
+std::string getGLFrameSummary(const GLFrameCounters& counters) {
+    auto formatBytes = [](uint64_t bytes) {
+        char text[32];
+        if(bytes >= 1024 * 1024) {
+            std::snprintf(text, sizeof(text), "%.1f MB", bytes / (1024. * 1024.));
+        } else if(bytes >= 1024) {
+            std::snprintf(text, sizeof(text), "%.1f KB", bytes / 1024.);
+        } else {
+            std::snprintf(text, sizeof(text), "%u B", unsigned(bytes));
+        }
+        return std::string(text);
+    };
+
+    std::string summary = std::to_string(counters.m_nDrawCalls) + " draws, " + std::to_string(counters.getBindCount()) + " binds, "
+        + formatBytes(counters.m_nUniformBytes) + " uniforms, " + formatBytes(counters.m_nBufferBytes) + " uploads";
+    if(counters.m_nMappedBytes) {
+        summary += ", " + formatBytes(counters.m_nMappedBytes) + " mapped";
+    }
+    if(counters.m_nDispatches) {
+        summary += ", " + std::to_string(counters.m_nDispatches) + " dispatches";
+    }
+    if(counters.m_nErrors) {
+        summary += ", " + std::to_string(counters.m_nErrors) + " GL errors";
+    }
+    return summary;
+}
+
+void checkGLErrors(const char* function, const GLSourceLocation& where) {
+    for(GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError()) {
+        ++detail::g_CurrentGLFrame.m_nErrors;
+        if(g_ReportedErrors.insert(std::make_tuple(where.m_pFile, where.m_nLine, error)).second) {
+            std::cerr << where.m_pFile << ":" << where.m_nLine << ": " << getGLErrorName(error) << " in " << function << std::endl;
+        }
+    }
+}
+
+void reportInvalidGLName(const char* function, const char* kind, GLuint name, const GLSourceLocation& where) {
+    ++detail::g_CurrentGLFrame.m_nErrors;
+    if(g_ReportedErrors.insert(std::make_tuple(where.m_pFile, where.m_nLine, GLenum(GL_NONE))).second) {
+        std::cerr << where.m_pFile << ":" << where.m_nLine << ": " << name << " is not a " << kind << " name in " << function << std::endl;
+    }
+}
+
+void trackGeneratedFramebuffers(GLsizei n, const GLuint* framebuffers, bool created) {
+    for(GLsizei i = 0; i < n; ++i) {
+        if(created) {
+            g_GeneratedFramebuffers.insert(framebuffers[i]);
+        } else {
+            g_GeneratedFramebuffers.erase(framebuffers[i]);
+        }
+    }
+}
+
+bool isFramebufferName(GLuint framebuffer) {
+    return glIsFramebuffer(framebuffer) || g_GeneratedFramebuffers.count(framebuffer);
+}
+
+size_t getGLImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type) {
+    size_t components = 4;
+    switch(format) {
+    case GL_RED:
+    case GL_DEPTH_COMPONENT:
+        components = 1;
+        break;
+    case GL_RG:
+        components = 2;
+        break;
+    case GL_RGB:
+    case GL_BGR:
+        components = 3;
+        break;
+    }
+
+    size_t componentSize = 1;
+    switch(type) {
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+    case GL_HALF_FLOAT:
+        componentSize = 2;
+        break;
+    case GL_INT:
+    case GL_UNSIGNED_INT:
+    case GL_FLOAT:
+        componentSize = 4;
+        break;
+    }
+
+    return size_t(width) * height * components * componentSize;
+}
+
+}
@@ -0,0 +1,613 @@
+#include "glimac/GLCapture.hpp"
+#include "glimac/Profiler.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+
+// Deflate encoder of stb_image_write (implemented in Image.cpp), not declared by its header
+unsigned char* stbi_zlib_compress(unsigned char* data, int data_len, int* out_len, int quality);
+
+namespace glimac {
+
+namespace {
+
+// Blocks smaller than this are stored as is
+const size_t COMPRESSION_THRESHOLD = 4096;
+
+struct CaptureState {
+    std::ofstream m_File;
+    unsigned int m_nRemainingFrames = 0;
+    std::map<std::pair<const char*, int>, uint32_t> m_Locations; // 0 is the snapshot
+    std::vector<unsigned char> m_Payload;
+};
+
+CaptureState g_Capture;
+
+std::set<GLuint> g_Objects[5]; // Indexed by GLObjectType
+std::map<GLuint, GLenum> g_TextureTargets;
+
+void writeRecord(GLOp op, uint32_t location, const std::vector<unsigned char>& payload) {
+    const uint32_t header[3] = {uint32_t(op), location, uint32_t(payload.size())};
+    g_Capture.m_File.write(reinterpret_cast<const char*>(header), sizeof(header));
+    g_Capture.m_File.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+}
+
+uint32_t getLocationId(const char* file, int line) {
+    if(!file) {
+        return 0;
+    }
+    auto it = g_Capture.m_Locations.find(std::make_pair(file, line));
+    if(it != g_Capture.m_Locations.end()) {
+        return it->second;
+    }
+
+    const uint32_t id = g_Capture.m_Locations.size() + 1;
+    g_Capture.m_Locations[std::make_pair(file, line)] = id;
+
+    std::string text = std::string(file) + ":" + std::to_string(line);
+    std::vector<unsigned char> payload(sizeof(id) + sizeof(uint32_t) + text.size());
+    const uint32_t length = text.size();
+    std::memcpy(payload.data(), &id, sizeof(id));
+    std::memcpy(payload.data() + sizeof(id), &length, sizeof(length));
+    std::memcpy(payload.data() + sizeof(id) + sizeof(length), text.data(), text.size());
+    writeRecord(GLOp::SOURCE_LOCATION, 0, payload);
+    return id;
+}
+
+// Components of a uniform type read back with glGetUniformfv (or glGetUniformiv if 'integer'), 0 if not handled
+unsigned int getUniformComponents(GLenum type, bool& integer) {
+    integer = false;
+    switch(type) {
+    case GL_FLOAT:
+        return 1;
+    case GL_FLOAT_VEC2:
+        return 2;
+    case GL_FLOAT_VEC3:
+        return 3;
+    case GL_FLOAT_VEC4:
+    case GL_FLOAT_MAT2:
+        return 4;
+    case GL_FLOAT_MAT3:
+        return 9;
+    case GL_FLOAT_MAT4:
+        return 16;
+    case GL_INT:
+    case GL_BOOL:
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_CUBE:
+        integer = true;
+        return 1;
+    case GL_INT_VEC2:
+    case GL_BOOL_VEC2:
+        integer = true;
+        return 2;
+    case GL_INT_VEC3:
+    case GL_BOOL_VEC3:
+        integer = true;
+        return 3;
+    case GL_INT_VEC4:
+    case GL_BOOL_VEC4:
+        integer = true;
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+void snapshotProgram(GLuint program) {
+    GLuint shaders[8];
+    GLsizei shaderCount = 0;
+    glGetAttachedShaders(program, 8, &shaderCount, shaders);
+    {
+        GLCapture::Record record(GLOp::CREATE_PROGRAM, nullptr, 0);
+        record << program << uint32_t(shaderCount);
+        for(GLsizei i = 0; i < shaderCount; ++i) {
+            GLint type, length;
+            glGetShaderiv(shaders[i], GL_SHADER_TYPE, &type);
+            glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &length);
+            std::string source(std::max(length, 1), '\0');
+            glGetShaderSource(shaders[i], length, nullptr, &source[0]);
+            record << uint32_t(type);
+            record.string(source.c_str());
+        }
+    }
+
+    GLint blockCount = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    for(GLint i = 0; i < blockCount; ++i) {
+        char name[256];
+        GLint binding = 0;
+        glGetActiveUniformBlockName(program, i, sizeof(name), nullptr, name);
+        glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_BINDING, &binding);
+        GLCapture::Record record(GLOp::UNIFORM_BLOCK_BINDING, nullptr, 0);
+        record << program << GLuint(binding);
+        record.string(name);
+    }
+
+    GLint uniformCount = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+    for(GLint i = 0; i < uniformCount; ++i) {
+        char name[256];
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(program, i, sizeof(name), nullptr, &size, &type, name);
+        bool integer;
+        const unsigned int components = getUniformComponents(type, integer);
+
+        // Arrays are read element by element: "lights[0]" is listed, "lights[1]"... are not
+        std::string base(name);
+        if(size > 1 && base.size() > 3 && base.compare(base.size() - 3, 3, "[0]") == 0) {
+            base.resize(base.size() - 3);
+        }
+        for(GLint element = 0; element < size; ++element) {
+            const std::string elementName = size > 1 ? base + "[" + std::to_string(element) + "]" : base;
+            const GLint location = glGetUniformLocation(program, elementName.c_str());
+            if(location < 0) {
+                continue; // In a uniform block
+            }
+            {
+                GLCapture::Record record(GLOp::UNIFORM_LOCATION, nullptr, 0);
+                record << program << location;
+                record.string(elementName.c_str());
+            }
+            if(!components) {
+                continue;
+            }
+
+            float values[16];
+            if(integer) {
+                glGetUniformiv(program, location, reinterpret_cast<GLint*>(values));
+            } else {
+                glGetUniformfv(program, location, values);
+            }
+            GLCapture::Record record(GLOp::SET_UNIFORM, nullptr, 0);
+            record << program << location << uint32_t(type) << uint32_t(1);
+            record.data(values, components * sizeof(float));
+        }
+    }
+}
+
+void snapshotBuffers() {
+    const auto& buffers = g_Objects[int(GLObjectType::BUFFER)];
+    {
+        GLCapture::Record record(GLOp::GEN_BUFFERS, nullptr, 0);
+        record << GLsizei(buffers.size());
+        for(GLuint buffer: buffers) {
+            record << buffer;
+        }
+    }
+
+    std::vector<unsigned char> contents;
+    for(GLuint buffer: buffers) {
+        if(!glIsBuffer(buffer)) {
+            continue; // Generated, never bound
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        GLint64 size = 0;
+        GLint usage = GL_STATIC_DRAW;
+        glGetBufferParameteri64v(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+        glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_USAGE, &usage);
+        contents.resize(size);
+        if(size) {
+            glGetBufferSubData(GL_COPY_READ_BUFFER, 0, size, contents.data());
+        }
+
+        GLCapture::Record(GLOp::BIND_BUFFER, nullptr, 0) << GLenum(GL_COPY_WRITE_BUFFER) << buffer;
+        GLCapture::Record record(GLOp::BUFFER_DATA, nullptr, 0);
+        record << GLenum(GL_COPY_WRITE_BUFFER) << int64_t(size) << GLenum(usage);
+        record.data(contents.data(), contents.size());
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    GLCapture::Record(GLOp::BIND_BUFFER, nullptr, 0) << GLenum(GL_COPY_WRITE_BUFFER) << GLuint(0);
+}
+
+void snapshotTextures() {
+    const auto& textures = g_Objects[int(GLObjectType::TEXTURE)];
+    {
+        GLCapture::Record record(GLOp::GEN_TEXTURES, nullptr, 0);
+        record << GLsizei(textures.size());
+        for(GLuint texture: textures) {
+            record << texture;
+        }
+    }
+
+    std::vector<unsigned char> pixels;
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    for(GLuint texture: textures) {
+        auto target = g_TextureTargets.find(texture);
+        if(target == g_TextureTargets.end() || !glIsTexture(texture)) {
+            continue;
+        }
+        glBindTexture(target->second, texture);
+        GLCapture::Record(GLOp::BIND_TEXTURE, nullptr, 0) << target->second << texture;
+
+        const bool cubemap = target->second == GL_TEXTURE_CUBE_MAP;
+        for(GLenum face = 0; face < (cubemap ? 6u : 1u); ++face) {
+            const GLenum imageTarget = cubemap ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : target->second;
+            GLint width = 0, height = 0, depth = 1, internalFormat = GL_RGBA;
+            glGetTexLevelParameteriv(imageTarget, 0, GL_TEXTURE_WIDTH, &width);
+            glGetTexLevelParameteriv(imageTarget, 0, GL_TEXTURE_HEIGHT, &height);
+            glGetTexLevelParameteriv(imageTarget, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+            if(imageTarget == GL_TEXTURE_2D_ARRAY) {
+                glGetTexLevelParameteriv(imageTarget, 0, GL_TEXTURE_DEPTH, &depth);
+            }
+            if(!width || !height || !depth) {
+                continue;
+            }
+
+            // 8 bits formats are read back as they are stored, anything else as floats
+            GLenum format = GL_RGBA, type = GL_FLOAT;
+            size_t pixelSize = 4 * sizeof(float);
+            switch(internalFormat) {
+            case GL_RGB:
+            case GL_RGB8:
+            case GL_SRGB8:
+                format = GL_RGB, type = GL_UNSIGNED_BYTE, pixelSize = 3;
+                break;
+            case GL_RGBA:
+            case GL_RGBA8:
+            case GL_SRGB8_ALPHA8:
+                format = GL_RGBA, type = GL_UNSIGNED_BYTE, pixelSize = 4;
+                break;
+            case GL_RED:
+            case GL_R8:
+                format = GL_RED, type = GL_UNSIGNED_BYTE, pixelSize = 1;
+                break;
+            }
+            pixels.resize(size_t(width) * height * depth * pixelSize);
+            glGetTexImage(imageTarget, 0, format, type, pixels.data());
+
+            // Every layer of an array at once
+            if(imageTarget == GL_TEXTURE_2D_ARRAY) {
+                GLCapture::Record record(GLOp::TEX_IMAGE_3D, nullptr, 0);
+                record << imageTarget << GLint(0) << internalFormat << width << height << depth << GLint(0) << format << type;
+                record.data(pixels.data(), pixels.size());
+            } else {
+                GLCapture::Record record(GLOp::TEX_IMAGE_2D, nullptr, 0);
+                record << imageTarget << GLint(0) << internalFormat << width << height << GLint(0) << format << type;
+                record.data(pixels.data(), pixels.size());
+            }
+        }
+
+        const GLenum parameters[] = {GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T, GL_TEXTURE_WRAP_R};
+        for(GLenum parameter: parameters) {
+            GLint value;
+            glGetTexParameteriv(target->second, parameter, &value);
+            GLCapture::Record(GLOp::TEX_PARAMETERI, nullptr, 0) << target->second << parameter << value;
+        }
+        // Only level 0 is read back: the others are computed again, or the texture would be incomplete
+        GLint minFilter = GL_LINEAR;
+        glGetTexParameteriv(target->second, GL_TEXTURE_MIN_FILTER, &minFilter);
+        if(minFilter != GL_NEAREST && minFilter != GL_LINEAR) {
+            GLCapture::Record(GLOp::GENERATE_MIPMAP, nullptr, 0) << target->second;
+        }
+        glBindTexture(target->second, 0);
+        GLCapture::Record(GLOp::BIND_TEXTURE, nullptr, 0) << target->second << GLuint(0);
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+}
+
+void snapshotVertexArrays() {
+    const auto& arrays = g_Objects[int(GLObjectType::VERTEX_ARRAY)];
+    {
+        GLCapture::Record record(GLOp::GEN_VERTEX_ARRAYS, nullptr, 0);
+        record << GLsizei(arrays.size());
+        for(GLuint array: arrays) {
+            record << array;
+        }
+    }
+
+    GLint attribCount = 16;
+    glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &attribCount);
+    for(GLuint array: arrays) {
+        if(!glIsVertexArray(array)) {
+            continue;
+        }
+        glBindVertexArray(array);
+        GLCapture::Record(GLOp::BIND_VERTEX_ARRAY, nullptr, 0) << array;
+
+        // With GL 4.3 the attributes are recorded as formats and buffer bindings, which also describe the arrays
+        // set up with glVertexAttribPointer (binding = index): VAOs shared by several vertex buffers replay as they are
+        const bool attribBinding = GLAD_GL_VERSION_4_3;
+        for(GLint index = 0; index < attribCount; ++index) {
+            GLint enabled = GL_FALSE;
+            glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+            if(!enabled) {
+                continue;
+            }
+            GLint buffer, size, type, normalized, stride, integer, divisor;
+            void* pointer = nullptr;
+            glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+            glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_SIZE, &size);
+            glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_TYPE, &type);
+            glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &normalized);
+            glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &stride);
+            glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_INTEGER, &integer);
+            glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_DIVISOR, &divisor);
+
+            if(attribBinding) {
+                GLint relativeOffset, binding, bindingStride;
+                GLint64 bindingOffset;
+                glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_RELATIVE_OFFSET, &relativeOffset);
+                glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_BINDING, &binding);
+                glGetInteger64i_v(GL_VERTEX_BINDING_OFFSET, binding, &bindingOffset);
+                glGetIntegeri_v(GL_VERTEX_BINDING_STRIDE, binding, &bindingStride);
+                glGetIntegeri_v(GL_VERTEX_BINDING_DIVISOR, binding, &divisor);
+
+                if(integer) {
+                    GLCapture::Record(GLOp::VERTEX_ATTRIB_I_FORMAT, nullptr, 0) << GLuint(index) << size << GLenum(type)
+                        << GLuint(relativeOffset);
+                } else {
+                    GLCapture::Record(GLOp::VERTEX_ATTRIB_FORMAT, nullptr, 0) << GLuint(index) << size << GLenum(type)
+                        << uint8_t(normalized) << GLuint(relativeOffset);
+                }
+                GLCapture::Record(GLOp::VERTEX_ATTRIB_BINDING, nullptr, 0) << GLuint(index) << GLuint(binding);
+                GLCapture::Record(GLOp::BIND_VERTEX_BUFFER, nullptr, 0) << GLuint(binding) << GLuint(buffer) << int64_t(bindingOffset)
+                    << bindingStride;
+                GLCapture::Record(GLOp::VERTEX_BINDING_DIVISOR, nullptr, 0) << GLuint(binding) << GLuint(divisor);
+                GLCapture::Record(GLOp::ENABLE_VERTEX_ATTRIB_ARRAY, nullptr, 0) << GLuint(index);
+                continue;
+            }
+
+            glGetVertexAttribPointerv(index, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+            GLCapture::Record(GLOp::BIND_BUFFER, nullptr, 0) << GLenum(GL_ARRAY_BUFFER) << GLuint(buffer);
+            if(integer) {
+                GLCapture::Record(GLOp::VERTEX_ATTRIB_I_POINTER, nullptr, 0) << GLuint(index) << size << GLenum(type) << stride
+                    << uint64_t(reinterpret_cast<uintptr_t>(pointer));
+            } else {
+                GLCapture::Record(GLOp::VERTEX_ATTRIB_POINTER, nullptr, 0) << GLuint(index) << size << GLenum(type)
+                    << uint8_t(normalized) << stride << uint64_t(reinterpret_cast<uintptr_t>(pointer));
+            }
+            GLCapture::Record(GLOp::ENABLE_VERTEX_ATTRIB_ARRAY, nullptr, 0) << GLuint(index);
+            GLCapture::Record(GLOp::VERTEX_ATTRIB_DIVISOR, nullptr, 0) << GLuint(index) << GLuint(divisor);
+        }
+
+        GLint elements = 0;
+        glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &elements);
+        GLCapture::Record(GLOp::BIND_BUFFER, nullptr, 0) << GLenum(GL_ELEMENT_ARRAY_BUFFER) << GLuint(elements);
+    }
+}
+
+// Color and depth textures attached to each framebuffer, after the textures they refer to
+void snapshotFramebuffers() {
+    const auto& framebuffers = g_Objects[int(GLObjectType::FRAMEBUFFER)];
+    {
+        GLCapture::Record record(GLOp::GEN_FRAMEBUFFERS, nullptr, 0);
+        record << GLsizei(framebuffers.size());
+        for(GLuint framebuffer: framebuffers) {
+            record << framebuffer;
+        }
+    }
+
+    for(GLuint framebuffer: framebuffers) {
+        if(!glIsFramebuffer(framebuffer)) {
+            continue;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        GLCapture::Record(GLOp::BIND_FRAMEBUFFER, nullptr, 0) << GLenum(GL_FRAMEBUFFER) << framebuffer;
+
+        const GLenum attachments[] = {GL_COLOR_ATTACHMENT0, GL_DEPTH_ATTACHMENT};
+        for(GLenum attachment: attachments) {
+            GLint type = GL_NONE, texture = 0, level = 0;
+            glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+            if(type != GL_TEXTURE) {
+                continue; // Renderbuffers are not created through GL::
+            }
+            glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME, &texture);
+            glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_LEVEL, &level);
+            auto target = g_TextureTargets.find(texture);
+            GLCapture::Record(GLOp::FRAMEBUFFER_TEXTURE_2D, nullptr, 0) << GLenum(GL_FRAMEBUFFER) << attachment
+                << (target != g_TextureTargets.end() ? target->second : GLenum(GL_TEXTURE_2D)) << GLuint(texture) << level;
+        }
+    }
+}
+
+// Current state: capabilities, depth, blending, polygon mode, viewport, bindings
+void snapshotState() {
+    const GLenum capabilities[] = {GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE};
+    for(GLenum capability: capabilities) {
+        GLCapture::Record(glIsEnabled(capability) ? GLOp::ENABLE : GLOp::DISABLE, nullptr, 0) << capability;
+    }
+
+    GLint depthFunc, blendSource, blendDestination, polygonMode[2], viewport[4];
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+    glGetIntegerv(GL_BLEND_SRC_RGB, &blendSource);
+    glGetIntegerv(GL_BLEND_DST_RGB, &blendDestination);
+    glGetIntegerv(GL_POLYGON_MODE, polygonMode);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLfloat clearColor[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+    GLCapture::Record(GLOp::DEPTH_FUNC, nullptr, 0) << GLenum(depthFunc);
+    GLCapture::Record(GLOp::BLEND_FUNC, nullptr, 0) << GLenum(blendSource) << GLenum(blendDestination);
+    GLCapture::Record(GLOp::POLYGON_MODE, nullptr, 0) << GLenum(GL_FRONT_AND_BACK) << GLenum(polygonMode[0]);
+    GLCapture::Record(GLOp::VIEWPORT, nullptr, 0) << viewport[0] << viewport[1] << viewport[2] << viewport[3];
+    GLCapture::Record(GLOp::CLEAR_COLOR, nullptr, 0) << clearColor[0] << clearColor[1] << clearColor[2] << clearColor[3];
+}
+
+}
+
+const char* getGLOpName(GLOp op) {
+    static const char* const NAMES[] = {
+        "?", "source location", "snapshot end", "frame end",
+        "snapshot: program", "uniform location", "snapshot: uniform", "glDisableVertexAttribArray", "glVertexAttribIPointer",
+        "glUseProgram", "glBindVertexArray", "glBindBuffer", "glBindTexture", "glActiveTexture",
+        "glUniform1i", "glUniform1f", "glUniform3fv", "glUniformMatrix4fv",
+        "glGenBuffers", "glDeleteBuffers", "glBufferData", "glBufferSubData",
+        "glGenVertexArrays", "glDeleteVertexArrays", "glEnableVertexAttribArray", "glVertexAttribPointer",
+        "glVertexAttribDivisor", "glVertexAttrib4fv",
+        "glGenTextures", "glDeleteTextures", "glTexImage2D", "glTexParameteri",
+        "glGenFramebuffers", "glDeleteFramebuffers", "glBindFramebuffer", "glFramebufferTexture2D",
+        "glEnable", "glDisable", "glBlendFunc", "glDepthFunc", "glPolygonMode", "glViewport", "glClearColor", "glClear",
+        "glDrawArrays", "glDrawElements", "glDrawArraysInstancedBaseInstance", "glMultiDrawArraysIndirect",
+        "glBindBufferRange", "glUniformBlockBinding", "glBindBufferBase", "glBlitFramebuffer",
+        "glDispatchCompute", "glMemoryBarrier", "glBindImageTexture", "glVertexAttribFormat", "glVertexAttribIFormat",
+        "glVertexAttribBinding", "glVertexBindingDivisor", "glBindVertexBuffer",
+        "glTexSubImage2D", "glCreateBuffers", "glNamedBufferData", "glNamedBufferSubData", "glCreateTextures",
+        "glTextureStorage2D", "glTextureSubImage2D", "glTextureSubImage3D", "glTextureParameteri",
+        "glTexImage3D", "glTexSubImage3D", "glGenerateMipmap", "glTextureStorage3D", "glGenerateTextureMipmap",
+        "glMultiDrawElementsIndirect"};
+    static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == size_t(GLOp::COUNT), "One name per GLOp");
+    return uint32_t(op) < uint32_t(GLOp::COUNT) ? NAMES[uint32_t(op)] : "?";
+}
+
+bool GLCapture::start(const std::string& path, unsigned int frameCount) {
+    GLIMAC_PROFILE_ZONE("start GL capture");
+    stop();
+    g_Capture.m_File.open(path, std::ios::binary | std::ios::trunc);
+    if(!g_Capture.m_File) {
+        std::cerr << "Unable to write " << path << std::endl;
+        return false;
+    }
+    g_Capture.m_nRemainingFrames = frameCount;
+    g_Capture.m_Locations.clear();
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLTraceHeader header;
+    std::memcpy(header.m_Magic, GL_TRACE_MAGIC, sizeof(header.m_Magic));
+    header.m_nVersion = GL_TRACE_VERSION;
+    header.m_nWidth = viewport[2];
+    header.m_nHeight = viewport[3];
+    header.m_nFrameCount = frameCount;
+    g_Capture.m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Bindings changed by the snapshot, restored afterwards
+    GLint program, vertexArray, arrayBuffer, indirectBuffer, activeTexture, texture2D, textureCube, texture2DArray, framebuffer;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &arrayBuffer);
+    glGetIntegerv(GL_DRAW_INDIRECT_BUFFER_BINDING, &indirectBuffer);
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+    glActiveTexture(GL_TEXTURE0);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture2D);
+    glGetIntegerv(GL_TEXTURE_BINDING_CUBE_MAP, &textureCube);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &texture2DArray);
+
+    for(GLuint program: g_Objects[int(GLObjectType::PROGRAM)]) {
+        snapshotProgram(program);
+    }
+    Record(GLOp::ACTIVE_TEXTURE, nullptr, 0) << GLenum(GL_TEXTURE0);
+    snapshotBuffers();
+    snapshotTextures();
+    snapshotVertexArrays();
+    snapshotFramebuffers();
+    snapshotState();
+
+    glBindVertexArray(vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
+    glBindTexture(GL_TEXTURE_2D, texture2D);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textureCube);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture2DArray);
+    glActiveTexture(activeTexture);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    Record(GLOp::BIND_VERTEX_ARRAY, nullptr, 0) << GLuint(vertexArray);
+    Record(GLOp::BIND_BUFFER, nullptr, 0) << GLenum(GL_ARRAY_BUFFER) << GLuint(arrayBuffer);
+    Record(GLOp::BIND_BUFFER, nullptr, 0) << GLenum(GL_DRAW_INDIRECT_BUFFER) << GLuint(indirectBuffer);
+    Record(GLOp::BIND_TEXTURE, nullptr, 0) << GLenum(GL_TEXTURE_2D) << GLuint(texture2D);
+    Record(GLOp::BIND_TEXTURE, nullptr, 0) << GLenum(GL_TEXTURE_CUBE_MAP) << GLuint(textureCube);
+    Record(GLOp::BIND_TEXTURE, nullptr, 0) << GLenum(GL_TEXTURE_2D_ARRAY) << GLuint(texture2DArray);
+    Record(GLOp::ACTIVE_TEXTURE, nullptr, 0) << GLenum(activeTexture);
+    Record(GLOp::USE_PROGRAM, nullptr, 0) << GLuint(program);
+    Record(GLOp::BIND_FRAMEBUFFER, nullptr, 0) << GLenum(GL_FRAMEBUFFER) << GLuint(framebuffer);
+    Record(GLOp::SNAPSHOT_END, nullptr, 0);
+
+    s_bRecording = frameCount > 0;
+    std::clog << "Capturing " << frameCount << " frames into " << path << std::endl;
+    return true;
+}
+
+void GLCapture::stop() {
+    if(g_Capture.m_File.is_open()) {
+        g_Capture.m_File.close();
+    }
+    s_bRecording = false;
+}
+
+void GLCapture::endFrame() {
+    if(!s_bRecording) {
+        return;
+    }
+    Record(GLOp::FRAME_END, nullptr, 0);
+    if(--g_Capture.m_nRemainingFrames == 0) {
+        stop();
+        std::clog << "GL capture done" << std::endl;
+    }
+}
+
+void GLCapture::trackObjects(GLObjectType type, GLsizei n, const GLuint* names, bool created) {
+    auto& objects = g_Objects[int(type)];
+    for(GLsizei i = 0; i < n; ++i) {
+        if(created) {
+            objects.insert(names[i]);
+        } else {
+            objects.erase(names[i]);
+            if(type == GLObjectType::TEXTURE) {
+                g_TextureTargets.erase(names[i]);
+            }
+        }
+    }
+}
+
+void GLCapture::trackTextureImage(GLenum target) {
+    // Looked up here rather than in every glBindTexture: images are only given when loading
+    if(target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z) {
+        target = GL_TEXTURE_CUBE_MAP;
+    }
+    GLint texture = 0;
+    glGetIntegerv(target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_BINDING_CUBE_MAP
+                  : target == GL_TEXTURE_2D_ARRAY ? GL_TEXTURE_BINDING_2D_ARRAY : GL_TEXTURE_BINDING_2D, &texture);
+    if(texture) {
+        g_TextureTargets[texture] = target;
+    }
+}
+
+void GLCapture::trackTextureTarget(GLsizei n, const GLuint* textures, GLenum target) {
+    for(GLsizei i = 0; i < n; ++i) {
+        g_TextureTargets[textures[i]] = target;
+    }
+}
+
+GLCapture::Record::Record(GLOp op, const char* file, int line):
+    m_Op(op), m_nLocation(getLocationId(file, line)), m_Payload(g_Capture.m_Payload) {
+    m_Payload.clear();
+}
+
+GLCapture::Record::~Record() {
+    writeRecord(m_Op, m_nLocation, m_Payload);
+}
+
+GLCapture::Record& GLCapture::Record::data(const void* data, size_t size) {
+    unsigned char* compressed = nullptr;
+    int compressedSize = 0;
+    if(data && size >= COMPRESSION_THRESHOLD) {
+        GLIMAC_PROFILE_ZONE("compress GL capture data");
+        compressed = stbi_zlib_compress(static_cast<unsigned char*>(const_cast<void*>(data)), int(size), &compressedSize, 8);
+    }
+
+    if(compressed && size_t(compressedSize) < size) {
+        *this << uint8_t(1) << uint64_t(size) << uint64_t(compressedSize);
+        m_Payload.insert(m_Payload.end(), compressed, compressed + compressedSize);
+    } else {
+        const uint64_t storedSize = data ? size : 0;
+        *this << uint8_t(0) << uint64_t(size) << storedSize;
+        if(data) {
+            const auto bytes = static_cast<const unsigned char*>(data);
+            m_Payload.insert(m_Payload.end(), bytes, bytes + size);
+        }
+    }
+    std::free(compressed);
+    return *this;
+}
+
+GLCapture::Record& GLCapture::Record::string(const char* text) {
+    const uint32_t length = std::strlen(text);
+    *this << length;
+    m_Payload.insert(m_Payload.end(), text, text + length);
+    return *this;
+}
+
+}
@@ -0,0 +1,83 @@
+#include "glimac/GLExtensions.hpp"
+#include <cstring>
+
+#ifdef GLIMAC_LOAD_GL_ARB_buffer_storage
+int GLAD_GL_ARB_buffer_storage = 0;
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = nullptr;
+#endif
+#ifdef GLIMAC_LOAD_GL_VERSION_4_5
+int GLAD_GL_VERSION_4_5 = 0;
+#endif
+#ifdef GLIMAC_LOAD_GL_ARB_direct_state_access
+int GLAD_GL_ARB_direct_state_access = 0;
+#endif
+#ifdef GLIMAC_LOAD_DIRECT_STATE_ACCESS
+PFNGLCREATEBUFFERSPROC glad_glCreateBuffers = nullptr;
+PFNGLNAMEDBUFFERSTORAGEPROC glad_glNamedBufferStorage = nullptr;
+PFNGLNAMEDBUFFERDATAPROC glad_glNamedBufferData = nullptr;
+PFNGLNAMEDBUFFERSUBDATAPROC glad_glNamedBufferSubData = nullptr;
+PFNGLMAPNAMEDBUFFERRANGEPROC glad_glMapNamedBufferRange = nullptr;
+PFNGLCREATETEXTURESPROC glad_glCreateTextures = nullptr;
+PFNGLTEXTURESTORAGE2DPROC glad_glTextureStorage2D = nullptr;
+PFNGLTEXTURESTORAGE3DPROC glad_glTextureStorage3D = nullptr;
+PFNGLTEXTURESUBIMAGE2DPROC glad_glTextureSubImage2D = nullptr;
+PFNGLTEXTURESUBIMAGE3DPROC glad_glTextureSubImage3D = nullptr;
+PFNGLTEXTUREPARAMETERIPROC glad_glTextureParameteri = nullptr;
+PFNGLGENERATETEXTUREMIPMAPPROC glad_glGenerateTextureMipmap = nullptr;
+#endif
+
+namespace glimac {
+
+namespace {
+
+bool hasExtension(const char* name) {
+    if(!glGetStringi) {
+        return false;
+    }
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for(GLint i = 0; i < count; ++i) {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, GLuint(i)));
+        if(extension && std::strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+void loadGLExtensions(GLADloadproc load) {
+#ifdef GLIMAC_LOAD_GL_ARB_buffer_storage
+    glad_glBufferStorage = nullptr;
+    GLAD_GL_ARB_buffer_storage = hasExtension("GL_ARB_buffer_storage");
+    if(GLAD_GL_ARB_buffer_storage) {
+        glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC) load("glBufferStorage");
+    }
+#endif
+#ifdef GLIMAC_LOAD_GL_VERSION_4_5
+    GLAD_GL_VERSION_4_5 = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 5);
+#endif
+#ifdef GLIMAC_LOAD_GL_ARB_direct_state_access
+    GLAD_GL_ARB_direct_state_access = hasExtension("GL_ARB_direct_state_access");
+#endif
+#ifdef GLIMAC_LOAD_DIRECT_STATE_ACCESS
+    const bool directStateAccess = GLAD_GL_VERSION_4_5 || GLAD_GL_ARB_direct_state_access;
+    glad_glCreateBuffers = directStateAccess ? (PFNGLCREATEBUFFERSPROC) load("glCreateBuffers") : nullptr;
+    glad_glNamedBufferStorage = directStateAccess ? (PFNGLNAMEDBUFFERSTORAGEPROC) load("glNamedBufferStorage") : nullptr;
+    glad_glNamedBufferData = directStateAccess ? (PFNGLNAMEDBUFFERDATAPROC) load("glNamedBufferData") : nullptr;
+    glad_glNamedBufferSubData = directStateAccess ? (PFNGLNAMEDBUFFERSUBDATAPROC) load("glNamedBufferSubData") : nullptr;
+    glad_glMapNamedBufferRange = directStateAccess ? (PFNGLMAPNAMEDBUFFERRANGEPROC) load("glMapNamedBufferRange") : nullptr;
+    glad_glCreateTextures = directStateAccess ? (PFNGLCREATETEXTURESPROC) load("glCreateTextures") : nullptr;
+    glad_glTextureStorage2D = directStateAccess ? (PFNGLTEXTURESTORAGE2DPROC) load("glTextureStorage2D") : nullptr;
+    glad_glTextureStorage3D = directStateAccess ? (PFNGLTEXTURESTORAGE3DPROC) load("glTextureStorage3D") : nullptr;
+    glad_glTextureSubImage2D = directStateAccess ? (PFNGLTEXTURESUBIMAGE2DPROC) load("glTextureSubImage2D") : nullptr;
+    glad_glTextureSubImage3D = directStateAccess ? (PFNGLTEXTURESUBIMAGE3DPROC) load("glTextureSubImage3D") : nullptr;
+    glad_glTextureParameteri = directStateAccess ? (PFNGLTEXTUREPARAMETERIPROC) load("glTextureParameteri") : nullptr;
+    glad_glGenerateTextureMipmap = directStateAccess ? (PFNGLGENERATETEXTUREMIPMAPPROC) load("glGenerateTextureMipmap") : nullptr;
+#endif
+    (void) load;
+    (void) &hasExtension;
+}
+
+}
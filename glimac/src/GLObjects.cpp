@@ -0,0 +1,244 @@
+#include "glimac/GLObjects.hpp"
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace glimac {
+
+namespace {
+
+struct RegisteredObject {
+    GLMemoryCategory m_Category;
+    std::string m_sLabel;
+    size_t m_nBytes;
+    const char* m_pFile;
+    int m_nLine;
+};
+
+std::map<std::pair<GLObjectType, GLuint>, RegisteredObject> g_Registry;
+GLMemoryUsage g_Usage;
+bool g_bDirectStateAccess = true;
+
+const char* getObjectKind(GLObjectType type) {
+    switch(type) {
+    case GLObjectType::BUFFER:
+        return "buffer";
+    case GLObjectType::VERTEX_ARRAY:
+        return "vertex array";
+    case GLObjectType::TEXTURE:
+        return "texture";
+    case GLObjectType::PROGRAM:
+        return "program";
+    case GLObjectType::FRAMEBUFFER:
+        return "framebuffer";
+    }
+    return "object";
+}
+
+// Format and type of the pixels given to glTexImage2D with no data, to allocate 'internalFormat'
+void getUploadFormat(GLenum internalFormat, GLenum& format, GLenum& type) {
+    switch(internalFormat) {
+    case GL_DEPTH_COMPONENT16:
+    case GL_DEPTH_COMPONENT24:
+    case GL_DEPTH_COMPONENT32F:
+        format = GL_DEPTH_COMPONENT, type = GL_FLOAT;
+        break;
+    case GL_R8:
+    case GL_R16F:
+    case GL_R32F:
+        format = GL_RED, type = GL_FLOAT;
+        break;
+    case GL_RGB8:
+    case GL_SRGB8:
+    case GL_RGB32F:
+        format = GL_RGB, type = GL_UNSIGNED_BYTE;
+        break;
+    default:
+        format = GL_RGBA, type = GL_UNSIGNED_BYTE;
+        break;
+    }
+}
+
+}
+
+bool isDirectStateAccessSupported() {
+    return GLAD_GL_VERSION_4_5 || GLAD_GL_ARB_direct_state_access;
+}
+
+void setDirectStateAccessEnabled(bool enabled) {
+    g_bDirectStateAccess = enabled;
+}
+
+bool isDirectStateAccessEnabled() {
+    return g_bDirectStateAccess && isDirectStateAccessSupported();
+}
+
+const char* getGLMemoryCategoryName(GLMemoryCategory category) {
+    static const char* const names[] = {"vertices", "indices", "streaming", "commands", "textures", "render targets"};
+    return category < GLMemoryCategory::COUNT ? names[int(category)] : "unknown";
+}
+
+const GLMemoryUsage& getGLMemoryUsage() {
+    return g_Usage;
+}
+
+size_t reportGLLeaks(std::ostream& out) {
+    for(const auto& entry: g_Registry) {
+        const RegisteredObject& object = entry.second;
+        out << "Leaked GL " << getObjectKind(entry.first.first) << " " << entry.first.second << " '" << object.m_sLabel << "' ("
+            << getGLMemoryCategoryName(object.m_Category) << ", " << object.m_nBytes << " B), created at "
+            << object.m_pFile << ":" << object.m_nLine << std::endl;
+    }
+    return g_Registry.size();
+}
+
+size_t getGLTextureSize(GLsizei width, GLsizei height, GLint internalFormat) {
+    size_t texelSize = 4;
+    switch(internalFormat) {
+    case GL_RED:
+    case GL_R8:
+        texelSize = 1;
+        break;
+    case GL_RG:
+    case GL_RG8:
+    case GL_R16F:
+        texelSize = 2;
+        break;
+    case GL_RGB:
+    case GL_RGB8:
+    case GL_SRGB8:
+    case GL_DEPTH_COMPONENT24:
+        texelSize = 3;
+        break;
+    case GL_RGBA16F:
+    case GL_RG32F:
+        texelSize = 8;
+        break;
+    case GL_RGB32F:
+        texelSize = 12;
+        break;
+    case GL_RGBA32F:
+        texelSize = 16;
+        break;
+    }
+    return size_t(width) * height * texelSize;
+}
+
+void Texture::setStorage2D(GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height, GLSourceLocation where) {
+    const size_t faces = m_Target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+    if(isDirectStateAccessEnabled()) {
+        GL::textureStorage2D(m_nGLId, levels, internalFormat, width, height, where);
+    } else {
+        GLenum format, type;
+        getUploadFormat(internalFormat, format, type);
+        GL::bindTexture(m_Target, m_nGLId, where);
+        for(size_t face = 0; face < faces; ++face) {
+            const GLenum imageTarget = faces > 1 ? GLenum(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face) : m_Target;
+            for(GLint level = 0; level < levels; ++level) {
+                GL::texImage2D(imageTarget, level, internalFormat, std::max(width >> level, 1), std::max(height >> level, 1), 0, format,
+                               type, nullptr, where);
+            }
+        }
+        GL::bindTexture(m_Target, 0, where);
+    }
+    detail::resizeGLObject(GLObjectType::TEXTURE, m_nGLId, getGLTextureSize(width, height, internalFormat) * faces);
+}
+
+void Texture::setSubImage2D(GLint level, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels, GLint face,
+                            GLSourceLocation where) {
+    if(isDirectStateAccessEnabled()) {
+        if(m_Target == GL_TEXTURE_CUBE_MAP) {
+            GL::textureSubImage3D(m_nGLId, level, 0, 0, face, width, height, 1, format, type, pixels, where);
+        } else {
+            GL::textureSubImage2D(m_nGLId, level, 0, 0, width, height, format, type, pixels, where);
+        }
+        return;
+    }
+    const GLenum imageTarget = m_Target == GL_TEXTURE_CUBE_MAP ? GLenum(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face) : m_Target;
+    GL::bindTexture(m_Target, m_nGLId, where);
+    GL::texSubImage2D(imageTarget, level, 0, 0, width, height, format, type, pixels, where);
+    GL::bindTexture(m_Target, 0, where);
+}
+
+void Texture::setStorage3D(GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height, GLsizei layers, GLSourceLocation where) {
+    if(isDirectStateAccessEnabled()) {
+        GL::textureStorage3D(m_nGLId, levels, internalFormat, width, height, layers, where);
+    } else {
+        GLenum format, type;
+        getUploadFormat(internalFormat, format, type);
+        GL::bindTexture(m_Target, m_nGLId, where);
+        for(GLint level = 0; level < levels; ++level) {
+            GL::texImage3D(m_Target, level, internalFormat, std::max(width >> level, 1), std::max(height >> level, 1), layers, 0, format,
+                           type, nullptr, where);
+        }
+        GL::bindTexture(m_Target, 0, where);
+    }
+    detail::resizeGLObject(GLObjectType::TEXTURE, m_nGLId, getGLTextureSize(width, height, internalFormat) * layers);
+}
+
+void Texture::setSubImage3D(GLint level, GLint layer, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels,
+                            GLSourceLocation where) {
+    if(isDirectStateAccessEnabled()) {
+        GL::textureSubImage3D(m_nGLId, level, 0, 0, layer, width, height, 1, format, type, pixels, where);
+        return;
+    }
+    GL::bindTexture(m_Target, m_nGLId, where);
+    GL::texSubImage3D(m_Target, level, 0, 0, layer, width, height, 1, format, type, pixels, where);
+    GL::bindTexture(m_Target, 0, where);
+}
+
+void Texture::generateMipmap(GLSourceLocation where) {
+    if(isDirectStateAccessEnabled()) {
+        GL::generateTextureMipmap(m_nGLId, where);
+        return;
+    }
+    GL::bindTexture(m_Target, m_nGLId, where);
+    GL::generateMipmap(m_Target, where);
+    GL::bindTexture(m_Target, 0, where);
+}
+
+void Texture::setParameter(GLenum name, GLint value, GLSourceLocation where) {
+    if(isDirectStateAccessEnabled()) {
+        GL::textureParameteri(m_nGLId, name, value, where);
+        return;
+    }
+    GL::bindTexture(m_Target, m_nGLId, where);
+    GL::texParameteri(m_Target, name, value, where);
+    GL::bindTexture(m_Target, 0, where);
+}
+
+namespace detail {
+
+void registerGLObject(GLObjectType type, GLuint name, GLMemoryCategory category, const char* label, const GLSourceLocation& where) {
+    g_Registry[{type, name}] = {category, label, 0, where.m_pFile, where.m_nLine};
+    ++g_Usage.m_nObjects;
+}
+
+void resizeGLObject(GLObjectType type, GLuint name, size_t bytes) {
+    auto it = g_Registry.find({type, name});
+    if(it == g_Registry.end()) {
+        return;
+    }
+    auto category = size_t(it->second.m_Category);
+    g_Usage.m_nBytes[category] += bytes - it->second.m_nBytes;
+    g_Usage.m_nTotalBytes += bytes - it->second.m_nBytes;
+    it->second.m_nBytes = bytes;
+
+    g_Usage.m_nPeakBytes[category] = std::max(g_Usage.m_nPeakBytes[category], g_Usage.m_nBytes[category]);
+    g_Usage.m_nPeakTotalBytes = std::max(g_Usage.m_nPeakTotalBytes, g_Usage.m_nTotalBytes);
+}
+
+void unregisterGLObject(GLObjectType type, GLuint name) {
+    auto it = g_Registry.find({type, name});
+    if(it == g_Registry.end()) {
+        return;
+    }
+    resizeGLObject(type, name, 0);
+    g_Registry.erase(it);
+    --g_Usage.m_nObjects;
+}
+
+}
+
+}
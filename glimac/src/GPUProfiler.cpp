@@ -0,0 +1,198 @@
+#include "glimac/GPUProfiler.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace glimac {
+
+namespace {
+
+double cpuTime() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+void GPUProfiler::release() {
+    for(auto& frame: m_Frames) {
+        if(!frame.m_Queries.empty()) {
+            glDeleteQueries(frame.m_Queries.size(), frame.m_Queries.data());
+        }
+        frame = Frame();
+    }
+    m_nCurrentFrame = 0;
+    m_bInFrame = false;
+    m_Timings.clear();
+    m_CSV.close();
+}
+
+void GPUProfiler::beginFrame() {
+    if(m_bInFrame) {
+        endFrame();
+    }
+
+    m_nCurrentFrame = (m_nCurrentFrame + 1) % FRAME_LATENCY;
+    auto& frame = m_Frames[m_nCurrentFrame];
+    if(frame.m_bPending) {
+        resolve(frame, false);
+    }
+
+    frame.m_nUsedQueries = 0;
+    frame.m_Records.clear();
+    frame.m_Stack.clear();
+    frame.m_nFrameIndex = m_nFrameIndex++;
+    frame.m_bPending = false;
+
+    m_bInFrame = true;
+    beginScope("frame");
+}
+
+void GPUProfiler::endFrame() {
+    if(!m_bInFrame) {
+        return;
+    }
+    auto& frame = m_Frames[m_nCurrentFrame];
+    while(!frame.m_Stack.empty()) {
+        endScope();
+    }
+    frame.m_bPending = true;
+    m_bInFrame = false;
+}
+
+void GPUProfiler::flush() {
+    endFrame();
+    // Oldest first, the current frame last
+    for(auto i = 1u; i <= FRAME_LATENCY; ++i) {
+        auto& frame = m_Frames[(m_nCurrentFrame + i) % FRAME_LATENCY];
+        if(frame.m_bPending) {
+            resolve(frame, true);
+            frame.m_bPending = false;
+        }
+    }
+}
+
+void GPUProfiler::beginScope(const char* name) {
+    if(!m_bInFrame) {
+        return;
+    }
+    auto& frame = m_Frames[m_nCurrentFrame];
+    Record record;
+    record.m_nTiming = findTiming(name, frame.m_Stack.size());
+    record.m_nBeginQuery = timestamp(frame);
+    record.m_nEndQuery = record.m_nBeginQuery;
+    record.m_fCPUBegin = record.m_fCPUEnd = cpuTime();
+    frame.m_Stack.push_back(frame.m_Records.size());
+    frame.m_Records.push_back(record);
+}
+
+void GPUProfiler::endScope() {
+    if(!m_bInFrame) {
+        return;
+    }
+    auto& frame = m_Frames[m_nCurrentFrame];
+    if(frame.m_Stack.empty()) {
+        return;
+    }
+    auto& record = frame.m_Records[frame.m_Stack.back()];
+    record.m_nEndQuery = timestamp(frame);
+    record.m_fCPUEnd = cpuTime();
+    frame.m_Stack.pop_back();
+}
+
+std::string GPUProfiler::getSummary() const {
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(2);
+    for(auto i = 0u; i < m_Timings.size(); ++i) {
+        if(i > 0) {
+            summary << " | ";
+        }
+        summary << m_Timings[i].m_sName << " " << m_Timings[i].m_fGPUTime << "/" << m_Timings[i].m_fCPUTime << " ms";
+    }
+    return summary.str();
+}
+
+bool GPUProfiler::openCSV(const std::string& path) {
+    m_CSV.close();
+    m_CSV.open(path, std::ios::trunc);
+    if(!m_CSV) {
+        std::cerr << "Unable to open " << path << std::endl;
+        return false;
+    }
+    m_CSV << "frame,scope,depth,gpu_ms,cpu_ms" << std::endl;
+    return true;
+}
+
+unsigned int GPUProfiler::timestamp(Frame& frame) {
+    if(frame.m_nUsedQueries == frame.m_Queries.size()) {
+        GLuint query;
+        glGenQueries(1, &query);
+        frame.m_Queries.push_back(query);
+    }
+    glQueryCounter(frame.m_Queries[frame.m_nUsedQueries], GL_TIMESTAMP);
+    return frame.m_nUsedQueries++;
+}
+
+void GPUProfiler::resolve(Frame& frame, bool wait) {
+    if(frame.m_Records.empty()) {
+        return;
+    }
+
+    // Queries complete in order: if the last one is there, all of them are
+    GLint available = wait;
+    if(!wait) {
+        glGetQueryObjectiv(frame.m_Queries[frame.m_nUsedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    }
+    if(!available) {
+        ++m_nDroppedFrames;
+        return;
+    }
+
+    // A scope can be entered several times in a frame: sum before smoothing
+    m_GPUTimes.assign(m_Timings.size(), 0.);
+    m_CPUTimes.assign(m_Timings.size(), 0.);
+    m_Seen.assign(m_Timings.size(), false);
+    for(const auto& record: frame.m_Records) {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(frame.m_Queries[record.m_nBeginQuery], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.m_Queries[record.m_nEndQuery], GL_QUERY_RESULT, &end);
+        m_GPUTimes[record.m_nTiming] += (end - begin) * 1e-6;
+        m_CPUTimes[record.m_nTiming] += record.m_fCPUEnd - record.m_fCPUBegin;
+        m_Seen[record.m_nTiming] = true;
+    }
+
+    for(auto i = 0u; i < m_Timings.size(); ++i) {
+        if(!m_Seen[i]) {
+            continue;
+        }
+        auto& timing = m_Timings[i];
+        timing.m_fLastGPUTime = m_GPUTimes[i];
+        timing.m_fLastCPUTime = m_CPUTimes[i];
+        if(timing.m_nSampleCount++ == 0) {
+            timing.m_fGPUTime = m_GPUTimes[i];
+            timing.m_fCPUTime = m_CPUTimes[i];
+        } else {
+            timing.m_fGPUTime += m_fSmoothing * (m_GPUTimes[i] - timing.m_fGPUTime);
+            timing.m_fCPUTime += m_fSmoothing * (m_CPUTimes[i] - timing.m_fCPUTime);
+        }
+        if(m_CSV.is_open()) {
+            m_CSV << frame.m_nFrameIndex << "," << timing.m_sName << "," << timing.m_nDepth << ","
+                  << m_GPUTimes[i] << "," << m_CPUTimes[i] << "\n";
+        }
+    }
+}
+
+unsigned int GPUProfiler::findTiming(const char* name, unsigned int depth) {
+    for(auto i = 0u; i < m_Timings.size(); ++i) {
+        if(m_Timings[i].m_sName == name) {
+            return i;
+        }
+    }
+    Timing timing;
+    timing.m_sName = name;
+    timing.m_nDepth = depth;
+    m_Timings.push_back(timing);
+    return m_Timings.size() - 1;
+}
+
+}
@@ -1,6 +1,8 @@
 #include "glimac/Geometry.hpp"
+#include "glimac/Profiler.hpp"
+#include "glimac/MeshSimplifier.hpp"
+#include "glimac/Log.hpp"
 #include "tiny_obj_loader.h"
-#include <iostream>
 #include <algorithm>
 
 namespace glimac {
@@ -22,21 +24,22 @@ void Geometry::generateNormals(unsigned int meshIndex) {
 }
 
 bool Geometry::loadOBJ(const FilePath& filepath, const FilePath& mtlBasePath, bool loadTextures) {
+    GLIMAC_PROFILE_ZONE("load OBJ");
     std::vector<tinyobj::shape_t> shapes;
     std::vector<tinyobj::material_t> materials;
 
-    std::clog << "Load OBJ " << filepath << std::endl;
+    GLIMAC_LOG_INFO("Load OBJ {}", filepath);
+    // tinyobj appends the name of the mtllib to the base path as is, and FilePath drops the trailing separator
+    const std::string mtlDirectory = mtlBasePath.empty() ? std::string() : mtlBasePath.str() + FilePath::PATH_SEPARATOR;
     std::string objErr = tinyobj::LoadObj(shapes, materials,
-        filepath.c_str(), mtlBasePath.c_str());
-
-    std::clog << "done." << std::endl;
+        filepath.c_str(), mtlDirectory.c_str());
 
     if (!objErr.empty()) {
-        std::cerr << objErr << std::endl;
+        GLIMAC_LOG_ERROR("{}: {}", filepath, objErr);
         return false;
     }
 
-    std::clog << "Load materials" << std::endl;
+    GLIMAC_LOG_DEBUG("Load {} materials", materials.size());
     m_Materials.reserve(m_Materials.size() + materials.size());
     for(auto& material: materials) {
         m_Materials.emplace_back();
@@ -55,34 +58,32 @@ bool Geometry::loadOBJ(const FilePath& filepath, const FilePath& mtlBasePath, bo
             if(!material.ambient_texname.empty()) {
                 //std::replace(material.ambient_texname.begin(), material.ambient_texname.end(), '\\', '/');
                 FilePath texturePath = mtlBasePath + material.ambient_texname;
-                std::clog << "load " << texturePath << std::endl;
+                GLIMAC_LOG_DEBUG("load {}", texturePath);
                 m.m_pKaMap = ImageManager::loadImage(texturePath);
             }
 
             if(!material.diffuse_texname.empty()) {
                 //std::replace(material.diffuse_texname.begin(), material.diffuse_texname.end(), '\\', '/');
                 FilePath texturePath = mtlBasePath + material.diffuse_texname;
-                std::clog << "load " << texturePath << std::endl;
+                GLIMAC_LOG_DEBUG("load {}", texturePath);
                 m.m_pKdMap = ImageManager::loadImage(texturePath);
             }
 
             if(!material.specular_texname.empty()) {
                 //std::replace(material.specular_texname.begin(), material.specular_texname.end(), '\\', '/');
                 FilePath texturePath = mtlBasePath + material.specular_texname;
-                std::clog << "load " << texturePath << std::endl;
+                GLIMAC_LOG_DEBUG("load {}", texturePath);
                 m.m_pKsMap = ImageManager::loadImage(texturePath);
             }
 
             if(!material.normal_texname.empty()) {
                 //std::replace(material.normal_texname.begin(), material.normal_texname.end(), '\\', '/');
                 FilePath texturePath = mtlBasePath + material.normal_texname;
-                std::clog << "load " << texturePath << std::endl;
+                GLIMAC_LOG_DEBUG("load {}", texturePath);
                 m.m_pNormalMap = ImageManager::loadImage(texturePath);
             }
         }
     }
-    std::clog << "done." << std::endl;
-
     auto globalVertexOffset = m_VertexBuffer.size();
     auto globalIndexOffset = m_IndexBuffer.size();
 
@@ -93,9 +94,7 @@ bool Geometry::loadOBJ(const FilePath& filepath, const FilePath& mtlBasePath, bo
         nbIndex += shape.mesh.indices.size();
     }
 
-    std::clog << "Number of meshes: " << shapes.size() << std::endl;
-    std::clog << "Number of vertices: " << nbVertex << std::endl;
-    std::clog << "Number of triangles: " << (nbIndex) / 3 << std::endl;
+    GLIMAC_LOG_INFO("{}: {} meshes, {} vertices, {} triangles", filepath, shapes.size(), nbVertex, nbIndex / 3);
 
     m_BBox = BBox3f(glm::vec3(shapes[0].mesh.positions[0], shapes[0].mesh.positions[1], shapes[0].mesh.positions[2]));
 
@@ -170,4 +169,43 @@ bool Geometry::loadOBJ(const FilePath& filepath, const FilePath& mtlBasePath, bo
     return true;
 }
 
+void Geometry::buildLods(const std::vector<float>& ratios) {
+    GLIMAC_PROFILE_ZONE("build LODs");
+    for(auto& mesh: m_MeshBuffer) {
+        mesh.m_Lods.clear();
+        mesh.m_Lods.push_back({ mesh.m_nIndexOffset, mesh.m_nIndexCount, 0.f });
+
+        for(auto ratio: ratios) {
+            size_t targetIndexCount = size_t(mesh.m_nIndexCount * ratio) / 3 * 3;
+            float error = 0.f;
+            // Always simplify from the full resolution mesh so that the errors don't accumulate
+            auto indices = simplifyMesh(m_VertexBuffer.data(), m_IndexBuffer.data() + mesh.m_nIndexOffset,
+                                        mesh.m_nIndexCount, targetIndexCount, &error);
+            const auto& previous = mesh.m_Lods.back();
+            if(indices.size() >= previous.m_nIndexCount) {
+                break; // The mesh can't be simplified any further
+            }
+
+            unsigned int offset = m_IndexBuffer.size();
+            m_IndexBuffer.insert(m_IndexBuffer.end(), indices.begin(), indices.end());
+            mesh.m_Lods.push_back({ offset, (unsigned int) indices.size(), std::max(error, previous.m_fError) });
+        }
+
+        for(auto i = 0u; i < mesh.m_Lods.size(); ++i) {
+            GLIMAC_LOG_DEBUG("{} LOD {}: {} triangles, error {}", mesh.m_sName, i, mesh.m_Lods[i].m_nIndexCount / 3, mesh.m_Lods[i].m_fError);
+        }
+    }
+}
+
+unsigned int Geometry::selectLod(unsigned int meshIndex, float distance, float projectionScale, float maxPixelError) const {
+    const auto& lods = m_MeshBuffer[meshIndex].m_Lods;
+    distance = std::max(distance, 1e-4f);
+    for(auto level = (unsigned int) lods.size(); level-- > 1;) {
+        if(lods[level].m_fError * projectionScale / distance <= maxPixelError) {
+            return level;
+        }
+    }
+    return 0;
+}
+
 }
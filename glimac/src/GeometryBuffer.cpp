@@ -0,0 +1,94 @@
+#include "glimac/GeometryBuffer.hpp"
+#include "glimac/Profiler.hpp"
+#include <cstddef>
+
+namespace glimac {
+
+void GeometryBuffer::upload(const Geometry& geometry) {
+    GLIMAC_PROFILE_ZONE("upload geometry");
+    release();
+
+    m_Meshes.assign(geometry.getMeshBuffer(), geometry.getMeshBuffer() + geometry.getMeshCount());
+
+    m_VBO = Buffer(GLMemoryCategory::VERTICES, "geometry");
+    m_VBO.setData(geometry.getVertexCount() * sizeof(Geometry::Vertex), geometry.getVertexBuffer(), GL_STATIC_DRAW);
+    m_IBO = Buffer(GLMemoryCategory::INDICES, "geometry");
+    m_IBO.setData(geometry.getIndexCount() * sizeof(unsigned int), geometry.getIndexBuffer(), GL_STATIC_DRAW);
+
+    std::vector<GLint> materials;
+    materials.reserve(m_Meshes.size());
+    for(const auto& mesh: m_Meshes) {
+        materials.push_back(mesh.m_nMaterialIndex);
+    }
+    m_MaterialVBO = Buffer(GLMemoryCategory::VERTICES, "geometry materials");
+    m_MaterialVBO.setData(materials.size() * sizeof(GLint), materials.data(), GL_STATIC_DRAW);
+
+    m_CommandBuffer = Buffer(GLMemoryCategory::COMMANDS, "geometry commands");
+    m_CommandBuffer.setData(m_Meshes.size() * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+
+    m_VAO = VertexArray("geometry");
+    m_VAO.bind();
+    m_IBO.bind(GL_ELEMENT_ARRAY_BUFFER);
+
+    m_VBO.bind(GL_ARRAY_BUFFER);
+    GL::enableVertexAttribArray(ATTR_POSITION);
+    GL::vertexAttribPointer(ATTR_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(Geometry::Vertex), (const GLvoid *)offsetof(Geometry::Vertex, m_Position));
+    GL::enableVertexAttribArray(ATTR_NORMAL);
+    GL::vertexAttribPointer(ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(Geometry::Vertex), (const GLvoid *)offsetof(Geometry::Vertex, m_Normal));
+    GL::enableVertexAttribArray(ATTR_TEXCOORDS);
+    GL::vertexAttribPointer(ATTR_TEXCOORDS, 2, GL_FLOAT, GL_FALSE, sizeof(Geometry::Vertex), (const GLvoid *)offsetof(Geometry::Vertex, m_TexCoords));
+
+    m_MaterialVBO.bind(GL_ARRAY_BUFFER);
+    GL::enableVertexAttribArray(ATTR_MATERIAL);
+    GL::vertexAttribIPointer(ATTR_MATERIAL, 1, GL_INT, sizeof(GLint), (const GLvoid *)0);
+    GL::vertexAttribDivisor(ATTR_MATERIAL, 1);
+
+    GL::bindVertexArray(0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_Commands.reserve(m_Meshes.size());
+}
+
+void GeometryBuffer::release() {
+    m_VAO = VertexArray();
+    m_VBO = Buffer();
+    m_IBO = Buffer();
+    m_MaterialVBO = Buffer();
+    m_CommandBuffer = Buffer();
+    m_Meshes.clear();
+}
+
+size_t GeometryBuffer::draw(const std::vector<bool>& visibleMeshes, const unsigned int* lodLevels) const {
+    m_Commands.clear();
+    for(auto i = 0u; i < m_Meshes.size(); ++i) {
+        if(i < visibleMeshes.size() && !visibleMeshes[i]) {
+            continue;
+        }
+        const auto& mesh = m_Meshes[i];
+        auto offset = mesh.m_nIndexOffset, count = mesh.m_nIndexCount;
+        if(lodLevels && lodLevels[i] < mesh.m_Lods.size()) {
+            offset = mesh.m_Lods[lodLevels[i]].m_nIndexOffset;
+            count = mesh.m_Lods[lodLevels[i]].m_nIndexCount;
+        }
+        if(count > 0) {
+            m_Commands.push_back({ count, 1u, offset, 0, i });
+        }
+    }
+    if(m_Commands.empty()) {
+        return 0;
+    }
+
+    // Orphan the previous commands, the GPU may still be reading them
+    m_CommandBuffer.setData(m_Meshes.size() * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+    m_CommandBuffer.setSubData(0, m_Commands.size() * sizeof(DrawElementsIndirectCommand), m_Commands.data());
+
+    m_VAO.bind();
+    m_CommandBuffer.bind(GL_DRAW_INDIRECT_BUFFER);
+    GL::multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, m_Commands.size(), 0);
+    GL::bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    GL::bindVertexArray(0);
+
+    return m_Commands.size();
+}
+
+}
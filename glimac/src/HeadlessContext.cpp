@@ -0,0 +1,163 @@
+#include "glimac/HeadlessContext.hpp"
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+#ifdef GLIMAC_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+namespace glimac {
+
+bool HeadlessContext::create(int width, int height) {
+    release();
+
+    if(createEGL()) {
+        m_sBackend = "egl";
+    } else if(createOSMesa()) {
+        m_sBackend = "osmesa";
+    } else {
+        std::cerr << "Unable to create a headless OpenGL context (no EGL or OSMesa)" << std::endl;
+        return false;
+    }
+
+    m_nWidth = width;
+    m_nHeight = height;
+
+    glGenRenderbuffers(1, &m_nColorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_nColorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &m_nDepthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_nDepthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_nFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_nFBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_nColorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_nDepthBuffer);
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Headless framebuffer is incomplete" << std::endl;
+        release();
+        return false;
+    }
+
+    glViewport(0, 0, width, height);
+
+    return true;
+}
+
+void HeadlessContext::release() {
+    if(m_nFBO) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &m_nFBO);
+        glDeleteRenderbuffers(1, &m_nColorBuffer);
+        glDeleteRenderbuffers(1, &m_nDepthBuffer);
+        m_nFBO = m_nColorBuffer = m_nDepthBuffer = 0;
+    }
+
+#ifdef GLIMAC_HAS_EGL
+    if(m_pDisplay) {
+        eglMakeCurrent(m_pDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if(m_pContext) {
+            eglDestroyContext(m_pDisplay, m_pContext);
+        }
+        eglTerminate(m_pDisplay);
+        m_pDisplay = m_pContext = nullptr;
+    }
+#endif
+
+    if(m_pWindow) {
+        glfwDestroyWindow(m_pWindow);
+        glfwTerminate();
+        m_pWindow = nullptr;
+    }
+
+    m_sBackend.clear();
+}
+
+bool HeadlessContext::createEGL() {
+#ifdef GLIMAC_HAS_EGL
+    // Surfaceless display (Mesa), otherwise the default one
+    EGLDisplay display = EGL_NO_DISPLAY;
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if(getPlatformDisplay) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if(display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    EGLint major, minor;
+    if(display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        return false;
+    }
+    m_pDisplay = display;
+
+    if(!eglBindAPI(EGL_OPENGL_API)) {
+        release();
+        return false;
+    }
+
+    // We only render into our own framebuffer: no config and no surface needed
+    const EGLint configAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    if(!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        config = nullptr; // EGL_NO_CONFIG_KHR
+    }
+
+    // Same version as the glad loader, then whatever the driver gives
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if(context == EGL_NO_CONTEXT) {
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+    }
+    if(context == EGL_NO_CONTEXT) {
+        release();
+        return false;
+    }
+    m_pContext = context;
+
+    if(!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)
+        || !gladLoadGLLoader((GLADloadproc) eglGetProcAddress)) {
+        release();
+        return false;
+    }
+    loadGLExtensions((GLADloadproc) eglGetProcAddress);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool HeadlessContext::createOSMesa() {
+    // Without display, GLFW has to be built with GLFW_USE_OSMESA (null platform)
+    if(!glfwInit()) {
+        return false;
+    }
+
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+    m_pWindow = glfwCreateWindow(1, 1, "headless", nullptr, nullptr);
+    if(!m_pWindow) {
+        glfwTerminate();
+        return false;
+    }
+
+    glfwMakeContextCurrent(m_pWindow);
+    if(!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+        release();
+        return false;
+    }
+    loadGLExtensions((GLADloadproc) glfwGetProcAddress);
+    return true;
+}
+
+}
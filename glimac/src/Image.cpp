@@ -1,15 +1,19 @@
 #include "glimac/Image.hpp"
+#include "glimac/Profiler.hpp"
+#include "glimac/Log.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
-#include <iostream>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <third-party/glfw/deps/stb_image_write.h>
 
 namespace glimac {
 
 std::unique_ptr<Image> loadImage(const FilePath& filepath) {
+    GLIMAC_PROFILE_ZONE("decode image");
     int x, y, n;
     unsigned char *data = stbi_load(filepath.c_str(), &x, &y, &n, 4);
     if(!data) {
-        std::cerr << "loading image " << filepath << " error: " << stbi_failure_reason() << std::endl;
+        GLIMAC_LOG_ERROR("loading image {} error: {}", filepath, stbi_failure_reason());
         return std::unique_ptr<Image>();
     }
     std::unique_ptr<Image> pImage(new Image(x, y));
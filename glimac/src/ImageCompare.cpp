@@ -0,0 +1,77 @@
+#include "glimac/ImageCompare.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace glimac {
+
+namespace {
+
+struct Lab {
+    double L, a, b;
+};
+
+double toLinear(unsigned char value) {
+    const double c = value / 255.;
+    return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+}
+
+double labCurve(double t) {
+    return t > 216. / 24389. ? std::cbrt(t) : (24389. / 27. * t + 16.) / 116.;
+}
+
+// sRGB -> XYZ (D65) -> L*a*b*
+Lab toLab(const unsigned char* rgb, const double* linear) {
+    const double r = linear[rgb[0]], g = linear[rgb[1]], b = linear[rgb[2]];
+    const double x = (0.4124 * r + 0.3576 * g + 0.1805 * b) / 0.95047;
+    const double y = 0.2126 * r + 0.7152 * g + 0.0722 * b;
+    const double z = (0.0193 * r + 0.1192 * g + 0.9505 * b) / 1.08883;
+    const double fx = labCurve(x), fy = labCurve(y), fz = labCurve(z);
+    return { 116. * fy - 16., 500. * (fx - fy), 200. * (fy - fz) };
+}
+
+}
+
+ImageDifference compareImages(const unsigned char* reference, const unsigned char* image, size_t width, size_t height,
+                              double threshold, std::vector<unsigned char>* diffImage) {
+    double linear[256];
+    for(auto i = 0; i < 256; ++i) {
+        linear[i] = toLinear(i);
+    }
+
+    ImageDifference difference;
+    difference.m_nPixelCount = width * height;
+    if(diffImage) {
+        diffImage->resize(difference.m_nPixelCount * 4);
+    }
+
+    double sum = 0.;
+    for(size_t i = 0; i < difference.m_nPixelCount; ++i) {
+        const auto p = reference + 4 * i, q = image + 4 * i;
+        double deltaE = 0.;
+        if(p[0] != q[0] || p[1] != q[1] || p[2] != q[2]) {
+            const auto a = toLab(p, linear), b = toLab(q, linear);
+            deltaE = std::sqrt((a.L - b.L) * (a.L - b.L) + (a.a - b.a) * (a.a - b.a) + (a.b - b.b) * (a.b - b.b));
+        }
+        sum += deltaE;
+        difference.m_fMaxDeltaE = std::max(difference.m_fMaxDeltaE, deltaE);
+        if(deltaE > threshold) {
+            ++difference.m_nDifferentPixels;
+        }
+
+        if(diffImage) {
+            auto d = diffImage->data() + 4 * i;
+            if(deltaE > threshold) {
+                d[0] = (unsigned char) std::min(255., 128. + deltaE * 4.);
+                d[1] = d[2] = 0;
+            } else {
+                d[0] = d[1] = d[2] = (unsigned char) ((p[0] * 54 + p[1] * 183 + p[2] * 19) >> 10); // Grey, a quarter
+            }
+            d[3] = 255;
+        }
+    }
+    difference.m_fMeanDeltaE = difference.m_nPixelCount ? sum / difference.m_nPixelCount : 0.;
+
+    return difference;
+}
+
+}
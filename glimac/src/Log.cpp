@@ -0,0 +1,235 @@
+#include "glimac/Log.hpp"
+#include "glimac/Profiler.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+namespace glimac {
+
+namespace {
+
+const char* getLevelName(LogLevel level) {
+    switch(level) {
+    case LogLevel::DEBUG:
+        return "debug";
+    case LogLevel::INFO:
+        return "info";
+    case LogLevel::WARNING:
+        return "warning";
+    case LogLevel::ERROR:
+        return "error";
+    }
+    return "?";
+}
+
+// Ring of records (bounded multi-producer queue with a sequence number per record, the writer thread
+// being its only consumer) and the thread that prints them
+struct Logger {
+    std::unique_ptr<Log::Record[]> m_Records;
+    alignas(64) std::atomic<uint64_t> m_nWritePosition { 0 }; // Next record reserved by a producer
+    alignas(64) std::atomic<uint64_t> m_nReadPosition { 0 };  // Next record printed by the writer
+    std::atomic<uint64_t> m_nDropped { 0 };
+    std::atomic<bool> m_bStop { false };
+    int64_t m_nStartTime;
+    std::thread m_Writer;
+
+    Logger(): m_Records(new Log::Record[Log::CAPACITY]) {
+        for(uint64_t i = 0; i < Log::CAPACITY; ++i) {
+            m_Records[i].m_nSequence.store(i, std::memory_order_relaxed);
+        }
+        m_nStartTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        m_Writer = std::thread([this]() {
+            run();
+        });
+    }
+
+    // Prints what is left before the static destructors of the program end
+    ~Logger() {
+        m_bStop.store(true, std::memory_order_release);
+        m_Writer.join();
+    }
+
+    void run() {
+        GLIMAC_PROFILE_THREAD("log writer");
+        std::string line;
+        uint64_t reportedDrops = 0;
+        for(;;) {
+            bool stop = m_bStop.load(std::memory_order_acquire);
+            bool printed = false;
+            while(print(line)) {
+                printed = true;
+            }
+
+            auto dropped = m_nDropped.load(std::memory_order_relaxed);
+            if(dropped != reportedDrops) {
+                std::cerr << "[log] " << dropped - reportedDrops << " messages dropped, the log ring was full" << std::endl;
+                reportedDrops = dropped;
+            }
+            if(printed) {
+                std::clog.flush();
+            }
+
+            if(stop) {
+                return;
+            }
+            if(!printed) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        }
+    }
+
+    // Prints the next record if it is written, false if the ring is empty
+    bool print(std::string& line) {
+        auto position = m_nReadPosition.load(std::memory_order_relaxed);
+        auto& record = m_Records[position & (Log::CAPACITY - 1)];
+        if(record.m_nSequence.load(std::memory_order_acquire) != position + 1) {
+            return false;
+        }
+
+        char time[32];
+        std::snprintf(time, sizeof(time), "[%.3f] ", (record.m_nTime - m_nStartTime) * 1e-9);
+        line = time;
+        line += getLevelName(record.m_Level);
+        line += ": ";
+        format(record, line);
+        bool error = record.m_Level >= LogLevel::WARNING;
+
+        // The record can be reused from here
+        record.m_nSequence.store(position + Log::CAPACITY, std::memory_order_release);
+        m_nReadPosition.store(position + 1, std::memory_order_release);
+
+        // Unbuffered std::cerr for the warnings and errors, as before
+        if(error) {
+            std::cerr << line << '\n';
+        } else {
+            std::clog << line << '\n';
+        }
+        return true;
+    }
+
+    static void format(const Log::Record& record, std::string& line) {
+        const unsigned char* argument = record.m_Arguments;
+        const unsigned char* end = record.m_Arguments + record.m_nSize;
+        for(const char* c = record.m_pFormat; *c; ++c) {
+            if(c[0] != '{' || c[1] != '}') {
+                line += *c;
+                continue;
+            }
+            ++c;
+            if(argument == end) {
+                line += record.m_bTruncated ? "..." : "{}";
+                continue;
+            }
+            argument = appendArgument(argument, line);
+        }
+    }
+
+    static const unsigned char* appendArgument(const unsigned char* argument, std::string& line) {
+        char text[32];
+        auto tag = detail::LogArgument(*argument++);
+        switch(tag) {
+        case detail::LogArgument::SIGNED: {
+            int64_t value;
+            std::memcpy(&value, argument, sizeof(value));
+            std::snprintf(text, sizeof(text), "%" PRId64, value);
+            line += text;
+            return argument + sizeof(value);
+        }
+        case detail::LogArgument::UNSIGNED: {
+            uint64_t value;
+            std::memcpy(&value, argument, sizeof(value));
+            std::snprintf(text, sizeof(text), "%" PRIu64, value);
+            line += text;
+            return argument + sizeof(value);
+        }
+        case detail::LogArgument::FLOATING: {
+            double value;
+            std::memcpy(&value, argument, sizeof(value));
+            std::snprintf(text, sizeof(text), "%g", value);
+            line += text;
+            return argument + sizeof(value);
+        }
+        case detail::LogArgument::BOOLEAN:
+            line += *argument ? "true" : "false";
+            return argument + sizeof(bool);
+        case detail::LogArgument::STRING: {
+            uint16_t length;
+            std::memcpy(&length, argument, sizeof(length));
+            argument += sizeof(length);
+            line.append(reinterpret_cast<const char*>(argument), length);
+            return argument + length;
+        }
+        }
+        return argument;
+    }
+};
+
+Logger& getLogger() {
+    static Logger logger;
+    return logger;
+}
+
+}
+
+namespace detail {
+
+void LogEncoder::addString(const char* text, size_t length) {
+    const size_t header = 1 + sizeof(uint16_t);
+    if(m_nSize + header >= m_nCapacity) {
+        m_bTruncated = true;
+        return;
+    }
+    auto stored = uint16_t(std::min(length, m_nCapacity - m_nSize - header));
+    m_bTruncated = m_bTruncated || stored < length;
+    m_pData[m_nSize++] = static_cast<unsigned char>(LogArgument::STRING);
+    std::memcpy(m_pData + m_nSize, &stored, sizeof(stored));
+    m_nSize += sizeof(stored);
+    std::memcpy(m_pData + m_nSize, text, stored);
+    m_nSize += stored;
+}
+
+}
+
+Log::Record* Log::acquire() {
+    auto& logger = getLogger();
+    auto position = logger.m_nWritePosition.load(std::memory_order_relaxed);
+    for(;;) {
+        auto& record = logger.m_Records[position & (CAPACITY - 1)];
+        auto sequence = record.m_nSequence.load(std::memory_order_acquire);
+        auto difference = int64_t(sequence) - int64_t(position);
+        if(difference == 0) {
+            // Free record: reserve it, or retry with the position another producer left
+            if(logger.m_nWritePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                record.m_nPosition = position;
+                return &record;
+            }
+        } else if(difference < 0) {
+            // Not printed yet: a whole ring behind
+            logger.m_nDropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = logger.m_nWritePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Log::publish(Record* record) {
+    record->m_nSequence.store(record->m_nPosition + 1, std::memory_order_release);
+}
+
+void Log::flush() {
+    auto& logger = getLogger();
+    auto position = logger.m_nWritePosition.load(std::memory_order_acquire);
+    while(logger.m_nReadPosition.load(std::memory_order_acquire) < position) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+uint64_t Log::getDroppedCount() {
+    return getLogger().m_nDropped.load(std::memory_order_relaxed);
+}
+
+}
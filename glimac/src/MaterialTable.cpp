@@ -0,0 +1,125 @@
+#include "glimac/MaterialTable.hpp"
+#include "glimac/Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace glimac {
+
+namespace {
+
+// Bilinear resampling of an image to size x size RGBA8 texels
+void resample(const Image& image, unsigned int size, std::vector<unsigned char>& texels) {
+    const auto width = image.getWidth(), height = image.getHeight();
+    const auto* pixels = image.getPixels();
+    auto fetch = [&](int x, int y) {
+        x = std::min(std::max(x, 0), int(width) - 1);
+        y = std::min(std::max(y, 0), int(height) - 1);
+        return pixels[y * width + x];
+    };
+
+    texels.resize(size * size * 4);
+    auto* texel = texels.data();
+    for(auto y = 0u; y < size; ++y) {
+        float v = (y + 0.5f) * height / size - 0.5f;
+        int y0 = int(std::floor(v));
+        float fy = v - y0;
+        for(auto x = 0u; x < size; ++x) {
+            float u = (x + 0.5f) * width / size - 0.5f;
+            int x0 = int(std::floor(u));
+            float fx = u - x0;
+            glm::vec4 color = glm::mix(glm::mix(fetch(x0, y0), fetch(x0 + 1, y0), fx),
+                                       glm::mix(fetch(x0, y0 + 1), fetch(x0 + 1, y0 + 1), fx), fy);
+            color = glm::clamp(color, 0.f, 1.f) * 255.f + 0.5f;
+            for(auto c = 0; c < 4; ++c) {
+                *texel++ = (unsigned char) color[c];
+            }
+        }
+    }
+}
+
+}
+
+void MaterialTable::upload(const Geometry& geometry, unsigned int mapSize) {
+    GLIMAC_PROFILE_ZONE("upload materials");
+    release();
+
+    // Each distinct image gets one layer (ImageManager returns the same pointer for the same file)
+    std::vector<const Image*> maps;
+    std::unordered_map<const Image*, int> layers;
+    auto layerOf = [&](const Image* image) {
+        if(!image) {
+            return -1;
+        }
+        auto it = layers.emplace(image, (int) maps.size());
+        if(it.second) {
+            maps.push_back(image);
+        }
+        return it.first->second;
+    };
+
+    std::vector<GPUMaterial> materials;
+    materials.reserve(geometry.getMaterialCount() + 1);
+    for(auto i = 0u; i < geometry.getMaterialCount(); ++i) {
+        const auto& m = geometry.getMaterialBuffer()[i];
+        materials.push_back({
+            glm::vec4(m.m_Ka, 1.f),
+            glm::vec4(m.m_Kd, m.m_Dissolve),
+            glm::vec4(m.m_Ks, m.m_Shininess),
+            glm::vec4(m.m_Le, 1.f),
+            glm::ivec4(layerOf(m.m_pKaMap), layerOf(m.m_pKdMap), layerOf(m.m_pKsMap), layerOf(m.m_pNormalMap))
+        });
+    }
+    // Default material, same values as the ones used for the room
+    materials.push_back({
+        glm::vec4(0.f, 0.f, 0.f, 1.f),
+        glm::vec4(0.8f, 0.8f, 0.8f, 1.f),
+        glm::vec4(0.5f, 0.5f, 0.5f, 50.f),
+        glm::vec4(0.f, 0.f, 0.f, 1.f),
+        glm::ivec4(-1)
+    });
+
+    m_MaterialBuffer = Buffer(GLMemoryCategory::VERTICES, "materials");
+    m_MaterialBuffer.setData(materials.size() * sizeof(GPUMaterial), materials.data(), GL_STATIC_DRAW);
+    m_nMaterialCount = materials.size();
+
+    m_MapArray = Texture(GL_TEXTURE_2D_ARRAY, GLMemoryCategory::TEXTURES, "material maps");
+    if(maps.empty()) {
+        // Keep a valid (white) texture bound so that the sampler is complete
+        const unsigned char white[] = { 255, 255, 255, 255 };
+        m_MapArray.setStorage3D(1, GL_RGBA8, 1, 1, 1);
+        m_MapArray.setSubImage3D(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        m_MapArray.setParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    } else {
+        GLsizei levels = 1;
+        while((mapSize >> levels) > 0) {
+            ++levels;
+        }
+        m_MapArray.setStorage3D(levels, GL_RGBA8, mapSize, mapSize, maps.size());
+        std::vector<unsigned char> texels;
+        for(auto layer = 0u; layer < maps.size(); ++layer) {
+            resample(*maps[layer], mapSize, texels);
+            m_MapArray.setSubImage3D(0, layer, mapSize, mapSize, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+        }
+        m_MapArray.generateMipmap();
+        m_MapArray.setParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    }
+    m_MapArray.setParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    m_MapArray.setParameter(GL_TEXTURE_WRAP_S, GL_REPEAT);
+    m_MapArray.setParameter(GL_TEXTURE_WRAP_T, GL_REPEAT);
+    m_nMapCount = maps.size();
+}
+
+void MaterialTable::release() {
+    m_MaterialBuffer = Buffer();
+    m_MapArray = Texture();
+    m_nMaterialCount = m_nMapCount = 0;
+}
+
+void MaterialTable::bind(GLuint textureUnit) const {
+    GL::bindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIAL_BINDING, m_MaterialBuffer.getGLId());
+    GL::activeTexture(GL_TEXTURE0 + textureUnit);
+    m_MapArray.bind();
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,289 @@
+#include "glimac/MeshSimplifier.hpp"
+#include "glimac/Profiler.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <cstdint>
+
+namespace glimac {
+
+namespace {
+
+// Sum of weighted squared distances to a set of planes, stored as a symmetric 4x4 matrix
+struct Quadric {
+    double a00 = 0., a01 = 0., a02 = 0., a11 = 0., a12 = 0., a22 = 0.;
+    double b0 = 0., b1 = 0., b2 = 0.;
+    double c = 0.;
+    double w = 0.;
+
+    void addPlane(const glm::dvec3& n, double d, double weight) {
+        a00 += weight * n.x * n.x; a01 += weight * n.x * n.y; a02 += weight * n.x * n.z;
+        a11 += weight * n.y * n.y; a12 += weight * n.y * n.z; a22 += weight * n.z * n.z;
+        b0 += weight * n.x * d; b1 += weight * n.y * d; b2 += weight * n.z * d;
+        c += weight * d * d;
+        w += weight;
+    }
+
+    void add(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02;
+        a11 += q.a11; a12 += q.a12; a22 += q.a22;
+        b0 += q.b0; b1 += q.b1; b2 += q.b2;
+        c += q.c;
+        w += q.w;
+    }
+
+    // Mean squared distance from p to the planes
+    double evaluate(const glm::vec3& p) const {
+        if(w <= 0.) {
+            return 0.;
+        }
+        double x = p.x, y = p.y, z = p.z;
+        double r = a00 * x * x + a11 * y * y + a22 * z * z
+                 + 2. * (a01 * x * y + a02 * x * z + a12 * y * z)
+                 + 2. * (b0 * x + b1 * y + b2 * z) + c;
+        return std::max(r, 0.) / w;
+    }
+};
+
+struct PositionKey {
+    uint32_t x, y, z;
+
+    bool operator ==(const PositionKey& other) const {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+struct PositionKeyHash {
+    size_t operator()(const PositionKey& k) const {
+        return (k.x * 73856093u) ^ (k.y * 19349663u) ^ (k.z * 83492791u);
+    }
+};
+
+PositionKey makeKey(const glm::vec3& p) {
+    PositionKey key;
+    std::memcpy(&key.x, &p.x, sizeof(float));
+    std::memcpy(&key.y, &p.y, sizeof(float));
+    std::memcpy(&key.z, &p.z, sizeof(float));
+    return key;
+}
+
+struct Collapse {
+    unsigned int from, to; // Local vertex indices
+    double cost;
+};
+
+}
+
+std::vector<unsigned int> simplifyMesh(const Geometry::Vertex* vertices,
+                                       const unsigned int* indices, size_t indexCount,
+                                       size_t targetIndexCount, float* outError) {
+    GLIMAC_PROFILE_ZONE("simplify mesh");
+    std::vector<unsigned int> result(indices, indices + indexCount);
+    double maxError = 0.;
+
+    if(indexCount < 3 || targetIndexCount >= indexCount) {
+        if(outError) {
+            *outError = 0.f;
+        }
+        return result;
+    }
+
+    // The meshes of a Geometry address a contiguous range of the vertex buffer: work with local indices
+    auto range = std::minmax_element(indices, indices + indexCount);
+    const unsigned int base = *range.first;
+    const size_t vertexCount = *range.second - base + 1;
+    auto position = [&](unsigned int local) -> const glm::vec3& {
+        return vertices[base + local].m_Position;
+    };
+
+    // Weld the vertices sharing a position: positionId is the first vertex of the group
+    std::vector<unsigned int> positionId(vertexCount);
+    {
+        std::unordered_map<PositionKey, unsigned int, PositionKeyHash> positions;
+        positions.reserve(vertexCount);
+        for(auto v = 0u; v < vertexCount; ++v) {
+            positionId[v] = positions.emplace(makeKey(position(v)), v).first->second;
+        }
+    }
+
+    // Vertices which must stay in place
+    std::vector<char> locked(vertexCount, 0);
+    {
+        // Attribute seams: several referenced vertices with the same position
+        std::vector<char> referenced(vertexCount, 0);
+        std::vector<unsigned int> groupSize(vertexCount, 0);
+        for(auto i = 0u; i < indexCount; ++i) {
+            auto v = indices[i] - base;
+            if(!referenced[v]) {
+                referenced[v] = 1;
+                if(++groupSize[positionId[v]] > 1) {
+                    locked[positionId[v]] = 1;
+                }
+            }
+        }
+
+        // Borders and non-manifold edges: edges not shared by exactly two triangles
+        std::unordered_map<uint64_t, unsigned int> edges;
+        edges.reserve(indexCount);
+        for(auto i = 0u; i < indexCount; i += 3) {
+            for(auto k = 0u; k < 3; ++k) {
+                uint64_t a = positionId[indices[i + k] - base];
+                uint64_t b = positionId[indices[i + (k + 1) % 3] - base];
+                if(a != b) {
+                    ++edges[(std::min(a, b) << 32) | std::max(a, b)];
+                }
+            }
+        }
+        for(const auto& edge: edges) {
+            if(edge.second != 2) {
+                locked[edge.first >> 32] = 1;
+                locked[edge.first & 0xFFFFFFFFu] = 1;
+            }
+        }
+    }
+
+    // Initial quadrics: planes of the incident triangles weighted by their area
+    std::vector<Quadric> quadrics(vertexCount);
+    for(auto i = 0u; i < indexCount; i += 3) {
+        unsigned int v[3] = { indices[i] - base, indices[i + 1] - base, indices[i + 2] - base };
+        glm::dvec3 p0(position(v[0])), p1(position(v[1])), p2(position(v[2]));
+        glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+        double length = glm::length(n);
+        if(length <= 0.) {
+            continue;
+        }
+        n /= length;
+        double d = -glm::dot(n, p0);
+        for(auto k = 0u; k < 3; ++k) {
+            quadrics[positionId[v[k]]].addPlane(n, d, 0.5 * length);
+        }
+    }
+
+    std::vector<unsigned int> remap(vertexCount);
+    for(auto v = 0u; v < vertexCount; ++v) {
+        remap[v] = v;
+    }
+
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1);
+    std::vector<unsigned int> adjacency;
+    std::vector<char> touched(vertexCount);
+    std::vector<Collapse> collapses;
+
+    // Returns true if moving 'from' onto 'to' would flip or crush one of the remaining triangles
+    auto flips = [&](unsigned int from, unsigned int to) {
+        const glm::vec3& target = position(to);
+        for(auto t = adjacencyOffsets[from]; t < adjacencyOffsets[from + 1]; ++t) {
+            auto tri = adjacency[t];
+            unsigned int v[3] = { remap[result[tri] - base], remap[result[tri + 1] - base], remap[result[tri + 2] - base] };
+            unsigned int p[3] = { positionId[v[0]], positionId[v[1]], positionId[v[2]] };
+            if(p[0] == p[1] || p[1] == p[2] || p[0] == p[2]) {
+                continue; // Already removed by a previous collapse of this pass
+            }
+            if(p[0] == positionId[to] || p[1] == positionId[to] || p[2] == positionId[to]) {
+                continue; // Removed by this collapse
+            }
+            glm::vec3 before[3] = { position(v[0]), position(v[1]), position(v[2]) };
+            glm::vec3 after[3] = { before[0], before[1], before[2] };
+            for(auto k = 0u; k < 3; ++k) {
+                if(v[k] == from) {
+                    after[k] = target;
+                }
+            }
+            glm::vec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+            glm::vec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+            float l0 = glm::length(n0), l1 = glm::length(n1);
+            if(l1 <= 0.f || glm::dot(n0, n1) < 0.25f * l0 * l1) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    while(result.size() > targetIndexCount) {
+        // Vertex to triangle adjacency of the current index buffer
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0u);
+        for(auto index: result) {
+            ++adjacencyOffsets[index - base + 1];
+        }
+        for(auto v = 0u; v < vertexCount; ++v) {
+            adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        }
+        adjacency.resize(result.size());
+        {
+            std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for(auto i = 0u; i < result.size(); ++i) {
+                adjacency[fill[result[i] - base]++] = i - i % 3;
+            }
+        }
+
+        // Candidate collapses, each edge is considered in both directions
+        collapses.clear();
+        for(auto i = 0u; i < result.size(); i += 3) {
+            for(auto k = 0u; k < 3; ++k) {
+                auto a = result[i + k] - base;
+                auto b = result[i + (k + 1) % 3] - base;
+                auto pa = positionId[a], pb = positionId[b];
+                if(pa >= pb || (locked[pa] && locked[pb])) {
+                    continue;
+                }
+                Quadric q = quadrics[pa];
+                q.add(quadrics[pb]);
+                auto costAB = locked[pa] ? -1. : q.evaluate(position(b));
+                auto costBA = locked[pb] ? -1. : q.evaluate(position(a));
+                if(costBA < 0. || (costAB >= 0. && costAB <= costBA)) {
+                    collapses.push_back({ a, b, costAB });
+                } else {
+                    collapses.push_back({ b, a, costBA });
+                }
+            }
+        }
+        if(collapses.empty()) {
+            break;
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+            return x.cost < y.cost;
+        });
+
+        // Each collapse removes two triangles on a manifold; only the cheapest third of the
+        // candidates is considered so that the costs get refreshed between passes
+        const size_t wanted = (result.size() - targetIndexCount) / 6 + 1;
+        const size_t considered = std::max<size_t>(collapses.size() / 3, 1);
+        std::fill(touched.begin(), touched.end(), 0);
+        size_t applied = 0;
+        for(auto c = 0u; c < considered && applied < wanted; ++c) {
+            const auto& collapse = collapses[c];
+            auto pFrom = positionId[collapse.from], pTo = positionId[collapse.to];
+            if(touched[pFrom] || touched[pTo] || flips(collapse.from, collapse.to)) {
+                continue;
+            }
+            remap[collapse.from] = collapse.to;
+            quadrics[pTo].add(quadrics[pFrom]);
+            touched[pFrom] = touched[pTo] = 1;
+            maxError = std::max(maxError, collapse.cost);
+            ++applied;
+        }
+        if(applied == 0) {
+            break;
+        }
+
+        // Apply the collapses and drop the degenerated triangles
+        size_t write = 0;
+        for(auto i = 0u; i < result.size(); i += 3) {
+            unsigned int v[3] = { remap[result[i] - base], remap[result[i + 1] - base], remap[result[i + 2] - base] };
+            if(positionId[v[0]] == positionId[v[1]] || positionId[v[1]] == positionId[v[2]] || positionId[v[0]] == positionId[v[2]]) {
+                continue;
+            }
+            for(auto k = 0u; k < 3; ++k) {
+                result[write++] = base + v[k];
+            }
+        }
+        result.resize(write);
+    }
+
+    if(outError) {
+        *outError = float(std::sqrt(maxError));
+    }
+    return result;
+}
+
+}
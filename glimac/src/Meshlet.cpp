@@ -0,0 +1,214 @@
+#include "glimac/Meshlet.hpp"
+#include "glimac/Profiler.hpp"
+#include <algorithm>
+
+namespace glimac {
+
+void MeshletBuffer::build(const Geometry& geometry, unsigned int meshIndex, unsigned int maxVertices, unsigned int maxTriangles) {
+    GLIMAC_PROFILE_ZONE("build meshlets");
+    const auto& mesh = geometry.getMeshBuffer()[meshIndex];
+    const unsigned int* indices = geometry.getIndexBuffer() + mesh.m_nIndexOffset;
+    const size_t triangleCount = mesh.m_nIndexCount / 3;
+    if(triangleCount == 0) {
+        return;
+    }
+
+    // The meshes of a Geometry address a contiguous range of the vertex buffer: work with local indices
+    auto range = std::minmax_element(indices, indices + triangleCount * 3);
+    const unsigned int base = *range.first;
+    const size_t vertexCount = *range.second - base + 1;
+
+    // Vertex to triangle adjacency
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0u);
+    for(auto i = 0u; i < triangleCount * 3; ++i) {
+        ++adjacencyOffsets[indices[i] - base + 1];
+    }
+    for(auto v = 0u; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    }
+    std::vector<unsigned int> adjacency(triangleCount * 3);
+    {
+        std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for(auto i = 0u; i < triangleCount * 3; ++i) {
+            adjacency[fill[indices[i] - base]++] = i / 3;
+        }
+    }
+
+    // Number of triangles not yet emitted around each vertex
+    std::vector<unsigned int> liveTriangles(vertexCount);
+    for(auto v = 0u; v < vertexCount; ++v) {
+        liveTriangles[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v];
+    }
+
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<int> slot(vertexCount, -1); // Position of the vertex in the current meshlet
+    std::vector<unsigned int> candidates;
+
+    Meshlet current = {};
+    auto start = [&]() {
+        current = {};
+        current.m_nIndexOffset = m_Indices.size();
+        current.m_nVertexOffset = m_Vertices.size();
+        current.m_nMeshIndex = meshIndex;
+        candidates.clear();
+    };
+    auto flush = [&]() {
+        if(current.m_nIndexCount == 0) {
+            return;
+        }
+        for(auto i = 0u; i < current.m_nVertexCount; ++i) {
+            slot[m_Vertices[current.m_nVertexOffset + i] - base] = -1;
+        }
+        computeBounds(geometry, current);
+        m_Meshlets.push_back(current);
+        start();
+    };
+    auto newVertices = [&](unsigned int triangle) {
+        auto count = 0u;
+        for(auto k = 0u; k < 3; ++k) {
+            count += slot[indices[triangle * 3 + k] - base] < 0;
+        }
+        return count;
+    };
+
+    start();
+    size_t seed = 0;
+    for(size_t remaining = triangleCount; remaining > 0; --remaining) {
+        // Grow the meshlet with the adjacent triangle adding the fewest vertices,
+        // favouring vertices with few triangles left so that they get completed
+        int best = -1;
+        auto bestNew = 4u, bestLive = ~0u;
+        size_t write = 0;
+        for(auto candidate: candidates) {
+            if(emitted[candidate]) {
+                continue;
+            }
+            candidates[write++] = candidate;
+            auto added = newVertices(candidate);
+            auto live = 0u;
+            for(auto k = 0u; k < 3; ++k) {
+                live += liveTriangles[indices[candidate * 3 + k] - base];
+            }
+            if(added < bestNew || (added == bestNew && live < bestLive)) {
+                best = candidate;
+                bestNew = added;
+                bestLive = live;
+            }
+        }
+        candidates.resize(write);
+
+        if(best < 0) {
+            // Nothing connected to the current meshlet: continue with the next triangle in index order
+            while(emitted[seed]) {
+                ++seed;
+            }
+            best = seed;
+            bestNew = newVertices(best);
+        }
+
+        if(current.m_nVertexCount + bestNew > maxVertices || current.m_nIndexCount / 3 + 1 > maxTriangles) {
+            flush();
+        }
+
+        for(auto k = 0u; k < 3; ++k) {
+            auto index = indices[best * 3 + k];
+            auto v = index - base;
+            if(slot[v] < 0) {
+                slot[v] = current.m_nVertexCount++;
+                m_Vertices.push_back(index);
+                for(auto t = adjacencyOffsets[v]; t < adjacencyOffsets[v + 1]; ++t) {
+                    if(!emitted[adjacency[t]]) {
+                        candidates.push_back(adjacency[t]);
+                    }
+                }
+            }
+            --liveTriangles[v];
+            m_Indices.push_back(index);
+        }
+        current.m_nIndexCount += 3;
+        emitted[best] = 1;
+    }
+    flush();
+}
+
+void MeshletBuffer::computeBounds(const Geometry& geometry, Meshlet& meshlet) const {
+    const auto* vertices = geometry.getVertexBuffer();
+
+    glm::vec3 center(0.f);
+    for(auto i = 0u; i < meshlet.m_nVertexCount; ++i) {
+        center += vertices[m_Vertices[meshlet.m_nVertexOffset + i]].m_Position;
+    }
+    center /= float(meshlet.m_nVertexCount);
+
+    float radius = 0.f;
+    for(auto i = 0u; i < meshlet.m_nVertexCount; ++i) {
+        radius = std::max(radius, glm::length(vertices[m_Vertices[meshlet.m_nVertexOffset + i]].m_Position - center));
+    }
+
+    // Normal cone
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshlet.m_nIndexCount / 3);
+    glm::vec3 axis(0.f);
+    for(auto i = 0u; i < meshlet.m_nIndexCount; i += 3) {
+        const auto* triangle = &m_Indices[meshlet.m_nIndexOffset + i];
+        const auto& p0 = vertices[triangle[0]].m_Position;
+        glm::vec3 n = glm::cross(vertices[triangle[1]].m_Position - p0, vertices[triangle[2]].m_Position - p0);
+        float length = glm::length(n);
+        if(length > 0.f) {
+            normals.push_back(n / length);
+            axis += normals.back();
+        }
+    }
+
+    meshlet.m_Center = center;
+    meshlet.m_fRadius = radius;
+    meshlet.m_ConeAxis = glm::vec3(0.f);
+    meshlet.m_fConeCutoff = 1.f;
+
+    float axisLength = glm::length(axis);
+    if(axisLength <= 0.f) {
+        return;
+    }
+    axis /= axisLength;
+    float minDot = 1.f;
+    for(const auto& n: normals) {
+        minDot = std::min(minDot, glm::dot(n, axis));
+    }
+    // Normals spread over more than ~85 degrees: the cone test would never succeed
+    if(minDot <= 0.1f) {
+        return;
+    }
+    meshlet.m_ConeAxis = axis;
+    meshlet.m_fConeCutoff = std::sqrt(1.f - minDot * minDot);
+}
+
+size_t MeshletBuffer::cull(const Frustum& frustum, const glm::vec3& cameraPosition, std::vector<unsigned int>& outIndices) const {
+    size_t visibleCount = 0;
+    for(const auto& meshlet: m_Meshlets) {
+        if(isVisible(meshlet, frustum, cameraPosition)) {
+            outIndices.insert(outIndices.end(), m_Indices.begin() + meshlet.m_nIndexOffset,
+                              m_Indices.begin() + meshlet.m_nIndexOffset + meshlet.m_nIndexCount);
+            ++visibleCount;
+        }
+    }
+    return visibleCount;
+}
+
+size_t MeshletBuffer::cull(const Frustum& frustum, const glm::vec3& cameraPosition, std::vector<DrawElementsIndirectCommand>& outCommands) const {
+    const size_t firstCommand = outCommands.size();
+    size_t visibleCount = 0;
+    for(const auto& meshlet: m_Meshlets) {
+        if(isVisible(meshlet, frustum, cameraPosition)) {
+            // Consecutive visible meshlets are merged in a single command
+            if(outCommands.size() > firstCommand && outCommands.back().firstIndex + outCommands.back().count == meshlet.m_nIndexOffset) {
+                outCommands.back().count += meshlet.m_nIndexCount;
+            } else {
+                outCommands.push_back({ meshlet.m_nIndexCount, 1u, meshlet.m_nIndexOffset, 0, 0u });
+            }
+            ++visibleCount;
+        }
+    }
+    return visibleCount;
+}
+
+}
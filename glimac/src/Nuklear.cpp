@@ -0,0 +1,3 @@
+#define NK_IMPLEMENTATION
+#define NK_GLFW_GL2_IMPLEMENTATION
+#include "glimac/Nuklear.hpp"
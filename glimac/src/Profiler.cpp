@@ -0,0 +1,186 @@
+#include "glimac/Profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace glimac {
+
+#ifdef GLIMAC_PROFILER
+
+namespace {
+
+static_assert((Profiler::EVENT_CAPACITY & (Profiler::EVENT_CAPACITY - 1)) == 0, "EVENT_CAPACITY must be a power of two");
+
+// A null name marks the end of the innermost zone
+struct Event {
+    std::atomic<const char*> m_pName;
+    std::atomic<uint64_t> m_nTime; // Nanoseconds since the first event
+};
+
+// Only written by its thread; m_nHead publishes the events to writeChromeTrace
+struct ThreadBuffer {
+    Event m_Events[Profiler::EVENT_CAPACITY];
+    std::atomic<uint64_t> m_nHead { 0 };
+    unsigned int m_nThreadId = 0;
+    std::string m_sName; // Guarded by Registry::m_Mutex
+};
+
+// Buffers are never freed, so the zones of the threads that have exited can still be written
+struct Registry {
+    std::mutex m_Mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_Buffers;
+};
+
+Registry& getRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+uint64_t now() {
+    static const auto origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+thread_local ThreadBuffer* t_pBuffer = nullptr;
+
+ThreadBuffer& getThreadBuffer() {
+    if(!t_pBuffer) {
+        auto& registry = getRegistry();
+        std::lock_guard<std::mutex> lock(registry.m_Mutex);
+        registry.m_Buffers.emplace_back(new ThreadBuffer());
+        t_pBuffer = registry.m_Buffers.back().get();
+        t_pBuffer->m_nThreadId = registry.m_Buffers.size();
+        t_pBuffer->m_sName = "thread " + std::to_string(t_pBuffer->m_nThreadId);
+    }
+    return *t_pBuffer;
+}
+
+void record(const char* name) {
+    auto& buffer = getThreadBuffer();
+    auto head = buffer.m_nHead.load(std::memory_order_relaxed);
+    auto& event = buffer.m_Events[head & (Profiler::EVENT_CAPACITY - 1)];
+    event.m_pName.store(name, std::memory_order_relaxed);
+    event.m_nTime.store(now(), std::memory_order_relaxed);
+    buffer.m_nHead.store(head + 1, std::memory_order_release);
+}
+
+void writeString(std::ostream& out, const std::string& value) {
+    out << '"';
+    for(auto c: value) {
+        if(c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+}
+
+void Profiler::beginZone(const char* name) {
+    record(name);
+}
+
+void Profiler::endZone() {
+    record(nullptr);
+}
+
+void Profiler::setThreadName(const char* name) {
+    auto& buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(getRegistry().m_Mutex);
+    buffer.m_sName = name;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+    std::ofstream file(path, std::ios::trunc);
+    if(!file) {
+        std::cerr << "Unable to open " << path << std::endl;
+        return false;
+    }
+
+    struct Copy {
+        const char* m_pName;
+        uint64_t m_nTime;
+    };
+    struct Open {
+        const char* m_pName;
+        uint64_t m_nBegin;
+    };
+    std::vector<Copy> events;
+    std::vector<Open> stack;
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    bool first = true;
+
+    auto& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.m_Mutex);
+    for(const auto& pBuffer: registry.m_Buffers) {
+        const auto& buffer = *pBuffer;
+
+        file << (first ? "" : ",") << "\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer.m_nThreadId
+             << ", \"args\": {\"name\": ";
+        writeString(file, buffer.m_sName);
+        file << "}}";
+        first = false;
+
+        auto head = buffer.m_nHead.load(std::memory_order_acquire);
+        auto begin = head > EVENT_CAPACITY ? head - EVENT_CAPACITY : 0;
+        events.clear();
+        for(auto i = begin; i < head; ++i) {
+            const auto& event = buffer.m_Events[i & (EVENT_CAPACITY - 1)];
+            events.push_back({ event.m_pName.load(std::memory_order_relaxed), event.m_nTime.load(std::memory_order_relaxed) });
+        }
+
+        // The thread kept running: drop the slots it may have overwritten while they were copied,
+        // including the one it may be writing
+        auto written = buffer.m_nHead.load(std::memory_order_acquire) + 1;
+        auto valid = written > EVENT_CAPACITY ? written - EVENT_CAPACITY : 0;
+        auto skipped = valid > begin ? std::min<uint64_t>(valid - begin, events.size()) : 0;
+
+        // Ends whose begin was overwritten are skipped, zones still open are left out
+        stack.clear();
+        for(auto i = skipped; i < events.size(); ++i) {
+            const auto& event = events[i];
+            if(event.m_pName) {
+                stack.push_back({ event.m_pName, event.m_nTime });
+            } else if(!stack.empty()) {
+                const auto& zone = stack.back();
+                file << ",\n{\"name\": ";
+                writeString(file, zone.m_pName);
+                file << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer.m_nThreadId
+                     << ", \"ts\": " << zone.m_nBegin * 1e-3 << ", \"dur\": " << (event.m_nTime - zone.m_nBegin) * 1e-3 << "}";
+                stack.pop_back();
+            }
+        }
+    }
+
+    file << "\n]}" << std::endl;
+    return bool(file);
+}
+
+#else
+
+void Profiler::beginZone(const char*) {
+}
+
+void Profiler::endZone() {
+}
+
+void Profiler::setThreadName(const char*) {
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+    std::cerr << "Unable to write " << path << ": glimac was built without GLIMAC_PROFILER" << std::endl;
+    return false;
+}
+
+#endif
+
+}
@@ -1,9 +1,11 @@
 #include "glimac/Program.hpp"
+#include "glimac/Profiler.hpp"
 #include <stdexcept>
 
 namespace glimac {
 
 bool Program::link() {
+	GLIMAC_PROFILE_ZONE("link program");
 	glLinkProgram(m_nGLId);
 	GLint status;
 	glGetProgramiv(m_nGLId, GL_LINK_STATUS, &status);
@@ -49,6 +51,7 @@ Program buildProgram(const GLchar* vsSrc, const GLchar* fsSrc) {
 
 // Load source code from files and build a GLSL program
 Program loadProgram(const FilePath& vsFile, const FilePath& fsFile) {
+	GLIMAC_PROFILE_ZONE("load program");
 	Shader vs = loadShader(GL_VERTEX_SHADER, vsFile);
 	Shader fs = loadShader(GL_FRAGMENT_SHADER, fsFile);
 
@@ -71,4 +74,22 @@ Program loadProgram(const FilePath& vsFile, const FilePath& fsFile) {
 	return program;
 }
 
+Program loadComputeProgram(const FilePath& csFile) {
+	GLIMAC_PROFILE_ZONE("load program");
+	Shader cs = loadShader(GL_COMPUTE_SHADER, csFile);
+
+	if(!cs.compile()) {
+		throw std::runtime_error("Compilation error for compute shader (from file " + std::string(csFile) + "): " + cs.getInfoLog());
+	}
+
+	Program program;
+	program.attachShader(cs);
+
+	if(!program.link()) {
+		throw std::runtime_error("Link error (for file " + csFile.str() + "): " + program.getInfoLog());
+	}
+
+	return program;
+}
+
 }
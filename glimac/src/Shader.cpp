@@ -1,4 +1,6 @@
 #include "glimac/Shader.hpp"
+#include "glimac/Profiler.hpp"
+#include "glimac/Log.hpp"
 
 #include <fstream>
 #include <stdexcept>
@@ -8,6 +10,7 @@
 namespace glimac {
 
 bool Shader::compile() {
+	GLIMAC_PROFILE_ZONE("compile shader");
 	glCompileShader(m_nGLId);
 	GLint status;
 	glGetShaderiv(m_nGLId, GL_COMPILE_STATUS, &status);
@@ -25,6 +28,7 @@ const std::string Shader::getInfoLog() const {
 }
 
 Shader loadShader(GLenum type, const FilePath& filepath) {
+    GLIMAC_LOG_DEBUG("load shader {}", filepath);
     std::ifstream input(filepath.c_str());
     if(!input) {
         throw std::runtime_error("Unable to load the file " + filepath.str());
@@ -3,10 +3,12 @@
 #include <iostream>
 #include "glimac/common.hpp"
 #include "glimac/Sphere.hpp"
+#include "glimac/Profiler.hpp"
 
 namespace glimac {
 
 void Sphere::build(GLfloat r, GLsizei discLat, GLsizei discLong) {
+    GLIMAC_PROFILE_ZONE("build sphere");
     // Equation paramétrique en (r, phi, theta) de la sphère 
     // avec r >= 0, -PI / 2 <= theta <= PI / 2, 0 <= phi <= 2PI
     //
@@ -0,0 +1,136 @@
+#include "glimac/StreamBuffer.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace glimac {
+
+namespace {
+
+// Never-signaled fences time out after a second: a lost context must not hang the application
+const GLuint64 FENCE_TIMEOUT = 1000000000;
+
+}
+
+StreamBuffer::StreamBuffer(size_t regionSize, const char* label, GLSourceLocation where):
+    m_Buffer(GLMemoryCategory::STREAMING, label, where), m_nRegionSize(regionSize) {
+    GLsizeiptr size = GLsizeiptr(m_nRegionSize * REGIONS);
+    if(isPersistent()) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        m_Buffer.setStorage(size, nullptr, flags, where);
+        m_pData = static_cast<unsigned char*>(m_Buffer.map(0, size, flags, where));
+    }
+    if(!m_pData) {
+        m_Buffer.setData(size, nullptr, GL_STREAM_DRAW, where);
+        m_pCopy.reset(new unsigned char[size]);
+        m_pData = m_pCopy.get();
+    }
+}
+
+StreamBuffer::StreamBuffer(StreamBuffer&& rvalue):
+    m_Buffer(std::move(rvalue.m_Buffer)), m_nRegionSize(rvalue.m_nRegionSize),
+    m_pData(rvalue.m_pData), m_pCopy(std::move(rvalue.m_pCopy)), m_nRegion(rvalue.m_nRegion),
+    m_nOffset(rvalue.m_nOffset), m_nFrameBytes(rvalue.m_nFrameBytes),
+    m_bFrameOverflowed(rvalue.m_bFrameOverflowed), m_Stats(rvalue.m_Stats) {
+    std::copy(rvalue.m_Fences, rvalue.m_Fences + REGIONS, m_Fences);
+    std::fill(rvalue.m_Fences, rvalue.m_Fences + REGIONS, nullptr);
+    rvalue.m_pData = nullptr;
+}
+
+StreamBuffer& StreamBuffer::operator =(StreamBuffer&& rvalue) {
+    if(this != &rvalue) {
+        release();
+        m_Buffer = std::move(rvalue.m_Buffer);
+        m_nRegionSize = rvalue.m_nRegionSize;
+        m_pData = rvalue.m_pData;
+        m_pCopy = std::move(rvalue.m_pCopy);
+        std::copy(rvalue.m_Fences, rvalue.m_Fences + REGIONS, m_Fences);
+        std::fill(rvalue.m_Fences, rvalue.m_Fences + REGIONS, nullptr);
+        m_nRegion = rvalue.m_nRegion;
+        m_nOffset = rvalue.m_nOffset;
+        m_nFrameBytes = rvalue.m_nFrameBytes;
+        m_bFrameOverflowed = rvalue.m_bFrameOverflowed;
+        m_Stats = rvalue.m_Stats;
+        rvalue.m_pData = nullptr;
+    }
+    return *this;
+}
+
+void StreamBuffer::release() {
+    for(GLsync& fence: m_Fences) {
+        if(fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    // Deleting the buffer unmaps it
+    m_Buffer = Buffer();
+    m_pCopy.reset();
+    m_pData = nullptr;
+}
+
+void StreamBuffer::beginFrame() {
+    nextRegion();
+    m_nFrameBytes = 0;
+    m_bFrameOverflowed = false;
+}
+
+void StreamBuffer::endFrame() {
+    fenceRegion();
+    m_Stats.m_nPeakBytes = std::max(m_Stats.m_nPeakBytes, m_nFrameBytes);
+}
+
+void* StreamBuffer::allocate(size_t size, size_t alignment, GLintptr& offset) {
+    if(size > m_nRegionSize) {
+        return nullptr;
+    }
+    size_t aligned = (m_nOffset + alignment - 1) & ~(alignment - 1);
+    if(aligned + size > m_nRegionSize) {
+        // The draws already issued keep reading this region: fence it and carry on in the next one
+        if(!m_bFrameOverflowed) {
+            m_bFrameOverflowed = true;
+            ++m_Stats.m_nOverflows;
+        }
+        m_nFrameBytes += m_nRegionSize - m_nOffset;
+        fenceRegion();
+        nextRegion();
+        aligned = 0;
+    }
+    m_nFrameBytes += aligned + size - m_nOffset;
+    m_nOffset = aligned + size;
+    offset = GLintptr(m_nRegion * m_nRegionSize + aligned);
+    return m_pData + offset;
+}
+
+void StreamBuffer::commit(GLintptr offset, size_t size, GLSourceLocation where) {
+    if(!m_pCopy) {
+        // Coherent mapping: nothing to flush, only counted and captured
+        GL::mappedWrite(m_Buffer.getGLId(), offset, GLsizeiptr(size), m_pData + offset, where);
+        return;
+    }
+    m_Buffer.setSubData(offset, GLsizeiptr(size), m_pData + offset, where);
+}
+
+void StreamBuffer::fenceRegion() {
+    if(m_nOffset > 0 && !m_Fences[m_nRegion]) {
+        m_Fences[m_nRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+void StreamBuffer::nextRegion() {
+    m_nRegion = (m_nRegion + 1) % REGIONS;
+    m_nOffset = 0;
+    GLsync& fence = m_Fences[m_nRegion];
+    if(!fence) {
+        return;
+    }
+    if(glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        auto start = std::chrono::steady_clock::now();
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+        ++m_Stats.m_nWaits;
+        m_Stats.m_fWaitTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+}
@@ -0,0 +1,71 @@
+#include "glimac/VertexFormat.hpp"
+
+namespace glimac {
+
+void VertexFormat::apply() const {
+    for(size_t i = 0; i < m_nAttributeCount; ++i) {
+        const VertexAttribute& attribute = m_Attributes[i];
+        GL::enableVertexAttribArray(attribute.m_nLocation);
+        GL::vertexAttribFormat(attribute.m_nLocation, attribute.m_nSize, attribute.m_Type, attribute.m_bNormalized, attribute.m_nOffset);
+        GL::vertexAttribBinding(attribute.m_nLocation, attribute.m_nBinding);
+    }
+    for(size_t binding = 0; binding < m_nBufferCount; ++binding) {
+        GL::vertexBindingDivisor(GLuint(binding), m_Buffers[binding].m_nDivisor);
+    }
+}
+
+void VertexFormat::apply(const GLuint buffers[]) const {
+    for(size_t i = 0; i < m_nAttributeCount; ++i) {
+        const VertexAttribute& attribute = m_Attributes[i];
+        const VertexBufferBinding& binding = m_Buffers[attribute.m_nBinding];
+        GL::bindBuffer(GL_ARRAY_BUFFER, buffers[attribute.m_nBinding]);
+        GL::enableVertexAttribArray(attribute.m_nLocation);
+        GL::vertexAttribPointer(attribute.m_nLocation, attribute.m_nSize, attribute.m_Type, attribute.m_bNormalized, binding.m_nStride,
+                                (const GLvoid*)uintptr_t(attribute.m_nOffset));
+        if(binding.m_nDivisor) {
+            GL::vertexAttribDivisor(attribute.m_nLocation, binding.m_nDivisor);
+        }
+    }
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool VertexFormat::operator ==(const VertexFormat& other) const {
+    if(m_nAttributeCount != other.m_nAttributeCount || m_nBufferCount != other.m_nBufferCount) {
+        return false;
+    }
+    for(size_t i = 0; i < m_nAttributeCount; ++i) {
+        const VertexAttribute& a = m_Attributes[i];
+        const VertexAttribute& b = other.m_Attributes[i];
+        if(a.m_nLocation != b.m_nLocation || a.m_nBinding != b.m_nBinding || a.m_nSize != b.m_nSize || a.m_Type != b.m_Type
+           || a.m_bNormalized != b.m_bNormalized || a.m_nOffset != b.m_nOffset) {
+            return false;
+        }
+    }
+    for(size_t i = 0; i < m_nBufferCount; ++i) {
+        if(m_Buffers[i].m_nStride != other.m_Buffers[i].m_nStride || m_Buffers[i].m_nDivisor != other.m_Buffers[i].m_nDivisor) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isVertexAttribBindingSupported() {
+    return GLAD_GL_VERSION_4_3;
+}
+
+const VertexArray& VertexArrayCache::get(const VertexFormat& format, const char* label) {
+    for(const auto& entry: m_Entries) {
+        if(entry->m_Format == format) {
+            return entry->m_VertexArray;
+        }
+    }
+
+    m_Entries.emplace_back(new Entry{format, VertexArray(label)});
+    const VertexArray& vertexArray = m_Entries.back()->m_VertexArray;
+    vertexArray.bind();
+    format.apply();
+    GL::bindVertexArray(0);
+    return vertexArray;
+}
+
+}
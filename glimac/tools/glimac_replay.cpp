@@ -0,0 +1,1003 @@
+// Replays a GL trace recorded by GLCapture (glimac/GLCapture.hpp) in a headless context, without the application.
+//
+// The snapshot at the start of the trace recreates the programs, buffers, textures and vertex arrays, then
+// the captured frames are replayed --repeat times. Every call of a frame is surrounded by GL timestamp queries:
+// the report gives the GPU and CPU time of each frame, the most expensive calls with the source location that
+// issued them, and the totals per GL function. --csv writes every call, --png the last replayed frame.
+
+#include <glimac/GLCapture.hpp>
+#include <glimac/GLObjects.hpp>
+#include <glimac/HeadlessContext.hpp>
+#include <src/stb_image.h>
+#include <third-party/glfw/deps/stb_image_write.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace glimac;
+
+namespace {
+
+struct Options {
+    std::string m_sTrace;
+    unsigned int m_nRepeat = 10;
+    unsigned int m_nTop = 15;
+    std::string m_sCSV;
+    std::string m_sPNG;
+};
+
+struct Call {
+    GLOp m_Op;
+    uint32_t m_nLocation;
+    const unsigned char* m_pPayload;
+    uint32_t m_nSize;
+};
+
+// Time of one call of a frame, over the repetitions
+struct CallTiming {
+    double m_fGPUTotal = 0.; // Nanoseconds
+    double m_fGPUMin = 0.;
+    double m_fCPUTotal = 0.;
+};
+
+struct Trace {
+    GLTraceHeader m_Header;
+    std::vector<unsigned char> m_Bytes;
+    std::vector<Call> m_Snapshot;
+    std::vector<std::vector<Call>> m_Frames;
+    std::map<uint32_t, std::string> m_Locations; // 0 is the snapshot
+};
+
+double now() {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool loadTrace(const std::string& path, Trace& trace) {
+    std::ifstream file(path, std::ios::binary);
+    if(!file) {
+        std::cerr << "Unable to open " << path << std::endl;
+        return false;
+    }
+    trace.m_Bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if(trace.m_Bytes.size() < sizeof(GLTraceHeader)) {
+        std::cerr << path << " is not a GL trace" << std::endl;
+        return false;
+    }
+    std::memcpy(&trace.m_Header, trace.m_Bytes.data(), sizeof(GLTraceHeader));
+    if(std::memcmp(trace.m_Header.m_Magic, GL_TRACE_MAGIC, sizeof(GL_TRACE_MAGIC)) || trace.m_Header.m_nVersion != GL_TRACE_VERSION) {
+        std::cerr << path << " is not a GL trace of version " << GL_TRACE_VERSION << std::endl;
+        return false;
+    }
+
+    trace.m_Locations[0] = "snapshot";
+    bool snapshot = true;
+    std::vector<Call> frame;
+    size_t offset = sizeof(GLTraceHeader);
+    while(offset + 3 * sizeof(uint32_t) <= trace.m_Bytes.size()) {
+        uint32_t header[3];
+        std::memcpy(header, &trace.m_Bytes[offset], sizeof(header));
+        offset += sizeof(header);
+        if(offset + header[2] > trace.m_Bytes.size()) {
+            break;
+        }
+        const Call call = {GLOp(header[0]), header[1], &trace.m_Bytes[offset], header[2]};
+        offset += header[2];
+
+        if(call.m_Op == GLOp::SOURCE_LOCATION) {
+            uint32_t id, length;
+            std::memcpy(&id, call.m_pPayload, sizeof(id));
+            std::memcpy(&length, call.m_pPayload + sizeof(id), sizeof(length));
+            trace.m_Locations[id].assign(reinterpret_cast<const char*>(call.m_pPayload) + 2 * sizeof(uint32_t), length);
+        } else if(call.m_Op == GLOp::SNAPSHOT_END) {
+            snapshot = false;
+        } else if(call.m_Op == GLOp::FRAME_END) {
+            trace.m_Frames.push_back(std::move(frame));
+            frame.clear();
+        } else if(snapshot) {
+            trace.m_Snapshot.push_back(call);
+        } else {
+            frame.push_back(call);
+        }
+    }
+    if(snapshot || trace.m_Frames.empty()) {
+        std::cerr << path << " is truncated: no complete frame" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Reads the payload of a call in the order it was written
+class Reader {
+public:
+    explicit Reader(const Call& call): m_pData(call.m_pPayload), m_pEnd(call.m_pPayload + call.m_nSize) {
+    }
+
+    template<typename T>
+    T read() {
+        T value{};
+        if(m_pData + sizeof(T) <= m_pEnd) {
+            std::memcpy(&value, m_pData, sizeof(T));
+        }
+        m_pData += sizeof(T);
+        return value;
+    }
+
+    std::string string() {
+        const auto length = read<uint32_t>();
+        std::string text(reinterpret_cast<const char*>(m_pData), std::min<size_t>(length, m_pEnd - m_pData));
+        m_pData += length;
+        return text;
+    }
+
+    // Data block, decompressed; nullptr if the application gave no data
+    const void* data() {
+        const auto compressed = read<uint8_t>();
+        const auto size = read<uint64_t>();
+        const auto stored = read<uint64_t>();
+        const unsigned char* bytes = m_pData;
+        m_pData += stored;
+        if(!compressed) {
+            return stored ? bytes : nullptr;
+        }
+
+        int decodedSize = 0;
+        char* decoded = stbi_zlib_decode_malloc_guesssize_headerflag(reinterpret_cast<const char*>(bytes), int(stored), int(size),
+                                                                     &decodedSize, 1);
+        m_Decoded.assign(decoded, decoded + (decoded ? decodedSize : 0));
+        std::free(decoded);
+        m_Decoded.resize(size);
+        return m_Decoded.data();
+    }
+
+private:
+    const unsigned char* m_pData;
+    const unsigned char* m_pEnd;
+    std::vector<unsigned char> m_Decoded;
+};
+
+const void* toPointer(uint64_t offset) {
+    return reinterpret_cast<const void*>(uintptr_t(offset));
+}
+
+// Issues the captured calls with the replay's own object names
+class Replayer {
+public:
+    // 'defaultFramebuffer' stands for every framebuffer the application did not create through GL::
+    explicit Replayer(GLuint defaultFramebuffer): m_nDefaultFramebuffer(defaultFramebuffer) {
+    }
+
+    void execute(const Call& call) {
+        Reader in(call);
+        switch(call.m_Op) {
+        case GLOp::CREATE_PROGRAM:
+            createProgram(in);
+            break;
+        case GLOp::UNIFORM_LOCATION: {
+            const auto program = in.read<GLuint>();
+            const auto location = in.read<GLint>();
+            const auto name = in.string();
+            m_UniformLocations[std::make_pair(program, location)] = glGetUniformLocation(m_Programs[program], name.c_str());
+            break;
+        }
+        case GLOp::SET_UNIFORM:
+            setUniform(in);
+            break;
+        case GLOp::DISABLE_VERTEX_ATTRIB_ARRAY:
+            glDisableVertexAttribArray(in.read<GLuint>());
+            break;
+        case GLOp::VERTEX_ATTRIB_I_POINTER: {
+            const auto index = in.read<GLuint>();
+            const auto size = in.read<GLint>();
+            const auto type = in.read<GLenum>();
+            const auto stride = in.read<GLsizei>();
+            glVertexAttribIPointer(index, size, type, stride, toPointer(in.read<uint64_t>()));
+            break;
+        }
+        case GLOp::USE_PROGRAM:
+            m_nCurrentProgram = in.read<GLuint>();
+            glUseProgram(m_Programs[m_nCurrentProgram]);
+            break;
+        case GLOp::BIND_VERTEX_ARRAY:
+            glBindVertexArray(m_VertexArrays[in.read<GLuint>()]);
+            break;
+        case GLOp::BIND_BUFFER: {
+            const auto target = in.read<GLenum>();
+            glBindBuffer(target, m_Buffers[in.read<GLuint>()]);
+            break;
+        }
+        case GLOp::BIND_TEXTURE: {
+            const auto target = in.read<GLenum>();
+            glBindTexture(target, m_Textures[in.read<GLuint>()]);
+            break;
+        }
+        case GLOp::ACTIVE_TEXTURE:
+            glActiveTexture(in.read<GLenum>());
+            break;
+        case GLOp::UNIFORM_1I: {
+            const auto location = getUniformLocation(in.read<GLint>());
+            glUniform1i(location, in.read<GLint>());
+            break;
+        }
+        case GLOp::UNIFORM_1F: {
+            const auto location = getUniformLocation(in.read<GLint>());
+            glUniform1f(location, in.read<GLfloat>());
+            break;
+        }
+        case GLOp::UNIFORM_3FV: {
+            const auto location = getUniformLocation(in.read<GLint>());
+            const auto count = in.read<GLsizei>();
+            glUniform3fv(location, count, static_cast<const GLfloat*>(in.data()));
+            break;
+        }
+        case GLOp::UNIFORM_MATRIX_4FV: {
+            const auto location = getUniformLocation(in.read<GLint>());
+            const auto count = in.read<GLsizei>();
+            const auto transpose = in.read<GLboolean>();
+            glUniformMatrix4fv(location, count, transpose, static_cast<const GLfloat*>(in.data()));
+            break;
+        }
+        case GLOp::GEN_BUFFERS:
+            generate(in, m_Buffers, glGenBuffers);
+            break;
+        case GLOp::DELETE_BUFFERS:
+            release(in, m_Buffers, glDeleteBuffers);
+            break;
+        case GLOp::BUFFER_DATA: {
+            const auto target = in.read<GLenum>();
+            const auto size = in.read<int64_t>();
+            const auto usage = in.read<GLenum>();
+            glBufferData(target, size, in.data(), usage);
+            break;
+        }
+        case GLOp::BUFFER_SUB_DATA: {
+            const auto target = in.read<GLenum>();
+            const auto offset = in.read<int64_t>();
+            const auto size = in.read<int64_t>();
+            glBufferSubData(target, offset, size, in.data());
+            break;
+        }
+        case GLOp::GEN_VERTEX_ARRAYS:
+            generate(in, m_VertexArrays, glGenVertexArrays);
+            break;
+        case GLOp::DELETE_VERTEX_ARRAYS:
+            release(in, m_VertexArrays, glDeleteVertexArrays);
+            break;
+        case GLOp::ENABLE_VERTEX_ATTRIB_ARRAY:
+            glEnableVertexAttribArray(in.read<GLuint>());
+            break;
+        case GLOp::VERTEX_ATTRIB_POINTER: {
+            const auto index = in.read<GLuint>();
+            const auto size = in.read<GLint>();
+            const auto type = in.read<GLenum>();
+            const auto normalized = in.read<uint8_t>();
+            const auto stride = in.read<GLsizei>();
+            glVertexAttribPointer(index, size, type, normalized, stride, toPointer(in.read<uint64_t>()));
+            break;
+        }
+        case GLOp::VERTEX_ATTRIB_DIVISOR: {
+            const auto index = in.read<GLuint>();
+            glVertexAttribDivisor(index, in.read<GLuint>());
+            break;
+        }
+        case GLOp::VERTEX_ATTRIB_4FV: {
+            const auto index = in.read<GLuint>();
+            glVertexAttrib4fv(index, static_cast<const GLfloat*>(in.data()));
+            break;
+        }
+        case GLOp::GEN_TEXTURES:
+            generate(in, m_Textures, glGenTextures);
+            break;
+        case GLOp::DELETE_TEXTURES:
+            release(in, m_Textures, glDeleteTextures);
+            break;
+        case GLOp::TEX_IMAGE_2D: {
+            const auto target = in.read<GLenum>();
+            const auto level = in.read<GLint>();
+            const auto internalFormat = in.read<GLint>();
+            const auto width = in.read<GLsizei>();
+            const auto height = in.read<GLsizei>();
+            const auto border = in.read<GLint>();
+            const auto format = in.read<GLenum>();
+            const auto type = in.read<GLenum>();
+            glTexImage2D(target, level, internalFormat, width, height, border, format, type, in.data());
+            break;
+        }
+        case GLOp::TEX_PARAMETERI: {
+            const auto target = in.read<GLenum>();
+            const auto name = in.read<GLenum>();
+            glTexParameteri(target, name, in.read<GLint>());
+            break;
+        }
+        case GLOp::GEN_FRAMEBUFFERS:
+            generate(in, m_Framebuffers, glGenFramebuffers);
+            break;
+        case GLOp::DELETE_FRAMEBUFFERS:
+            release(in, m_Framebuffers, glDeleteFramebuffers);
+            break;
+        case GLOp::BIND_FRAMEBUFFER: {
+            const auto target = in.read<GLenum>();
+            auto it = m_Framebuffers.find(in.read<GLuint>());
+            glBindFramebuffer(target, it != m_Framebuffers.end() ? it->second : m_nDefaultFramebuffer);
+            break;
+        }
+        case GLOp::FRAMEBUFFER_TEXTURE_2D: {
+            const auto target = in.read<GLenum>();
+            const auto attachment = in.read<GLenum>();
+            const auto textureTarget = in.read<GLenum>();
+            const auto texture = in.read<GLuint>();
+            glFramebufferTexture2D(target, attachment, textureTarget, m_Textures[texture], in.read<GLint>());
+            break;
+        }
+        case GLOp::ENABLE:
+            glEnable(in.read<GLenum>());
+            break;
+        case GLOp::DISABLE:
+            glDisable(in.read<GLenum>());
+            break;
+        case GLOp::BLEND_FUNC: {
+            const auto sfactor = in.read<GLenum>();
+            glBlendFunc(sfactor, in.read<GLenum>());
+            break;
+        }
+        case GLOp::DEPTH_FUNC:
+            glDepthFunc(in.read<GLenum>());
+            break;
+        case GLOp::POLYGON_MODE: {
+            const auto face = in.read<GLenum>();
+            glPolygonMode(face, in.read<GLenum>());
+            break;
+        }
+        case GLOp::VIEWPORT: {
+            const auto x = in.read<GLint>();
+            const auto y = in.read<GLint>();
+            const auto width = in.read<GLsizei>();
+            glViewport(x, y, width, in.read<GLsizei>());
+            break;
+        }
+        case GLOp::CLEAR_COLOR: {
+            const auto red = in.read<GLfloat>();
+            const auto green = in.read<GLfloat>();
+            const auto blue = in.read<GLfloat>();
+            glClearColor(red, green, blue, in.read<GLfloat>());
+            break;
+        }
+        case GLOp::CLEAR:
+            glClear(in.read<GLbitfield>());
+            break;
+        case GLOp::DRAW_ARRAYS: {
+            const auto mode = in.read<GLenum>();
+            const auto first = in.read<GLint>();
+            glDrawArrays(mode, first, in.read<GLsizei>());
+            break;
+        }
+        case GLOp::DRAW_ELEMENTS: {
+            const auto mode = in.read<GLenum>();
+            const auto count = in.read<GLsizei>();
+            const auto type = in.read<GLenum>();
+            glDrawElements(mode, count, type, toPointer(in.read<uint64_t>()));
+            break;
+        }
+        case GLOp::DRAW_ARRAYS_INSTANCED_BASE_INSTANCE: {
+            const auto mode = in.read<GLenum>();
+            const auto first = in.read<GLint>();
+            const auto count = in.read<GLsizei>();
+            const auto instanceCount = in.read<GLsizei>();
+            glDrawArraysInstancedBaseInstance(mode, first, count, instanceCount, in.read<GLuint>());
+            break;
+        }
+        case GLOp::MULTI_DRAW_ARRAYS_INDIRECT: {
+            const auto mode = in.read<GLenum>();
+            const auto indirect = toPointer(in.read<uint64_t>());
+            const auto drawCount = in.read<GLsizei>();
+            glMultiDrawArraysIndirect(mode, indirect, drawCount, in.read<GLsizei>());
+            break;
+        }
+        case GLOp::BIND_BUFFER_RANGE: {
+            const auto target = in.read<GLenum>();
+            const auto index = in.read<GLuint>();
+            const auto buffer = m_Buffers[in.read<GLuint>()];
+            const auto offset = in.read<int64_t>();
+            glBindBufferRange(target, index, buffer, offset, in.read<int64_t>());
+            break;
+        }
+        case GLOp::UNIFORM_BLOCK_BINDING: {
+            const GLuint program = m_Programs[in.read<GLuint>()];
+            const auto binding = in.read<GLuint>();
+            const GLuint block = glGetUniformBlockIndex(program, in.string().c_str());
+            if(block != GL_INVALID_INDEX) {
+                glUniformBlockBinding(program, block, binding);
+            }
+            break;
+        }
+        case GLOp::BIND_BUFFER_BASE: {
+            const auto target = in.read<GLenum>();
+            const auto index = in.read<GLuint>();
+            glBindBufferBase(target, index, m_Buffers[in.read<GLuint>()]);
+            break;
+        }
+        case GLOp::BLIT_FRAMEBUFFER: {
+            GLint rectangles[8];
+            for(GLint& coordinate: rectangles) {
+                coordinate = in.read<GLint>();
+            }
+            const auto mask = in.read<GLbitfield>();
+            glBlitFramebuffer(rectangles[0], rectangles[1], rectangles[2], rectangles[3],
+                              rectangles[4], rectangles[5], rectangles[6], rectangles[7], mask, in.read<GLenum>());
+            break;
+        }
+        case GLOp::DISPATCH_COMPUTE: {
+            const auto groupsX = in.read<GLuint>();
+            const auto groupsY = in.read<GLuint>();
+            glDispatchCompute(groupsX, groupsY, in.read<GLuint>());
+            break;
+        }
+        case GLOp::MEMORY_BARRIER:
+            glMemoryBarrier(in.read<GLbitfield>());
+            break;
+        case GLOp::BIND_IMAGE_TEXTURE: {
+            const auto unit = in.read<GLuint>();
+            const auto texture = m_Textures[in.read<GLuint>()];
+            const auto level = in.read<GLint>();
+            const auto layered = in.read<uint8_t>();
+            const auto layer = in.read<GLint>();
+            const auto access = in.read<GLenum>();
+            glBindImageTexture(unit, texture, level, layered, layer, access, in.read<GLenum>());
+            break;
+        }
+        case GLOp::VERTEX_ATTRIB_FORMAT: {
+            const auto index = in.read<GLuint>();
+            const auto size = in.read<GLint>();
+            const auto type = in.read<GLenum>();
+            const auto normalized = in.read<uint8_t>();
+            glVertexAttribFormat(index, size, type, normalized, in.read<GLuint>());
+            break;
+        }
+        case GLOp::VERTEX_ATTRIB_I_FORMAT: {
+            const auto index = in.read<GLuint>();
+            const auto size = in.read<GLint>();
+            const auto type = in.read<GLenum>();
+            glVertexAttribIFormat(index, size, type, in.read<GLuint>());
+            break;
+        }
+        case GLOp::VERTEX_ATTRIB_BINDING: {
+            const auto index = in.read<GLuint>();
+            glVertexAttribBinding(index, in.read<GLuint>());
+            break;
+        }
+        case GLOp::VERTEX_BINDING_DIVISOR: {
+            const auto binding = in.read<GLuint>();
+            glVertexBindingDivisor(binding, in.read<GLuint>());
+            break;
+        }
+        case GLOp::BIND_VERTEX_BUFFER: {
+            const auto binding = in.read<GLuint>();
+            const auto buffer = m_Buffers[in.read<GLuint>()];
+            const auto offset = in.read<int64_t>();
+            glBindVertexBuffer(binding, buffer, GLintptr(offset), in.read<GLsizei>());
+            break;
+        }
+        case GLOp::TEX_SUB_IMAGE_2D: {
+            const auto target = in.read<GLenum>();
+            const auto level = in.read<GLint>();
+            const auto x = in.read<GLint>();
+            const auto y = in.read<GLint>();
+            const auto width = in.read<GLsizei>();
+            const auto height = in.read<GLsizei>();
+            const auto format = in.read<GLenum>();
+            const auto type = in.read<GLenum>();
+            glTexSubImage2D(target, level, x, y, width, height, format, type, in.data());
+            break;
+        }
+        case GLOp::CREATE_BUFFERS:
+            if(hasDirectStateAccess()) {
+                generate(in, m_Buffers, glCreateBuffers);
+            }
+            break;
+        case GLOp::NAMED_BUFFER_DATA: {
+            const auto buffer = m_Buffers[in.read<GLuint>()];
+            const auto size = in.read<int64_t>();
+            const auto usage = in.read<GLenum>();
+            if(hasDirectStateAccess()) {
+                glNamedBufferData(buffer, size, in.data(), usage);
+            }
+            break;
+        }
+        case GLOp::NAMED_BUFFER_SUB_DATA: {
+            const auto buffer = m_Buffers[in.read<GLuint>()];
+            const auto offset = in.read<int64_t>();
+            const auto size = in.read<int64_t>();
+            if(hasDirectStateAccess()) {
+                glNamedBufferSubData(buffer, offset, size, in.data());
+            }
+            break;
+        }
+        case GLOp::CREATE_TEXTURES: {
+            const auto target = in.read<GLenum>();
+            if(hasDirectStateAccess()) {
+                generate(in, m_Textures, [target](GLsizei n, GLuint* textures) { glCreateTextures(target, n, textures); });
+            }
+            break;
+        }
+        case GLOp::TEXTURE_STORAGE_2D: {
+            const auto texture = m_Textures[in.read<GLuint>()];
+            const auto levels = in.read<GLsizei>();
+            const auto internalFormat = in.read<GLenum>();
+            const auto width = in.read<GLsizei>();
+            const auto height = in.read<GLsizei>();
+            if(hasDirectStateAccess()) {
+                glTextureStorage2D(texture, levels, internalFormat, width, height);
+            }
+            break;
+        }
+        case GLOp::TEXTURE_SUB_IMAGE_2D: {
+            const auto texture = m_Textures[in.read<GLuint>()];
+            const auto level = in.read<GLint>();
+            const auto x = in.read<GLint>();
+            const auto y = in.read<GLint>();
+            const auto width = in.read<GLsizei>();
+            const auto height = in.read<GLsizei>();
+            const auto format = in.read<GLenum>();
+            const auto type = in.read<GLenum>();
+            if(hasDirectStateAccess()) {
+                glTextureSubImage2D(texture, level, x, y, width, height, format, type, in.data());
+            }
+            break;
+        }
+        case GLOp::TEXTURE_SUB_IMAGE_3D: {
+            const auto texture = m_Textures[in.read<GLuint>()];
+            const auto level = in.read<GLint>();
+            const auto x = in.read<GLint>();
+            const auto y = in.read<GLint>();
+            const auto z = in.read<GLint>();
+            const auto width = in.read<GLsizei>();
+            const auto height = in.read<GLsizei>();
+            const auto depth = in.read<GLsizei>();
+            const auto format = in.read<GLenum>();
+            const auto type = in.read<GLenum>();
+            if(hasDirectStateAccess()) {
+                glTextureSubImage3D(texture, level, x, y, z, width, height, depth, format, type, in.data());
+            }
+            break;
+        }
+        case GLOp::TEXTURE_PARAMETERI: {
+            const auto texture = m_Textures[in.read<GLuint>()];
+            const auto name = in.read<GLenum>();
+            const auto param = in.read<GLint>();
+            if(hasDirectStateAccess()) {
+                glTextureParameteri(texture, name, param);
+            }
+            break;
+        }
+        case GLOp::TEX_IMAGE_3D: {
+            const auto target = in.read<GLenum>();
+            const auto level = in.read<GLint>();
+            const auto internalFormat = in.read<GLint>();
+            const auto width = in.read<GLsizei>();
+            const auto height = in.read<GLsizei>();
+            const auto depth = in.read<GLsizei>();
+            const auto border = in.read<GLint>();
+            const auto format = in.read<GLenum>();
+            const auto type = in.read<GLenum>();
+            glTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, in.data());
+            break;
+        }
+        case GLOp::TEX_SUB_IMAGE_3D: {
+            const auto target = in.read<GLenum>();
+            const auto level = in.read<GLint>();
+            const auto x = in.read<GLint>();
+            const auto y = in.read<GLint>();
+            const auto z = in.read<GLint>();
+            const auto width = in.read<GLsizei>();
+            const auto height = in.read<GLsizei>();
+            const auto depth = in.read<GLsizei>();
+            const auto format = in.read<GLenum>();
+            const auto type = in.read<GLenum>();
+            glTexSubImage3D(target, level, x, y, z, width, height, depth, format, type, in.data());
+            break;
+        }
+        case GLOp::GENERATE_MIPMAP:
+            glGenerateMipmap(in.read<GLenum>());
+            break;
+        case GLOp::TEXTURE_STORAGE_3D: {
+            const auto texture = m_Textures[in.read<GLuint>()];
+            const auto levels = in.read<GLsizei>();
+            const auto internalFormat = in.read<GLenum>();
+            const auto width = in.read<GLsizei>();
+            const auto height = in.read<GLsizei>();
+            const auto depth = in.read<GLsizei>();
+            if(hasDirectStateAccess()) {
+                glTextureStorage3D(texture, levels, internalFormat, width, height, depth);
+            }
+            break;
+        }
+        case GLOp::GENERATE_TEXTURE_MIPMAP: {
+            const auto texture = m_Textures[in.read<GLuint>()];
+            if(hasDirectStateAccess()) {
+                glGenerateTextureMipmap(texture);
+            }
+            break;
+        }
+        case GLOp::MULTI_DRAW_ELEMENTS_INDIRECT: {
+            const auto mode = in.read<GLenum>();
+            const auto type = in.read<GLenum>();
+            const auto indirect = toPointer(in.read<uint64_t>());
+            const auto drawCount = in.read<GLsizei>();
+            glMultiDrawElementsIndirect(mode, type, indirect, drawCount, in.read<GLsizei>());
+            break;
+        }
+        default:
+            std::cerr << "Unknown op " << uint32_t(call.m_Op) << " in the trace" << std::endl;
+            break;
+        }
+    }
+
+private:
+    void createProgram(Reader& in) {
+        const auto name = in.read<GLuint>();
+        const auto shaderCount = in.read<uint32_t>();
+        const GLuint program = glCreateProgram();
+        for(uint32_t i = 0; i < shaderCount; ++i) {
+            const auto type = in.read<uint32_t>();
+            const auto source = in.string();
+            const char* text = source.c_str();
+            const GLuint shader = glCreateShader(type);
+            glShaderSource(shader, 1, &text, nullptr);
+            glCompileShader(shader);
+            glAttachShader(program, shader);
+            glDeleteShader(shader);
+        }
+        glLinkProgram(program);
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if(!linked) {
+            char log[1024] = "";
+            glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+            std::cerr << "Program " << name << " does not link: " << log << std::endl;
+        }
+        m_Programs[name] = program;
+    }
+
+    // Value read back by the snapshot, set without binding the program
+    void setUniform(Reader& in) {
+        const auto name = in.read<GLuint>();
+        const auto location = in.read<GLint>();
+        const auto type = in.read<GLenum>();
+        const auto count = in.read<GLsizei>();
+        const GLuint program = m_Programs[name];
+        const GLint replayLocation = m_UniformLocations[std::make_pair(name, location)];
+        const auto floats = static_cast<const GLfloat*>(in.data());
+        const auto ints = reinterpret_cast<const GLint*>(floats);
+        switch(type) {
+        case GL_FLOAT:
+            glProgramUniform1fv(program, replayLocation, count, floats);
+            break;
+        case GL_FLOAT_VEC2:
+            glProgramUniform2fv(program, replayLocation, count, floats);
+            break;
+        case GL_FLOAT_VEC3:
+            glProgramUniform3fv(program, replayLocation, count, floats);
+            break;
+        case GL_FLOAT_VEC4:
+            glProgramUniform4fv(program, replayLocation, count, floats);
+            break;
+        case GL_FLOAT_MAT2:
+            glProgramUniformMatrix2fv(program, replayLocation, count, GL_FALSE, floats);
+            break;
+        case GL_FLOAT_MAT3:
+            glProgramUniformMatrix3fv(program, replayLocation, count, GL_FALSE, floats);
+            break;
+        case GL_FLOAT_MAT4:
+            glProgramUniformMatrix4fv(program, replayLocation, count, GL_FALSE, floats);
+            break;
+        case GL_INT_VEC2:
+        case GL_BOOL_VEC2:
+            glProgramUniform2iv(program, replayLocation, count, ints);
+            break;
+        case GL_INT_VEC3:
+        case GL_BOOL_VEC3:
+            glProgramUniform3iv(program, replayLocation, count, ints);
+            break;
+        case GL_INT_VEC4:
+        case GL_BOOL_VEC4:
+            glProgramUniform4iv(program, replayLocation, count, ints);
+            break;
+        default: // int, bool, samplers
+            glProgramUniform1iv(program, replayLocation, count, ints);
+            break;
+        }
+    }
+
+    GLint getUniformLocation(GLint location) {
+        auto it = m_UniformLocations.find(std::make_pair(m_nCurrentProgram, location));
+        return it != m_UniformLocations.end() ? it->second : -1;
+    }
+
+    template<typename Function>
+    void generate(Reader& in, std::map<GLuint, GLuint>& names, Function function) {
+        const auto n = in.read<GLsizei>();
+        std::vector<GLuint> created(n);
+        function(n, created.data());
+        for(GLsizei i = 0; i < n; ++i) {
+            names[in.read<GLuint>()] = created[i];
+        }
+    }
+
+    // The application created or edited objects by name: skipped, with a warning, in a context without it
+    bool hasDirectStateAccess() {
+        const bool supported = isDirectStateAccessSupported();
+        if(!supported && !m_bWarnedDirectStateAccess) {
+            std::cerr << "The trace uses direct state access (GL 4.5), not supported here: its calls are skipped" << std::endl;
+            m_bWarnedDirectStateAccess = true;
+        }
+        return supported;
+    }
+
+    template<typename Function>
+    void release(Reader& in, std::map<GLuint, GLuint>& names, Function function) {
+        const auto n = in.read<GLsizei>();
+        std::vector<GLuint> released;
+        for(GLsizei i = 0; i < n; ++i) {
+            auto it = names.find(in.read<GLuint>());
+            if(it != names.end()) {
+                released.push_back(it->second);
+                names.erase(it);
+            }
+        }
+        function(GLsizei(released.size()), released.data());
+    }
+
+    // Application name -> replay name, 0 maps to 0
+    std::map<GLuint, GLuint> m_Buffers = {{0, 0}};
+    std::map<GLuint, GLuint> m_VertexArrays = {{0, 0}};
+    std::map<GLuint, GLuint> m_Textures = {{0, 0}};
+    std::map<GLuint, GLuint> m_Programs = {{0, 0}};
+    std::map<GLuint, GLuint> m_Framebuffers; // Without 0: see m_nDefaultFramebuffer
+    std::map<std::pair<GLuint, GLint>, GLint> m_UniformLocations; // (application program, location)
+    GLuint m_nCurrentProgram = 0;
+    GLuint m_nDefaultFramebuffer;
+    bool m_bWarnedDirectStateAccess = false;
+};
+
+// Timestamps around every call of a frame: query i is written before call i, the last one after the frame
+class FrameTimer {
+public:
+    FrameTimer() {
+        GLint bits = 0;
+        glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+        m_bAvailable = bits > 0;
+    }
+
+    ~FrameTimer() {
+        if(!m_Queries.empty()) {
+            glDeleteQueries(GLsizei(m_Queries.size()), m_Queries.data());
+        }
+    }
+
+    bool isAvailable() const {
+        return m_bAvailable;
+    }
+
+    void reserve(size_t count) {
+        if(m_bAvailable && m_Queries.size() < count) {
+            const auto previous = m_Queries.size();
+            m_Queries.resize(count);
+            glGenQueries(GLsizei(count - previous), m_Queries.data() + previous);
+        }
+    }
+
+    void stamp(size_t index) {
+        if(m_bAvailable) {
+            glQueryCounter(m_Queries[index], GL_TIMESTAMP);
+        }
+    }
+
+    // Nanoseconds between the stamps i and i + 1, waits for the GPU
+    std::vector<double> getIntervals(size_t callCount) const {
+        std::vector<double> intervals(callCount, 0.);
+        if(!m_bAvailable) {
+            return intervals;
+        }
+        GLuint64 previous = 0;
+        glGetQueryObjectui64v(m_Queries[0], GL_QUERY_RESULT, &previous);
+        for(size_t i = 0; i < callCount; ++i) {
+            GLuint64 next = 0;
+            glGetQueryObjectui64v(m_Queries[i + 1], GL_QUERY_RESULT, &next);
+            intervals[i] = double(next - previous);
+            previous = next;
+        }
+        return intervals;
+    }
+
+private:
+    FrameTimer(const FrameTimer&);
+    FrameTimer& operator =(const FrameTimer&);
+
+    bool m_bAvailable = false;
+    std::vector<GLuint> m_Queries;
+};
+
+std::string formatMs(double nanoseconds) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(3) << nanoseconds / 1e6 << " ms";
+    return text.str();
+}
+
+bool isDraw(GLOp op) {
+    return op == GLOp::DRAW_ARRAYS || op == GLOp::DRAW_ELEMENTS || op == GLOp::DRAW_ARRAYS_INSTANCED_BASE_INSTANCE
+        || op == GLOp::MULTI_DRAW_ARRAYS_INDIRECT || op == GLOp::MULTI_DRAW_ELEMENTS_INDIRECT;
+}
+
+void writePNG(const std::string& path, int width, int height) {
+    std::vector<unsigned char> pixels(size_t(width) * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    for(size_t i = 3; i < pixels.size(); i += 4) {
+        pixels[i] = 255;
+    }
+    // Bottom-up rows in GL
+    if(!stbi_write_png(path.c_str(), width, height, 4, pixels.data() + size_t(width) * (height - 1) * 4, -width * 4)) {
+        std::cerr << "Unable to write " << path << std::endl;
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for(auto i = 1; i < argc; ++i) {
+        if(!std::strcmp(argv[i], "--repeat") && i + 1 < argc) {
+            options.m_nRepeat = std::atoi(argv[++i]);
+        } else if(!std::strcmp(argv[i], "--top") && i + 1 < argc) {
+            options.m_nTop = std::atoi(argv[++i]);
+        } else if(!std::strcmp(argv[i], "--csv") && i + 1 < argc) {
+            options.m_sCSV = argv[++i];
+        } else if(!std::strcmp(argv[i], "--png") && i + 1 < argc) {
+            options.m_sPNG = argv[++i];
+        } else if(argv[i][0] != '-' && options.m_sTrace.empty()) {
+            options.m_sTrace = argv[i];
+        } else {
+            options.m_sTrace.clear();
+            break;
+        }
+    }
+    if(options.m_sTrace.empty() || !options.m_nRepeat) {
+        std::cerr << "Usage: " << argv[0] << " TRACE [--repeat N] [--top N] [--csv FILE] [--png FILE]" << std::endl;
+        return -1;
+    }
+
+    Trace trace;
+    if(!loadTrace(options.m_sTrace, trace)) {
+        return -1;
+    }
+
+    HeadlessContext context;
+    if(!context.create(trace.m_Header.m_nWidth, trace.m_Header.m_nHeight)) {
+        std::cerr << "No headless OpenGL context available" << std::endl;
+        return -1;
+    }
+    std::cerr << options.m_sTrace << ": " << trace.m_Header.m_nWidth << "x" << trace.m_Header.m_nHeight << ", " << trace.m_Frames.size()
+              << " frames, " << trace.m_Snapshot.size() << " snapshot calls (" << context.getBackend() << ")" << std::endl;
+
+    // Snapshot data is tightly packed
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    Replayer replayer(context.getFramebuffer());
+    for(const auto& call: trace.m_Snapshot) {
+        replayer.execute(call);
+    }
+    glFinish();
+
+    FrameTimer timer;
+    if(!timer.isAvailable()) {
+        std::cerr << "No GL timestamp queries: CPU times only" << std::endl;
+    }
+
+    // Frames replayed one after the other, the whole sequence --repeat times
+    std::vector<std::vector<CallTiming>> timings(trace.m_Frames.size());
+    for(size_t frame = 0; frame < trace.m_Frames.size(); ++frame) {
+        timings[frame].resize(trace.m_Frames[frame].size());
+        timer.reserve(trace.m_Frames[frame].size() + 1);
+    }
+    for(unsigned int repeat = 0; repeat < options.m_nRepeat; ++repeat) {
+        for(size_t frame = 0; frame < trace.m_Frames.size(); ++frame) {
+            const auto& calls = trace.m_Frames[frame];
+            auto& frameTimings = timings[frame];
+            for(size_t i = 0; i < calls.size(); ++i) {
+                timer.stamp(i);
+                const double start = now();
+                replayer.execute(calls[i]);
+                frameTimings[i].m_fCPUTotal += now() - start;
+            }
+            timer.stamp(calls.size());
+
+            const auto intervals = timer.getIntervals(calls.size());
+            for(size_t i = 0; i < calls.size(); ++i) {
+                frameTimings[i].m_fGPUTotal += intervals[i];
+                frameTimings[i].m_fGPUMin = repeat ? std::min(frameTimings[i].m_fGPUMin, intervals[i]) : intervals[i];
+            }
+        }
+    }
+
+    if(GLenum error = glGetError()) {
+        std::cerr << "GL error 0x" << std::hex << error << std::dec << " during the replay" << std::endl;
+    }
+    if(!options.m_sPNG.empty()) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, context.getFramebuffer());
+        writePNG(options.m_sPNG, trace.m_Header.m_nWidth, trace.m_Header.m_nHeight);
+    }
+
+    // ---Report, averaged over the repetitions---
+    struct Ranked {
+        size_t m_nFrame;
+        size_t m_nCall;
+        double m_fGPU;
+    };
+    std::vector<Ranked> ranked;
+    std::map<GLOp, std::pair<unsigned int, double>> perOp; // Calls, GPU nanoseconds per frame sequence
+
+    std::cout << "frame   calls  draws       GPU         CPU" << std::endl;
+    for(size_t frame = 0; frame < trace.m_Frames.size(); ++frame) {
+        double gpu = 0., cpu = 0.;
+        unsigned int draws = 0;
+        for(size_t i = 0; i < trace.m_Frames[frame].size(); ++i) {
+            const auto& timing = timings[frame][i];
+            const GLOp op = trace.m_Frames[frame][i].m_Op;
+            gpu += timing.m_fGPUTotal / options.m_nRepeat;
+            cpu += timing.m_fCPUTotal / options.m_nRepeat;
+            draws += isDraw(op);
+            ranked.push_back({frame, i, timing.m_fGPUTotal / options.m_nRepeat});
+            perOp[op].first += 1;
+            perOp[op].second += timing.m_fGPUTotal / options.m_nRepeat;
+        }
+        std::cout << std::setw(5) << frame << std::setw(8) << trace.m_Frames[frame].size() << std::setw(7) << draws << std::setw(13)
+                  << formatMs(gpu) << std::setw(12) << formatMs(cpu) << std::endl;
+    }
+
+    const auto top = std::min<size_t>(options.m_nTop, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + top, ranked.end(),
+                      [](const Ranked& a, const Ranked& b) { return a.m_fGPU > b.m_fGPU; });
+    std::cout << std::endl << "Most expensive calls (GPU):" << std::endl;
+    for(size_t i = 0; i < top; ++i) {
+        const auto& call = trace.m_Frames[ranked[i].m_nFrame][ranked[i].m_nCall];
+        std::cout << std::setw(12) << formatMs(ranked[i].m_fGPU) << "  frame " << ranked[i].m_nFrame << " call " << std::setw(4)
+                  << ranked[i].m_nCall << "  " << std::left << std::setw(34) << getGLOpName(call.m_Op) << std::right
+                  << trace.m_Locations[call.m_nLocation] << std::endl;
+    }
+
+    std::vector<std::pair<GLOp, std::pair<unsigned int, double>>> ops(perOp.begin(), perOp.end());
+    std::sort(ops.begin(), ops.end(), [](const auto& a, const auto& b) { return a.second.second > b.second.second; });
+    std::cout << std::endl << "Per GL function (all frames):" << std::endl;
+    for(const auto& op: ops) {
+        std::cout << "  " << std::left << std::setw(36) << getGLOpName(op.first) << std::right << std::setw(7) << op.second.first
+                  << " calls" << std::setw(13) << formatMs(op.second.second) << std::endl;
+    }
+
+    if(!options.m_sCSV.empty()) {
+        std::ofstream csv(options.m_sCSV);
+        csv << "frame,call,function,location,gpu_ns,gpu_min_ns,cpu_ns" << std::endl;
+        for(size_t frame = 0; frame < trace.m_Frames.size(); ++frame) {
+            for(size_t i = 0; i < trace.m_Frames[frame].size(); ++i) {
+                const auto& call = trace.m_Frames[frame][i];
+                const auto& timing = timings[frame][i];
+                csv << frame << "," << i << "," << getGLOpName(call.m_Op) << "," << trace.m_Locations[call.m_nLocation] << ","
+                    << timing.m_fGPUTotal / options.m_nRepeat << "," << timing.m_fGPUMin << "," << timing.m_fCPUTotal / options.m_nRepeat
+                    << std::endl;
+            }
+        }
+        if(!csv) {
+            std::cerr << "Unable to write " << options.m_sCSV << std::endl;
+        }
+    }
+
+    return 0;
+}
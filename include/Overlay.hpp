@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <vector>
+#include <glimac/AllocationTracker.hpp>
+#include "Scene.hpp"
+
+struct nk_context;
+
+/*
+ * Overlay de mesure dessiné par dessus la scène avec Nuklear (glimac/Nuklear.hpp) : graphe des temps de frame
+ * avec leurs percentiles, temps GPU / CPU des passes, compteurs de la scène, des appels GL et des allocations du
+ * frame, mémoire GPU par catégorie (glimac/GLObjects.hpp), niveaux de détail, et réglages modifiables en direct
+ * (culling, instancing, vertex pulling, biais des niveaux de détail, vsync, vue de débogage).
+ * Le binding GLFW de Nuklear n'a qu'un état global : une seule instance, créée avec le contexte GL courant.
+ */
+class Overlay
+{
+public:
+    explicit Overlay(GLFWwindow *window);
+    ~Overlay();
+
+    void toggle()
+    {
+        visible = !visible;
+    }
+
+    bool isVisible() const
+    {
+        return visible;
+    }
+
+    // Durée du dernier frame en millisecondes, à donner à chaque frame, même quand l'overlay est caché
+    void addFrameTime(float ms);
+
+    // Allocations sur le tas du dernier frame (glimac/AllocationTracker.hpp)
+    void setFrameAllocations(const glimac::AllocationReport &report)
+    {
+        frameAllocations = report;
+    }
+
+    // Construit l'interface et la dessine dans le framebuffer courant, après la scène
+    void render(Scene &scene, bool &vsync);
+
+private:
+    Overlay(const Overlay &);
+    Overlay &operator=(const Overlay &);
+
+    void frameTimeSection();
+    void passesSection(Scene &scene);
+    void countersSection(const Scene &scene);
+    void settingsSection(Scene &scene, bool &vsync);
+
+    nk_context *context;
+    bool visible = false;
+
+    /* Derniers temps de frame, en anneau */
+    std::vector<float> frameTimes;
+    size_t frameCount = 0;
+    size_t nextFrame = 0;
+    std::vector<float> sortedFrameTimes; // Pour les percentiles, réutilisé d'un frame à l'autre
+
+    glimac::AllocationReport frameAllocations;
+};
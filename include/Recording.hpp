@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glimac/FreeflyCamera.hpp>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/* Evènement d'entrée GLFW, tel qu'il est reçu par les callbacks */
+struct InputEvent
+{
+    enum Type : uint8_t
+    {
+        KEY,
+        MOUSE_BUTTON,
+        CURSOR
+    };
+
+    Type type;
+    int16_t code;   // Touche ou bouton
+    uint8_t action; // GLFW_PRESS, GLFW_RELEASE ou GLFW_REPEAT
+    double x, y;    // Position du curseur
+};
+
+/* Pose de la caméra à la fin d'un frame, pour vérifier le rejeu */
+struct CameraPose
+{
+    glm::vec3 position;
+    float phi;
+    float theta;
+
+    static CameraPose fromCamera(const glimac::FreeflyCamera &camera);
+
+    bool operator==(const CameraPose &other) const;
+};
+
+/* Un frame enregistré : les évènements reçus avant son rendu et la pose qui en résulte */
+struct RecordedFrame
+{
+    float time; // Temps de l'animation lors de l'enregistrement
+    CameraPose pose;
+    std::vector<InputEvent> events;
+};
+
+/*
+ * Format binaire (little endian) : "DSDAREC" + version (1 octet), puis pour chaque frame
+ * temps (f32), pose (5 x f32), nombre d'évènements (u16) et les évènements :
+ * type (u8) puis touche (i16) + action (u8), bouton (u8) + action (u8) ou curseur (2 x f64).
+ */
+class InputRecorder
+{
+public:
+    bool open(const std::string &path);
+
+    bool isOpen() const
+    {
+        return file.is_open();
+    }
+
+    void addEvent(const InputEvent &event);
+
+    // A appeler avant le rendu de chaque frame, une fois les évènements appliqués
+    void endFrame(float time, const CameraPose &pose);
+
+    void close();
+
+private:
+    std::ofstream file;
+    std::vector<InputEvent> events;
+};
+
+/* Lecture d'un enregistrement, pour le rejouer frame par frame */
+class InputReplay
+{
+public:
+    bool load(const std::string &path);
+
+    size_t getFrameCount() const
+    {
+        return frames.size();
+    }
+
+    const RecordedFrame &getFrame(size_t index) const
+    {
+        return frames[index];
+    }
+
+private:
+    std::vector<RecordedFrame> frames;
+};
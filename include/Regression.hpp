@@ -0,0 +1,35 @@
+#pragma once
+
+#include <glimac/FilePath.hpp>
+#include <string>
+
+/* Paramètres de --check */
+struct RegressionOptions
+{
+    std::string directory;            // Images de référence (PNG) et budgets de temps
+    bool update = false;              // Réécrit les références et les budgets au lieu de comparer
+    bool budgets = true;              // Faux avec --no-budget : images seulement, sans mesure de temps
+    int width = 800;
+    int height = 800;
+    int frames = 100;                 // Frames de chaque mesure des budgets
+    int warmup = 10;
+    int runs = 5;                     // Mesures par scène : le budget compare la médiane de leurs p95
+    double maxDeltaE = 2.3;           // Différence de couleur au-delà de laquelle un pixel compte comme différent
+    double maxDifferentRatio = 0.001; // Part des pixels qui peuvent différer
+    double tolerance = 0.1;           // Dépassement minimal accepté, celui du budget vient aussi de l'écart type mesuré
+    double deviations = 3.;           // Ecarts types des p95 des mesures ajoutés à la tolérance par 'update'
+};
+
+/*
+ * Tests de non-régression, hors écran :
+ *  - des poses de caméra fixes de la scène principale, et la scène --stress avec chacun de ses chemins de dessin,
+ *    sont comparées aux PNG de référence '<scène>-<pose>.png' du répertoire ;
+ *  - la médiane des p95 du temps par frame de 'runs' mesures de chaque scène est comparée au budget
+ *    '<scène>.budget' du même répertoire, dont la tolérance couvre la dispersion des mesures qui l'ont créé.
+ * Les images et les budgets notent le GL_RENDERER qui les a créés (renderer.txt, clé 'renderer') : sur un autre,
+ * ils sont ignorés (SKIP) plutôt que comparés.
+ * En cas d'échec, l'image obtenue et une image des différences sont écrites dans le répertoire courant.
+ * Les références dépendent du GPU et du pilote : elles se créent avec 'update' sur la machine de test.
+ * Renvoie 0 si tout passe, 1 si un test échoue, -1 en cas d'erreur.
+ */
+int runRegression(const glimac::FilePath &applicationPath, const RegressionOptions &options);
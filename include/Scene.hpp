@@ -0,0 +1,308 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glimac/FilePath.hpp>
+#include <glimac/Program.hpp>
+#include <glimac/GLObjects.hpp>
+#include <glimac/FreeflyCamera.hpp>
+#include <glimac/Sphere.hpp>
+#include <glimac/Cone.hpp>
+#include <glimac/BBox.hpp>
+#include <glimac/GPUProfiler.hpp>
+#include <glimac/FrameArena.hpp>
+#include <glimac/StreamBuffer.hpp>
+#include <glimac/VertexFormat.hpp>
+#include <vector>
+
+/* Niveaux de détail du cône et de la sphère, du plus fin au plus grossier */
+const int SCENE_LOD_COUNT = 3;
+
+/* Compteurs du dernier frame rendu */
+struct SceneStats
+{
+    unsigned int drawCalls = 0;
+    unsigned int triangles = 0;
+    unsigned int objects = 0;       // Objets testés contre le frustum (tout sauf la skybox)
+    unsigned int culledObjects = 0; // Objets hors du frustum, non dessinés
+    unsigned int lodObjects[SCENE_LOD_COUNT] = {}; // Cônes et sphères dessinés à chaque niveau
+};
+
+/* Réglages modifiables pendant l'exécution (overlay) */
+struct SceneSettings
+{
+    bool culling = true;     // Objets hors du frustum ignorés
+    bool instancing = false; // Cônes des boules à pointes en un appel instancié par niveau (GL 4.2)
+    bool vertexPulling = false; // Sommets lus dans un SSBO par gl_VertexID, un seul VAO pour tous les objets (GL 4.3)
+    float lodBias = 0.f;     // Décalage des niveaux de détail : > 0 plus grossier, < 0 plus fin
+};
+
+/* Modes de rendu de débogage, parcourus avec la touche F */
+enum class DebugView
+{
+    NONE,
+    WIREFRAME,
+    OVERDRAW, // Fragments par pixel, cumulés dans une texture R32F puis affichés en fausses couleurs
+    LOD,      // Couleur du niveau de détail de chaque objet
+    DRAW_ID,  // Une couleur par appel de dessin : un lot instancié garde une seule couleur
+    CULLING,  // Frustum figé à l'entrée du mode, boîtes englobantes vertes (dessinées) ou rouges (éliminées)
+    COUNT
+};
+
+// "none", "wireframe", "overdraw", "lod", "draw-id", "culling"
+const char *getDebugViewName(DebugView view);
+// Inverse de getDebugViewName, false si le nom est inconnu
+bool parseDebugView(const char *name, DebugView &view);
+
+/*
+ * Les deux salles : ressources GL et rendu d'un frame.
+ * Partagé par la fenêtre GLFW et le mode --headless pour que les mesures soient comparables.
+ * Le contexte GL doit être courant à la construction.
+ */
+class Scene
+{
+public:
+    Scene(const glimac::FilePath &applicationPath);
+
+    // Chargement des textures et des buffers, false en cas d'erreur
+    bool init();
+
+    // Rendu dans le framebuffer courant, 'time' en secondes (anime la balle et la lumière)
+    void render(float time, int width, int height);
+
+    void setDebugView(DebugView view);
+    void nextDebugView();
+
+    DebugView getDebugView() const
+    {
+        return debugView;
+    }
+
+    void toggleLight();
+    void toggleBallAnimation(float time);
+
+    const SceneStats &getStats() const
+    {
+        return stats;
+    }
+
+    // Le dessin instancié demande glDrawArraysInstancedBaseInstance
+    static bool isInstancingSupported();
+    // Le vertex pulling demande les SSBO dans le vertex shader
+    static bool isVertexPullingSupported();
+    // Les textures chargées par init sont présentes dans assets/textures
+    static bool hasTextures();
+
+    // Temps GPU / CPU des passes : skybox, walls, room 1 objects, room 2 objects, windows
+    glimac::GPUProfiler &getProfiler()
+    {
+        return profiler;
+    }
+
+    // Listes temporaires du frame (fenêtres triées), remise à zéro au début de render
+    const glimac::FrameArena &getFrameArena() const
+    {
+        return frameArena;
+    }
+
+    // Matrices de chaque objet (bloc DrawData des shaders), réécrites à chaque frame
+    const glimac::StreamBuffer &getDrawDataBuffer() const
+    {
+        return drawDataBuffer;
+    }
+
+    /* Camera */
+    glimac::FreeflyCamera camera;
+    float cameraHeight = 0.f;
+
+    SceneSettings settings;
+
+private:
+    Scene(const Scene &);
+    Scene &operator=(const Scene &);
+
+    /* Uniforms d'un programme, -1 pour ceux qu'il n'a pas */
+    struct ProgramUniforms
+    {
+        GLint texture, isCone, instanced, color;
+    };
+
+    /* Bloc uniforme DrawData des vertex shaders, en disposition std140 */
+    struct DrawData
+    {
+        glm::mat4 MVPMatrix;
+        glm::mat4 MVMatrix;
+        glm::mat4 NormalMatrix;
+    };
+
+    /* Boîte testée contre le frustum, pour la vue CULLING */
+    struct CullResult
+    {
+        glm::mat4 MVPMatrix;
+        glimac::BBox3f box;
+        bool visible;
+    };
+
+    /* Place d'un maillage dans les buffers communs du vertex pulling */
+    struct PulledMesh
+    {
+        GLint first;          // Premier sommet
+        GLintptr indexOffset; // Octets avant ses indices, déjà décalés de 'first'
+    };
+
+    /* Buffers d'un maillage et format de ses sommets */
+    struct Mesh
+    {
+        const glimac::VertexFormat *format = nullptr;
+        glimac::Buffer vbo, ebo;                   // ebo vide sans indices
+        const glimac::Buffer *instances = nullptr; // Deuxième buffer du format (matrices des instances), à remplir avant initMesh
+        const glimac::VertexArray *vao = nullptr;  // VAO partagé par les maillages du même format, ou ownVAO
+        glimac::VertexArray ownVAO;                // Sans GL 4.3 seulement : VAO du maillage, avec glVertexAttribPointer
+        glimac::BBox3f box;                        // Boîte englobante des sommets (culling, niveaux de détail)
+        PulledMesh pulled = {0, 0};                // Place dans les buffers communs du vertex pulling
+    };
+
+    /* Objet transparent, trié par distance à la caméra */
+    struct TransparentObject
+    {
+        const Mesh *mesh;
+        glm::vec3 position;
+        glm::mat4 modelMatrix;
+    };
+
+    /* Sommets de chaque niveau de détail d'un maillage, à la suite dans son VBO */
+    struct MeshLods
+    {
+        GLint first[SCENE_LOD_COUNT];
+        GLsizei count[SCENE_LOD_COUNT];
+    };
+
+    static ProgramUniforms getUniforms(const glimac::Program &program);
+
+    // Envoie les sommets (et les indices) du maillage. Avec GL 4.3 il prend le VAO partagé de son format,
+    // sinon il a son propre VAO décrit par le même format
+    void initMesh(Mesh &mesh, const glimac::VertexFormat &format, const char *label, const void *vertices, GLsizeiptr size,
+                  const GLuint indices[] = nullptr, GLsizeiptr indicesSize = 0);
+
+    // Matrices de l'objet suivant, copiées dans drawDataBuffer et liées au bloc DrawData.
+    // Sans MVMatrix ni NormalMatrix, celles de l'objet précédent restent en place (les shaders qui n'éclairent pas les ignorent)
+    void setDrawData(const glm::mat4 &MVPMatrix);
+    void setDrawData(const glm::mat4 &MVPMatrix, const glm::mat4 &MVMatrix, const glm::mat4 &NormalMatrix);
+
+    // Lie le VAO du format du maillage s'il ne l'est pas déjà et y attache ses buffers ; en vertex pulling,
+    // choisit seulement sa place dans les buffers communs (VAO déjà lié)
+    void bindMesh(const Mesh &mesh);
+    // Délie le VAO après le dernier maillage de la frame
+    void unbindMeshes();
+    // 'first' et les indices sont relatifs au maillage lié par bindMesh
+    void drawArrays(GLint first, GLsizei count);
+    void drawElements(GLsizei count);
+    // Couleur du prochain appel de dessin avec le programme de débogage (LOD, DRAW_ID)
+    void setDebugColor(int lod);
+
+    // Cible R32F de la vue OVERDRAW, (re)créée à la taille du viewport
+    void beginOverdraw(int width, int height);
+    // Fausses couleurs du nombre de couches dans 'framebuffer'
+    void resolveOverdraw(GLuint framebuffer);
+    // Boîtes englobantes de la vue CULLING et frustum figé
+    void drawCullResults(const glm::mat4 &ViewMatrix, const glm::mat4 &ProjMatrix);
+
+    // Compte l'objet et le teste contre le frustum, avec la boîte du maillage
+    bool isVisible(const Mesh &mesh, const glm::mat4 &MVMatrix, const glm::mat4 &ProjMatrix);
+    // Niveau de détail d'après la taille à l'écran de la boîte du maillage
+    int selectLod(const Mesh &mesh, const glm::mat4 &MVMatrix);
+    // Dessine les cônes instanciés mis de côté par drawCone2
+    void flushConeInstances();
+
+    void drawRec(const Mesh &mesh, const glm::mat4 &MVMatrix, const glm::mat4 &ProjMatrix, const glimac::Texture &texture);
+    void drawRec2(const Mesh &mesh, const glm::mat4 &MVMatrix, const glm::mat4 &ProjMatrix);
+    void drawCone(const glimac::Texture &texture, const glm::mat4 &ViewMatrix, const glm::mat4 &ProjMatrix, glm::vec3 translateVec, glm::vec3 scaleVec);
+    void drawCone2(const glm::mat4 &MVMatrix, const glm::mat4 &ProjMatrix);
+    void drawBalloon(float time, const glm::mat4 &ViewMatrix, const glm::mat4 &ProjMatrix);
+
+    glimac::FilePath applicationPath;
+    SceneStats stats;
+    glimac::GPUProfiler profiler;
+    glimac::FrameArena frameArena;
+
+    /* Débogage */
+    DebugView debugView = DebugView::NONE;
+    int drawLod = -1;           // Niveau de détail de l'objet en cours de dessin, -1 sans niveaux
+    bool cullingFrozen = false; // cullingViewMatrix est celle de l'entrée dans la vue CULLING
+    glm::mat4 cullingViewMatrix;
+    glm::mat4 cullingCorrection; // Vue courante -> vue figée, identité hors de la vue CULLING
+    std::vector<CullResult> cullResults;
+
+    /* Current room */
+    bool room1 = true;
+
+    /* Light state */
+    bool light = true;
+
+    /* Ball animation */
+    bool animateBall = true;
+    float ballTimeOffset = 0.0f;
+    float lastTime = 0.0f;
+
+    /* Shaders */
+    glimac::Program skyboxProgram;
+    glimac::Program room1Program;
+    glimac::Program room2Program;
+    glimac::Program debugProgram;   // Couleur unie par appel (OVERDRAW, LOD, DRAW_ID, CULLING)
+    glimac::Program heatmapProgram; // Résolution de la vue OVERDRAW
+
+    ProgramUniforms room1Uniforms;
+    ProgramUniforms room2Uniforms;
+    ProgramUniforms debugUniforms;
+    /* Mêmes programmes avec pulled.vs.glsl, si isVertexPullingSupported() */
+    glimac::Program room1PulledProgram;
+    glimac::Program room2PulledProgram;
+    glimac::Program debugPulledProgram;
+    ProgramUniforms room1PulledUniforms;
+    ProgramUniforms room2PulledUniforms;
+    ProgramUniforms debugPulledUniforms;
+    const ProgramUniforms *uniforms = nullptr; // Programme des objets du frame en cours
+
+    /* Matrices par objet */
+    DrawData drawData;                 // Dernières matrices écrites
+    glimac::StreamBuffer drawDataBuffer;
+    GLint drawDataAlignment = 256;     // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+
+    /* Textures */
+    glimac::Texture woodTexture;
+    glimac::Texture treeTexture;
+    glimac::Texture ballTexture;
+    glimac::Texture cubemapTexture;
+
+    /* Geometry */
+    MeshLods coneLods;
+    MeshLods sphereLods;
+
+    /* Niveaux de détail */
+    float lodScale = 1.f; // Pixels par unité à distance 1
+
+    /* Vertex pulling : tous les maillages dans un SSBO et un buffer d'indices, liés au même VAO */
+    bool vertexPulling = false;   // Objets du frame en cours dessinés avec pullingVAO
+    PulledMesh boundMesh = {0, 0}; // Maillage lié par bindMesh, {0, 0} hors vertex pulling
+    glimac::Buffer pulledVertexBuffer, pulledIndexBuffer;
+    glimac::VertexArray pullingVAO;
+
+    /* Cônes instanciés : matrice MVP de chaque instance, par niveau de détail */
+    std::vector<glm::mat4> coneInstances[SCENE_LOD_COUNT];
+    std::vector<glm::mat4> instanceData;
+    glimac::Buffer instanceVBO;
+
+    /* Un VAO par format de sommets (GL 4.3) : bindMesh ne change de VAO qu'entre deux formats */
+    glimac::VertexArrayCache vertexArrays;
+    GLuint boundVertexArray = 0;           // VAO lié par bindMesh, 0 après unbindMeshes
+    const Mesh *boundVertexMesh = nullptr; // Maillage dont les buffers y sont attachés
+
+    Mesh floorMesh, backWallMesh, leftWallMesh, rightWallMesh, smallWallMesh, leftPassageWallMesh, rightPassageWallMesh;
+    Mesh windowMesh, pedestalMesh, coneMesh, trunkMesh, sphereMesh, skyboxMesh;
+
+    /* Débogage */
+    Mesh boxMesh;                  // Arêtes du cube unité, en lignes
+    glimac::VertexArray screenVAO; // Sans attributs : triangle plein écran construit avec gl_VertexID
+    glimac::Texture overdrawTexture;
+    glimac::Framebuffer overdrawFBO;
+    int overdrawWidth = 0, overdrawHeight = 0;
+};
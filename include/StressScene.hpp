@@ -0,0 +1,149 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glimac/FilePath.hpp>
+#include <glimac/Program.hpp>
+#include <glimac/GLObjects.hpp>
+#include <glimac/GPUProfiler.hpp>
+#include <glimac/VertexFormat.hpp>
+#include <glimac/glm.hpp>
+#include <glimac/common.hpp>
+#include <vector>
+#include "Scene.hpp"
+
+/* Façons de soumettre les objets de la scène de test */
+enum class DrawPath
+{
+    IMMEDIATE, // Un appel de dessin par partie d'objet, attributs d'instance constants
+    INSTANCED, // Un appel instancié par maillage (GL 4.2, base instance)
+    INDIRECT,  // Un seul glMultiDrawArraysIndirect pour toute la scène (GL 4.3)
+    GPU_CULLED // Comme INDIRECT, avec les instances triées par un compute shader (frustum et Hi-Z, GL 4.3)
+};
+
+/*
+ * Scène de test de montée en charge : 'roomCount' salles en grille, avec les murs, le sol et le passage
+ * des salles de Scene, et 'objectCount' objets répartis entre elles (sapins, balles, boules à pointes, fenêtres).
+ * Les objets sont placés aléatoirement (graine 'seed') et ne bougent pas, pour que les chemins de dessin
+ * soient comparés sur exactement la même image. Le contexte GL doit être courant à la construction.
+ */
+class StressScene
+{
+public:
+    StressScene(const glimac::FilePath &applicationPath, unsigned int roomCount, unsigned int objectCount, unsigned int seed = 1);
+
+    static bool isSupported(DrawPath path);
+    static const char *getName(DrawPath path);
+
+    // Vue plongeante sur toute la grille ; le temps GPU est mesuré dans le scope au nom du chemin
+    void render(DrawPath path, int width, int height);
+
+    const SceneStats &getStats() const
+    {
+        return stats;
+    }
+
+    glimac::GPUProfiler &getProfiler()
+    {
+        return profiler;
+    }
+
+    // Nombre de parties d'objets (un sapin compte 4 parties : 3 cônes et le tronc)
+    size_t getInstanceCount() const
+    {
+        return instances.size();
+    }
+
+    // Le CPU ne sait pas ce que GPU_CULLED a dessiné : complète les compteurs du dernier frame avec les
+    // commandes écrites par le compute shader. Attend le GPU, à appeler hors des frames mesurés.
+    void readGPUCullingStats();
+
+private:
+    StressScene(const StressScene &);
+    StressScene &operator=(const StressScene &);
+
+    /* Maillages partagés, dans un seul VBO */
+    enum Mesh
+    {
+        QUAD,
+        BOX,
+        CONE,
+        SPHERE,
+        MESH_COUNT
+    };
+
+    /* Attributs d'une instance, dans l'ordre des emplacements 5 à 9 */
+    struct Instance
+    {
+        glm::mat4 modelMatrix;
+        glm::vec4 color;
+    };
+
+    /* Boîte englobante d'une instance dans le monde, comme la lit cull.cs.glsl (std430) */
+    struct InstanceBounds
+    {
+        glm::vec3 lower;
+        GLuint mesh;
+        glm::vec3 upper;
+        GLuint padding;
+    };
+
+    // Cibles du chemin GPU_CULLED, (re)créées à la taille du viewport : la profondeur doit pouvoir être lue
+    void beginGPUCulling(int width, int height);
+    // Remplit gpuCommandBuffer et visibleInstanceBuffer avec les instances visibles
+    void cullInstances(const glm::mat4 &ViewProjMatrix);
+    // Pyramide Hi-Z de la profondeur du frame, pour le prochain cullInstances
+    void buildHiZ(const glm::mat4 &ViewProjMatrix);
+
+    // Sommets partagés (binding 0), et si 'instanced' les attributs d'instance (binding 1)
+    static const glimac::VertexFormat &getVertexFormat(bool instanced);
+    // Lie le VAO du format et y attache vbo et 'instanceBuffer' (GL 4.3), sinon 'ownVAO' déjà complet
+    void bindVertices(const glimac::VertexArray &ownVAO, const glimac::Buffer *instanceBuffer);
+
+    void addInstance(Mesh mesh, const glm::mat4 &modelMatrix, const glm::vec4 &color);
+    void addRoom(const glm::vec3 &center);
+    void addObject(unsigned int type, const glm::vec3 &position);
+
+    SceneStats stats;
+    glimac::GPUProfiler profiler;
+
+    glimac::Program program;
+    GLint viewProjMatrixLocation;
+
+    GLint meshFirst[MESH_COUNT];
+    GLsizei meshCount[MESH_COUNT];
+
+    /* Instances dans l'ordre de création (rendu immédiat) et regroupées par maillage (instancié, indirect) */
+    std::vector<Instance> instances;
+    std::vector<Mesh> instanceMeshes;
+    GLuint groupFirst[MESH_COUNT];
+    GLuint groupCount[MESH_COUNT];
+
+    glm::vec3 sceneCenter;
+    float sceneExtent = 1.f;
+
+    glimac::Buffer vbo;
+    glimac::Buffer instanceVBO;
+    glimac::Buffer commandBuffer;
+    glimac::VertexArrayCache vertexArrays; // Un VAO par format, quand glBindVertexBuffer est disponible
+    glimac::VertexArray immediateVAO;      // Sinon un VAO par chemin, sans attributs d'instance
+    glimac::VertexArray instancedVAO;
+
+    /* GPU_CULLED */
+    glimac::Program cullProgram;
+    glimac::Program hiZProgram;
+    GLint cullInstanceCountLocation, cullViewProjMatrixLocation, cullHiZLocation, cullHiZViewProjMatrixLocation;
+    GLint hiZLevelLocation;
+    glimac::Buffer boundsBuffer;           // InstanceBounds, dans l'ordre de instanceVBO
+    glimac::Buffer visibleInstanceBuffer;  // Instances gardées, à la suite par maillage
+    glimac::Buffer gpuCommandBuffer;       // Une commande par maillage, même vide
+    glimac::DrawArraysIndirectCommand gpuCommands[MESH_COUNT]; // instanceCount à 0, pour remettre gpuCommandBuffer à zéro
+    glimac::VertexArray gpuCulledVAO;      // Instances lues dans visibleInstanceBuffer (sans glBindVertexBuffer)
+    glimac::Framebuffer gpuFBO;
+    glimac::Texture gpuColorTexture;
+    glimac::Texture gpuDepthTexture;
+    glimac::Texture hiZTexture;            // R32F, tous les niveaux
+    int gpuWidth = 0, gpuHeight = 0;
+    int hiZLevels = 0;
+    bool hiZValid = false;                 // Faux avant le premier frame GPU_CULLED et après un changement de taille
+    glm::mat4 hiZViewProjMatrix;
+};
@@ -0,0 +1,264 @@
+#include "Overlay.hpp"
+#include <glimac/Nuklear.hpp>
+#include <glimac/GLCalls.hpp>
+#include <glimac/GLObjects.hpp>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+using namespace glimac;
+
+/* Frames affichés dans le graphe et utilisés pour les percentiles */
+const size_t FRAME_HISTORY = 240;
+
+/* Percentile au rang le plus proche, comme glimac::FrameStats */
+static float percentile(const std::vector<float> &sorted, float p)
+{
+    size_t rank = size_t(std::ceil(p * sorted.size()));
+    return sorted[std::min(std::max(rank, size_t(1)), sorted.size()) - 1];
+}
+
+Overlay::Overlay(GLFWwindow *window)
+    : frameTimes(FRAME_HISTORY, 0.f)
+{
+    // Sans les callbacks de Nuklear : ceux de l'application restent en place, la souris est lue à chaque frame
+    context = nk_glfw3_init(window, NK_GLFW3_DEFAULT);
+
+    struct nk_font_atlas *atlas;
+    nk_glfw3_font_stash_begin(&atlas);
+    nk_glfw3_font_stash_end();
+
+    sortedFrameTimes.reserve(FRAME_HISTORY);
+}
+
+Overlay::~Overlay()
+{
+    nk_glfw3_shutdown();
+}
+
+void Overlay::addFrameTime(float ms)
+{
+    frameTimes[nextFrame] = ms;
+    nextFrame = (nextFrame + 1) % FRAME_HISTORY;
+    frameCount = std::min(frameCount + 1, FRAME_HISTORY);
+}
+
+void Overlay::render(Scene &scene, bool &vsync)
+{
+    if (!visible)
+    {
+        return;
+    }
+
+    nk_glfw3_new_frame();
+    if (nk_begin(context, "Performances", nk_rect(10, 10, 340, 900),
+                 NK_WINDOW_BORDER | NK_WINDOW_MOVABLE | NK_WINDOW_SCALABLE | NK_WINDOW_MINIMIZABLE | NK_WINDOW_TITLE))
+    {
+        frameTimeSection();
+        passesSection(scene);
+        countersSection(scene);
+        settingsSection(scene, vsync);
+    }
+    nk_end(context);
+
+    // Le binding dessine avec le pipeline fixe et des tableaux en mémoire client, rempli même en mode fil de fer.
+    // Appels GL directs : l'overlay ne fait pas partie du frame mesuré ni des captures
+    glUseProgram(0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glPushAttrib(GL_POLYGON_BIT);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    nk_glfw3_render(NK_ANTI_ALIASING_ON);
+    glPopAttrib();
+}
+
+void Overlay::frameTimeSection()
+{
+    if (frameCount == 0)
+    {
+        return;
+    }
+
+    sortedFrameTimes.assign(frameTimes.begin(), frameTimes.begin() + frameCount);
+    std::sort(sortedFrameTimes.begin(), sortedFrameTimes.end());
+    float last = frameTimes[(nextFrame + FRAME_HISTORY - 1) % FRAME_HISTORY];
+    float p99 = percentile(sortedFrameTimes, 0.99f);
+
+    nk_layout_row_dynamic(context, 18, 1);
+    nk_labelf(context, NK_TEXT_LEFT, "Frame: %.2f ms (%d fps)", last, last > 0.f ? int(std::lround(1000.f / last)) : 0);
+    nk_labelf(context, NK_TEXT_LEFT, "p50 %.2f   p95 %.2f   p99 %.2f ms", percentile(sortedFrameTimes, 0.5f),
+              percentile(sortedFrameTimes, 0.95f), p99);
+
+    // Echelle fixée à au moins 60 fps pour que le graphe ne saute pas d'un frame à l'autre
+    nk_layout_row_dynamic(context, 80, 1);
+    if (nk_chart_begin(context, NK_CHART_LINES, int(frameCount), 0.f, std::max(1.5f * p99, 1000.f / 60.f)))
+    {
+        for (size_t i = 0; i < frameCount; i++)
+        {
+            nk_chart_push(context, frameTimes[(nextFrame + FRAME_HISTORY - frameCount + i) % FRAME_HISTORY]);
+        }
+        nk_chart_end(context);
+    }
+}
+
+void Overlay::passesSection(Scene &scene)
+{
+    if (nk_tree_push(context, NK_TREE_TAB, "Passes (GPU / CPU ms)", NK_MAXIMIZED))
+    {
+        nk_layout_row_dynamic(context, 18, 2);
+        for (const auto &timing : scene.getProfiler().getTimings())
+        {
+            std::string name = std::string(2 * timing.m_nDepth, ' ') + timing.m_sName;
+            nk_label(context, name.c_str(), NK_TEXT_LEFT);
+            nk_labelf(context, NK_TEXT_RIGHT, "%.3f / %.3f", timing.m_fGPUTime, timing.m_fCPUTime);
+        }
+        nk_tree_pop(context);
+    }
+}
+
+void Overlay::countersSection(const Scene &scene)
+{
+    const SceneStats &stats = scene.getStats();
+
+    if (nk_tree_push(context, NK_TREE_TAB, "Scene", NK_MAXIMIZED))
+    {
+        nk_layout_row_dynamic(context, 18, 1);
+        nk_labelf(context, NK_TEXT_LEFT, "Draw calls: %u, triangles: %u", stats.drawCalls, stats.triangles);
+        nk_labelf(context, NK_TEXT_LEFT, "Objects: %u drawn, %u culled", stats.objects - stats.culledObjects, stats.culledObjects);
+        nk_layout_row_dynamic(context, 36, 1);
+        nk_label_wrap(context, ("GL: " + getGLFrameSummary(getLastGLFrameCounters())).c_str());
+        if (AllocationTracker::isEnabled())
+        {
+            nk_label_wrap(context, ("Heap: " + frameAllocations.getSummary()).c_str());
+        }
+        const FrameArena &arena = scene.getFrameArena();
+        nk_layout_row_dynamic(context, 18, 1);
+        nk_labelf(context, NK_TEXT_LEFT, "Frame arena: %zu B (peak %zu / %zu B)", arena.getUsedBytes(), arena.getPeakBytes(), arena.getCapacity());
+        if (arena.getOverflowCount())
+        {
+            nk_labelf(context, NK_TEXT_LEFT, "Frame arena overflows: %zu", arena.getOverflowCount());
+        }
+        const StreamBuffer &drawData = scene.getDrawDataBuffer();
+        const StreamBuffer::Stats &streamStats = drawData.getStats();
+        nk_labelf(context, NK_TEXT_LEFT, "Draw data (%s): %zu B (peak %zu / %zu B)", StreamBuffer::isPersistent() ? "mapped" : "glBufferSubData",
+                  drawData.getFrameBytes(), streamStats.m_nPeakBytes, drawData.getRegionSize());
+        if (streamStats.m_nWaits || streamStats.m_nOverflows)
+        {
+            nk_labelf(context, NK_TEXT_LEFT, "Draw data waits: %zu (%.2f ms), overflows: %zu", streamStats.m_nWaits, streamStats.m_fWaitTime, streamStats.m_nOverflows);
+        }
+        nk_tree_pop(context);
+    }
+
+    if (nk_tree_push(context, NK_TREE_TAB, "GPU memory (live / peak KB)", NK_MAXIMIZED))
+    {
+        const GLMemoryUsage &memory = getGLMemoryUsage();
+        nk_layout_row_dynamic(context, 18, 2);
+        for (int category = 0; category < int(GLMemoryCategory::COUNT); category++)
+        {
+            nk_label(context, getGLMemoryCategoryName(GLMemoryCategory(category)), NK_TEXT_LEFT);
+            nk_labelf(context, NK_TEXT_RIGHT, "%.1f / %.1f", memory.m_nBytes[category] / 1024., memory.m_nPeakBytes[category] / 1024.);
+        }
+        nk_labelf(context, NK_TEXT_LEFT, "Total (%zu objects)", memory.m_nObjects);
+        nk_labelf(context, NK_TEXT_RIGHT, "%.1f / %.1f", memory.m_nTotalBytes / 1024., memory.m_nPeakTotalBytes / 1024.);
+        nk_tree_pop(context);
+    }
+
+    if (nk_tree_push(context, NK_TREE_TAB, "Levels of detail", NK_MAXIMIZED))
+    {
+        unsigned int total = 0;
+        for (unsigned int count : stats.lodObjects)
+        {
+            total += count;
+        }
+        nk_layout_row_dynamic(context, 18, 2);
+        for (int lod = 0; lod < SCENE_LOD_COUNT; lod++)
+        {
+            nk_labelf(context, NK_TEXT_LEFT, "LOD %d: %u", lod, stats.lodObjects[lod]);
+            nk_prog(context, stats.lodObjects[lod], std::max(total, 1u), nk_false);
+        }
+        nk_tree_pop(context);
+    }
+}
+
+void Overlay::settingsSection(Scene &scene, bool &vsync)
+{
+    if (nk_tree_push(context, NK_TREE_TAB, "Settings", NK_MAXIMIZED))
+    {
+        SceneSettings &settings = scene.settings;
+        nk_layout_row_dynamic(context, 20, 1);
+
+        int culling = settings.culling;
+        nk_checkbox_label(context, "Frustum culling", &culling);
+        settings.culling = culling;
+
+        if (Scene::isInstancingSupported())
+        {
+            int instancing = settings.instancing;
+            nk_checkbox_label(context, "Instanced spike cones", &instancing);
+            settings.instancing = instancing;
+        }
+        else
+        {
+            nk_label(context, "Instancing needs OpenGL 4.2", NK_TEXT_LEFT);
+        }
+
+        if (Scene::isVertexPullingSupported())
+        {
+            int vertexPulling = settings.vertexPulling;
+            nk_checkbox_label(context, "Vertex pulling (one VAO)", &vertexPulling);
+            settings.vertexPulling = vertexPulling;
+        }
+        else
+        {
+            nk_label(context, "Vertex pulling needs OpenGL 4.3", NK_TEXT_LEFT);
+        }
+
+        int swapInterval = vsync;
+        nk_checkbox_label(context, "Vsync", &swapInterval);
+        vsync = swapInterval;
+
+        nk_labelf(context, NK_TEXT_LEFT, "LOD bias: %+.2f", settings.lodBias);
+        nk_slider_float(context, -4.f, &settings.lodBias, 4.f, 0.25f);
+        nk_tree_pop(context);
+    }
+
+    if (nk_tree_push(context, NK_TREE_TAB, "Debug view (F)", NK_MAXIMIZED))
+    {
+        const char *views[int(DebugView::COUNT)];
+        for (int i = 0; i < int(DebugView::COUNT); i++)
+        {
+            views[i] = getDebugViewName(DebugView(i));
+        }
+        nk_layout_row_dynamic(context, 20, 1);
+        int view = nk_combo(context, views, int(DebugView::COUNT), int(scene.getDebugView()), 20, nk_vec2(200, 160));
+        if (view != int(scene.getDebugView()))
+        {
+            scene.setDebugView(DebugView(view));
+        }
+
+        const char *legend = nullptr;
+        switch (scene.getDebugView())
+        {
+        case DebugView::OVERDRAW:
+            legend = "Layers: 1 blue, 2 cyan, 3 green, 4 yellow, 5 orange, 6 red, 7 magenta, 8+ white";
+            break;
+        case DebugView::LOD:
+            legend = "LOD 0 green, 1 yellow, 2 red, grey without levels";
+            break;
+        case DebugView::DRAW_ID:
+            legend = "One color per draw call: an instanced batch has a single color";
+            break;
+        case DebugView::CULLING:
+            legend = "Frustum frozen when selected (yellow): boxes green if drawn, red if culled";
+            break;
+        default:
+            break;
+        }
+        if (legend)
+        {
+            nk_layout_row_dynamic(context, 36, 1);
+            nk_label_wrap(context, legend);
+        }
+        nk_tree_pop(context);
+    }
+}
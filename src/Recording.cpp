@@ -0,0 +1,135 @@
+#include "Recording.hpp"
+#include <cstring>
+#include <iostream>
+
+static const char MAGIC[] = "DSDAREC";
+static const uint8_t VERSION = 1;
+
+// Les valeurs sont écrites telles qu'en mémoire (machines little endian)
+template <typename T>
+static void write(std::ofstream &file, T value)
+{
+    file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool read(std::ifstream &file, T &value)
+{
+    return bool(file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+CameraPose CameraPose::fromCamera(const glimac::FreeflyCamera &camera)
+{
+    return {camera.getPosition(), camera.getPhi(), camera.getTheta()};
+}
+
+bool CameraPose::operator==(const CameraPose &other) const
+{
+    // Comparaison bit à bit : le rejeu doit refaire exactement les mêmes calculs
+    return std::memcmp(this, &other, sizeof(CameraPose)) == 0;
+}
+
+bool InputRecorder::open(const std::string &path)
+{
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "Unable to open recording file " << path << std::endl;
+        return false;
+    }
+    file.write(MAGIC, sizeof(MAGIC) - 1);
+    write(file, VERSION);
+    return true;
+}
+
+void InputRecorder::addEvent(const InputEvent &event)
+{
+    events.push_back(event);
+}
+
+void InputRecorder::endFrame(float time, const CameraPose &pose)
+{
+    write(file, time);
+    write(file, pose.position.x);
+    write(file, pose.position.y);
+    write(file, pose.position.z);
+    write(file, pose.phi);
+    write(file, pose.theta);
+    write(file, uint16_t(events.size()));
+    for (const auto &event : events)
+    {
+        write(file, uint8_t(event.type));
+        switch (event.type)
+        {
+        case InputEvent::KEY:
+            write(file, event.code);
+            write(file, event.action);
+            break;
+        case InputEvent::MOUSE_BUTTON:
+            write(file, uint8_t(event.code));
+            write(file, event.action);
+            break;
+        case InputEvent::CURSOR:
+            write(file, event.x);
+            write(file, event.y);
+            break;
+        }
+    }
+    events.clear();
+}
+
+void InputRecorder::close()
+{
+    file.close();
+    events.clear();
+}
+
+bool InputReplay::load(const std::string &path)
+{
+    frames.clear();
+
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(MAGIC) - 1];
+    uint8_t version = 0;
+    if (!file || !file.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(magic)) || !read(file, version) || version != VERSION)
+    {
+        std::cerr << "Invalid recording file " << path << std::endl;
+        return false;
+    }
+
+    RecordedFrame frame;
+    uint16_t eventCount;
+    while (read(file, frame.time) && read(file, frame.pose.position.x) && read(file, frame.pose.position.y) && read(file, frame.pose.position.z) && read(file, frame.pose.phi) && read(file, frame.pose.theta) && read(file, eventCount))
+    {
+        frame.events.resize(eventCount);
+        for (auto &event : frame.events)
+        {
+            uint8_t type = 0, button = 0;
+            bool ok = read(file, type);
+            event = InputEvent{InputEvent::Type(type), 0, 0, 0., 0.};
+            switch (type)
+            {
+            case InputEvent::KEY:
+                ok = ok && read(file, event.code) && read(file, event.action);
+                break;
+            case InputEvent::MOUSE_BUTTON:
+                ok = ok && read(file, button) && read(file, event.action);
+                event.code = button;
+                break;
+            case InputEvent::CURSOR:
+                ok = ok && read(file, event.x) && read(file, event.y);
+                break;
+            default:
+                ok = false;
+            }
+            if (!ok)
+            {
+                std::cerr << "Truncated recording file " << path << std::endl;
+                return false;
+            }
+        }
+        frames.push_back(frame);
+    }
+
+    return true;
+}
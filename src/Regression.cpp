@@ -0,0 +1,465 @@
+#include "Regression.hpp"
+#include "Scene.hpp"
+#include "StressScene.hpp"
+#include <glimac/HeadlessContext.hpp>
+#include <glimac/FrameStats.hpp>
+#include <glimac/ImageCompare.hpp>
+#include <glimac/GLCalls.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <src/stb_image.h>
+#include <third-party/glfw/deps/stb_image_write.h>
+
+using namespace glimac;
+
+/* Instant de l'animation (balle, lumière) des images de référence */
+const float GOLDEN_TIME = 1.f;
+
+/* Pose de caméra de la scène principale, donnée par un point regardé */
+struct GoldenPose
+{
+    const char *name;
+    glm::vec3 position;
+    glm::vec3 target;
+};
+
+static const GoldenPose ROOM_POSES[] = {
+    {"room1-entrance", {0.f, 0.f, 3.f}, {0.f, 0.f, -10.f}},
+    {"room1-tree", {-3.f, 0.f, -2.f}, {-9.f, -1.f, 1.f}},
+    {"room1-ball", {3.f, 0.f, -7.f}, {8.f, -1.6f, -5.f}},
+    {"passage", {0.f, 0.f, -12.f}, {0.f, 0.f, -30.f}},
+    {"room2-spikeball", {2.f, 0.f, -26.f}, {7.f, -1.f, -32.f}},
+    {"room2-windows", {-2.f, 0.f, -21.f}, {-6.f, -1.f, -24.75f}}};
+
+/* Place la caméra de la scène sur la pose, tournée vers son point regardé */
+static void setGoldenPose(Scene &scene, const GoldenPose &pose)
+{
+    glm::vec3 direction = pose.target - pose.position;
+    scene.camera.setPose(pose.position, std::atan2(direction.x, direction.z),
+                         std::atan2(direction.y, std::sqrt(direction.x * direction.x + direction.z * direction.z)));
+}
+
+/* GL_RENDERER de la mesure ou des images de référence */
+const char *const RENDERER_FILE = "renderer.txt";
+
+/* Budget de temps par frame d'une scène, fichier texte "clé valeur" */
+struct Budget
+{
+    std::string renderer; // GL_RENDERER de la mesure
+    std::string config;   // Résolution et chemin de dessin de la mesure
+    double p95 = 0.;    // Médiane des p95 des mesures
+    double stddev = 0.; // Ecart type des p95 des mesures
+    double tolerance = 0.;
+};
+
+static bool readBudget(const std::string &path, Budget &budget)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream stream(line);
+        std::string key;
+        stream >> key;
+        if (key == "renderer")
+        {
+            std::getline(stream >> std::ws, budget.renderer);
+        }
+        else if (key == "config")
+        {
+            std::getline(stream >> std::ws, budget.config);
+        }
+        else if (key == "p95_ms")
+        {
+            stream >> budget.p95;
+        }
+        else if (key == "stddev_ms")
+        {
+            stream >> budget.stddev;
+        }
+        else if (key == "tolerance")
+        {
+            stream >> budget.tolerance;
+        }
+    }
+    return budget.p95 > 0.;
+}
+
+static bool writeBudget(const std::string &path, const std::string &scene, const Budget &budget)
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "Unable to write " << path << std::endl;
+        return false;
+    }
+    file << "# Budget de temps par frame de la scène " << scene << " (DSDA --check)" << std::endl
+         << "renderer " << budget.renderer << std::endl
+         << "config " << budget.config << std::endl
+         << "p95_ms " << budget.p95 << std::endl
+         << "stddev_ms " << budget.stddev << std::endl
+         << "tolerance " << budget.tolerance << std::endl;
+    return true;
+}
+
+/* GL_RENDERER des images de référence du répertoire, vide s'il n'est pas noté */
+static std::string readRenderer(const std::string &directory)
+{
+    std::ifstream file(directory + "/" + RENDERER_FILE);
+    std::string renderer;
+    std::getline(file, renderer);
+    return renderer;
+}
+
+static bool writeRenderer(const std::string &directory, const std::string &renderer)
+{
+    std::string path = directory + "/" + RENDERER_FILE;
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "Unable to write " << path << std::endl;
+        return false;
+    }
+    file << renderer << std::endl;
+    return true;
+}
+
+/* Lit le framebuffer courant en RGBA, première ligne en haut comme dans un PNG.
+   L'alpha est forcé à 255 : les shaders des salles n'en écrivent pas et la fenêtre l'ignore */
+static std::vector<unsigned char> readPixels(int width, int height)
+{
+    std::vector<unsigned char> pixels(width * height * 4), flipped(pixels.size());
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    for (int y = 0; y < height; y++)
+    {
+        std::copy(pixels.begin() + y * width * 4, pixels.begin() + (y + 1) * width * 4, flipped.begin() + (height - 1 - y) * width * 4);
+    }
+    for (size_t i = 3; i < flipped.size(); i += 4)
+    {
+        flipped[i] = 255;
+    }
+    return flipped;
+}
+
+static bool writePNG(const std::string &path, int width, int height, const std::vector<unsigned char> &pixels)
+{
+    if (!stbi_write_png(path.c_str(), width, height, 4, pixels.data(), width * 4))
+    {
+        std::cerr << "Unable to write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/* Compte les tests passés et échoués */
+class Report
+{
+public:
+    void pass(const std::string &message)
+    {
+        std::cout << "PASS " << message << std::endl;
+        passed++;
+    }
+
+    void fail(const std::string &message)
+    {
+        std::cout << "FAIL " << message << std::endl;
+        failed++;
+    }
+
+    int getResult() const
+    {
+        std::cout << passed << " passed, " << failed << " failed" << std::endl;
+        return failed ? 1 : 0;
+    }
+
+private:
+    int passed = 0;
+    int failed = 0;
+};
+
+/* Compare le framebuffer à la référence 'golden', ou la réécrit ; 'label' nomme le test */
+static void checkImage(const RegressionOptions &options, const std::string &golden, const std::string &label, bool update, Report &report)
+{
+    std::vector<unsigned char> pixels = readPixels(options.width, options.height);
+    std::string path = options.directory + "/" + golden + ".png";
+    if (update)
+    {
+        if (writePNG(path, options.width, options.height, pixels))
+        {
+            std::cout << "Updated " << path << std::endl;
+        }
+        return;
+    }
+
+    int width = 0, height = 0, channels = 0;
+    unsigned char *reference = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    if (!reference)
+    {
+        report.fail("image " + label + ": missing " + path + " (create it with --update-golden)");
+        return;
+    }
+    if (width != options.width || height != options.height)
+    {
+        stbi_image_free(reference);
+        report.fail("image " + label + ": " + path + " is " + std::to_string(width) + "x" + std::to_string(height));
+        return;
+    }
+
+    std::vector<unsigned char> diff;
+    ImageDifference difference = compareImages(reference, pixels.data(), width, height, options.maxDeltaE, &diff);
+    stbi_image_free(reference);
+
+    char message[256];
+    std::snprintf(message, sizeof(message), "image %s: max dE %.2f, mean dE %.4f, %.3f%% pixels differ",
+                  label.c_str(), difference.m_fMaxDeltaE, difference.m_fMeanDeltaE, 100. * difference.getDifferentRatio());
+    if (difference.getDifferentRatio() <= options.maxDifferentRatio)
+    {
+        report.pass(message);
+        return;
+    }
+    report.fail(message);
+    std::string name = label;
+    std::replace(name.begin(), name.end(), '/', '-');
+    writePNG(name + ".actual.png", width, height, pixels);
+    writePNG(name + ".diff.png", width, height, diff);
+}
+
+/* Compare la médiane des p95 des mesures au budget de la scène, ou le réécrit */
+static void checkBudget(const RegressionOptions &options, const std::string &scene, const std::string &renderer, const std::string &config,
+                        std::vector<double> p95s, Report &report)
+{
+    std::sort(p95s.begin(), p95s.end());
+    double p95 = p95s.size() % 2 ? p95s[p95s.size() / 2] : (p95s[p95s.size() / 2 - 1] + p95s[p95s.size() / 2]) / 2.;
+    std::string path = options.directory + "/" + scene + ".budget";
+    Budget budget;
+    bool found = readBudget(path, budget);
+
+    if (options.update)
+    {
+        // La tolérance couvre la dispersion des mesures, sans descendre sous celle des options
+        double mean = 0., variance = 0.;
+        for (double value : p95s)
+        {
+            mean += value / p95s.size();
+        }
+        for (double value : p95s)
+        {
+            variance += (value - mean) * (value - mean) / p95s.size();
+        }
+        budget.renderer = renderer;
+        budget.config = config;
+        budget.p95 = p95;
+        budget.stddev = std::sqrt(variance);
+        budget.tolerance = std::max(options.tolerance, options.deviations * budget.stddev / p95);
+        if (writeBudget(path, scene, budget))
+        {
+            std::cout << "Updated " << path << std::endl;
+        }
+        return;
+    }
+
+    if (!found)
+    {
+        report.fail("budget " + scene + ": missing " + path + " (create it with --update-golden)");
+        return;
+    }
+    // Un temps ne se compare qu'à une mesure du même GPU et du même pilote
+    if (!budget.renderer.empty() && budget.renderer != renderer)
+    {
+        std::cout << "SKIP budget " << scene << ": measured on " << budget.renderer << ", now " << renderer << std::endl;
+        return;
+    }
+    if (budget.config != config)
+    {
+        std::cout << "SKIP budget " << scene << ": measured with " << budget.config << ", now " << config << std::endl;
+        return;
+    }
+
+    double tolerance = budget.tolerance > 0. ? budget.tolerance : options.tolerance;
+    char message[256];
+    std::snprintf(message, sizeof(message), "budget %s: median p95 of %zu runs %.2f ms (%.2f to %.2f), budget %.2f ms +%.0f%%",
+                  scene.c_str(), p95s.size(), p95, p95s.front(), p95s.back(), budget.p95, 100. * tolerance);
+    if (p95 > budget.p95 * (1. + tolerance))
+    {
+        report.fail(message);
+        return;
+    }
+    report.pass(message);
+    if (p95 < budget.p95 * (1. - tolerance))
+    {
+        std::cout << "     faster than the budget: --update-golden to lower it" << std::endl;
+    }
+}
+
+/* p95 de la durée de 'frames' frames, glFinish compris, pour chacune des 'runs' mesures faites après 'warmup' */
+template <typename RenderFrame>
+static std::vector<double> measure(const RegressionOptions &options, RenderFrame renderFrame)
+{
+    std::vector<double> p95s;
+    for (int i = 0; i < options.warmup; i++)
+    {
+        renderFrame(i);
+        endGLFrame();
+    }
+    glFinish();
+    for (int run = 0; run < options.runs; run++)
+    {
+        FrameStats stats;
+        stats.reserve(options.frames);
+        for (int i = 0; i < options.frames; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            unsigned int drawCalls = renderFrame(options.warmup + i);
+            endGLFrame();
+            glFinish();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            stats.addFrame(elapsed.count(), drawCalls, 0);
+        }
+        p95s.push_back(stats.getFrameTimeSummary().m_fP95);
+    }
+    return p95s;
+}
+
+int runRegression(const FilePath &applicationPath, const RegressionOptions &options)
+{
+    HeadlessContext context;
+    if (!context.create(options.width, options.height))
+    {
+        return -1;
+    }
+    const std::string renderer = reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+    std::cout << "Renderer: " << renderer << std::endl;
+
+    const std::string size = std::to_string(options.width) + "x" + std::to_string(options.height);
+    Report report;
+
+    // Les images dépendent du GPU et du pilote : celles d'un autre renderer ne sont pas comparées
+    bool images = true;
+    if (options.update)
+    {
+        writeRenderer(options.directory, renderer);
+    }
+    else
+    {
+        std::string referenceRenderer = readRenderer(options.directory);
+        if (!referenceRenderer.empty() && referenceRenderer != renderer)
+        {
+            std::cout << "SKIP images: references made on " << referenceRenderer << ", now " << renderer << std::endl;
+            images = false;
+        }
+    }
+
+    /* Scène principale */
+    if (!Scene::hasTextures())
+    {
+        // wood.png et tree.png ne sont pas dans le dépôt : les références n'ont de sens qu'avec les textures d'origine
+        std::cout << "SKIP image rooms, budget rooms: textures missing from assets/textures" << std::endl;
+    }
+    else
+    {
+        Scene scene(applicationPath);
+        if (!scene.init())
+        {
+            return -1;
+        }
+
+        for (const GoldenPose &pose : ROOM_POSES)
+        {
+            setGoldenPose(scene, pose);
+            scene.render(GOLDEN_TIME, options.width, options.height);
+            if (images)
+            {
+                checkImage(options, std::string("rooms-") + pose.name, std::string("rooms/") + pose.name, options.update, report);
+            }
+        }
+
+        // Le vertex pulling lit les mêmes sommets : mêmes références
+        if (Scene::isVertexPullingSupported())
+        {
+            scene.settings.vertexPulling = true;
+            for (const GoldenPose &pose : ROOM_POSES)
+            {
+                setGoldenPose(scene, pose);
+                scene.render(GOLDEN_TIME, options.width, options.height);
+                if (images)
+                {
+                    checkImage(options, std::string("rooms-") + pose.name, std::string("rooms-pulled/") + pose.name, false, report);
+                }
+            }
+            scene.settings.vertexPulling = false;
+        }
+        else
+        {
+            std::cout << "SKIP image rooms-pulled: vertex pulling not supported" << std::endl;
+        }
+
+        // Temps mesurés depuis l'entrée, l'animation avançant à 60 images par seconde
+        if (options.budgets)
+        {
+            const GoldenPose &start = ROOM_POSES[0];
+            glm::vec3 direction = start.target - start.position;
+            scene.camera.setPose(start.position, std::atan2(direction.x, direction.z), 0.f);
+            std::vector<double> p95s = measure(options, [&scene, &options](int frame)
+            {
+                scene.render(frame / 60.f, options.width, options.height);
+                return scene.getStats().drawCalls;
+            });
+            checkBudget(options, "rooms", renderer, size, p95s, report);
+        }
+    }
+
+    /* Scène de montée en charge : tous les chemins de dessin doivent donner la même image */
+    {
+        StressScene scene(applicationPath, 16, 1000);
+        const DrawPath paths[] = {DrawPath::IMMEDIATE, DrawPath::INSTANCED, DrawPath::INDIRECT, DrawPath::GPU_CULLED};
+        DrawPath measured = DrawPath::IMMEDIATE;
+        for (DrawPath path : paths)
+        {
+            if (!StressScene::isSupported(path))
+            {
+                std::cout << "SKIP image stress/" << StressScene::getName(path) << ": not supported" << std::endl;
+                continue;
+            }
+            scene.render(path, options.width, options.height);
+            if (path == DrawPath::GPU_CULLED)
+            {
+                // Le premier frame n'a que le frustum, le second utilise aussi la pyramide Hi-Z du premier
+                scene.render(path, options.width, options.height);
+            }
+            // La référence vient du rendu immédiat, les autres chemins y sont comparés
+            if (images)
+            {
+                checkImage(options, "stress", std::string("stress/") + StressScene::getName(path), options.update && path == DrawPath::IMMEDIATE, report);
+            }
+            // Le budget reste mesuré sur le dernier chemin CPU, celui des références existantes
+            if (path != DrawPath::GPU_CULLED)
+            {
+                measured = path;
+            }
+        }
+
+        if (options.budgets)
+        {
+            std::vector<double> p95s = measure(options, [&scene, &options, measured](int)
+            {
+                scene.render(measured, options.width, options.height);
+                return scene.getStats().drawCalls;
+            });
+            checkBudget(options, "stress", renderer, size + " " + StressScene::getName(measured), p95s, report);
+        }
+    }
+
+    return report.getResult();
+}
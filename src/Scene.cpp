@@ -0,0 +1,1491 @@
+#include "Scene.hpp"
+#include <glimac/Image.hpp>
+#include <glimac/Profiler.hpp>
+#include <glimac/AllocationTracker.hpp>
+#include <glimac/Log.hpp>
+#include <glimac/GLCalls.hpp>
+#include <glimac/Frustum.hpp>
+#include <glimac/MeshSimplifier.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <future>
+#include <iterator>
+#include <vector>
+#include <src/stb_image.h>
+
+using namespace glimac;
+
+const GLuint VERTEX_ATTR_POSITION = 0;
+const GLuint VERTEX_ATTR_NORMAL = 1;
+const GLuint VERTEX_ATTR_COLOR = 2;
+const GLuint VERTEX_ATTR_TEXTURE = 3;
+const GLuint VERTEX_ATTR_INSTANCE_MVP = 5; // mat4 : attributs 5 à 8
+
+/* Rayon à l'écran (pixels) à partir duquel chaque niveau de détail est remplacé par le suivant */
+const float LOD_MIN_PIXELS[SCENE_LOD_COUNT - 1] = {24.f, 8.f};
+
+/* Octets par frame de l'arène des listes temporaires */
+const size_t FRAME_ARENA_CAPACITY = 64 * 1024;
+
+/* Bloc DrawData des vertex shaders : point de liaison et octets par région (frame) du buffer de flux */
+const GLuint DRAW_DATA_BINDING = 0;
+const size_t DRAW_DATA_REGION_SIZE = 64 * 1024;
+
+/* SSBO des sommets de pulled.vs.glsl */
+const GLuint PULLED_VERTICES_BINDING = 0;
+
+/* Textures des objets, relatives au répertoire courant (bin/) */
+const char *const WOOD_TEXTURE_PATH = "../assets/textures/wood.png";
+const char *const TREE_TEXTURE_PATH = "../assets/textures/tree.png";
+const char *const BALL_TEXTURE_PATH = "../assets/textures/ball.png";
+
+struct Vertex3DColor
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec4 color;
+    glm::vec2 texCoords;
+
+    Vertex3DColor(const glm::vec3 &position, const glm::vec3 &normal, const glm::vec4 &color, const glm::vec2 &texCoords)
+        : position(position), normal(normal), color(color), texCoords(texCoords)
+    {
+    }
+};
+
+// Aussi le sommet du SSBO de pulled.vs.glsl : 12 float sans remplissage
+static_assert(sizeof(Vertex3DColor) == 12 * sizeof(float), "Vertex3DColor is read as float[12] by pulled.vs.glsl");
+
+/* Formats des sommets de la scène : les maillages d'un même format partagent son VAO */
+constexpr VertexFormat ROOM_FORMAT = VertexFormat()
+    .buffer<Vertex3DColor>()
+    .attribute(VERTEX_ATTR_POSITION, GLIMAC_VERTEX_MEMBER(Vertex3DColor, position))
+    .attribute(VERTEX_ATTR_NORMAL, GLIMAC_VERTEX_MEMBER(Vertex3DColor, normal))
+    .attribute(VERTEX_ATTR_COLOR, GLIMAC_VERTEX_MEMBER(Vertex3DColor, color))
+    .attribute(VERTEX_ATTR_TEXTURE, GLIMAC_VERTEX_MEMBER(Vertex3DColor, texCoords));
+// Piédestal et tronc : sans normales ni coordonnées de texture
+constexpr VertexFormat COLORED_FORMAT = VertexFormat()
+    .buffer<Vertex3DColor>()
+    .attribute(VERTEX_ATTR_POSITION, GLIMAC_VERTEX_MEMBER(Vertex3DColor, position))
+    .attribute(VERTEX_ATTR_COLOR, GLIMAC_VERTEX_MEMBER(Vertex3DColor, color));
+constexpr VertexFormat SHAPE_FORMAT = VertexFormat()
+    .buffer<ShapeVertex>()
+    .attribute(VERTEX_ATTR_POSITION, GLIMAC_VERTEX_MEMBER(ShapeVertex, position))
+    .attribute(VERTEX_ATTR_NORMAL, GLIMAC_VERTEX_MEMBER(ShapeVertex, normal))
+    .attribute(VERTEX_ATTR_TEXTURE, GLIMAC_VERTEX_MEMBER(ShapeVertex, texCoords));
+// Cônes instanciés : matrice MVP de chaque instance dans un deuxième buffer
+constexpr VertexFormat INSTANCED_SHAPE_FORMAT = SHAPE_FORMAT
+    .buffer<glm::mat4>(1)
+    .attribute(VERTEX_ATTR_INSTANCE_MVP, VertexMember<glm::mat4>{0});
+// Vertex pulling : plus que les matrices des instances
+constexpr VertexFormat INSTANCES_FORMAT = VertexFormat()
+    .buffer<glm::mat4>(1)
+    .attribute(VERTEX_ATTR_INSTANCE_MVP, VertexMember<glm::mat4>{0});
+// Skybox et boîtes de la vue CULLING
+constexpr VertexFormat POSITION_FORMAT = VertexFormat()
+    .buffer<glm::vec3>()
+    .attribute(VERTEX_ATTR_POSITION, VertexMember<glm::vec3>{0});
+
+/* Boîte englobante des positions d'un tableau de sommets */
+template <typename Vertex>
+static BBox3f computeBox(const Vertex vertices[], size_t count)
+{
+    BBox3f box(vertices[0].position);
+    for (size_t i = 1; i < count; i++)
+    {
+        box.grow(BBox3f(vertices[i].position));
+    }
+    return box;
+}
+
+/* Met les niveaux de détail d'une forme à la suite, en notant le premier sommet et le nombre de sommets de chacun */
+template <typename Shape>
+static std::vector<ShapeVertex> packLods(const Shape (&levels)[SCENE_LOD_COUNT], GLint first[], GLsizei count[])
+{
+    std::vector<ShapeVertex> vertices;
+    for (int lod = 0; lod < SCENE_LOD_COUNT; lod++)
+    {
+        first[lod] = GLint(vertices.size());
+        count[lod] = levels[lod].getVertexCount();
+        vertices.insert(vertices.end(), levels[lod].getDataPointer(), levels[lod].getDataPointer() + count[lod]);
+    }
+    return vertices;
+}
+
+/* Sommets pour le vertex pulling, avec les valeurs que lisait le vertex shader pour les attributs absents du VAO :
+ * (0, 0, 0, 1) par défaut, soit une couleur noire opaque pour les formes, une normale et des coordonnées nulles
+ * pour le piédestal et le tronc */
+static std::vector<Vertex3DColor> toPulledVertices(const std::vector<ShapeVertex> &vertices)
+{
+    std::vector<Vertex3DColor> pulled;
+    pulled.reserve(vertices.size());
+    for (const ShapeVertex &vertex : vertices)
+    {
+        pulled.emplace_back(vertex.position, vertex.normal, glm::vec4(0.f, 0.f, 0.f, 1.f), vertex.texCoords);
+    }
+    return pulled;
+}
+
+static std::vector<Vertex3DColor> toPulledVerticesWithoutNormals(const Vertex3DColor vertices[], size_t count)
+{
+    std::vector<Vertex3DColor> pulled;
+    pulled.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        pulled.emplace_back(vertices[i].position, glm::vec3(0.f), vertices[i].color, glm::vec2(0.f));
+    }
+    return pulled;
+}
+
+static float calculateDistance(const glm::vec3 &cameraPosition, const glm::vec3 &objectPosition)
+{
+    return glm::length(cameraPosition - objectPosition);
+}
+
+/* Face de cubemap décodée par stb_image */
+struct CubemapFace
+{
+    unsigned char *data = nullptr;
+    int width = 0, height = 0, nrChannels = 0;
+};
+
+static Texture loadCubemap(std::vector<std::string> faces)
+{
+    // Les faces sont décodées en parallèle, l'envoi au GPU reste sur le thread du contexte GL
+    std::vector<std::future<CubemapFace>> decoded;
+    for (const auto &face : faces)
+    {
+        decoded.push_back(std::async(std::launch::async, [face]()
+        {
+            GLIMAC_PROFILE_THREAD("image loader");
+            GLIMAC_PROFILE_ZONE("decode cubemap face");
+            CubemapFace result;
+            result.data = stbi_load(face.c_str(), &result.width, &result.height, &result.nrChannels, 0);
+            return result;
+        }));
+    }
+
+    // Load cubemap for skybox
+    Texture texture(GL_TEXTURE_CUBE_MAP, GLMemoryCategory::TEXTURES, "skybox");
+    bool allocated = false;
+
+    for (unsigned int i = 0; i < faces.size(); i++)
+    {
+        CubemapFace face = decoded[i].get();
+        if (face.data)
+        {
+            // Toutes les faces ont la taille de la première chargée
+            if (!allocated)
+            {
+                texture.setStorage2D(1, GL_RGB8, face.width, face.height);
+                allocated = true;
+            }
+            texture.setSubImage2D(0, face.width, face.height, GL_RGB, GL_UNSIGNED_BYTE, face.data, i);
+            stbi_image_free(face.data);
+        }
+        else
+        {
+            GLIMAC_LOG_ERROR("Cubemap texture failed to load at path: {}", faces[i]);
+            stbi_image_free(face.data);
+        }
+    }
+    texture.setParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    texture.setParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    texture.setParameter(GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    texture.setParameter(GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    texture.setParameter(GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    return texture;
+}
+
+/* Décode une image dans un thread de chargement */
+static std::future<std::unique_ptr<Image>> loadImageAsync(const FilePath &filepath)
+{
+    return std::async(std::launch::async, [filepath]()
+    {
+        GLIMAC_PROFILE_THREAD("image loader");
+        return loadImage(filepath);
+    });
+}
+
+static Texture loadTexture(const Image &image, const char *label)
+{
+    Texture texture(GL_TEXTURE_2D, GLMemoryCategory::TEXTURES, label);
+    texture.setStorage2D(1, GL_RGBA8, image.getWidth(), image.getHeight());
+    texture.setSubImage2D(0, image.getWidth(), image.getHeight(), GL_RGBA, GL_FLOAT, image.getPixels());
+    texture.setParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    texture.setParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return texture;
+}
+
+/* Bloc DrawData du programme, s'il en a un, lié au point de liaison des matrices par objet */
+static void bindDrawDataBlock(const Program &program)
+{
+    GLuint blockIndex = GL::getUniformBlockIndex(program.getGLId(), "DrawData");
+    if (blockIndex != GL_INVALID_INDEX)
+    {
+        GL::uniformBlockBinding(program.getGLId(), blockIndex, DRAW_DATA_BINDING);
+    }
+}
+
+Scene::Scene(const FilePath &applicationPath)
+    : applicationPath(applicationPath),
+      frameArena(FRAME_ARENA_CAPACITY),
+      skyboxProgram(loadProgram(applicationPath.dirPath() + "../src/shaders/skybox.vs.glsl",
+                                applicationPath.dirPath() + "../src/shaders/skybox.fs.glsl")),
+      room1Program(loadProgram(applicationPath.dirPath() + "../src/shaders/room1.vs.glsl",
+                               applicationPath.dirPath() + "../src/shaders/room1.fs.glsl")),
+      room2Program(loadProgram(applicationPath.dirPath() + "../src/shaders/room2.vs.glsl",
+                               applicationPath.dirPath() + "../src/shaders/room2.fs.glsl")),
+      debugProgram(loadProgram(applicationPath.dirPath() + "../src/shaders/debug.vs.glsl",
+                               applicationPath.dirPath() + "../src/shaders/debug.fs.glsl")),
+      heatmapProgram(loadProgram(applicationPath.dirPath() + "../src/shaders/heatmap.vs.glsl",
+                                 applicationPath.dirPath() + "../src/shaders/heatmap.fs.glsl"))
+{
+    room1Uniforms = getUniforms(room1Program);
+    room2Uniforms = getUniforms(room2Program);
+    debugUniforms = getUniforms(debugProgram);
+    for (const Program *program : {&room1Program, &room2Program, &debugProgram})
+    {
+        bindDrawDataBlock(*program);
+    }
+
+    // Mêmes fragment shaders, sommets lus dans un SSBO
+    if (isVertexPullingSupported())
+    {
+        const FilePath pulledVertexShader = applicationPath.dirPath() + "../src/shaders/pulled.vs.glsl";
+        room1PulledProgram = loadProgram(pulledVertexShader, applicationPath.dirPath() + "../src/shaders/room1.fs.glsl");
+        room2PulledProgram = loadProgram(pulledVertexShader, applicationPath.dirPath() + "../src/shaders/room2.fs.glsl");
+        debugPulledProgram = loadProgram(pulledVertexShader, applicationPath.dirPath() + "../src/shaders/debug.fs.glsl");
+        room1PulledUniforms = getUniforms(room1PulledProgram);
+        room2PulledUniforms = getUniforms(room2PulledProgram);
+        debugPulledUniforms = getUniforms(debugPulledProgram);
+        for (const Program *program : {&room1PulledProgram, &room2PulledProgram, &debugPulledProgram})
+        {
+            bindDrawDataBlock(*program);
+        }
+    }
+}
+
+Scene::ProgramUniforms Scene::getUniforms(const Program &program)
+{
+    ProgramUniforms uniforms;
+    uniforms.texture = GL::getUniformLocation(program.getGLId(), "uTexture");
+    uniforms.isCone = GL::getUniformLocation(program.getGLId(), "isCone");
+    uniforms.instanced = GL::getUniformLocation(program.getGLId(), "uInstanced");
+    uniforms.color = GL::getUniformLocation(program.getGLId(), "uColor");
+    return uniforms;
+}
+
+bool Scene::init()
+{
+    GLIMAC_PROFILE_ZONE("init scene");
+
+    // Load images
+    auto woodLoader = loadImageAsync(WOOD_TEXTURE_PATH);
+    auto treeLoader = loadImageAsync(TREE_TEXTURE_PATH);
+    auto ballLoader = loadImageAsync(BALL_TEXTURE_PATH);
+    std::unique_ptr<Image> wood = woodLoader.get();
+    std::unique_ptr<Image> tree = treeLoader.get();
+    std::unique_ptr<Image> ball = ballLoader.get();
+
+    if (wood == nullptr || tree == nullptr || ball == nullptr)
+    {
+        return false;
+    }
+
+    // Load texture
+    woodTexture = loadTexture(*wood, "wood");
+    treeTexture = loadTexture(*tree, "tree");
+    ballTexture = loadTexture(*ball, "ball");
+
+    /*********
+     * FLOOR
+     *********/
+
+    Vertex3DColor floorVertices[] = {
+        Vertex3DColor(glm::vec3(-12.f, -21.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.25f, 0.2f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(12.f, -21.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.25f, 0.2f, 1.f), glm::vec2(1.f, 0.f)),
+        Vertex3DColor(glm::vec3(12.f, 21.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.25f, 0.2f, 1.f), glm::vec2(1.f, 1.f)),
+        Vertex3DColor(glm::vec3(-12.f, 21.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.25f, 0.2f, 1.f), glm::vec2(0.f, 1.f)),
+        Vertex3DColor(glm::vec3(-12.f, -21.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.25f, 0.2f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(12.f, 21.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.25f, 0.2f, 1.f), glm::vec2(1.f, 1.f))};
+
+    initMesh(floorMesh, ROOM_FORMAT, "floor", floorVertices, sizeof(floorVertices));
+    floorMesh.box = computeBox(floorVertices, std::size(floorVertices));
+
+    /********
+     * WALLS
+     ********/
+
+    // Mur arrière
+    Vertex3DColor backWallVertices[] = {
+        Vertex3DColor(glm::vec3(-12.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(12.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 0.f)),
+        Vertex3DColor(glm::vec3(12.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f)),
+        Vertex3DColor(glm::vec3(-12.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 1.f)),
+        Vertex3DColor(glm::vec3(-12.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(12.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f))};
+
+    // Mur gauche
+    Vertex3DColor leftWallVertices[] = {
+        Vertex3DColor(glm::vec3(-10.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(10.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 0.f)),
+        Vertex3DColor(glm::vec3(10.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f)),
+        Vertex3DColor(glm::vec3(-10.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 1.f)),
+        Vertex3DColor(glm::vec3(-10.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(10.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f))};
+
+    // Mur droit
+    Vertex3DColor rightWallVertices[] = {
+        Vertex3DColor(glm::vec3(-10.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(10.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 0.f)),
+        Vertex3DColor(glm::vec3(10.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f)),
+        Vertex3DColor(glm::vec3(-10.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 1.f)),
+        Vertex3DColor(glm::vec3(-10.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(10.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f))};
+
+    // Mur petit
+    Vertex3DColor smallWallVertices[] = {
+        Vertex3DColor(glm::vec3(-5.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(5.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 0.f)),
+        Vertex3DColor(glm::vec3(5.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f)),
+        Vertex3DColor(glm::vec3(-5.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 1.f)),
+        Vertex3DColor(glm::vec3(-5.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(5.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f))};
+
+    // Mur de passage
+    Vertex3DColor leftPassageWallVertices[] = {
+        Vertex3DColor(glm::vec3(-1.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(1.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 0.f)),
+        Vertex3DColor(glm::vec3(1.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f)),
+        Vertex3DColor(glm::vec3(-1.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 1.f)),
+        Vertex3DColor(glm::vec3(-1.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(1.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f))};
+
+    Vertex3DColor rightPassageWallVertices[] = {
+        Vertex3DColor(glm::vec3(-1.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(1.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 0.f)),
+        Vertex3DColor(glm::vec3(1.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f)),
+        Vertex3DColor(glm::vec3(-1.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 1.f)),
+        Vertex3DColor(glm::vec3(-1.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(1.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f))};
+
+    // Un maillage par mur, tous du même format
+    initMesh(backWallMesh, ROOM_FORMAT, "back wall", backWallVertices, sizeof(backWallVertices));
+    initMesh(leftWallMesh, ROOM_FORMAT, "left wall", leftWallVertices, sizeof(leftWallVertices));
+    initMesh(rightWallMesh, ROOM_FORMAT, "right wall", rightWallVertices, sizeof(rightWallVertices));
+    initMesh(smallWallMesh, ROOM_FORMAT, "small wall", smallWallVertices, sizeof(smallWallVertices));
+    initMesh(leftPassageWallMesh, ROOM_FORMAT, "left passage wall", leftPassageWallVertices, sizeof(leftPassageWallVertices));
+    initMesh(rightPassageWallMesh, ROOM_FORMAT, "right passage wall", rightPassageWallVertices, sizeof(rightPassageWallVertices));
+
+    backWallMesh.box = computeBox(backWallVertices, std::size(backWallVertices));
+    leftWallMesh.box = computeBox(leftWallVertices, std::size(leftWallVertices));
+    rightWallMesh.box = computeBox(rightWallVertices, std::size(rightWallVertices));
+    smallWallMesh.box = computeBox(smallWallVertices, std::size(smallWallVertices));
+    leftPassageWallMesh.box = computeBox(leftPassageWallVertices, std::size(leftPassageWallVertices));
+    rightPassageWallMesh.box = computeBox(rightPassageWallVertices, std::size(rightPassageWallVertices));
+
+    /*********
+     * WINDOW
+     *********/
+
+    Vertex3DColor windowVertices[] = {
+        Vertex3DColor(glm::vec3(-0.5f, -0.5f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 1.f, 1.f, 0.15f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(0.5f, -0.5f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 1.f, 1.f, 0.15f), glm::vec2(1.f, 1.f)),
+        Vertex3DColor(glm::vec3(0.5f, 0.5f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 1.f, 1.f, 0.15f), glm::vec2(1.f, 1.f)),
+        Vertex3DColor(glm::vec3(-0.5f, 0.5f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 1.f, 1.f, 0.15f), glm::vec2(0.f, 1.f)),
+        Vertex3DColor(glm::vec3(-0.5f, -0.5f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 1.f, 1.f, 0.15f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(0.5f, 0.5f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 1.f, 1.f, 0.15f), glm::vec2(1.f, 1.f))};
+
+    initMesh(windowMesh, ROOM_FORMAT, "window", windowVertices, sizeof(windowVertices));
+    windowMesh.box = computeBox(windowVertices, std::size(windowVertices));
+
+    /***********
+     * PEDESTAL
+     ***********/
+
+    Vertex3DColor pedestalVertices[] = {
+        Vertex3DColor(glm::vec3(-1.f, -1.25f, -1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(1.f, -1.25f, -1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(1.f, 1.25f, -1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(-1.f, 1.25f, -1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(-1.f, -1.25f, 1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(1.f, -1.25f, 1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(1.f, 1.25f, 1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(-1.f, 1.25f, 1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(1.f, 1.f))};
+
+    GLuint pedestalIndices[] = {
+        0, 1, 2, 2, 3, 0, // Front face
+        4, 5, 6, 6, 7, 4, // Back face
+        0, 1, 5, 5, 4, 0, // Bottom face
+        2, 3, 7, 7, 6, 2, // Top face
+        0, 3, 7, 7, 4, 0, // Left face
+        1, 2, 6, 6, 5, 1  // Right face
+    };
+
+    initMesh(pedestalMesh, COLORED_FORMAT, "pedestal", pedestalVertices, sizeof(pedestalVertices), pedestalIndices, sizeof(pedestalIndices));
+    pedestalMesh.box = computeBox(pedestalVertices, std::size(pedestalVertices));
+
+    /*******
+     * CONE
+     ********/
+
+    // Niveaux de détail à la suite dans le VBO
+    const Cone coneLevels[SCENE_LOD_COUNT] = {Cone(2, 1.5f, 32, 16), Cone(2, 1.5f, 16, 8), Cone(2, 1.5f, 8, 4)};
+    std::vector<ShapeVertex> coneVertices = packLods(coneLevels, coneLods.first, coneLods.count);
+
+    // Matrice MVP par instance dans un deuxième buffer, remplie à chaque frame par flushConeInstances
+    if (isInstancingSupported())
+    {
+        instanceVBO = Buffer(GLMemoryCategory::STREAMING, "cone instances");
+        coneMesh.instances = &instanceVBO;
+    }
+    initMesh(coneMesh, isInstancingSupported() ? INSTANCED_SHAPE_FORMAT : SHAPE_FORMAT, "cone", coneVertices.data(),
+             coneVertices.size() * sizeof(ShapeVertex));
+    coneMesh.box = computeBox(coneVertices.data(), coneVertices.size());
+
+    /********
+     * TRUNK
+     ********/
+
+    Vertex3DColor trunkVertices[] = {
+        Vertex3DColor(glm::vec3(-0.2f, -1.f, -0.2f), glm::vec3(-1.f, 0.f, 0.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(0.2f, -1.f, -0.2), glm::vec3(-1.f, 0.f, 0.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(0.2f, 1.f, -0.2), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(-0.2f, 1.f, -0.2), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(-0.2f, -1.f, 0.2), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(0.2f, -1.f, 0.2), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(0.2f, 1.f, 0.2), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
+        Vertex3DColor(glm::vec3(-0.2f, 1.f, 0.2), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(1.f, 1.f))};
+
+    GLuint trunkIndices[] = {
+        0, 1, 2, 2, 3, 0, // Front face
+        4, 5, 6, 6, 7, 4, // Back face
+        0, 1, 5, 5, 4, 0, // Bottom face
+        2, 3, 7, 7, 6, 2, // Top face
+        0, 3, 7, 7, 4, 0, // Left face
+        1, 2, 6, 6, 5, 1  // Right face
+    };
+
+    initMesh(trunkMesh, COLORED_FORMAT, "trunk", trunkVertices, sizeof(trunkVertices), trunkIndices, sizeof(trunkIndices));
+    trunkMesh.box = computeBox(trunkVertices, std::size(trunkVertices));
+
+    /**********
+     * SPHERE
+     **********/
+    // Niveaux de détail à la suite dans le VBO
+    const Sphere sphereLevels[SCENE_LOD_COUNT] = {Sphere(1, 32, 16), Sphere(1, 16, 8), Sphere(1, 8, 4)};
+    std::vector<ShapeVertex> sphereVertices = packLods(sphereLevels, sphereLods.first, sphereLods.count);
+
+    initMesh(sphereMesh, SHAPE_FORMAT, "sphere", sphereVertices.data(), sphereVertices.size() * sizeof(ShapeVertex));
+    sphereMesh.box = computeBox(sphereVertices.data(), sphereVertices.size());
+
+    /**********
+     * SKYBOX
+     **********/
+
+    float skyboxVertices[] = {
+        -1.0f, 1.0f, -1.0f,
+        -1.0f, -1.0f, -1.0f,
+        1.0f, -1.0f, -1.0f,
+        1.0f, -1.0f, -1.0f,
+        1.0f, 1.0f, -1.0f,
+        -1.0f, 1.0f, -1.0f,
+
+        -1.0f, -1.0f, 1.0f,
+        -1.0f, -1.0f, -1.0f,
+        -1.0f, 1.0f, -1.0f,
+        -1.0f, 1.0f, -1.0f,
+        -1.0f, 1.0f, 1.0f,
+        -1.0f, -1.0f, 1.0f,
+
+        1.0f, -1.0f, -1.0f,
+        1.0f, -1.0f, 1.0f,
+        1.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, -1.0f,
+        1.0f, -1.0f, -1.0f,
+
+        -1.0f, -1.0f, 1.0f,
+        -1.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 1.0f,
+        1.0f, -1.0f, 1.0f,
+        -1.0f, -1.0f, 1.0f,
+
+        -1.0f, 1.0f, -1.0f,
+        1.0f, 1.0f, -1.0f,
+        1.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 1.0f,
+        -1.0f, 1.0f, 1.0f,
+        -1.0f, 1.0f, -1.0f,
+
+        -1.0f, -1.0f, -1.0f,
+        -1.0f, -1.0f, 1.0f,
+        1.0f, -1.0f, -1.0f,
+        1.0f, -1.0f, -1.0f,
+        -1.0f, -1.0f, 1.0f,
+        1.0f, -1.0f, 1.0f};
+
+    // Load skybox textures
+    std::vector<std::string> faces{
+        applicationPath.dirPath() + "/assets/skybox/right.jpg",
+        applicationPath.dirPath() + "/assets/skybox/left.jpg",
+        applicationPath.dirPath() + "/assets/skybox/top.jpg",
+        applicationPath.dirPath() + "/assets/skybox/bottom.jpg",
+        applicationPath.dirPath() + "/assets/skybox/front.jpg",
+        applicationPath.dirPath() + "/assets/skybox/back.jpg"};
+
+    cubemapTexture = loadCubemap(faces);
+
+    initMesh(skyboxMesh, POSITION_FORMAT, "skybox", skyboxVertices, sizeof(skyboxVertices));
+
+    /*****************
+     * VERTEX PULLING
+     *****************/
+
+    // Les mêmes maillages à la suite dans un SSBO (indices décalés de leur premier sommet) : un seul VAO pour tous
+    if (isVertexPullingSupported())
+    {
+        std::vector<Vertex3DColor> pulledVertices;
+        std::vector<GLuint> pulledIndices;
+        auto addPulledMesh = [&](Mesh &mesh, const std::vector<Vertex3DColor> &vertices, const GLuint indices[], size_t indexCount)
+        {
+            mesh.pulled = {GLint(pulledVertices.size()), GLintptr(pulledIndices.size() * sizeof(GLuint))};
+            pulledVertices.insert(pulledVertices.end(), vertices.begin(), vertices.end());
+            for (size_t i = 0; i < indexCount; i++)
+            {
+                pulledIndices.push_back(GLuint(mesh.pulled.first) + indices[i]);
+            }
+        };
+        auto addPulledRec = [&](Mesh &mesh, const Vertex3DColor (&vertices)[6])
+        {
+            addPulledMesh(mesh, std::vector<Vertex3DColor>(std::begin(vertices), std::end(vertices)), nullptr, 0);
+        };
+
+        addPulledRec(floorMesh, floorVertices);
+        addPulledRec(backWallMesh, backWallVertices);
+        addPulledRec(leftWallMesh, leftWallVertices);
+        addPulledRec(rightWallMesh, rightWallVertices);
+        addPulledRec(smallWallMesh, smallWallVertices);
+        addPulledRec(leftPassageWallMesh, leftPassageWallVertices);
+        addPulledRec(rightPassageWallMesh, rightPassageWallVertices);
+        addPulledRec(windowMesh, windowVertices);
+        addPulledMesh(pedestalMesh, toPulledVerticesWithoutNormals(pedestalVertices, std::size(pedestalVertices)), pedestalIndices, std::size(pedestalIndices));
+        addPulledMesh(trunkMesh, toPulledVerticesWithoutNormals(trunkVertices, std::size(trunkVertices)), trunkIndices, std::size(trunkIndices));
+        addPulledMesh(coneMesh, toPulledVertices(coneVertices), nullptr, 0);
+        addPulledMesh(sphereMesh, toPulledVertices(sphereVertices), nullptr, 0);
+
+        pulledVertexBuffer = Buffer(GLMemoryCategory::VERTICES, "vertex pulling");
+        pulledVertexBuffer.setData(pulledVertices.size() * sizeof(Vertex3DColor), pulledVertices.data(), GL_STATIC_DRAW);
+
+        // Le VAO ne garde que les indices et les matrices des cônes instanciés
+        pullingVAO = VertexArray("vertex pulling");
+        pulledIndexBuffer = Buffer(GLMemoryCategory::INDICES, "vertex pulling");
+        pulledIndexBuffer.setData(pulledIndices.size() * sizeof(GLuint), pulledIndices.data(), GL_STATIC_DRAW);
+        pullingVAO.bind();
+        pulledIndexBuffer.bind(GL_ELEMENT_ARRAY_BUFFER);
+        INSTANCES_FORMAT.apply();
+        GL::bindVertexBuffer(0, instanceVBO.getGLId(), 0, INSTANCES_FORMAT.getStride(0));
+        GL::bindVertexArray(0);
+    }
+
+    /**********
+     * DEBUG
+     **********/
+
+    // Les 12 arêtes du cube [0, 1]^3, mis à l'échelle de chaque boîte englobante
+    std::vector<glm::vec3> boxVertices;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        for (int corner = 0; corner < 4; corner++)
+        {
+            glm::vec3 start(0.f);
+            start[(axis + 1) % 3] = float(corner & 1);
+            start[(axis + 2) % 3] = float(corner >> 1);
+            glm::vec3 end = start;
+            end[axis] = 1.f;
+            boxVertices.push_back(start);
+            boxVertices.push_back(end);
+        }
+    }
+    initMesh(boxMesh, POSITION_FORMAT, "culling box", boxVertices.data(), boxVertices.size() * sizeof(glm::vec3));
+    screenVAO = VertexArray("fullscreen triangle");
+    screenVAO.bind();
+    GL::bindVertexArray(0);
+
+    // Matrices par objet : projeté en permanence avec GL_ARB_buffer_storage, sinon glBufferSubData à chaque objet
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &drawDataAlignment);
+    drawDataBuffer = StreamBuffer(DRAW_DATA_REGION_SIZE, "draw data");
+
+    GL::enable(GL_DEPTH_TEST);
+
+    return true;
+}
+
+void Scene::render(float time, int width, int height)
+{
+    GLIMAC_PROFILE_ZONE("render scene");
+    GLIMAC_ALLOCATION_TAG("render scene");
+    stats = SceneStats();
+    profiler.beginFrame();
+    frameArena.beginFrame();
+    drawDataBuffer.beginFrame();
+    uniforms = nullptr; // Choisi avec le programme des objets, après la skybox
+
+    // La vue OVERDRAW dessine dans sa propre cible, puis dans le framebuffer courant (celui de HeadlessContext hors écran)
+    GLint targetFramebuffer = 0;
+    if (debugView == DebugView::OVERDRAW)
+    {
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFramebuffer);
+        beginOverdraw(width, height);
+    }
+
+    GL::viewport(0, 0, width, height);
+
+    GL::clearColor(0.f, 0.f, 0.f, 1.f);
+    GL::clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    /*****************
+     * RENDERING CODE
+     *****************/
+
+    glm::mat4 ViewMatrix = camera.getViewMatrix();
+    glm::mat4 ProjMatrix = glm::perspective(glm::radians(70.f), (float)width / height, 0.1f, 100.f);
+    glm::mat4 MVMatrix = glm::translate(ViewMatrix, glm::vec3(0, 0, 0));
+    lodScale = lodProjectionScale(glm::radians(70.f), float(height));
+
+    // Vue CULLING : les objets sont testés contre le frustum de la caméra au moment où la vue a été choisie
+    cullResults.clear();
+    if (debugView == DebugView::CULLING)
+    {
+        if (!cullingFrozen)
+        {
+            cullingViewMatrix = ViewMatrix;
+            cullingFrozen = true;
+        }
+        cullingCorrection = cullingViewMatrix * glm::inverse(ViewMatrix);
+    }
+    else
+    {
+        cullingFrozen = false;
+        cullingCorrection = glm::mat4(1.f);
+    }
+
+    /* Skybox, sans intérêt pour le nombre de couches */
+    if (debugView != DebugView::OVERDRAW)
+    {
+        GPUProfiler::Scope scope(profiler, "skybox");
+        GLIMAC_ALLOCATION_TAG("skybox");
+        GL::depthFunc(GL_LEQUAL);
+        skyboxProgram.use();
+        glm::mat4 view = glm::mat4(glm::mat3(camera.getViewMatrix()));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / height, 0.1f, 100.0f);
+        GL::uniformMatrix4fv(GL::getUniformLocation(skyboxProgram.getGLId(), "view"), 1, GL_FALSE, glm::value_ptr(view));
+        GL::uniformMatrix4fv(GL::getUniformLocation(skyboxProgram.getGLId(), "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+        bindMesh(skyboxMesh);
+        cubemapTexture.bind();
+        drawArrays(0, 36);
+        GL::depthFunc(GL_LESS);
+    }
+
+    /*******************
+     * SHADER SELECTION
+     *******************/
+
+    room1 = camera.getPosition().z > -17;
+    vertexPulling = settings.vertexPulling && isVertexPullingSupported();
+    bool debugColors = debugView == DebugView::OVERDRAW || debugView == DebugView::LOD || debugView == DebugView::DRAW_ID;
+    if (debugColors)
+    {
+        // Une couche vaut 1 dans la cible R32F ; les autres vues changent de couleur à chaque appel
+        (vertexPulling ? debugPulledProgram : debugProgram).use();
+        uniforms = vertexPulling ? &debugPulledUniforms : &debugUniforms;
+        GL::uniform1i(uniforms->instanced, GL_FALSE);
+        GL::uniform3fv(uniforms->color, 1, glm::value_ptr(glm::vec3(1.f)));
+    }
+    else if (room1)
+    {
+        const Program &program = vertexPulling ? room1PulledProgram : room1Program;
+        program.use();
+        uniforms = vertexPulling ? &room1PulledUniforms : &room1Uniforms;
+
+        // World space
+        glm::vec3 lightPos1_world = glm::vec3(8.0f * cos(time), 0.f, -5.0f + 8.0f * sin(time));
+        glm::vec3 lightPos2_world = glm::vec3(8.f, 2.f, -12.f);
+
+        // View
+        glm::vec3 lightPos1_vs = glm::vec3(ViewMatrix * glm::vec4(lightPos1_world, 1.0f));
+        glm::vec3 lightPos2_vs = glm::vec3(ViewMatrix * glm::vec4(lightPos2_world, 1.0f));
+
+        // Light uniforms
+        GLint uLightPos1_vs = GL::getUniformLocation(program.getGLId(), "uLightPos1_vs");
+        GLint uLightIntensity1 = GL::getUniformLocation(program.getGLId(), "uLightIntensity1");
+        GLint uLightPos2_vs = GL::getUniformLocation(program.getGLId(), "uLightPos2_vs");
+        GLint uLightIntensity2 = GL::getUniformLocation(program.getGLId(), "uLightIntensity2");
+
+        // Light intensity
+        glm::vec3 lightIntensity1;
+        (light) ? lightIntensity1 = glm::vec3(1.0f, 0.5f, 0.0f) : lightIntensity1 = glm::vec3(0.0f, 0.0f, 0.0f);
+        glm::vec3 lightIntensity2 = glm::vec3(0.0f, 0.5f, 1.0f);
+
+        // Light uniforms
+        GL::uniform3fv(uLightPos1_vs, 1, glm::value_ptr(lightPos1_vs));
+        GL::uniform3fv(uLightIntensity1, 1, glm::value_ptr(lightIntensity1));
+        GL::uniform3fv(uLightPos2_vs, 1, glm::value_ptr(lightPos2_vs));
+        GL::uniform3fv(uLightIntensity2, 1, glm::value_ptr(lightIntensity2));
+
+        // Set material uniforms
+        GLint uKd = GL::getUniformLocation(program.getGLId(), "uKd");
+        GLint uKs = GL::getUniformLocation(program.getGLId(), "uKs");
+        GLint uShininess = GL::getUniformLocation(program.getGLId(), "uShininess");
+
+        glm::vec3 Kd = glm::vec3(0.8f, 0.8f, 0.8f);
+        glm::vec3 Ks = glm::vec3(0.5f, 0.5f, 0.5f);
+        float shininess = 50.0f;
+
+        GL::uniform3fv(uKd, 1, glm::value_ptr(Kd));
+        GL::uniform3fv(uKs, 1, glm::value_ptr(Ks));
+        GL::uniform1f(uShininess, shininess);
+    }
+    else
+    {
+        (vertexPulling ? room2PulledProgram : room2Program).use();
+        uniforms = vertexPulling ? &room2PulledUniforms : &room2Uniforms;
+    }
+
+    // Lié une fois pour tous les objets
+    if (vertexPulling)
+    {
+        pullingVAO.bind();
+        GL::bindBufferBase(GL_SHADER_STORAGE_BUFFER, PULLED_VERTICES_BINDING, pulledVertexBuffer.getGLId());
+    }
+
+    /*****************
+     * SCENE GEOMETRY
+     *****************/
+
+    {
+        GPUProfiler::Scope scope(profiler, "walls");
+        GLIMAC_ALLOCATION_TAG("walls");
+
+        /* Floor */
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(0, -3, -17));
+        MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(1, 0, 0));
+        (room1)
+            ? drawRec(floorMesh, MVMatrix, ProjMatrix, woodTexture)
+            : drawRec2(floorMesh, MVMatrix, ProjMatrix);
+
+        /* Room 1 Back wall */
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(0, 0, 4));
+        (room1)
+            ? drawRec(backWallMesh, MVMatrix, ProjMatrix, woodTexture)
+            : drawRec2(backWallMesh, MVMatrix, ProjMatrix);
+
+        /* Room 1 Left wall */
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(-12, 0, -6));
+        MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 1, 0));
+        (room1)
+            ? drawRec(leftWallMesh, MVMatrix, ProjMatrix, woodTexture)
+            : drawRec2(leftWallMesh, MVMatrix, ProjMatrix);
+
+        /* Room 1 Right wall */
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(12, 0, -6));
+        MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 1, 0));
+        (room1)
+            ? drawRec(rightWallMesh, MVMatrix, ProjMatrix, woodTexture)
+            : drawRec2(rightWallMesh, MVMatrix, ProjMatrix);
+
+        /* Room 1 Small left wall */
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(-7, 0, -16));
+        (room1)
+            ? drawRec(smallWallMesh, MVMatrix, ProjMatrix, woodTexture)
+            : drawRec2(smallWallMesh, MVMatrix, ProjMatrix);
+
+        /* Room 1 Small right wall */
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, 0, -16));
+        (room1)
+            ? drawRec(smallWallMesh, MVMatrix, ProjMatrix, woodTexture)
+            : drawRec2(smallWallMesh, MVMatrix, ProjMatrix);
+
+        /* Passage walls */
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(-2, 0, -17));
+        MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 1, 0));
+        (room1)
+            ? drawRec(leftPassageWallMesh, MVMatrix, ProjMatrix, woodTexture)
+            : drawRec2(leftPassageWallMesh, MVMatrix, ProjMatrix);
+
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(2, 0, -17));
+        MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 1, 0));
+        (room1)
+            ? drawRec(rightPassageWallMesh, MVMatrix, ProjMatrix, woodTexture)
+            : drawRec2(rightPassageWallMesh, MVMatrix, ProjMatrix);
+
+        /* Room 2 back wall */
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(0, 0, -38)); // Position in front
+        (room1)
+            ? drawRec(backWallMesh, MVMatrix, ProjMatrix, woodTexture)
+            : drawRec2(backWallMesh, MVMatrix, ProjMatrix);
+
+        /* Room 2 Left wall */
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(-12, 0, -28)); // Position in front
+        MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 1, 0));
+        (room1)
+            ? drawRec(leftWallMesh, MVMatrix, ProjMatrix, woodTexture)
+            : drawRec2(leftWallMesh, MVMatrix, ProjMatrix);
+
+        /* Room 2 Right wall */
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(12, 0, -28)); // Position in front
+        MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 1, 0));
+        (room1)
+            ? drawRec(rightWallMesh, MVMatrix, ProjMatrix, woodTexture)
+            : drawRec2(rightWallMesh, MVMatrix, ProjMatrix);
+
+        /* Room 2 Small left wall */
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(-7, 0, -18));
+        (room1)
+            ? drawRec(smallWallMesh, MVMatrix, ProjMatrix, woodTexture)
+            : drawRec2(smallWallMesh, MVMatrix, ProjMatrix);
+
+        /* Room 2 Small right wall */
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, 0, -18));
+        (room1)
+            ? drawRec(smallWallMesh, MVMatrix, ProjMatrix, woodTexture)
+            : drawRec2(smallWallMesh, MVMatrix, ProjMatrix);
+    }
+
+    /*****************
+     * ROOM 1 OBJECTS
+     *****************/
+    {
+        GPUProfiler::Scope scope(profiler, "room 1 objects");
+        GLIMAC_ALLOCATION_TAG("room 1 objects");
+
+        /* Tree */
+        drawCone(treeTexture, ViewMatrix, ProjMatrix, glm::vec3(-9.f, -0.15f, 1.f), glm::vec3(0.6f, 0.6f, 0.6f));
+        drawCone(treeTexture, ViewMatrix, ProjMatrix, glm::vec3(-9.f, -1, 1.f), glm::vec3(0.8f, 0.8f, 0.8f));
+        drawCone(treeTexture, ViewMatrix, ProjMatrix, glm::vec3(-9.f, -2, 1.f), glm::vec3(1.f, 1.f, 1.f));
+
+        /* Trunk */
+        MVMatrix = glm::translate(ViewMatrix, glm::vec3(-9.f, -2.f, 1.f));
+        if (isVisible(trunkMesh, MVMatrix, ProjMatrix))
+        {
+            bindMesh(trunkMesh);
+            setDrawData(ProjMatrix * MVMatrix);
+            drawElements(36);
+        }
+
+        /* Ball */
+        drawBalloon(time, ViewMatrix, ProjMatrix);
+    }
+
+    /*****************
+     * ROOM 2 OBJECTS
+     *****************/
+    {
+        GPUProfiler::Scope scope(profiler, "room 2 objects");
+        GLIMAC_ALLOCATION_TAG("room 2 objects");
+
+        /* Spikeball */
+        {
+            MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, -1, -32));
+            MVMatrix = glm::scale(MVMatrix, glm::vec3(1.05f, 1.05f, 1.05f));
+            if (isVisible(sphereMesh, MVMatrix, ProjMatrix))
+            {
+                int lod = selectLod(sphereMesh, MVMatrix);
+                bindMesh(sphereMesh);
+                setDrawData(ProjMatrix * MVMatrix);
+                drawArrays(sphereLods.first[lod], sphereLods.count[lod]);
+            }
+
+            MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, 0, -32));
+            MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
+            drawCone2(MVMatrix, ProjMatrix);
+
+            MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, -2, -32));
+            MVMatrix = glm::rotate(MVMatrix, glm::radians(180.f), glm::vec3(1, 0, 0));
+            MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
+            drawCone2(MVMatrix, ProjMatrix);
+
+            MVMatrix = glm::translate(ViewMatrix, glm::vec3(6, -1, -32));
+            MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 0, 1));
+            MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
+            drawCone2(MVMatrix, ProjMatrix);
+
+            MVMatrix = glm::translate(ViewMatrix, glm::vec3(8, -1, -32));
+            MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 0, -1));
+            MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
+            drawCone2(MVMatrix, ProjMatrix);
+
+            MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, -1, -31));
+            MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(1, 0, 0));
+            MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
+            drawCone2(MVMatrix, ProjMatrix);
+
+            MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, -1, -33));
+            MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(-1, 0, 0));
+            MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
+            drawCone2(MVMatrix, ProjMatrix);
+        }
+
+        /* Pedestal */
+        {
+            MVMatrix = glm::translate(ViewMatrix, glm::vec3(-6.f, -1.75f, -24.75));
+            if (isVisible(pedestalMesh, MVMatrix, ProjMatrix))
+            {
+                bindMesh(pedestalMesh);
+                setDrawData(ProjMatrix * MVMatrix);
+                drawElements(36);
+            }
+
+            MVMatrix = glm::translate(ViewMatrix, glm::vec3(-6.f, -0.5f, -24.75));
+            MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
+            drawCone2(MVMatrix, ProjMatrix);
+        }
+
+        /* Cônes instanciés, avant les fenêtres qui doivent être dessinées en dernier */
+        flushConeInstances();
+
+        /* Windows */
+        {
+            GPUProfiler::Scope scope(profiler, "windows");
+            GLIMAC_ALLOCATION_TAG("windows");
+
+            // Dans l'arène du frame : aucune allocation sur le tas
+            FrameVector<TransparentObject> transparentObjects(frameArena);
+            transparentObjects.reserve(4);
+            transparentObjects.push_back({&windowMesh, glm::vec3(-6, 0, -24), glm::translate(ViewMatrix, glm::vec3(-6, 0, -24))});
+            transparentObjects.push_back({&windowMesh, glm::vec3(-6, 0, -25.5), glm::translate(ViewMatrix, glm::vec3(-6, 0, -25.5))});
+            transparentObjects.push_back({&windowMesh, glm::vec3(-6.75f, 0, -24.75f), glm::rotate(glm::translate(ViewMatrix, glm::vec3(-6.75f, 0, -24.75f)), glm::radians(90.f), glm::vec3(0, 1, 0))});
+            transparentObjects.push_back({&windowMesh, glm::vec3(-5.25f, 0, -24.75f), glm::rotate(glm::translate(ViewMatrix, glm::vec3(-5.25f, 0, -24.75f)), glm::radians(90.f), glm::vec3(0, 1, 0))});
+
+            glm::vec3 cameraPosition = camera.getPosition();
+
+            std::sort(transparentObjects.begin(), transparentObjects.end(), [&cameraPosition](const TransparentObject &a, const TransparentObject &b)
+                      { return calculateDistance(cameraPosition, a.position) > calculateDistance(cameraPosition, b.position); });
+
+            // La vue OVERDRAW garde son mélange additif
+            bool overdraw = debugView == DebugView::OVERDRAW;
+            if (!overdraw)
+            {
+                GL::enable(GL_BLEND);
+                GL::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            }
+
+            for (const auto &obj : transparentObjects)
+            {
+                drawRec2(*obj.mesh, obj.modelMatrix, ProjMatrix);
+            }
+
+            if (!overdraw)
+            {
+                GL::disable(GL_BLEND);
+            }
+        }
+    }
+
+    unbindMeshes();
+    vertexPulling = false;
+
+    if (debugView == DebugView::OVERDRAW)
+    {
+        GPUProfiler::Scope scope(profiler, "overdraw resolve");
+        GLIMAC_ALLOCATION_TAG("overdraw resolve");
+        resolveOverdraw(GLuint(targetFramebuffer));
+    }
+    else if (debugView == DebugView::CULLING)
+    {
+        GPUProfiler::Scope scope(profiler, "culling boxes");
+        GLIMAC_ALLOCATION_TAG("culling boxes");
+        drawCullResults(ViewMatrix, ProjMatrix);
+    }
+
+    drawDataBuffer.endFrame();
+    profiler.endFrame();
+}
+
+const char *getDebugViewName(DebugView view)
+{
+    static const char *const NAMES[] = {"none", "wireframe", "overdraw", "lod", "draw-id", "culling"};
+    static_assert(std::size(NAMES) == size_t(DebugView::COUNT), "One name per debug view");
+    return NAMES[int(view)];
+}
+
+bool parseDebugView(const char *name, DebugView &view)
+{
+    for (int i = 0; i < int(DebugView::COUNT); i++)
+    {
+        if (!std::strcmp(name, getDebugViewName(DebugView(i))))
+        {
+            view = DebugView(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Scene::setDebugView(DebugView view)
+{
+    if ((view == DebugView::WIREFRAME) != (debugView == DebugView::WIREFRAME))
+    {
+        GL::polygonMode(GL_FRONT_AND_BACK, view == DebugView::WIREFRAME ? GL_LINE : GL_FILL);
+    }
+    debugView = view;
+}
+
+void Scene::nextDebugView()
+{
+    setDebugView(DebugView((int(debugView) + 1) % int(DebugView::COUNT)));
+}
+
+void Scene::beginOverdraw(int width, int height)
+{
+    if (!overdrawFBO.getGLId())
+    {
+        overdrawFBO = Framebuffer("overdraw");
+    }
+
+    overdrawFBO.bind(GL_FRAMEBUFFER);
+    if (width != overdrawWidth || height != overdrawHeight)
+    {
+        // Stockage immuable : une nouvelle texture à chaque taille
+        overdrawTexture = Texture(GL_TEXTURE_2D, GLMemoryCategory::RENDER_TARGETS, "overdraw");
+        overdrawTexture.setStorage2D(1, GL_R32F, width, height);
+        overdrawTexture.setParameter(GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        overdrawTexture.setParameter(GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        GL::framebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, overdrawTexture.getGLId(), 0);
+        overdrawWidth = width;
+        overdrawHeight = height;
+    }
+
+    // Chaque fragment ajoute 1, qu'il soit devant ou derrière les autres : c'est la complexité en profondeur
+    GL::disable(GL_DEPTH_TEST);
+    GL::enable(GL_BLEND);
+    GL::blendFunc(GL_ONE, GL_ONE);
+}
+
+void Scene::resolveOverdraw(GLuint framebuffer)
+{
+    GL::disable(GL_BLEND);
+    GL::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    heatmapProgram.use();
+    GL::activeTexture(GL_TEXTURE0);
+    overdrawTexture.bind();
+    screenVAO.bind();
+    GL::drawArrays(GL_TRIANGLES, 0, 3);
+    GL::bindVertexArray(0);
+    GL::bindTexture(GL_TEXTURE_2D, 0);
+
+    GL::enable(GL_DEPTH_TEST);
+}
+
+void Scene::drawCullResults(const glm::mat4 &ViewMatrix, const glm::mat4 &ProjMatrix)
+{
+    // Par dessus la scène, y compris les boîtes cachées par les murs
+    GL::disable(GL_DEPTH_TEST);
+    debugProgram.use();
+    GL::uniform1i(debugUniforms.instanced, GL_FALSE);
+    bindMesh(boxMesh);
+
+    const glm::vec3 visibleColor(0.2f, 1.f, 0.2f), culledColor(1.f, 0.2f, 0.2f);
+    for (const CullResult &result : cullResults)
+    {
+        glm::mat4 boxMatrix = glm::scale(glm::translate(result.MVPMatrix, result.box.lower), result.box.upper - result.box.lower);
+        setDrawData(boxMatrix);
+        GL::uniform3fv(debugUniforms.color, 1, glm::value_ptr(result.visible ? visibleColor : culledColor));
+        GL::drawArrays(GL_LINES, 0, 24);
+    }
+
+    // Frustum figé : le cube [-1, 1]^3 de l'espace de découpage ramené dans le monde
+    glm::mat4 frustumMatrix = ProjMatrix * ViewMatrix * glm::inverse(ProjMatrix * cullingViewMatrix);
+    frustumMatrix = glm::scale(glm::translate(frustumMatrix, glm::vec3(-1.f)), glm::vec3(2.f));
+    setDrawData(frustumMatrix);
+    GL::uniform3fv(debugUniforms.color, 1, glm::value_ptr(glm::vec3(1.f, 1.f, 0.2f)));
+    GL::drawArrays(GL_LINES, 0, 24);
+
+    unbindMeshes();
+    GL::enable(GL_DEPTH_TEST);
+}
+
+void Scene::toggleLight()
+{
+    light = !light;
+}
+
+void Scene::toggleBallAnimation(float time)
+{
+    if (animateBall)
+    {
+        lastTime = time;
+    }
+    else
+    {
+        ballTimeOffset += time - lastTime;
+    }
+    animateBall = !animateBall;
+}
+
+bool Scene::isInstancingSupported()
+{
+    return GLAD_GL_VERSION_4_2;
+}
+
+bool Scene::isVertexPullingSupported()
+{
+    return GLAD_GL_VERSION_4_3;
+}
+
+bool Scene::hasTextures()
+{
+    for (const char *path : {WOOD_TEXTURE_PATH, TREE_TEXTURE_PATH, BALL_TEXTURE_PATH})
+    {
+        if (!std::ifstream(path))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Scene::isVisible(const Mesh &mesh, const glm::mat4 &MVMatrix, const glm::mat4 &ProjMatrix)
+{
+    stats.objects++;
+    drawLod = -1;
+    // Plans du frustum dans l'espace de l'objet : la boîte des sommets est testée sans être transformée
+    bool visible = !settings.culling || Frustum(ProjMatrix * cullingCorrection * MVMatrix).intersects(mesh.box);
+    if (debugView == DebugView::CULLING)
+    {
+        cullResults.push_back({ProjMatrix * MVMatrix, mesh.box, visible});
+    }
+    if (!visible)
+    {
+        stats.culledObjects++;
+    }
+    return visible;
+}
+
+int Scene::selectLod(const Mesh &mesh, const glm::mat4 &MVMatrix)
+{
+    // Sphère englobant la boîte, avec la plus grande échelle de la matrice
+    const BBox3f &box = mesh.box;
+    glm::vec3 viewCenter = glm::vec3(MVMatrix * glm::vec4(center(box), 1.f));
+    float scale = std::max(glm::length(glm::vec3(MVMatrix[0])), std::max(glm::length(glm::vec3(MVMatrix[1])), glm::length(glm::vec3(MVMatrix[2]))));
+    float radius = 0.5f * glm::length(box.upper - box.lower) * scale;
+
+    float pixels = radius * lodScale / std::max(glm::length(viewCenter), 0.01f) * std::exp2(-settings.lodBias);
+    int lod = 0;
+    while (lod < SCENE_LOD_COUNT - 1 && pixels < LOD_MIN_PIXELS[lod])
+    {
+        lod++;
+    }
+    stats.lodObjects[lod]++;
+    drawLod = lod;
+    return lod;
+}
+
+void Scene::flushConeInstances()
+{
+    instanceData.clear();
+    for (const auto &instances : coneInstances)
+    {
+        instanceData.insert(instanceData.end(), instances.begin(), instances.end());
+    }
+    if (instanceData.empty())
+    {
+        return;
+    }
+
+    instanceVBO.setData(instanceData.size() * sizeof(glm::mat4), instanceData.data(), GL_STREAM_DRAW);
+
+    GL::uniform1i(uniforms->instanced, GL_TRUE);
+    if (uniforms->isCone >= 0)
+    {
+        GL::uniform1i(uniforms->isCone, GL_TRUE);
+    }
+
+    // Un appel par niveau de détail, les instances d'un niveau se suivent dans le buffer
+    bindMesh(coneMesh);
+    GLuint baseInstance = 0;
+    for (int lod = 0; lod < SCENE_LOD_COUNT; lod++)
+    {
+        GLsizei instanceCount = GLsizei(coneInstances[lod].size());
+        if (instanceCount > 0)
+        {
+            setDebugColor(lod);
+            GL::drawArraysInstancedBaseInstance(GL_TRIANGLES, boundMesh.first + coneLods.first[lod], coneLods.count[lod], instanceCount, baseInstance);
+            stats.drawCalls++;
+            stats.triangles += coneLods.count[lod] / 3 * instanceCount;
+            baseInstance += instanceCount;
+        }
+        coneInstances[lod].clear();
+    }
+
+    if (uniforms->isCone >= 0)
+    {
+        GL::uniform1i(uniforms->isCone, GL_FALSE);
+    }
+    GL::uniform1i(uniforms->instanced, GL_FALSE);
+}
+
+void Scene::setDrawData(const glm::mat4 &MVPMatrix)
+{
+    setDrawData(MVPMatrix, drawData.MVMatrix, drawData.NormalMatrix);
+}
+
+void Scene::setDrawData(const glm::mat4 &MVPMatrix, const glm::mat4 &MVMatrix, const glm::mat4 &NormalMatrix)
+{
+    drawData = {MVPMatrix, MVMatrix, NormalMatrix};
+
+    // Écrit directement dans la mémoire du GPU quand le buffer est projeté en permanence
+    GLintptr offset;
+    void *data = drawDataBuffer.allocate(sizeof(DrawData), size_t(drawDataAlignment), offset);
+    std::memcpy(data, &drawData, sizeof(DrawData));
+    drawDataBuffer.commit(offset, sizeof(DrawData));
+    GL::bindBufferRange(GL_UNIFORM_BUFFER, DRAW_DATA_BINDING, drawDataBuffer.getGLId(), offset, sizeof(DrawData));
+}
+
+void Scene::initMesh(Mesh &mesh, const VertexFormat &format, const char *label, const void *vertices, GLsizeiptr size,
+                     const GLuint indices[], GLsizeiptr indicesSize)
+{
+    mesh.format = &format;
+    mesh.vbo = Buffer(GLMemoryCategory::VERTICES, label);
+    mesh.vbo.setData(size, vertices, GL_STATIC_DRAW);
+    if (indices)
+    {
+        mesh.ebo = Buffer(GLMemoryCategory::INDICES, label);
+        mesh.ebo.setData(indicesSize, indices, GL_STATIC_DRAW);
+    }
+
+    if (isVertexAttribBindingSupported())
+    {
+        // Les buffers du maillage sont attachés au VAO du format par bindMesh, les indices compris
+        mesh.vao = &vertexArrays.get(format, "vertex format");
+    }
+    else
+    {
+        mesh.ownVAO = VertexArray(label);
+        mesh.ownVAO.bind();
+        const GLuint buffers[] = {mesh.vbo.getGLId(), mesh.instances ? mesh.instances->getGLId() : 0};
+        format.apply(buffers);
+        if (indices)
+        {
+            mesh.ebo.bind(GL_ELEMENT_ARRAY_BUFFER);
+        }
+        GL::bindVertexArray(0);
+        mesh.vao = &mesh.ownVAO;
+    }
+}
+
+void Scene::bindMesh(const Mesh &mesh)
+{
+    if (vertexPulling)
+    {
+        boundMesh = mesh.pulled;
+        return;
+    }
+    boundMesh = {0, 0};
+    if (&mesh == boundVertexMesh)
+    {
+        return;
+    }
+
+    if (mesh.vao->getGLId() != boundVertexArray)
+    {
+        mesh.vao->bind();
+        boundVertexArray = mesh.vao->getGLId();
+    }
+    if (mesh.vao != &mesh.ownVAO)
+    {
+        GL::bindVertexBuffer(0, mesh.vbo.getGLId(), 0, mesh.format->getStride(0));
+        if (mesh.instances)
+        {
+            GL::bindVertexBuffer(1, mesh.instances->getGLId(), 0, mesh.format->getStride(1));
+        }
+        if (mesh.ebo.getGLId())
+        {
+            mesh.ebo.bind(GL_ELEMENT_ARRAY_BUFFER);
+        }
+    }
+    boundVertexMesh = &mesh;
+}
+
+void Scene::unbindMeshes()
+{
+    GL::bindVertexArray(0);
+    boundVertexArray = 0;
+    boundVertexMesh = nullptr;
+}
+
+void Scene::drawArrays(GLint first, GLsizei count)
+{
+    setDebugColor(drawLod);
+    GL::drawArrays(GL_TRIANGLES, boundMesh.first + first, count);
+    stats.drawCalls++;
+    stats.triangles += count / 3;
+}
+
+void Scene::drawElements(GLsizei count)
+{
+    setDebugColor(drawLod);
+    GL::drawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (const GLvoid *)boundMesh.indexOffset);
+    stats.drawCalls++;
+    stats.triangles += count / 3;
+}
+
+void Scene::setDebugColor(int lod)
+{
+    if (!uniforms || uniforms->color < 0)
+    {
+        return;
+    }
+
+    glm::vec3 color;
+    if (debugView == DebugView::LOD)
+    {
+        // Du plus fin au plus grossier : vert, jaune, rouge ; gris pour les objets sans niveaux
+        const glm::vec3 LOD_COLORS[SCENE_LOD_COUNT] = {{0.2f, 0.9f, 0.2f}, {1.f, 0.85f, 0.1f}, {1.f, 0.2f, 0.1f}};
+        color = lod >= 0 ? LOD_COLORS[lod] : glm::vec3(0.35f);
+    }
+    else if (debugView == DebugView::DRAW_ID)
+    {
+        // Teinte au nombre d'or : deux appels successifs ont des couleurs éloignées
+        float hue = std::fmod(stats.drawCalls * 0.618034f, 1.f) * 6.f;
+        color = glm::clamp(glm::vec3(std::abs(hue - 3.f) - 1.f, 2.f - std::abs(hue - 2.f), 2.f - std::abs(hue - 4.f)), 0.f, 1.f);
+    }
+    else
+    {
+        return;
+    }
+    GL::uniform3fv(uniforms->color, 1, glm::value_ptr(color));
+}
+
+void Scene::drawRec(const Mesh &mesh, const glm::mat4 &MVMatrix, const glm::mat4 &ProjMatrix, const Texture &texture)
+{
+    if (!isVisible(mesh, MVMatrix, ProjMatrix))
+    {
+        return;
+    }
+
+    GL::activeTexture(GL_TEXTURE0);
+    texture.bind();
+    GL::uniform1i(uniforms->texture, 0);
+
+    setDrawData(ProjMatrix * MVMatrix, MVMatrix, glm::transpose(glm::inverse(MVMatrix)));
+    bindMesh(mesh);
+    drawArrays(0, 6);
+
+    GL::bindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Scene::drawRec2(const Mesh &mesh, const glm::mat4 &MVMatrix, const glm::mat4 &ProjMatrix)
+{
+    if (!isVisible(mesh, MVMatrix, ProjMatrix))
+    {
+        return;
+    }
+
+    setDrawData(ProjMatrix * MVMatrix);
+    bindMesh(mesh);
+    drawArrays(0, 6);
+}
+
+void Scene::drawCone(const Texture &texture, const glm::mat4 &ViewMatrix, const glm::mat4 &ProjMatrix, glm::vec3 translateVec, glm::vec3 scaleVec)
+{
+    glm::mat4 MVMatrix = glm::translate(ViewMatrix, translateVec);
+    glm::mat4 NormalMatrix = glm::transpose(glm::inverse(MVMatrix));
+    MVMatrix = glm::scale(MVMatrix, scaleVec);
+    if (!isVisible(coneMesh, MVMatrix, ProjMatrix))
+    {
+        return;
+    }
+    int lod = selectLod(coneMesh, MVMatrix);
+
+    GL::activeTexture(GL_TEXTURE0);
+    texture.bind();
+    // Texture et éclairage n'existent que dans le programme de la salle 1
+    if (uniforms->texture >= 0)
+    {
+        GL::uniform1i(uniforms->texture, 0);
+    }
+
+    bindMesh(coneMesh);
+
+    setDrawData(ProjMatrix * MVMatrix, MVMatrix, NormalMatrix);
+    drawArrays(coneLods.first[lod], coneLods.count[lod]);
+
+    GL::bindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Scene::drawCone2(const glm::mat4 &MVMatrix, const glm::mat4 &ProjMatrix)
+{
+    if (!isVisible(coneMesh, MVMatrix, ProjMatrix))
+    {
+        return;
+    }
+    int lod = selectLod(coneMesh, MVMatrix);
+
+    // Dessiné plus tard avec les autres cônes de même niveau, par flushConeInstances
+    if (settings.instancing && isInstancingSupported())
+    {
+        coneInstances[lod].push_back(ProjMatrix * MVMatrix);
+        return;
+    }
+
+    setDrawData(ProjMatrix * MVMatrix);
+    // isCone n'existe que dans le programme de la salle 2
+    if (uniforms->isCone >= 0)
+    {
+        GL::uniform1i(uniforms->isCone, GL_TRUE);
+    }
+
+    bindMesh(coneMesh);
+    drawArrays(coneLods.first[lod], coneLods.count[lod]);
+
+    if (uniforms->isCone >= 0)
+    {
+        GL::uniform1i(uniforms->isCone, GL_FALSE);
+    }
+}
+
+void Scene::drawBalloon(float time, const glm::mat4 &ViewMatrix, const glm::mat4 &ProjMatrix)
+{
+    float timeOffset = animateBall ? time - ballTimeOffset : lastTime - ballTimeOffset;
+
+    float angle = timeOffset * 0.5f;
+    float x = 8.0f * cos(angle);
+    float z = -5.0f + 8.0f * sin(angle);
+    float y = -1.6f + 1.0f * sin(10 * angle);
+
+    glm::mat4 MVMatrix = glm::translate(ViewMatrix, glm::vec3(x, y, z));
+
+    float directionAngle = atan2(8.0f * sin(angle), 8.0f * cos(angle));
+    MVMatrix = glm::rotate(MVMatrix, -directionAngle, glm::vec3(0.f, 1.f, 0.f));
+
+    MVMatrix = glm::rotate(MVMatrix, (float)timeOffset * 4, glm::vec3(1.f, 0.f, 0.f));
+
+    MVMatrix = glm::scale(MVMatrix, glm::vec3(0.5f, 0.5f, 0.5f));
+    glm::mat4 NormalMatrix = glm::transpose(glm::inverse(MVMatrix));
+    if (!isVisible(sphereMesh, MVMatrix, ProjMatrix))
+    {
+        return;
+    }
+    int lod = selectLod(sphereMesh, MVMatrix);
+
+    GL::activeTexture(GL_TEXTURE0);
+    ballTexture.bind();
+    if (uniforms->texture >= 0)
+    {
+        GL::uniform1i(uniforms->texture, 0);
+    }
+
+    bindMesh(sphereMesh);
+
+    setDrawData(ProjMatrix * MVMatrix, MVMatrix, NormalMatrix);
+    drawArrays(sphereLods.first[lod], sphereLods.count[lod]);
+
+    GL::bindTexture(GL_TEXTURE_2D, 0);
+}
@@ -0,0 +1,563 @@
+#include "StressScene.hpp"
+#include <glimac/Cone.hpp>
+#include <glimac/Sphere.hpp>
+#include <glimac/Profiler.hpp>
+#include <glimac/GLCalls.hpp>
+#include <glimac/common.hpp>
+#include <glimac/BBox.hpp>
+#include <glimac/VertexFormat.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <random>
+#include <utility>
+
+using namespace glimac;
+
+const GLuint VERTEX_ATTR_POSITION = 0;
+const GLuint VERTEX_ATTR_NORMAL = 1;
+const GLuint INSTANCE_ATTR_MODEL_MATRIX = 5; // 4 emplacements, un par colonne
+const GLuint INSTANCE_ATTR_COLOR = 9;
+
+/* Dimensions d'une salle, comme dans Scene : 24 x 20, murs de 6 de haut, passage de 2 vers la salle suivante */
+const float ROOM_WIDTH = 24.f;
+const float ROOM_DEPTH = 20.f;
+const float PASSAGE_DEPTH = 2.f;
+
+/* Instances testées par groupe de travail de cull.cs.glsl, pixels par côté d'un groupe de hiz.cs.glsl */
+const GLuint CULL_GROUP_SIZE = 64;
+const GLuint HIZ_GROUP_SIZE = 8;
+
+/* Carré unité dans le plan XY, normale +Z */
+static void addQuad(std::vector<ShapeVertex> &vertices)
+{
+    const glm::vec3 corners[] = {{-0.5f, -0.5f, 0.f}, {0.5f, -0.5f, 0.f}, {0.5f, 0.5f, 0.f}, {-0.5f, 0.5f, 0.f}};
+    const int order[] = {0, 1, 2, 0, 2, 3};
+    for (int i : order)
+    {
+        vertices.push_back({corners[i], glm::vec3(0.f, 0.f, 1.f), glm::vec2(corners[i]) + 0.5f});
+    }
+}
+
+/* Cube unité centré */
+static void addBox(std::vector<ShapeVertex> &vertices)
+{
+    for (int axis = 0; axis < 3; axis++)
+    {
+        for (float side : {-1.f, 1.f})
+        {
+            glm::vec3 normal(0.f), u(0.f), v(0.f);
+            normal[axis] = side;
+            u[(axis + 1) % 3] = 1.f;
+            v[(axis + 2) % 3] = side;
+            const glm::vec3 corners[] = {0.5f * (normal - u - v), 0.5f * (normal + u - v), 0.5f * (normal + u + v), 0.5f * (normal - u + v)};
+            const int order[] = {0, 1, 2, 0, 2, 3};
+            for (int i : order)
+            {
+                vertices.push_back({corners[i], normal, glm::vec2(0.f)});
+            }
+        }
+    }
+}
+
+StressScene::StressScene(const FilePath &applicationPath, unsigned int roomCount, unsigned int objectCount, unsigned int seed)
+    : program(loadProgram(applicationPath.dirPath() + "../src/shaders/stress.vs.glsl",
+                          applicationPath.dirPath() + "../src/shaders/stress.fs.glsl"))
+{
+    GLIMAC_PROFILE_ZONE("build stress scene");
+
+    viewProjMatrixLocation = GL::getUniformLocation(program.getGLId(), "uViewProjMatrix");
+
+    /* Maillages, moins découpés que ceux de Scene : c'est le coût de soumission qui est mesuré */
+    std::vector<ShapeVertex> vertices;
+    Cone cone(2, 1.5f, 16, 4);
+    Sphere sphere(1, 16, 8);
+    for (int mesh = 0; mesh < MESH_COUNT; mesh++)
+    {
+        meshFirst[mesh] = vertices.size();
+        switch (mesh)
+        {
+        case QUAD:
+            addQuad(vertices);
+            break;
+        case BOX:
+            addBox(vertices);
+            break;
+        case CONE:
+            vertices.insert(vertices.end(), cone.getDataPointer(), cone.getDataPointer() + cone.getVertexCount());
+            break;
+        case SPHERE:
+            vertices.insert(vertices.end(), sphere.getDataPointer(), sphere.getDataPointer() + sphere.getVertexCount());
+            break;
+        }
+        meshCount[mesh] = vertices.size() - meshFirst[mesh];
+    }
+    BBox3f meshBoxes[MESH_COUNT];
+    for (int mesh = 0; mesh < MESH_COUNT; mesh++)
+    {
+        meshBoxes[mesh] = BBox3f(vertices[meshFirst[mesh]].position);
+        for (GLsizei i = 1; i < meshCount[mesh]; i++)
+        {
+            meshBoxes[mesh].grow(vertices[meshFirst[mesh] + i].position);
+        }
+    }
+
+    /* Salles en grille, objets répartis entre elles */
+    roomCount = std::max(roomCount, 1u);
+    const unsigned int columns = std::ceil(std::sqrt(float(roomCount)));
+    const unsigned int rows = (roomCount + columns - 1) / columns;
+    std::vector<glm::vec3> roomCenters;
+    for (unsigned int i = 0; i < roomCount; i++)
+    {
+        roomCenters.push_back(glm::vec3((i % columns) * ROOM_WIDTH, 0.f, (i / columns) * (ROOM_DEPTH + PASSAGE_DEPTH)));
+        addRoom(roomCenters.back());
+    }
+    sceneCenter = glm::vec3((columns - 1) * ROOM_WIDTH, 0.f, (rows - 1) * (ROOM_DEPTH + PASSAGE_DEPTH)) * 0.5f;
+    sceneExtent = std::max(columns * ROOM_WIDTH, rows * (ROOM_DEPTH + PASSAGE_DEPTH));
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> x(-ROOM_WIDTH / 2 + 2, ROOM_WIDTH / 2 - 2), z(-ROOM_DEPTH / 2 + 2, ROOM_DEPTH / 2 - 2);
+    for (unsigned int i = 0; i < objectCount; i++)
+    {
+        // Types en alternance dans chaque salle
+        addObject((i / roomCount) % 4, roomCenters[i % roomCount] + glm::vec3(x(random), 0.f, z(random)));
+    }
+
+    /* Regroupement par maillage pour les chemins instancié et indirect */
+    std::vector<Instance> grouped(instances.size());
+    std::vector<InstanceBounds> groupedBounds(instances.size());
+    for (int mesh = 0; mesh < MESH_COUNT; mesh++)
+    {
+        groupCount[mesh] = 0;
+    }
+    for (Mesh mesh : instanceMeshes)
+    {
+        groupCount[mesh]++;
+    }
+    GLuint offsets[MESH_COUNT];
+    for (int mesh = 0, first = 0; mesh < MESH_COUNT; mesh++)
+    {
+        groupFirst[mesh] = offsets[mesh] = first;
+        first += groupCount[mesh];
+    }
+    for (size_t i = 0; i < instances.size(); i++)
+    {
+        Mesh mesh = instanceMeshes[i];
+        // Boîte du maillage transformée : celle de ses 8 coins
+        BBox3f box(glm::vec3(instances[i].modelMatrix * glm::vec4(meshBoxes[mesh].lower, 1.f)));
+        for (int corner = 1; corner < 8; corner++)
+        {
+            glm::vec3 p((corner & 1) ? meshBoxes[mesh].upper.x : meshBoxes[mesh].lower.x,
+                        (corner & 2) ? meshBoxes[mesh].upper.y : meshBoxes[mesh].lower.y,
+                        (corner & 4) ? meshBoxes[mesh].upper.z : meshBoxes[mesh].lower.z);
+            box.grow(glm::vec3(instances[i].modelMatrix * glm::vec4(p, 1.f)));
+        }
+        groupedBounds[offsets[mesh]] = {box.lower, GLuint(mesh), box.upper, 0};
+        grouped[offsets[mesh]++] = instances[i];
+    }
+
+    /* Buffers */
+    vbo = Buffer(GLMemoryCategory::VERTICES, "stress meshes");
+    vbo.setData(vertices.size() * sizeof(ShapeVertex), vertices.data(), GL_STATIC_DRAW);
+
+    instanceVBO = Buffer(GLMemoryCategory::VERTICES, "stress instances");
+    instanceVBO.setData(grouped.size() * sizeof(Instance), grouped.data(), GL_STATIC_DRAW);
+
+    if (isSupported(DrawPath::INDIRECT))
+    {
+        DrawArraysIndirectCommand commands[MESH_COUNT];
+        for (int mesh = 0; mesh < MESH_COUNT; mesh++)
+        {
+            commands[mesh] = {GLuint(meshCount[mesh]), groupCount[mesh], GLuint(meshFirst[mesh]), groupFirst[mesh]};
+        }
+        commandBuffer = Buffer(GLMemoryCategory::COMMANDS, "stress commands");
+        commandBuffer.setData(sizeof(commands), commands, GL_STATIC_DRAW);
+
+        // Mêmes commandes sans instances : cull.cs.glsl compte celles qu'il garde
+        for (int mesh = 0; mesh < MESH_COUNT; mesh++)
+        {
+            gpuCommands[mesh] = {GLuint(meshCount[mesh]), 0, GLuint(meshFirst[mesh]), groupFirst[mesh]};
+        }
+        gpuCommandBuffer = Buffer(GLMemoryCategory::COMMANDS, "stress gpu commands");
+        gpuCommandBuffer.setData(sizeof(gpuCommands), gpuCommands, GL_DYNAMIC_DRAW);
+
+        boundsBuffer = Buffer(GLMemoryCategory::VERTICES, "stress bounds");
+        boundsBuffer.setData(groupedBounds.size() * sizeof(InstanceBounds), groupedBounds.data(), GL_STATIC_DRAW);
+        visibleInstanceBuffer = Buffer(GLMemoryCategory::STREAMING, "stress visible instances");
+        visibleInstanceBuffer.setData(grouped.size() * sizeof(Instance), nullptr, GL_DYNAMIC_COPY);
+
+        cullProgram = loadComputeProgram(applicationPath.dirPath() + "../src/shaders/cull.cs.glsl");
+        cullInstanceCountLocation = GL::getUniformLocation(cullProgram.getGLId(), "uInstanceCount");
+        cullViewProjMatrixLocation = GL::getUniformLocation(cullProgram.getGLId(), "uViewProjMatrix");
+        cullHiZLocation = GL::getUniformLocation(cullProgram.getGLId(), "uHiZ");
+        cullHiZViewProjMatrixLocation = GL::getUniformLocation(cullProgram.getGLId(), "uHiZViewProjMatrix");
+        hiZProgram = loadComputeProgram(applicationPath.dirPath() + "../src/shaders/hiz.cs.glsl");
+        hiZLevelLocation = GL::getUniformLocation(hiZProgram.getGLId(), "uLevel");
+    }
+
+    /* VAOs : tous partagent les sommets, les deux derniers chemins lisent les instances dans un tableau.
+       Avec glBindVertexBuffer, les buffers sont attachés au VAO du format par bindVertices */
+    if (!isVertexAttribBindingSupported())
+    {
+        immediateVAO = VertexArray("stress immediate");
+        instancedVAO = VertexArray("stress instanced");
+        gpuCulledVAO = VertexArray("stress gpu culled");
+        const std::pair<const VertexArray *, const Buffer *> vertexSources[] = {{&immediateVAO, nullptr}, {&instancedVAO, &instanceVBO}, {&gpuCulledVAO, &visibleInstanceBuffer}};
+        for (const auto &source : vertexSources)
+        {
+            // Sans buffer d'instances (chemin non supporté), les sommets seulement
+            const GLuint buffers[] = {vbo.getGLId(), source.second ? source.second->getGLId() : 0};
+            source.first->bind();
+            getVertexFormat(buffers[1] != 0).apply(buffers);
+        }
+        GL::bindVertexArray(0);
+    }
+
+    GL::enable(GL_DEPTH_TEST);
+}
+
+const VertexFormat &StressScene::getVertexFormat(bool instanced)
+{
+    static constexpr VertexFormat format = VertexFormat()
+        .buffer<ShapeVertex>()
+        .attribute(VERTEX_ATTR_POSITION, GLIMAC_VERTEX_MEMBER(ShapeVertex, position))
+        .attribute(VERTEX_ATTR_NORMAL, GLIMAC_VERTEX_MEMBER(ShapeVertex, normal));
+    static constexpr VertexFormat instancedFormat = format
+        .buffer<Instance>(1)
+        .attribute(INSTANCE_ATTR_MODEL_MATRIX, GLIMAC_VERTEX_MEMBER(Instance, modelMatrix))
+        .attribute(INSTANCE_ATTR_COLOR, GLIMAC_VERTEX_MEMBER(Instance, color));
+    return instanced ? instancedFormat : format;
+}
+
+void StressScene::bindVertices(const VertexArray &ownVAO, const Buffer *instanceBuffer)
+{
+    if (!isVertexAttribBindingSupported())
+    {
+        ownVAO.bind();
+        return;
+    }
+
+    const VertexFormat &format = getVertexFormat(instanceBuffer != nullptr);
+    vertexArrays.get(format, "stress vertex format").bind();
+    GL::bindVertexBuffer(0, vbo.getGLId(), 0, format.getStride(0));
+    if (instanceBuffer)
+    {
+        GL::bindVertexBuffer(1, instanceBuffer->getGLId(), 0, format.getStride(1));
+    }
+}
+
+bool StressScene::isSupported(DrawPath path)
+{
+    switch (path)
+    {
+    case DrawPath::INSTANCED:
+        return GLAD_GL_VERSION_4_2;
+    case DrawPath::INDIRECT:
+    case DrawPath::GPU_CULLED:
+        return GLAD_GL_VERSION_4_3;
+    default:
+        return true;
+    }
+}
+
+const char *StressScene::getName(DrawPath path)
+{
+    switch (path)
+    {
+    case DrawPath::INSTANCED:
+        return "instanced";
+    case DrawPath::INDIRECT:
+        return "indirect";
+    case DrawPath::GPU_CULLED:
+        return "gpu-culled";
+    default:
+        return "immediate";
+    }
+}
+
+void StressScene::render(DrawPath path, int width, int height)
+{
+    GLIMAC_PROFILE_ZONE("render stress scene");
+    stats = SceneStats();
+    profiler.beginFrame();
+
+    // GPU_CULLED dessine dans sa propre cible, dont la profondeur peut être lue, puis la copie dans le framebuffer courant
+    GLint targetFramebuffer = 0;
+    if (path == DrawPath::GPU_CULLED)
+    {
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFramebuffer);
+        beginGPUCulling(width, height);
+    }
+
+    GL::viewport(0, 0, width, height);
+    GL::clearColor(0.f, 0.f, 0.f, 1.f);
+    GL::clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    /* Vue plongeante sur toute la grille */
+    glm::vec3 eye = sceneCenter + glm::vec3(0.f, 0.6f, 0.9f) * sceneExtent;
+    glm::mat4 ViewMatrix = glm::lookAt(eye, sceneCenter, glm::vec3(0.f, 1.f, 0.f));
+    glm::mat4 ProjMatrix = glm::perspective(glm::radians(60.f), (float)width / height, 0.5f, 3.f * sceneExtent);
+    glm::mat4 ViewProjMatrix = ProjMatrix * ViewMatrix;
+
+    program.use();
+    GL::uniformMatrix4fv(viewProjMatrixLocation, 1, GL_FALSE, glm::value_ptr(ViewProjMatrix));
+
+    {
+        GPUProfiler::Scope scope(profiler, getName(path));
+        switch (path)
+        {
+        case DrawPath::IMMEDIATE:
+            bindVertices(immediateVAO, nullptr);
+            for (size_t i = 0; i < instances.size(); i++)
+            {
+                const Instance &instance = instances[i];
+                for (GLuint column = 0; column < 4; column++)
+                {
+                    GL::vertexAttrib4fv(INSTANCE_ATTR_MODEL_MATRIX + column, glm::value_ptr(instance.modelMatrix[column]));
+                }
+                GL::vertexAttrib4fv(INSTANCE_ATTR_COLOR, glm::value_ptr(instance.color));
+                GL::drawArrays(GL_TRIANGLES, meshFirst[instanceMeshes[i]], meshCount[instanceMeshes[i]]);
+                stats.drawCalls++;
+                stats.triangles += meshCount[instanceMeshes[i]] / 3;
+            }
+            break;
+        case DrawPath::INSTANCED:
+            bindVertices(instancedVAO, &instanceVBO);
+            for (int mesh = 0; mesh < MESH_COUNT; mesh++)
+            {
+                if (groupCount[mesh])
+                {
+                    GL::drawArraysInstancedBaseInstance(GL_TRIANGLES, meshFirst[mesh], meshCount[mesh], groupCount[mesh], groupFirst[mesh]);
+                    stats.drawCalls++;
+                    stats.triangles += meshCount[mesh] / 3 * groupCount[mesh];
+                }
+            }
+            break;
+        case DrawPath::INDIRECT:
+            bindVertices(instancedVAO, &instanceVBO);
+            commandBuffer.bind(GL_DRAW_INDIRECT_BUFFER);
+            GL::multiDrawArraysIndirect(GL_TRIANGLES, 0, MESH_COUNT, 0);
+            GL::bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            stats.drawCalls++;
+            for (int mesh = 0; mesh < MESH_COUNT; mesh++)
+            {
+                stats.triangles += meshCount[mesh] / 3 * groupCount[mesh];
+            }
+            break;
+        case DrawPath::GPU_CULLED:
+            // Coût CPU constant : une passe de calcul et un appel, quel que soit le nombre d'objets
+            cullInstances(ViewProjMatrix);
+            program.use();
+            bindVertices(gpuCulledVAO, &visibleInstanceBuffer);
+            gpuCommandBuffer.bind(GL_DRAW_INDIRECT_BUFFER);
+            GL::multiDrawArraysIndirect(GL_TRIANGLES, 0, MESH_COUNT, 0);
+            GL::bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            stats.drawCalls++;
+            stats.objects = instances.size(); // Triangles et objets éliminés : readGPUCullingStats
+            break;
+        }
+        GL::bindVertexArray(0);
+
+        if (path == DrawPath::GPU_CULLED)
+        {
+            gpuFBO.bind(GL_READ_FRAMEBUFFER);
+            GL::bindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFramebuffer);
+            GL::blitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            GL::bindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+            buildHiZ(ViewProjMatrix);
+        }
+    }
+
+    profiler.endFrame();
+}
+
+void StressScene::beginGPUCulling(int width, int height)
+{
+    if (!gpuFBO.getGLId())
+    {
+        gpuFBO = Framebuffer("stress gpu culled");
+    }
+
+    gpuFBO.bind(GL_FRAMEBUFFER);
+    if (width == gpuWidth && height == gpuHeight)
+    {
+        return;
+    }
+
+    // Mêmes formats que HeadlessContext : l'image copiée est celle des autres chemins.
+    // Stockage immuable : de nouvelles textures à chaque taille
+    gpuColorTexture = Texture(GL_TEXTURE_2D, GLMemoryCategory::RENDER_TARGETS, "stress gpu culled color");
+    gpuColorTexture.setStorage2D(1, GL_RGBA8, width, height);
+    gpuColorTexture.setParameter(GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    gpuColorTexture.setParameter(GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    gpuDepthTexture = Texture(GL_TEXTURE_2D, GLMemoryCategory::RENDER_TARGETS, "stress gpu culled depth");
+    gpuDepthTexture.setStorage2D(1, GL_DEPTH_COMPONENT24, width, height);
+    gpuDepthTexture.setParameter(GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    gpuDepthTexture.setParameter(GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    GL::framebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gpuColorTexture.getGLId(), 0);
+    GL::framebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, gpuDepthTexture.getGLId(), 0);
+
+    // Tous les niveaux, jusqu'à 1 x 1, en divisant par 2 arrondi en dessous
+    hiZLevels = 1 + int(std::log2(float(std::max(width, height))));
+    hiZTexture = Texture(GL_TEXTURE_2D, GLMemoryCategory::RENDER_TARGETS, "stress hi-z");
+    hiZTexture.setStorage2D(hiZLevels, GL_R32F, width, height);
+    hiZTexture.setParameter(GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    hiZTexture.setParameter(GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    hiZTexture.setParameter(GL_TEXTURE_MAX_LEVEL, hiZLevels - 1);
+
+    gpuWidth = width;
+    gpuHeight = height;
+    hiZValid = false;
+}
+
+void StressScene::cullInstances(const glm::mat4 &ViewProjMatrix)
+{
+    // Compteurs d'instances remis à zéro
+    gpuCommandBuffer.setSubData(0, sizeof(gpuCommands), gpuCommands);
+
+    cullProgram.use();
+    GL::uniform1i(cullInstanceCountLocation, GLint(instances.size()));
+    GL::uniformMatrix4fv(cullViewProjMatrixLocation, 1, GL_FALSE, glm::value_ptr(ViewProjMatrix));
+    GL::uniform1i(cullHiZLocation, hiZValid);
+    GL::uniformMatrix4fv(cullHiZViewProjMatrixLocation, 1, GL_FALSE, glm::value_ptr(hiZViewProjMatrix));
+    GL::activeTexture(GL_TEXTURE0);
+    hiZTexture.bind();
+
+    GL::bindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceVBO.getGLId());
+    GL::bindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, boundsBuffer.getGLId());
+    GL::bindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, visibleInstanceBuffer.getGLId());
+    GL::bindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, gpuCommandBuffer.getGLId());
+    GL::dispatchCompute((GLuint(instances.size()) + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+    // Les commandes et les instances gardées sont lues par le dessin qui suit, les commandes aussi par
+    // readGPUCullingStats (glGetBufferSubData)
+    GL::memoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+    GL::bindTexture(GL_TEXTURE_2D, 0);
+}
+
+void StressScene::buildHiZ(const glm::mat4 &ViewProjMatrix)
+{
+    hiZProgram.use();
+    GL::activeTexture(GL_TEXTURE0);
+    gpuDepthTexture.bind();
+    for (int level = 0; level < hiZLevels; level++)
+    {
+        // Le niveau 0 lit la profondeur : sa source n'est pas utilisée
+        GL::bindImageTexture(0, hiZTexture.getGLId(), std::max(level - 1, 0), GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        GL::bindImageTexture(1, hiZTexture.getGLId(), level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        GL::uniform1i(hiZLevelLocation, level);
+        GLuint levelWidth = std::max(gpuWidth >> level, 1), levelHeight = std::max(gpuHeight >> level, 1);
+        GL::dispatchCompute((levelWidth + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, (levelHeight + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, 1);
+        GL::memoryBarrier(level + 1 < hiZLevels ? GL_SHADER_IMAGE_ACCESS_BARRIER_BIT : GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+    GL::bindTexture(GL_TEXTURE_2D, 0);
+
+    hiZViewProjMatrix = ViewProjMatrix;
+    hiZValid = true;
+}
+
+void StressScene::readGPUCullingStats()
+{
+    DrawArraysIndirectCommand commands[MESH_COUNT];
+    gpuCommandBuffer.bind(GL_DRAW_INDIRECT_BUFFER);
+    GL::getBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(commands), commands);
+    GL::bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    stats.triangles = 0;
+    stats.objects = instances.size();
+    stats.culledObjects = instances.size();
+    for (const DrawArraysIndirectCommand &command : commands)
+    {
+        stats.triangles += command.count / 3 * command.instanceCount;
+        stats.culledObjects -= command.instanceCount;
+    }
+}
+
+void StressScene::addInstance(Mesh mesh, const glm::mat4 &modelMatrix, const glm::vec4 &color)
+{
+    instances.push_back({modelMatrix, color});
+    instanceMeshes.push_back(mesh);
+}
+
+void StressScene::addRoom(const glm::vec3 &center)
+{
+    const glm::vec4 wallColor(0.5f, 0.6f, 0.7f, 1.f);
+    const glm::vec4 floorColor(0.4f, 0.25f, 0.2f, 1.f);
+    const glm::mat4 rotateY = glm::rotate(glm::mat4(1.f), glm::radians(90.f), glm::vec3(0, 1, 0));
+
+    /* Floor */
+    glm::mat4 MMatrix = glm::translate(glm::mat4(1.f), center + glm::vec3(0, -3, 0));
+    MMatrix = glm::rotate(MMatrix, glm::radians(-90.f), glm::vec3(1, 0, 0));
+    addInstance(QUAD, glm::scale(MMatrix, glm::vec3(ROOM_WIDTH, ROOM_DEPTH, 1)), floorColor);
+
+    /* Back wall */
+    MMatrix = glm::translate(glm::mat4(1.f), center + glm::vec3(0, 0, -ROOM_DEPTH / 2));
+    addInstance(QUAD, glm::scale(MMatrix, glm::vec3(ROOM_WIDTH, 6, 1)), wallColor);
+
+    /* Left and right walls */
+    for (float side : {-1.f, 1.f})
+    {
+        MMatrix = glm::translate(glm::mat4(1.f), center + glm::vec3(side * ROOM_WIDTH / 2, 0, 0)) * rotateY;
+        addInstance(QUAD, glm::scale(MMatrix, glm::vec3(ROOM_DEPTH, 6, 1)), wallColor);
+    }
+
+    /* Small walls on each side of the passage, and the passage walls */
+    for (float side : {-1.f, 1.f})
+    {
+        MMatrix = glm::translate(glm::mat4(1.f), center + glm::vec3(side * 7, 0, ROOM_DEPTH / 2));
+        addInstance(QUAD, glm::scale(MMatrix, glm::vec3(10, 6, 1)), wallColor);
+
+        MMatrix = glm::translate(glm::mat4(1.f), center + glm::vec3(side * 2, 0, ROOM_DEPTH / 2 + PASSAGE_DEPTH / 2)) * rotateY;
+        addInstance(QUAD, glm::scale(MMatrix, glm::vec3(PASSAGE_DEPTH, 6, 1)), wallColor);
+    }
+}
+
+void StressScene::addObject(unsigned int type, const glm::vec3 &position)
+{
+    glm::mat4 MMatrix;
+    switch (type)
+    {
+    case 0: /* Tree */
+        MMatrix = glm::translate(glm::mat4(1.f), position + glm::vec3(0, -0.15f, 0));
+        addInstance(CONE, glm::scale(MMatrix, glm::vec3(0.6f)), glm::vec4(0.1f, 0.5f, 0.15f, 1.f));
+        MMatrix = glm::translate(glm::mat4(1.f), position + glm::vec3(0, -1, 0));
+        addInstance(CONE, glm::scale(MMatrix, glm::vec3(0.8f)), glm::vec4(0.1f, 0.5f, 0.15f, 1.f));
+        MMatrix = glm::translate(glm::mat4(1.f), position + glm::vec3(0, -2, 0));
+        addInstance(CONE, MMatrix, glm::vec4(0.1f, 0.5f, 0.15f, 1.f));
+        MMatrix = glm::translate(glm::mat4(1.f), position + glm::vec3(0, -2.5f, 0));
+        addInstance(BOX, glm::scale(MMatrix, glm::vec3(0.4f, 1.f, 0.4f)), glm::vec4(0.4f, 0.25f, 0.1f, 1.f));
+        break;
+    case 1: /* Ball */
+        addInstance(SPHERE, glm::translate(glm::mat4(1.f), position + glm::vec3(0, -2, 0)), glm::vec4(0.9f, 0.3f, 0.2f, 1.f));
+        break;
+    case 2: /* Spikeball: sphere and 6 cones along the axes */
+    {
+        const glm::vec4 color(0.9f, 0.9f, 0.9f, 1.f);
+        const glm::vec3 center = position + glm::vec3(0, -1, 0);
+        addInstance(SPHERE, glm::scale(glm::translate(glm::mat4(1.f), center), glm::vec3(1.05f)), color);
+        const glm::vec3 axes[] = {{0, 1, 0}, {0, -1, 0}, {1, 0, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 0, -1}};
+        for (const glm::vec3 &axis : axes)
+        {
+            // Rotation qui amène l'axe du cône (0, 1, 0) sur 'axis'
+            glm::mat4 rotation(1.f);
+            if (axis.y < 0)
+            {
+                rotation = glm::rotate(rotation, glm::radians(180.f), glm::vec3(1, 0, 0));
+            }
+            else if (axis.y == 0)
+            {
+                rotation = glm::rotate(rotation, glm::radians(90.f), glm::cross(glm::vec3(0, 1, 0), axis));
+            }
+            MMatrix = glm::translate(glm::mat4(1.f), center + axis) * rotation;
+            addInstance(CONE, glm::scale(MMatrix, glm::vec3(0.2f)), color);
+        }
+        break;
+    }
+    default: /* Window, opaque here: the blending order is not what is measured */
+        MMatrix = glm::translate(glm::mat4(1.f), position + glm::vec3(0, -1, 0));
+        MMatrix = glm::rotate(MMatrix, position.x + position.z, glm::vec3(0, 1, 0));
+        addInstance(QUAD, glm::scale(MMatrix, glm::vec3(1.5f, 2.f, 1.f)), glm::vec4(0.6f, 0.8f, 1.f, 0.4f));
+        break;
+    }
+}
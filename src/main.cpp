@@ -2,309 +2,282 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glimac/FilePath.hpp>
-#include <glimac/Program.hpp>
-#include <glimac/FreeflyCamera.hpp>
-#include <glimac/Sphere.hpp>
-#include <glimac/Cone.hpp>
-#include <cstddef>
-#include <algorithm>
+#include <glimac/HeadlessContext.hpp>
+#include <glimac/FrameStats.hpp>
+#include <glimac/Profiler.hpp>
+#include <glimac/GLCalls.hpp>
+#include <glimac/GLObjects.hpp>
+#include <glimac/AllocationTracker.hpp>
+#include <map>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
 #include <vector>
-#include <src/stb_image.h>
-#include <glimac/Image.hpp>
+#include "Scene.hpp"
+#include "Overlay.hpp"
+#include "StressScene.hpp"
+#include "Recording.hpp"
+#include "Regression.hpp"
 
 using namespace glimac;
 
 int window_width = 800;
 int window_height = 800;
 
-const GLuint VERTEX_ATTR_POSITION = 0;
-const GLuint VERTEX_ATTR_NORMAL = 1;
-const GLuint VERTEX_ATTR_COLOR = 2;
-const GLuint VERTEX_ATTR_TEXTURE = 3;
-
-/* Camera */
-bool move = false;
-float cameraHeight = 0.f;
-FreeflyCamera camera;
-
-/* Fil de fer */
-bool line = false;
-
-/* Current room */
-bool room1 = true;
-
-/* Light state */
-bool light = true;
-
-/* Ball animation */
-bool animateBall = true;
-float ballTimeOffset = 0.0f;
-float lastTime = 0.0f;
-
-struct Vertex3DColor
+/* Options de la ligne de commande */
+struct Options
 {
-    glm::vec3 position;
-    glm::vec3 normal;
-    glm::vec4 color;
-    glm::vec2 texCoords;
-
-    Vertex3DColor(const glm::vec3 &position, const glm::vec3 &normal, const glm::vec4 &color, const glm::vec2 &texCoords)
-        : position(position), normal(normal), color(color), texCoords(texCoords)
-    {
-    }
+    bool headless = false;
+    int width = 800;
+    int height = 800;
+    int frames = 0;   // 600 par défaut, 30 avec --stress, 100 avec --check
+    int warmup = 10;  // Frames rendus mais non mesurés
+    float fps = 60.f; // Horloge virtuelle de l'animation (--headless et --replay)
+    std::string record;
+    std::string replay;
+    std::string profileCSV; // Temps GPU / CPU de chaque passe, frame par frame
+    std::string trace;      // Zones CPU au format chrome://tracing, écrites à la sortie
+    DebugView debugView = DebugView::NONE; // Mode de rendu au démarrage, changé ensuite avec la touche F
+    bool zeroAllocations = false;          // Echoue dès qu'un frame alloue sur le tas après le préchauffage
+    bool vertexPulling = false;            // SceneSettings::vertexPulling au démarrage
+    bool noDirectStateAccess = false;      // Buffers et textures modifiés en les liant, même avec OpenGL 4.5
+
+    /* Scène de test de montée en charge (--stress) */
+    bool stress = false;
+    int stressRooms = 16;
+    std::vector<int> stressObjects = {100, 1000, 10000, 100000};
+
+    /* Tests de non-régression (--check) */
+    std::string check;         // Répertoire des images de référence et des budgets
+    bool updateGolden = false; // Réécrit les références au lieu de comparer
+    bool noBudget = false;     // Images seulement, sans les budgets de temps
+
+    /* Capture des appels GL (--capture), rejouée par glimac_replay */
+    std::string capture;
+    int captureFrames = 1;
+    int captureStart = 0; // Premier frame capturé, après le préchauffage avec --headless
 };
 
-struct TransparentObject
+/* Etat partagé avec les callbacks GLFW */
+struct Application
 {
-    GLuint vao;
-    glm::vec3 position;
-    glm::mat4 modelMatrix;
+    Scene *scene = nullptr;
+    Overlay *overlay = nullptr; // Fenêtre seulement
+    InputRecorder recorder;
+    bool replaying = false; // Les entrées de l'utilisateur sont ignorées
+    bool diverged = false;  // La caméra rejouée ne suit plus l'enregistrement
+    bool quit = false;
+    std::string tracePath; // Touche T
+    bool captureRequested = false; // Touche C, la capture commence au frame suivant
+
+    /* Camera */
+    bool move = false;
+    bool hasCursor = false;
+    double lastX = 0.;
+    double lastY = 0.;
 };
 
-static void key_callback(GLFWwindow *window, int key, int /*scancode*/, int action, int /*mods*/)
+static Application &getApplication(GLFWwindow *window)
 {
-    // Close window if Q key is pressed
-    if (action == GLFW_PRESS && key == GLFW_KEY_Q)
-    {
-        glfwSetWindowShouldClose(window, GLFW_TRUE);
-    }
-    // Movement
-    if ((action == GLFW_PRESS || action == GLFW_REPEAT) && key == GLFW_KEY_W)
-    {
-        camera.moveFront(0.2);
-    }
-    else if ((action == GLFW_PRESS || action == GLFW_REPEAT) && key == GLFW_KEY_S)
-    {
-        camera.moveFront(-0.2);
-    }
-    else if ((action == GLFW_PRESS || action == GLFW_REPEAT) && key == GLFW_KEY_A)
-    {
-        camera.moveLeft(0.2);
-    }
-    else if ((action == GLFW_PRESS || action == GLFW_REPEAT) && key == GLFW_KEY_D)
-    {
-        camera.moveLeft(-0.2);
-    }
-    // Fix camera height
-    camera.setCameraPositionY(cameraHeight);
+    return *static_cast<Application *>(glfwGetWindowUserPointer(window));
+}
 
-    // Line mode
-    if (action == GLFW_PRESS && key == GLFW_KEY_F)
+/* Applique un évènement d'entrée, reçu de GLFW ou rejoué ; 'time' sert à l'animation de la balle */
+static void processEvent(Application &app, const InputEvent &event, float time)
+{
+    Scene &scene = *app.scene;
+
+    if (event.type == InputEvent::KEY)
     {
-        (line) ? glPolygonMode(GL_FRONT_AND_BACK, GL_FILL) : glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        line = !line;
+        int key = event.code, action = event.action;
+
+        // Close window if Q key is pressed
+        if (action == GLFW_PRESS && key == GLFW_KEY_Q)
+        {
+            app.quit = true;
+        }
+        // Movement
+        if ((action == GLFW_PRESS || action == GLFW_REPEAT) && key == GLFW_KEY_W)
+        {
+            scene.camera.moveFront(0.2);
+        }
+        else if ((action == GLFW_PRESS || action == GLFW_REPEAT) && key == GLFW_KEY_S)
+        {
+            scene.camera.moveFront(-0.2);
+        }
+        else if ((action == GLFW_PRESS || action == GLFW_REPEAT) && key == GLFW_KEY_A)
+        {
+            scene.camera.moveLeft(0.2);
+        }
+        else if ((action == GLFW_PRESS || action == GLFW_REPEAT) && key == GLFW_KEY_D)
+        {
+            scene.camera.moveLeft(-0.2);
+        }
+        // Fix camera height
+        scene.camera.setCameraPositionY(scene.cameraHeight);
+
+        // Debug views (wireframe, overdraw, LOD, draw ID, culling)
+        if (action == GLFW_PRESS && key == GLFW_KEY_F)
+        {
+            scene.nextDebugView();
+            std::clog << "Debug view: " << getDebugViewName(scene.getDebugView()) << std::endl;
+        }
+        // Room light 1
+        if (action == GLFW_PRESS && key == GLFW_KEY_R)
+        {
+            scene.toggleLight();
+        }
+        // Balloon animation
+        if (action == GLFW_PRESS && key == GLFW_KEY_B)
+        {
+            scene.toggleBallAnimation(time);
+        }
     }
-    // Room light 1
-    if (action == GLFW_PRESS && key == GLFW_KEY_R)
+    else if (event.type == InputEvent::MOUSE_BUTTON)
     {
-        light = !light;
+        if (event.code == GLFW_MOUSE_BUTTON_RIGHT && event.action == GLFW_PRESS)
+        {
+            app.move = true;
+        }
+        else if (event.code == GLFW_MOUSE_BUTTON_RIGHT && event.action == GLFW_RELEASE)
+        {
+            app.move = false;
+        }
     }
-    // Balloon animation
-    if (action == GLFW_PRESS && key == GLFW_KEY_B)
+    else if (event.type == InputEvent::CURSOR)
     {
-        if (animateBall)
+        if (!app.hasCursor)
         {
-            lastTime = glfwGetTime();
+            app.lastX = event.x;
+            app.lastY = event.y;
+            app.hasCursor = true;
         }
-        else
+
+        if (app.move)
         {
-            ballTimeOffset += glfwGetTime() - lastTime;
+            scene.camera.rotateLeft((event.x - app.lastX));
+            scene.camera.rotateUp((event.y - app.lastY));
         }
-        animateBall = !animateBall;
+
+        app.lastX = event.x;
+        app.lastY = event.y;
     }
 }
 
-static void mouse_button_callback(GLFWwindow * /*window*/, int button, int action, int /*mods*/)
+/* Rejoue les évènements d'un frame enregistré, false si la caméra n'arrive pas à la même pose */
+static bool replayFrame(Application &app, const RecordedFrame &frame, float time)
 {
-    if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS)
+    for (const auto &event : frame.events)
     {
-        move = true;
-    }
-    else if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_RELEASE)
-    {
-        move = false;
+        processEvent(app, event, time);
     }
+    return CameraPose::fromCamera(app.scene->camera) == frame.pose;
 }
 
-static void cursor_position_callback(GLFWwindow * /*window*/, double xpos, double ypos)
+static void onInput(GLFWwindow *window, const InputEvent &event)
 {
-    static double lastX = xpos;
-    static double lastY = ypos;
-
-    if (move)
+    Application &app = getApplication(window);
+    if (app.replaying)
     {
-        camera.rotateLeft((xpos - lastX));
-        camera.rotateUp((ypos - lastY));
+        return;
     }
-
-    lastX = xpos;
-    lastY = ypos;
-}
-
-static void size_callback(GLFWwindow * /*window*/, int width, int height)
-{
-    window_width = width;
-    window_height = height;
-}
-
-void initRecVBOandVAO(GLuint &vbo, GLuint &vao, const Vertex3DColor vertices[], GLsizeiptr size)
-{
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-
-    glBindVertexArray(vao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
-
-    glEnableVertexAttribArray(VERTEX_ATTR_POSITION);
-    glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3DColor), (const GLvoid *)offsetof(Vertex3DColor, position));
-
-    glEnableVertexAttribArray(VERTEX_ATTR_NORMAL);
-    glVertexAttribPointer(VERTEX_ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3DColor), (const GLvoid *)offsetof(Vertex3DColor, normal));
-
-    glEnableVertexAttribArray(VERTEX_ATTR_COLOR);
-    glVertexAttribPointer(VERTEX_ATTR_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex3DColor), (const GLvoid *)offsetof(Vertex3DColor, color));
-
-    glEnableVertexAttribArray(VERTEX_ATTR_TEXTURE);
-    glVertexAttribPointer(VERTEX_ATTR_TEXTURE, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex3DColor), (const GLvoid *)offsetof(Vertex3DColor, texCoords));
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    if (app.recorder.isOpen())
+    {
+        app.recorder.addEvent(event);
+    }
+    processEvent(app, event, glfwGetTime());
 }
 
-void drawRec(GLuint vao, const glm::mat4 &MVMatrix, const glm::mat4 &ProjMatrix, GLint MVPMatrixLocation, GLint MVMatrixLocation, GLint NormalMatrixLocation, GLuint texture, GLint textureLocation)
+static void key_callback(GLFWwindow *window, int key, int /*scancode*/, int action, int /*mods*/)
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glUniform1i(textureLocation, 0);
-
-    glm::mat4 NormalMatrix = glm::transpose(glm::inverse(MVMatrix));
-    glUniformMatrix4fv(MVPMatrixLocation, 1, GL_FALSE, glm::value_ptr(ProjMatrix * MVMatrix));
-    glUniformMatrix4fv(MVMatrixLocation, 1, GL_FALSE, glm::value_ptr(MVMatrix));
-    glUniformMatrix4fv(NormalMatrixLocation, 1, GL_FALSE, glm::value_ptr(NormalMatrix));
-    glBindVertexArray(vao);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // Trace des zones CPU à la demande ; ne change pas la scène, donc n'est pas enregistrée
+    if (action == GLFW_PRESS && key == GLFW_KEY_T)
+    {
+        const std::string &path = getApplication(window).tracePath;
+        if (Profiler::writeChromeTrace(path))
+        {
+            std::clog << "Trace written to " << path << std::endl;
+        }
+        return;
+    }
+    if (action == GLFW_PRESS && key == GLFW_KEY_C)
+    {
+        getApplication(window).captureRequested = true;
+        return;
+    }
+    // Overlay de mesure, hors de l'enregistrement comme la trace
+    if (action == GLFW_PRESS && key == GLFW_KEY_O)
+    {
+        getApplication(window).overlay->toggle();
+        return;
+    }
+    onInput(window, InputEvent{InputEvent::KEY, int16_t(key), uint8_t(action), 0., 0.});
 }
 
-void drawRec2(GLuint vao, const glm::mat4 &MVMatrix, const glm::mat4 &ProjMatrix, GLint MVPMatrixLocation)
+static void mouse_button_callback(GLFWwindow *window, int button, int action, int /*mods*/)
 {
-    glUniformMatrix4fv(MVPMatrixLocation, 1, GL_FALSE, glm::value_ptr(ProjMatrix * MVMatrix));
-    glBindVertexArray(vao);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    onInput(window, InputEvent{InputEvent::MOUSE_BUTTON, int16_t(button), uint8_t(action), 0., 0.});
 }
 
-void drawCone(Cone cone, GLuint texture, GLuint vao, glm::mat4 ViewMatrix, glm::mat4 ProjMatrix, glm::vec3 translateVec, glm::vec3 scaleVec, GLint textureLocation, GLint MVPMatrixLocation, GLint MVMatrixLocation, GLint NormalMatrixLocation)
+static void cursor_position_callback(GLFWwindow *window, double xpos, double ypos)
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glUniform1i(textureLocation, 0);
-
-    glBindVertexArray(vao);
-
-    glm::mat4 MVMatrix = glm::translate(ViewMatrix, translateVec);
-    glm::mat4 NormalMatrix = glm::transpose(glm::inverse(MVMatrix));
-    MVMatrix = glm::scale(MVMatrix, scaleVec);
-
-    glUniformMatrix4fv(MVPMatrixLocation, 1, GL_FALSE, glm::value_ptr(ProjMatrix * MVMatrix));
-    glUniformMatrix4fv(MVMatrixLocation, 1, GL_FALSE, glm::value_ptr(MVMatrix));
-    glUniformMatrix4fv(NormalMatrixLocation, 1, GL_FALSE, glm::value_ptr(NormalMatrix));
-    glDrawArrays(GL_TRIANGLES, 0, cone.getVertexCount());
-    glBindVertexArray(0);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
+    onInput(window, InputEvent{InputEvent::CURSOR, 0, 0, xpos, ypos});
 }
 
-void drawCone2(Cone cone, GLuint vao, const glm::mat4 &MVMatrix, glm::mat4 ProjMatrix, GLint MVPMatrixLocation, GLint isConeLocation)
+/* Charge l'enregistrement à rejouer, si demandé */
+static bool loadReplay(const Options &options, InputReplay &replay)
 {
-    glUniformMatrix4fv(MVPMatrixLocation, 1, GL_FALSE, glm::value_ptr(ProjMatrix * MVMatrix));
-    glUniform1i(isConeLocation, GL_TRUE);
-
-    glBindVertexArray(vao);
-    glDrawArrays(GL_TRIANGLES, 0, cone.getVertexCount());
-    glBindVertexArray(0);
-
-    glUniform1i(isConeLocation, GL_FALSE);
+    if (options.replay.empty())
+    {
+        return true;
+    }
+    if (!replay.load(options.replay))
+    {
+        return false;
+    }
+    std::clog << "Replaying " << replay.getFrameCount() << " frames from " << options.replay << std::endl;
+    return true;
 }
 
-void drawBalloon(Sphere sphere, GLuint vao, GLuint texture, glm::mat4 ViewMatrix, glm::mat4 ProjMatrix, GLint MVPMatrixLocation, GLint MVMatrixLocation, GLint NormalMatrixLocation, GLint textureLocation)
+/* Prépare le frame 'frame' : rejoue ses évènements ou enregistre ceux reçus depuis le frame précédent */
+static void beginFrame(Application &app, const InputReplay &replay, size_t frame, float time)
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glUniform1i(textureLocation, 0);
-
-    glBindVertexArray(vao);
-
-    float currentTime = glfwGetTime();
-    float timeOffset = animateBall ? currentTime - ballTimeOffset : lastTime - ballTimeOffset;
-
-    float angle = timeOffset * 0.5f;
-    float x = 8.0f * cos(angle);
-    float z = -5.0f + 8.0f * sin(angle);
-    float y = -1.6f + 1.0f * sin(10 * angle);
-
-    glm::mat4 MVMatrix = glm::translate(ViewMatrix, glm::vec3(x, y, z));
-
-    float directionAngle = atan2(8.0f * sin(angle), 8.0f * cos(angle));
-    MVMatrix = glm::rotate(MVMatrix, -directionAngle, glm::vec3(0.f, 1.f, 0.f));
-
-    MVMatrix = glm::rotate(MVMatrix, (float)timeOffset * 4, glm::vec3(1.f, 0.f, 0.f));
-
-    MVMatrix = glm::scale(MVMatrix, glm::vec3(0.5f, 0.5f, 0.5f));
-    glm::mat4 NormalMatrix = glm::transpose(glm::inverse(MVMatrix));
-
-    glUniformMatrix4fv(MVPMatrixLocation, 1, GL_FALSE, glm::value_ptr(ProjMatrix * MVMatrix));
-    glUniformMatrix4fv(MVMatrixLocation, 1, GL_FALSE, glm::value_ptr(MVMatrix));
-    glUniformMatrix4fv(NormalMatrixLocation, 1, GL_FALSE, glm::value_ptr(NormalMatrix));
-    glDrawArrays(GL_TRIANGLES, 0, sphere.getVertexCount());
-    glBindVertexArray(0);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
+    if (app.replaying && !replayFrame(app, replay.getFrame(frame), time) && !app.diverged)
+    {
+        std::cerr << "Replay diverged from the recording at frame " << frame << std::endl;
+        app.diverged = true;
+    }
+    if (app.recorder.isOpen())
+    {
+        app.recorder.endFrame(time, CameraPose::fromCamera(app.scene->camera));
+    }
 }
 
-float calculateDistance(const glm::vec3 &cameraPosition, const glm::vec3 &objectPosition)
+/*
+ * Allocations sur le tas du frame 'frame', comptées de Scene::render à endGLFrame. Avec --zero-alloc, false
+ * (et leur détail par étiquette sur la sortie d'erreur) si le frame alloue alors que la scène est préchauffée.
+ */
+static bool checkFrameAllocations(const Options &options, size_t frame, const AllocationReport &allocations)
 {
-    return glm::length(cameraPosition - objectPosition);
+    if (!options.zeroAllocations || frame < size_t(options.warmup) || !allocations.m_Total.m_nAllocations)
+    {
+        return true;
+    }
+    std::cerr << "Frame " << frame << " allocated after the warmup: " << allocations.getSummary() << std::endl;
+    return false;
 }
 
-GLuint loadCubemap(std::vector<std::string> faces)
+static int runWindowed(const FilePath &applicationPath, const Options &options)
 {
-    // Load cubemap for skybox
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-    int width, height, nrChannels;
-    for (unsigned int i = 0; i < faces.size(); i++)
+    InputReplay replay;
+    if (!loadReplay(options, replay))
     {
-        unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-        if (data)
-        {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                         0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        }
-        else
-        {
-            std::cerr << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-            stbi_image_free(data);
-        }
+        return -1;
     }
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-    return textureID;
-}
 
-int main(int /*argc*/, char **argv)
-{
     /* Initialize the library */
     if (!glfwInit())
     {
@@ -325,757 +298,579 @@ int main(int /*argc*/, char **argv)
     {
         return -1;
     }
+    glimac::loadGLExtensions((GLADloadproc)glfwGetProcAddress);
 
-    /* Load shaders */
+    {
+        Scene scene(applicationPath);
+        if (!scene.init())
+        {
+            return -1;
+        }
+        scene.setDebugView(options.debugView);
+        if (options.vertexPulling && !Scene::isVertexPullingSupported())
+        {
+            std::cerr << "--vertex-pulling needs OpenGL 4.3" << std::endl;
+            return -1;
+        }
+        scene.settings.vertexPulling = options.vertexPulling;
+
+        Overlay overlay(window);
+        bool vsync = true;
+        glfwSwapInterval(1);
+
+        Application app;
+        app.scene = &scene;
+        app.overlay = &overlay;
+        app.replaying = !options.replay.empty();
+        app.tracePath = options.trace.empty() ? "trace.json" : options.trace;
+        if (!options.record.empty() && !app.recorder.open(options.record))
+        {
+            return -1;
+        }
 
-    FilePath applicationPath(argv[0]);
+        if (!options.profileCSV.empty() && !scene.getProfiler().openCSV(options.profileCSV))
+        {
+            return -1;
+        }
 
-    /*****************
-     * Skybox Shaders
-     *****************/
+        /* Hook input callbacks */
+        glfwSetWindowUserPointer(window, &app);
+        glfwSetKeyCallback(window, &key_callback);
+        glfwSetMouseButtonCallback(window, &mouse_button_callback);
+        glfwSetCursorPosCallback(window, &cursor_position_callback);
 
-    Program skyboxProgram = loadProgram(applicationPath.dirPath() + "../src/shaders/skybox.vs.glsl",
-                                        applicationPath.dirPath() + "../src/shaders/skybox.fs.glsl");
+        double lastTitleUpdate = 0.;
+        double lastFrameTime = glfwGetTime();
+        bool allocated = false;
+        for (size_t frame = 0; !glfwWindowShouldClose(window) && !app.quit && !allocated; frame++)
+        {
+            if (app.replaying && frame == replay.getFrameCount())
+            {
+                break;
+            }
+            GLIMAC_PROFILE_ZONE("frame");
+            // En rejeu, l'horloge virtuelle remplace glfwGetTime
+            float time = app.replaying ? frame / options.fps : glfwGetTime();
+            beginFrame(app, replay, frame, time);
+            if ((!options.capture.empty() && frame == size_t(options.captureStart)) || app.captureRequested)
+            {
+                GLCapture::start(options.capture.empty() ? "capture.gltrace" : options.capture, options.captureFrames);
+                app.captureRequested = false;
+            }
 
-    /*****************
-     * Room 1 Shaders
-     *****************/
+            glfwGetFramebufferSize(window, &window_width, &window_height);
+            AllocationTracker::beginFrame();
+            scene.render(time, window_width, window_height);
+            endGLFrame();
+            AllocationReport allocations = AllocationTracker::endFrame();
+            allocated = !checkFrameAllocations(options, frame, allocations);
+            overlay.setFrameAllocations(allocations);
 
-    Program room1Program = loadProgram(applicationPath.dirPath() + "../src/shaders/room1.vs.glsl",
-                                       applicationPath.dirPath() + "../src/shaders/room1.fs.glsl");
+            /* Overlay (touche O) */
+            {
+                GLIMAC_PROFILE_ZONE("overlay");
+                double now = glfwGetTime();
+                overlay.addFrameTime(float((now - lastFrameTime) * 1000.));
+                lastFrameTime = now;
+
+                bool previousVsync = vsync;
+                overlay.render(scene, vsync);
+                if (vsync != previousVsync)
+                {
+                    glfwSwapInterval(vsync ? 1 : 0);
+                }
+            }
 
-    GLint room1MVPMatrixLocation = glGetUniformLocation(room1Program.getGLId(), "uMVPMatrix");
-    GLint room1MVMatrixLocation = glGetUniformLocation(room1Program.getGLId(), "uMVMatrix");
-    GLint room1NormalMatrixLocation = glGetUniformLocation(room1Program.getGLId(), "uNormalMatrix");
-    GLint room1TextureLocation = glGetUniformLocation(room1Program.getGLId(), "uTexture");
+            // Temps des passes (GPU/CPU) et appels GL dans le titre de la fenêtre, deux fois par seconde
+            if (glfwGetTime() - lastTitleUpdate > 0.5)
+            {
+                std::string title = "Deux salles, deux ambiances - " + scene.getProfiler().getSummary() + " - " + getGLFrameSummary(getLastGLFrameCounters());
+                glfwSetWindowTitle(window, title.c_str());
+                lastTitleUpdate = glfwGetTime();
+            }
 
-    // Load images
-    std::unique_ptr<Image> wood = loadImage("../assets/textures/wood.png");
-    std::unique_ptr<Image> tree = loadImage("../assets/textures/tree.png");
-    std::unique_ptr<Image> ball = loadImage("../assets/textures/ball.png");
+            /* Swap front and back buffers */
+            {
+                GLIMAC_PROFILE_ZONE("swap buffers");
+                glfwSwapBuffers(window);
+            }
+            /* Poll for and process events */
+            {
+                GLIMAC_PROFILE_ZONE("poll events");
+                glfwPollEvents();
+            }
+        }
 
-    if (wood == nullptr || tree == nullptr || ball == nullptr)
-    {
-        return -1;
+        app.recorder.close();
+        if (allocated)
+        {
+            glfwTerminate();
+            return -1;
+        }
     }
 
-    // Load texture
-    GLuint woodTexture;
-    {
-        glGenTextures(1, &woodTexture);
-        glBindTexture(GL_TEXTURE_2D, woodTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, wood->getWidth(), wood->getHeight(), 0, GL_RGBA, GL_FLOAT, wood->getPixels());
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
+    glfwTerminate();
 
-    GLuint treeTexture;
+    return 0;
+}
+
+/*
+ * Rendu hors écran (EGL surfaceless ou OSMesa) de 'frames' frames avec la même scène que la fenêtre,
+ * l'animation avançant à 'fps' images par seconde. Avec --replay, les frames sont ceux de l'enregistrement.
+ * Affiche les statistiques en JSON sur la sortie standard.
+ */
+static int runHeadless(const FilePath &applicationPath, const Options &options)
+{
+    InputReplay replay;
+    if (!loadReplay(options, replay))
     {
-        glGenTextures(1, &treeTexture);
-        glBindTexture(GL_TEXTURE_2D, treeTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tree->getWidth(), tree->getHeight(), 0, GL_RGBA, GL_FLOAT, tree->getPixels());
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        return -1;
     }
 
-    GLuint ballTexture;
+    HeadlessContext context;
+    if (!context.create(options.width, options.height))
     {
-        glGenTextures(1, &ballTexture);
-        glBindTexture(GL_TEXTURE_2D, ballTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ball->getWidth(), ball->getHeight(), 0, GL_RGBA, GL_FLOAT, ball->getPixels());
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        return -1;
     }
 
-    /*****************
-     * Room 2 Shaders
-     *****************/
-
-    Program room2Program = loadProgram(applicationPath.dirPath() + "../src/shaders/room2.vs.glsl",
-                                       applicationPath.dirPath() + "../src/shaders/room2.fs.glsl");
-    room2Program.use();
-
-    GLint room2MVPMatrixLocation = glGetUniformLocation(room2Program.getGLId(), "uMVPMatrix");
-    GLint isConeLocation = glGetUniformLocation(room2Program.getGLId(), "isCone");
-
-    glEnable(GL_DEPTH_TEST);
-
-    /* Hook input callbacks */
-    glfwSetKeyCallback(window, &key_callback);
-    glfwSetMouseButtonCallback(window, &mouse_button_callback);
-    glfwSetCursorPosCallback(window, &cursor_position_callback);
-    glfwSetWindowSizeCallback(window, &size_callback);
-
-    /***********************
-     * INITIALIZATION CODE
-     ***********************/
-
-    /*********
-     * FLOOR
-     *********/
-
-    Vertex3DColor floorVertices[] = {
-        Vertex3DColor(glm::vec3(-12.f, -21.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.25f, 0.2f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(12.f, -21.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.25f, 0.2f, 1.f), glm::vec2(1.f, 0.f)),
-        Vertex3DColor(glm::vec3(12.f, 21.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.25f, 0.2f, 1.f), glm::vec2(1.f, 1.f)),
-        Vertex3DColor(glm::vec3(-12.f, 21.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.25f, 0.2f, 1.f), glm::vec2(0.f, 1.f)),
-        Vertex3DColor(glm::vec3(-12.f, -21.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.25f, 0.2f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(12.f, 21.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.25f, 0.2f, 1.f), glm::vec2(1.f, 1.f))};
-
-    /* VBO & VAO */
-    GLuint floorVBO, floorVAO;
-    initRecVBOandVAO(floorVBO, floorVAO, floorVertices, sizeof(floorVertices));
-
-    /********
-     * WALLS
-     ********/
-
-    // Mur arrière
-    Vertex3DColor backWallVertices[] = {
-        Vertex3DColor(glm::vec3(-12.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(12.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 0.f)),
-        Vertex3DColor(glm::vec3(12.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f)),
-        Vertex3DColor(glm::vec3(-12.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 1.f)),
-        Vertex3DColor(glm::vec3(-12.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(12.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f))};
-
-    // Mur gauche
-    Vertex3DColor leftWallVertices[] = {
-        Vertex3DColor(glm::vec3(-10.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(10.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 0.f)),
-        Vertex3DColor(glm::vec3(10.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f)),
-        Vertex3DColor(glm::vec3(-10.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 1.f)),
-        Vertex3DColor(glm::vec3(-10.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(10.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f))};
-
-    // Mur droit
-    Vertex3DColor rightWallVertices[] = {
-        Vertex3DColor(glm::vec3(-10.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(10.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 0.f)),
-        Vertex3DColor(glm::vec3(10.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f)),
-        Vertex3DColor(glm::vec3(-10.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 1.f)),
-        Vertex3DColor(glm::vec3(-10.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(10.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f))};
-
-    // Mur petit
-    Vertex3DColor smallWallVertices[] = {
-        Vertex3DColor(glm::vec3(-5.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(5.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 0.f)),
-        Vertex3DColor(glm::vec3(5.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f)),
-        Vertex3DColor(glm::vec3(-5.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 1.f)),
-        Vertex3DColor(glm::vec3(-5.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(5.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f))};
-
-    // Mur de passage
-    Vertex3DColor leftPassageWallVertices[] = {
-        Vertex3DColor(glm::vec3(-1.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(1.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 0.f)),
-        Vertex3DColor(glm::vec3(1.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f)),
-        Vertex3DColor(glm::vec3(-1.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 1.f)),
-        Vertex3DColor(glm::vec3(-1.f, -3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(1.f, 3.f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f))};
-
-    Vertex3DColor rightPassageWallVertices[] = {
-        Vertex3DColor(glm::vec3(-1.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(1.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 0.f)),
-        Vertex3DColor(glm::vec3(1.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f)),
-        Vertex3DColor(glm::vec3(-1.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 1.f)),
-        Vertex3DColor(glm::vec3(-1.f, -3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(1.f, 3.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.5f, 0.6f, 0.7f, 1.f), glm::vec2(1.f, 1.f))};
-
-    // Initialisation des VBO et VAO pour chaque mur
-    GLuint backWallVBO, backWallVAO;
-    initRecVBOandVAO(backWallVBO, backWallVAO, backWallVertices, sizeof(backWallVertices));
-
-    GLuint leftWallVBO, leftWallVAO;
-    initRecVBOandVAO(leftWallVBO, leftWallVAO, leftWallVertices, sizeof(leftWallVertices));
-
-    GLuint rightWallVBO, rightWallVAO;
-    initRecVBOandVAO(rightWallVBO, rightWallVAO, rightWallVertices, sizeof(rightWallVertices));
-
-    GLuint smallWallVBO, smallWallVAO;
-    initRecVBOandVAO(smallWallVBO, smallWallVAO, smallWallVertices, sizeof(smallWallVertices));
-
-    GLuint leftPassageWallVBO, leftPassageWallVAO;
-    initRecVBOandVAO(leftPassageWallVBO, leftPassageWallVAO, leftPassageWallVertices, sizeof(leftPassageWallVertices));
-
-    GLuint rightPassageWallVBO, rightPassageWallVAO;
-    initRecVBOandVAO(rightPassageWallVBO, rightPassageWallVAO, rightPassageWallVertices, sizeof(rightPassageWallVertices));
-
-    /*********
-     * WINDOW
-     *********/
-
-    Vertex3DColor windowVertices[] = {
-        Vertex3DColor(glm::vec3(-0.5f, -0.5f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 1.f, 1.f, 0.15f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(0.5f, -0.5f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 1.f, 1.f, 0.15f), glm::vec2(1.f, 1.f)),
-        Vertex3DColor(glm::vec3(0.5f, 0.5f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 1.f, 1.f, 0.15f), glm::vec2(1.f, 1.f)),
-        Vertex3DColor(glm::vec3(-0.5f, 0.5f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 1.f, 1.f, 0.15f), glm::vec2(0.f, 1.f)),
-        Vertex3DColor(glm::vec3(-0.5f, -0.5f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 1.f, 1.f, 0.15f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(0.5f, 0.5f, 0.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(1.f, 1.f, 1.f, 0.15f), glm::vec2(1.f, 1.f))};
-
-    /* VBO & VAO */
-    GLuint windowVBO, windowVAO;
-    initRecVBOandVAO(windowVBO, windowVAO, windowVertices, sizeof(windowVertices));
-
-    /***********
-     * PEDESTAL
-     ***********/
-
-    Vertex3DColor pedestalVertices[] = {
-        Vertex3DColor(glm::vec3(-1.f, -1.25f, -1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(1.f, -1.25f, -1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(1.f, 1.25f, -1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(-1.f, 1.25f, -1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(-1.f, -1.25f, 1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(1.f, -1.25f, 1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(1.f, 1.25f, 1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(-1.f, 1.25f, 1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec4(0.5f, 0.5f, 0.5f, 1.f), glm::vec2(1.f, 1.f))};
-
-    GLuint pedestalIndices[] = {
-        0, 1, 2, 2, 3, 0, // Front face
-        4, 5, 6, 6, 7, 4, // Back face
-        0, 1, 5, 5, 4, 0, // Bottom face
-        2, 3, 7, 7, 6, 2, // Top face
-        0, 3, 7, 7, 4, 0, // Left face
-        1, 2, 6, 6, 5, 1  // Right face
-    };
-
-    GLuint pedestalVBO, pedestalVAO, pedestalEBO;
+    FrameStats frameStats;
+    std::vector<GPUProfiler::Timing> passes;
+    AllocationCounters allocations;                         // Somme des frames mesurés
+    std::map<std::string, AllocationCounters> allocationTags; // Idem, par étiquette
+    size_t arenaPeak = 0, arenaCapacity = 0, arenaOverflows = 0;
+    StreamBuffer::Stats drawDataStats;
     {
-        glGenVertexArrays(1, &pedestalVAO);
-        glGenBuffers(1, &pedestalVBO);
-        glGenBuffers(1, &pedestalEBO);
-
-        glBindVertexArray(pedestalVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, pedestalVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(pedestalVertices), pedestalVertices, GL_STATIC_DRAW);
+        Scene scene(applicationPath);
+        if (!scene.init())
+        {
+            return -1;
+        }
+        scene.setDebugView(options.debugView);
+        if (options.vertexPulling && !Scene::isVertexPullingSupported())
+        {
+            std::cerr << "--vertex-pulling needs OpenGL 4.3" << std::endl;
+            return -1;
+        }
+        scene.settings.vertexPulling = options.vertexPulling;
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pedestalEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(pedestalIndices), pedestalIndices, GL_STATIC_DRAW);
+        Application app;
+        app.scene = &scene;
+        app.replaying = !options.replay.empty();
+        if (!options.profileCSV.empty() && !scene.getProfiler().openCSV(options.profileCSV))
+        {
+            return -1;
+        }
 
-        glEnableVertexAttribArray(VERTEX_ATTR_POSITION);
-        glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3DColor), (const GLvoid *)offsetof(Vertex3DColor, position));
+        size_t frameCount = app.replaying ? replay.getFrameCount() : size_t(options.warmup + options.frames);
+        frameStats.reserve(frameCount);
+        for (size_t i = 0; i < frameCount; i++)
+        {
+            GLIMAC_PROFILE_ZONE("frame");
+            auto start = std::chrono::steady_clock::now();
 
-        glEnableVertexAttribArray(VERTEX_ATTR_COLOR);
-        glVertexAttribPointer(VERTEX_ATTR_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex3DColor), (const GLvoid *)offsetof(Vertex3DColor, color));
+            float time = i / options.fps;
+            beginFrame(app, replay, i, time);
+            if (!options.capture.empty() && i == size_t(options.warmup + options.captureStart))
+            {
+                GLCapture::start(options.capture, options.captureFrames);
+            }
+            AllocationTracker::beginFrame();
+            scene.render(time, options.width, options.height);
+            endGLFrame();
+            AllocationReport frameAllocations = AllocationTracker::endFrame();
+            if (!checkFrameAllocations(options, i, frameAllocations))
+            {
+                return -1;
+            }
+            // Pas de swap : on attend la fin du rendu pour mesurer le frame complet
+            {
+                GLIMAC_PROFILE_ZONE("finish");
+                glFinish();
+            }
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            if (i >= size_t(options.warmup))
+            {
+                frameStats.addFrame(elapsed.count(), scene.getStats().drawCalls, scene.getStats().triangles);
+                allocations.m_nAllocations += frameAllocations.m_Total.m_nAllocations;
+                allocations.m_nBytes += frameAllocations.m_Total.m_nBytes;
+                allocations.m_nFrees += frameAllocations.m_Total.m_nFrees;
+                for (size_t tag = 0; tag < frameAllocations.m_nTagCount; tag++)
+                {
+                    AllocationCounters &counters = allocationTags[frameAllocations.m_Tags[tag].m_pName];
+                    counters.m_nAllocations += frameAllocations.m_Tags[tag].m_Counters.m_nAllocations;
+                    counters.m_nBytes += frameAllocations.m_Tags[tag].m_Counters.m_nBytes;
+                }
+            }
+        }
+        // Lit les requêtes des derniers frames
+        scene.getProfiler().flush();
+        passes = scene.getProfiler().getTimings();
+        arenaPeak = scene.getFrameArena().getPeakBytes();
+        arenaCapacity = scene.getFrameArena().getCapacity();
+        arenaOverflows = scene.getFrameArena().getOverflowCount();
+        drawDataStats = scene.getDrawDataBuffer().getStats();
     }
 
-    /*******
-     * CONE
-     ********/
-    Cone cone(2, 1.5f, 32, 16);
-
-    /* VBO */
-    GLuint coneVBO;
+    std::cout << "{\"backend\": \"" << context.getBackend() << "\""
+              << ", \"renderer\": \"" << glGetString(GL_RENDERER) << "\""
+              << ", \"width\": " << options.width
+              << ", \"height\": " << options.height
+              << ", \"warmup\": " << options.warmup
+              << ", \"stats\": ";
+    frameStats.writeJSON(std::cout);
+    // Moyennes glissantes des passes
+    std::cout << ", \"passes\": [";
+    for (size_t i = 0; i < passes.size(); i++)
     {
-        glGenBuffers(1, &coneVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, coneVBO);
-        glBufferData(GL_ARRAY_BUFFER, cone.getVertexCount() * sizeof(ShapeVertex), cone.getDataPointer(), GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        std::cout << (i ? ", " : "") << "{\"name\": \"" << passes[i].m_sName << "\""
+                  << ", \"depth\": " << passes[i].m_nDepth
+                  << ", \"gpu_ms\": " << passes[i].m_fGPUTime
+                  << ", \"cpu_ms\": " << passes[i].m_fCPUTime << "}";
     }
-    /* VAO */
-    GLuint coneVAO;
+    // Appels GL du dernier frame
+    const GLFrameCounters &gl = getLastGLFrameCounters();
+    std::cout << "], \"gl\": {\"draw_calls\": " << gl.m_nDrawCalls
+              << ", \"vertices\": " << gl.m_nVertices
+              << ", \"program_binds\": " << gl.m_nProgramBinds
+              << ", \"vertex_array_binds\": " << gl.m_nVertexArrayBinds
+              << ", \"buffer_binds\": " << gl.m_nBufferBinds
+              << ", \"texture_binds\": " << gl.m_nTextureBinds
+              << ", \"framebuffer_binds\": " << gl.m_nFramebufferBinds
+              << ", \"state_changes\": " << gl.m_nStateChanges
+              << ", \"uniform_bytes\": " << gl.m_nUniformBytes
+              << ", \"buffer_bytes\": " << gl.m_nBufferBytes
+              << ", \"mapped_bytes\": " << gl.m_nMappedBytes
+              << ", \"errors\": " << gl.m_nErrors << "}";
+    // Sommets lus dans un SSBO : un seul bind de VAO pour les objets
+    std::cout << ", \"vertex_pulling\": " << (options.vertexPulling ? "true" : "false");
+    // Buffers et textures créés et modifiés par leur nom, sans les lier
+    std::cout << ", \"direct_state_access\": " << (isDirectStateAccessEnabled() ? "true" : "false");
+    // Maximum de mémoire GPU sur toute l'exécution, chargement compris
+    const GLMemoryUsage &memory = getGLMemoryUsage();
+    std::cout << ", \"gpu_memory_peak\": {";
+    for (int category = 0; category < int(GLMemoryCategory::COUNT); category++)
     {
-        glGenVertexArrays(1, &coneVAO);
-        glBindVertexArray(coneVAO);
-
-        glEnableVertexAttribArray(VERTEX_ATTR_POSITION);
-        glEnableVertexAttribArray(VERTEX_ATTR_NORMAL);
-        glEnableVertexAttribArray(VERTEX_ATTR_TEXTURE);
-
-        glBindBuffer(GL_ARRAY_BUFFER, coneVBO);
-
-        glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid *)offsetof(ShapeVertex, position));
-        glVertexAttribPointer(VERTEX_ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid *)offsetof(ShapeVertex, normal));
-        glVertexAttribPointer(VERTEX_ATTR_TEXTURE, 2, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid *)offsetof(ShapeVertex, texCoords));
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        std::cout << "\"" << getGLMemoryCategoryName(GLMemoryCategory(category)) << "\": " << memory.m_nPeakBytes[category] << ", ";
     }
-
-    /********
-     * TRUNK
-     ********/
-
-    Vertex3DColor trunkVertices[] = {
-        Vertex3DColor(glm::vec3(-0.2f, -1.f, -0.2f), glm::vec3(-1.f, 0.f, 0.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(0.2f, -1.f, -0.2), glm::vec3(-1.f, 0.f, 0.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(0.2f, 1.f, -0.2), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(-0.2f, 1.f, -0.2), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(-0.2f, -1.f, 0.2), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(0.2f, -1.f, 0.2), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(0.2f, 1.f, 0.2), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(0.f, 0.f)),
-        Vertex3DColor(glm::vec3(-0.2f, 1.f, 0.2), glm::vec3(0.f, 0.f, -1.f), glm::vec4(0.4f, 0.2f, 0.f, 1.f), glm::vec2(1.f, 1.f))};
-
-    GLuint trunkIndices[] = {
-        0, 1, 2, 2, 3, 0, // Front face
-        4, 5, 6, 6, 7, 4, // Back face
-        0, 1, 5, 5, 4, 0, // Bottom face
-        2, 3, 7, 7, 6, 2, // Top face
-        0, 3, 7, 7, 4, 0, // Left face
-        1, 2, 6, 6, 5, 1  // Right face
-    };
-
-    GLuint trunkVBO, trunkVAO, trunkEBO;
+    std::cout << "\"total\": " << memory.m_nPeakTotalBytes << "}";
+    // Pour dimensionner l'arène des listes temporaires
+    std::cout << ", \"frame_arena\": {\"peak_bytes\": " << arenaPeak
+              << ", \"capacity_bytes\": " << arenaCapacity
+              << ", \"overflows\": " << arenaOverflows << "}";
+    // Buffer de flux des matrices : attentes sur les fences = GPU en retard de plus de deux frames
+    std::cout << ", \"draw_data\": {\"persistent\": " << (StreamBuffer::isPersistent() ? "true" : "false")
+              << ", \"peak_bytes\": " << drawDataStats.m_nPeakBytes
+              << ", \"waits\": " << drawDataStats.m_nWaits
+              << ", \"wait_ms\": " << drawDataStats.m_fWaitTime
+              << ", \"overflows\": " << drawDataStats.m_nOverflows << "}";
+    // Allocations sur le tas par frame mesuré, de Scene::render à endGLFrame
+    if (AllocationTracker::isEnabled())
     {
-        glGenVertexArrays(1, &trunkVAO);
-        glGenBuffers(1, &trunkVBO);
-        glGenBuffers(1, &trunkEBO);
-
-        glBindVertexArray(trunkVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, trunkVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(trunkVertices), trunkVertices, GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, trunkEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(trunkIndices), trunkIndices, GL_STATIC_DRAW);
-
-        glEnableVertexAttribArray(VERTEX_ATTR_POSITION);
-        glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3DColor), (const GLvoid *)offsetof(Vertex3DColor, position));
-
-        glEnableVertexAttribArray(VERTEX_ATTR_COLOR);
-        glVertexAttribPointer(VERTEX_ATTR_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex3DColor), (const GLvoid *)offsetof(Vertex3DColor, color));
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        double frames = std::max(frameStats.getFrameCount(), size_t(1));
+        std::cout << ", \"allocations_per_frame\": {\"count\": " << allocations.m_nAllocations / frames
+                  << ", \"bytes\": " << allocations.m_nBytes / frames
+                  << ", \"frees\": " << allocations.m_nFrees / frames
+                  << ", \"tags\": {";
+        const char *separator = "";
+        for (const auto &tag : allocationTags)
+        {
+            if (tag.second.m_nAllocations)
+            {
+                std::cout << separator << "\"" << tag.first << "\": " << tag.second.m_nAllocations / frames;
+                separator = ", ";
+            }
+        }
+        std::cout << "}}";
     }
+    std::cout << "}" << std::endl;
 
-    /**********
-     * SPHERE
-     **********/
-    Sphere sphere(1, 32, 16);
-    /* VBO */
-    GLuint sphereVBO;
-    {
-        glGenBuffers(1, &sphereVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
-        glBufferData(GL_ARRAY_BUFFER, sphere.getVertexCount() * sizeof(ShapeVertex), sphere.getDataPointer(), GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-    }
+    return 0;
+}
 
-    /* VAO */
-    GLuint sphereVAO;
+/*
+ * Montée en charge : pour chaque nombre d'objets, la scène de test est rendue hors écran avec chacun
+ * des chemins de dessin. Affiche un tableau : temps CPU de soumission, temps GPU (requêtes de temps),
+ * frame complet (jusqu'à glFinish), appels de dessin et triangles par frame.
+ */
+static int runStress(const FilePath &applicationPath, const Options &options)
+{
+    HeadlessContext context;
+    if (!context.create(options.width, options.height))
     {
-        glGenVertexArrays(1, &sphereVAO);
-        glBindVertexArray(sphereVAO);
+        return -1;
+    }
 
-        glEnableVertexAttribArray(VERTEX_ATTR_POSITION);
-        glEnableVertexAttribArray(VERTEX_ATTR_NORMAL);
-        glEnableVertexAttribArray(VERTEX_ATTR_TEXTURE);
+    const DrawPath paths[] = {DrawPath::IMMEDIATE, DrawPath::INSTANCED, DrawPath::INDIRECT, DrawPath::GPU_CULLED};
 
-        glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
+    std::printf("# %s, %dx%d, %d rooms, %d frames (+%d warmup)\n", (const char *)glGetString(GL_RENDERER),
+                options.width, options.height, options.stressRooms, options.frames, options.warmup);
+    std::printf("%9s %10s %10s %8s %11s %9s %9s %9s\n", "objects", "instances", "path", "draws", "triangles", "cpu_ms", "gpu_ms", "frame_ms");
+    for (int objectCount : options.stressObjects)
+    {
+        StressScene scene(applicationPath, options.stressRooms, objectCount);
+        for (DrawPath path : paths)
+        {
+            if (!StressScene::isSupported(path))
+            {
+                std::printf("%9d %10zu %10s %8s\n", objectCount, scene.getInstanceCount(), StressScene::getName(path), "n/a");
+                continue;
+            }
 
-        glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid *)offsetof(ShapeVertex, position));
-        glVertexAttribPointer(VERTEX_ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid *)offsetof(ShapeVertex, normal));
-        glVertexAttribPointer(VERTEX_ATTR_TEXTURE, 2, GL_FLOAT, GL_FALSE, sizeof(ShapeVertex), (const GLvoid *)offsetof(ShapeVertex, texCoords));
+            double cpuTime = 0., frameTime = 0.;
+            for (int i = 0; i < options.warmup + options.frames; i++)
+            {
+                auto start = std::chrono::steady_clock::now();
+                scene.render(path, options.width, options.height);
+                endGLFrame();
+                auto submitted = std::chrono::steady_clock::now();
+                glFinish();
+                auto finished = std::chrono::steady_clock::now();
+                if (i >= options.warmup)
+                {
+                    cpuTime += std::chrono::duration<double, std::milli>(submitted - start).count();
+                    frameTime += std::chrono::duration<double, std::milli>(finished - start).count();
+                }
+            }
+            scene.getProfiler().flush();
+            if (path == DrawPath::GPU_CULLED)
+            {
+                scene.readGPUCullingStats();
+            }
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+            double gpuTime = 0.;
+            for (const auto &timing : scene.getProfiler().getTimings())
+            {
+                if (timing.m_sName == StressScene::getName(path))
+                {
+                    gpuTime = timing.m_fGPUTime;
+                }
+            }
+            std::printf("%9d %10zu %10s %8u %11u %9.3f %9.3f %9.3f\n", objectCount, scene.getInstanceCount(), StressScene::getName(path),
+                        scene.getStats().drawCalls, scene.getStats().triangles,
+                        cpuTime / options.frames, gpuTime, frameTime / options.frames);
+            std::fflush(stdout);
+        }
     }
 
-    /**********
-     * SKYBOX
-     **********/
-
-    float skyboxVertices[] = {
-        -1.0f, 1.0f, -1.0f,
-        -1.0f, -1.0f, -1.0f,
-        1.0f, -1.0f, -1.0f,
-        1.0f, -1.0f, -1.0f,
-        1.0f, 1.0f, -1.0f,
-        -1.0f, 1.0f, -1.0f,
-
-        -1.0f, -1.0f, 1.0f,
-        -1.0f, -1.0f, -1.0f,
-        -1.0f, 1.0f, -1.0f,
-        -1.0f, 1.0f, -1.0f,
-        -1.0f, 1.0f, 1.0f,
-        -1.0f, -1.0f, 1.0f,
-
-        1.0f, -1.0f, -1.0f,
-        1.0f, -1.0f, 1.0f,
-        1.0f, 1.0f, 1.0f,
-        1.0f, 1.0f, 1.0f,
-        1.0f, 1.0f, -1.0f,
-        1.0f, -1.0f, -1.0f,
-
-        -1.0f, -1.0f, 1.0f,
-        -1.0f, 1.0f, 1.0f,
-        1.0f, 1.0f, 1.0f,
-        1.0f, 1.0f, 1.0f,
-        1.0f, -1.0f, 1.0f,
-        -1.0f, -1.0f, 1.0f,
-
-        -1.0f, 1.0f, -1.0f,
-        1.0f, 1.0f, -1.0f,
-        1.0f, 1.0f, 1.0f,
-        1.0f, 1.0f, 1.0f,
-        -1.0f, 1.0f, 1.0f,
-        -1.0f, 1.0f, -1.0f,
-
-        -1.0f, -1.0f, -1.0f,
-        -1.0f, -1.0f, 1.0f,
-        1.0f, -1.0f, -1.0f,
-        1.0f, -1.0f, -1.0f,
-        -1.0f, -1.0f, 1.0f,
-        1.0f, -1.0f, 1.0f};
-
-    // Load skybox textures
-    std::vector<std::string> faces{
-        applicationPath.dirPath() + "/assets/skybox/right.jpg",
-        applicationPath.dirPath() + "/assets/skybox/left.jpg",
-        applicationPath.dirPath() + "/assets/skybox/top.jpg",
-        applicationPath.dirPath() + "/assets/skybox/bottom.jpg",
-        applicationPath.dirPath() + "/assets/skybox/front.jpg",
-        applicationPath.dirPath() + "/assets/skybox/back.jpg"};
-
-    GLuint cubemapTexture = loadCubemap(faces);
-
-    // Skybox VAO and VBO
-    GLuint skyboxVAO, skyboxVBO;
-    {
-        glGenVertexArrays(1, &skyboxVAO);
-        glGenBuffers(1, &skyboxVBO);
-        glBindVertexArray(skyboxVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
-        glEnableVertexAttribArray(VERTEX_ATTR_POSITION);
-        glVertexAttribPointer(VERTEX_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-        glBindVertexArray(0);
-    }
+    return 0;
+}
 
-    while (!glfwWindowShouldClose(window))
+/* Liste d'entiers séparés par des virgules : "100,1000,10000" */
+static bool parseIntList(const char *text, std::vector<int> &values)
+{
+    values.clear();
+    for (const char *c = text; *c;)
     {
-        glClearColor(0.f, 0.f, 0.f, 1.f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        /*****************
-         * RENDERING CODE
-         *****************/
-
-        glm::mat4 ViewMatrix = camera.getViewMatrix();
-        glm::mat4 ProjMatrix = glm::perspective(glm::radians(70.f), (float)window_width / window_height, 0.1f, 100.f);
-        glm::mat4 MVMatrix = glm::translate(ViewMatrix, glm::vec3(0, 0, 0));
-
-        /* Skybox */
+        char *end;
+        long value = std::strtol(c, &end, 10);
+        if (end == c || value <= 0 || (*end && *end != ','))
         {
-            glDepthFunc(GL_LEQUAL);
-            skyboxProgram.use();
-            glm::mat4 view = glm::mat4(glm::mat3(camera.getViewMatrix()));
-            glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)window_width / window_height, 0.1f, 100.0f);
-            glUniformMatrix4fv(glGetUniformLocation(skyboxProgram.getGLId(), "view"), 1, GL_FALSE, glm::value_ptr(view));
-            glUniformMatrix4fv(glGetUniformLocation(skyboxProgram.getGLId(), "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-            glBindVertexArray(skyboxVAO);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-            glBindVertexArray(0);
-            glDepthFunc(GL_LESS);
+            return false;
         }
+        values.push_back(value);
+        c = *end ? end + 1 : end;
+    }
+    return !values.empty();
+}
 
-        /*******************
-         * SHADER SELECTION
-         *******************/
+int main(int argc, char **argv)
+{
+    GLIMAC_PROFILE_THREAD("main");
+    FilePath applicationPath(argv[0]);
 
-        if (camera.getPosition().z > -17)
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--headless"))
         {
-            room1Program.use();
-            room1 = true;
-
-            // World space
-            glm::vec3 lightPos1_world = glm::vec3(8.0f * cos((float)glfwGetTime()), 0.f, -5.0f + 8.0f * sin((float)glfwGetTime()));
-            glm::vec3 lightPos2_world = glm::vec3(8.f, 2.f, -12.f);
-
-            // View
-            glm::vec3 lightPos1_vs = glm::vec3(ViewMatrix * glm::vec4(lightPos1_world, 1.0f));
-            glm::vec3 lightPos2_vs = glm::vec3(ViewMatrix * glm::vec4(lightPos2_world, 1.0f));
-
-            // Light uniforms
-            GLint uLightPos1_vs = glGetUniformLocation(room1Program.getGLId(), "uLightPos1_vs");
-            GLint uLightIntensity1 = glGetUniformLocation(room1Program.getGLId(), "uLightIntensity1");
-            GLint uLightPos2_vs = glGetUniformLocation(room1Program.getGLId(), "uLightPos2_vs");
-            GLint uLightIntensity2 = glGetUniformLocation(room1Program.getGLId(), "uLightIntensity2");
-
-            // Light intensity
-            glm::vec3 lightIntensity1;
-            (light) ? lightIntensity1 = glm::vec3(1.0f, 0.5f, 0.0f) : lightIntensity1 = glm::vec3(0.0f, 0.0f, 0.0f);
-            glm::vec3 lightIntensity2 = glm::vec3(0.0f, 0.5f, 1.0f);
-
-            // Light uniforms
-            glUniform3fv(uLightPos1_vs, 1, glm::value_ptr(lightPos1_vs));
-            glUniform3fv(uLightIntensity1, 1, glm::value_ptr(lightIntensity1));
-            glUniform3fv(uLightPos2_vs, 1, glm::value_ptr(lightPos2_vs));
-            glUniform3fv(uLightIntensity2, 1, glm::value_ptr(lightIntensity2));
-
-            // Set material uniforms
-            GLint uKd = glGetUniformLocation(room1Program.getGLId(), "uKd");
-            GLint uKs = glGetUniformLocation(room1Program.getGLId(), "uKs");
-            GLint uShininess = glGetUniformLocation(room1Program.getGLId(), "uShininess");
-
-            glm::vec3 Kd = glm::vec3(0.8f, 0.8f, 0.8f);
-            glm::vec3 Ks = glm::vec3(0.5f, 0.5f, 0.5f);
-            float shininess = 50.0f;
-
-            glUniform3fv(uKd, 1, glm::value_ptr(Kd));
-            glUniform3fv(uKs, 1, glm::value_ptr(Ks));
-            glUniform1f(uShininess, shininess);
+            options.headless = true;
         }
-        else
+        else if (!std::strcmp(argv[i], "--frames") && i + 1 < argc)
         {
-            room2Program.use();
-            room1 = false;
+            options.frames = std::atoi(argv[++i]);
         }
-
-        /*****************
-         * SCENE GEOMETRY
-         *****************/
-
+        else if (!std::strcmp(argv[i], "--warmup") && i + 1 < argc)
         {
-            /* Floor */
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(0, -3, -17));
-            MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(1, 0, 0));
-            (room1)
-                ? drawRec(floorVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, woodTexture, room1TextureLocation)
-                : drawRec2(floorVAO, MVMatrix, ProjMatrix, room2MVPMatrixLocation);
-
-            /* Room 1 Back wall */
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(0, 0, 4));
-            (room1)
-                ? drawRec(backWallVBO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, woodTexture, room1TextureLocation)
-                : drawRec2(backWallVBO, MVMatrix, ProjMatrix, room2MVPMatrixLocation);
-
-            /* Room 1 Left wall */
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(-12, 0, -6));
-            MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 1, 0));
-            (room1)
-                ? drawRec(leftWallVBO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, woodTexture, room1TextureLocation)
-                : drawRec2(leftWallVBO, MVMatrix, ProjMatrix, room2MVPMatrixLocation);
-
-            /* Room 1 Right wall */
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(12, 0, -6));
-            MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 1, 0));
-            (room1)
-                ? drawRec(rightWallVBO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, woodTexture, room1TextureLocation)
-                : drawRec2(rightWallVBO, MVMatrix, ProjMatrix, room2MVPMatrixLocation);
-
-            /* Room 1 Small left wall */
-            glBindVertexArray(smallWallVAO);
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(-7, 0, -16));
-            (room1)
-                ? drawRec(smallWallVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, woodTexture, room1TextureLocation)
-                : drawRec2(smallWallVAO, MVMatrix, ProjMatrix, room2MVPMatrixLocation);
-
-            /* Room 1 Small right wall */
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, 0, -16));
-            (room1)
-                ? drawRec(smallWallVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, woodTexture, room1TextureLocation)
-                : drawRec2(smallWallVAO, MVMatrix, ProjMatrix, room2MVPMatrixLocation);
-
-            /* Passage walls */
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(-2, 0, -17));
-            MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 1, 0));
-            (room1)
-                ? drawRec(leftPassageWallVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, woodTexture, room1TextureLocation)
-                : drawRec2(leftPassageWallVAO, MVMatrix, ProjMatrix, room2MVPMatrixLocation);
-
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(2, 0, -17));
-            MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 1, 0));
-            (room1)
-                ? drawRec(rightPassageWallVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, woodTexture, room1TextureLocation)
-                : drawRec2(rightPassageWallVAO, MVMatrix, ProjMatrix, room2MVPMatrixLocation);
-
-            /* Room 2 back wall */
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(0, 0, -38)); // Position in front
-            (room1)
-                ? drawRec(backWallVBO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, woodTexture, room1TextureLocation)
-                : drawRec2(backWallVBO, MVMatrix, ProjMatrix, room2MVPMatrixLocation);
-
-            /* Room 2 Left wall */
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(-12, 0, -28)); // Position in front
-            MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 1, 0));
-            (room1)
-                ? drawRec(leftWallVBO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, woodTexture, room1TextureLocation)
-                : drawRec2(leftWallVBO, MVMatrix, ProjMatrix, room2MVPMatrixLocation);
-
-            /* Room 2 Right wall */
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(12, 0, -28)); // Position in front
-            MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 1, 0));
-            (room1)
-                ? drawRec(rightWallVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, woodTexture, room1TextureLocation)
-                : drawRec2(rightWallVAO, MVMatrix, ProjMatrix, room2MVPMatrixLocation);
-
-            /* Room 2 Small left wall */
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(-7, 0, -18));
-            (room1)
-                ? drawRec(smallWallVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, woodTexture, room1TextureLocation)
-                : drawRec2(smallWallVAO, MVMatrix, ProjMatrix, room2MVPMatrixLocation);
-
-            /* Room 2 Small right wall */
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, 0, -18));
-            (room1)
-                ? drawRec(smallWallVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, woodTexture, room1TextureLocation)
-                : drawRec2(smallWallVAO, MVMatrix, ProjMatrix, room2MVPMatrixLocation);
+            options.warmup = std::atoi(argv[++i]);
         }
-
-        /*****************
-         * ROOM 1 OBJECTS
-         *****************/
+        else if (!std::strcmp(argv[i], "--width") && i + 1 < argc)
         {
-            /* Tree */
-            drawCone(cone, treeTexture, coneVAO, ViewMatrix, ProjMatrix, glm::vec3(-9.f, -0.15f, 1.f), glm::vec3(0.6f, 0.6f, 0.6f), room1TextureLocation, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation);
-            drawCone(cone, treeTexture, coneVAO, ViewMatrix, ProjMatrix, glm::vec3(-9.f, -1, 1.f), glm::vec3(0.8f, 0.8f, 0.8f), room1TextureLocation, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation);
-            drawCone(cone, treeTexture, coneVAO, ViewMatrix, ProjMatrix, glm::vec3(-9.f, -2, 1.f), glm::vec3(1.f, 1.f, 1.f), room1TextureLocation, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation);
-
-            /* Trunk */
-            MVMatrix = glm::translate(ViewMatrix, glm::vec3(-9.f, -2.f, 1.f));
-            glBindVertexArray(trunkVAO);
-            glUniformMatrix4fv(room1MVPMatrixLocation, 1, GL_FALSE, glm::value_ptr(ProjMatrix * MVMatrix));
-            glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-            glBindVertexArray(0);
-
-            /* Ball */
-            drawBalloon(sphere, sphereVAO, ballTexture, ViewMatrix, ProjMatrix, room1MVPMatrixLocation, room1MVMatrixLocation, room1NormalMatrixLocation, room1TextureLocation);
+            options.width = std::atoi(argv[++i]);
         }
-
-        /*****************
-         * ROOM 2 OBJECTS
-         *****************/
+        else if (!std::strcmp(argv[i], "--height") && i + 1 < argc)
         {
-            /* Spikeball */
-            {
-                glBindVertexArray(sphereVAO);
-                MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, -1, -32));
-                MVMatrix = glm::scale(MVMatrix, glm::vec3(1.05f, 1.05f, 1.05f));
-                glUniformMatrix4fv(room2MVPMatrixLocation, 1, GL_FALSE, glm::value_ptr(ProjMatrix * MVMatrix));
-                glDrawArrays(GL_TRIANGLES, 0, sphere.getVertexCount());
-                glBindVertexArray(0);
-
-                MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, 0, -32));
-                MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
-                drawCone2(cone, coneVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, isConeLocation);
-
-                MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, -2, -32));
-                MVMatrix = glm::rotate(MVMatrix, glm::radians(180.f), glm::vec3(1, 0, 0));
-                MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
-                drawCone2(cone, coneVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, isConeLocation);
-
-                MVMatrix = glm::translate(ViewMatrix, glm::vec3(6, -1, -32));
-                MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 0, 1));
-                MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
-                drawCone2(cone, coneVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, isConeLocation);
-
-                MVMatrix = glm::translate(ViewMatrix, glm::vec3(8, -1, -32));
-                MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(0, 0, -1));
-                MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
-                drawCone2(cone, coneVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, isConeLocation);
-
-                MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, -1, -31));
-                MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(1, 0, 0));
-                MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
-                drawCone2(cone, coneVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, isConeLocation);
-
-                MVMatrix = glm::translate(ViewMatrix, glm::vec3(7, -1, -33));
-                MVMatrix = glm::rotate(MVMatrix, glm::radians(90.f), glm::vec3(-1, 0, 0));
-                MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
-                drawCone2(cone, coneVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, isConeLocation);
-            }
-
-            /* Pedestal */
+            options.height = std::atoi(argv[++i]);
+        }
+        else if (!std::strcmp(argv[i], "--fps") && i + 1 < argc)
+        {
+            options.fps = std::atof(argv[++i]);
+        }
+        else if (!std::strcmp(argv[i], "--record") && i + 1 < argc)
+        {
+            options.record = argv[++i];
+        }
+        else if (!std::strcmp(argv[i], "--replay") && i + 1 < argc)
+        {
+            options.replay = argv[++i];
+        }
+        else if (!std::strcmp(argv[i], "--profile-csv") && i + 1 < argc)
+        {
+            options.profileCSV = argv[++i];
+        }
+        else if (!std::strcmp(argv[i], "--trace") && i + 1 < argc)
+        {
+            options.trace = argv[++i];
+        }
+        else if (!std::strcmp(argv[i], "--debug-view") && i + 1 < argc)
+        {
+            if (!parseDebugView(argv[++i], options.debugView))
             {
-                MVMatrix = glm::translate(ViewMatrix, glm::vec3(-6.f, -1.75f, -24.75));
-                glBindVertexArray(pedestalVAO);
-                glUniformMatrix4fv(room2MVPMatrixLocation, 1, GL_FALSE, glm::value_ptr(ProjMatrix * MVMatrix));
-                glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-                glBindVertexArray(0);
-
-                MVMatrix = glm::translate(ViewMatrix, glm::vec3(-6.f, -0.5f, -24.75));
-                MVMatrix = glm::scale(MVMatrix, glm::vec3(0.2f, 0.2f, 0.2f));
-                drawCone2(cone, coneVAO, MVMatrix, ProjMatrix, room1MVPMatrixLocation, isConeLocation);
+                std::cerr << "Unknown debug view " << argv[i] << " (none, wireframe, overdraw, lod, draw-id, culling)" << std::endl;
+                return -1;
             }
-
-            /* Windows */
+        }
+        else if (!std::strcmp(argv[i], "--zero-alloc"))
+        {
+            options.zeroAllocations = true;
+        }
+        else if (!std::strcmp(argv[i], "--vertex-pulling"))
+        {
+            options.vertexPulling = true;
+        }
+        else if (!std::strcmp(argv[i], "--no-dsa"))
+        {
+            options.noDirectStateAccess = true;
+        }
+        else if (!std::strcmp(argv[i], "--stress"))
+        {
+            options.stress = true;
+        }
+        else if (!std::strcmp(argv[i], "--stress-rooms") && i + 1 < argc)
+        {
+            options.stressRooms = std::atoi(argv[++i]);
+        }
+        else if (!std::strcmp(argv[i], "--stress-objects") && i + 1 < argc)
+        {
+            if (!parseIntList(argv[++i], options.stressObjects))
             {
-                std::vector<TransparentObject> transparentObjects = {
-                    {windowVAO, glm::vec3(-6, 0, -24), glm::translate(ViewMatrix, glm::vec3(-6, 0, -24))},
-                    {windowVAO, glm::vec3(-6, 0, -25.5), glm::translate(ViewMatrix, glm::vec3(-6, 0, -25.5))},
-                    {windowVAO, glm::vec3(-6.75f, 0, -24.75f), glm::rotate(glm::translate(ViewMatrix, glm::vec3(-6.75f, 0, -24.75f)), glm::radians(90.f), glm::vec3(0, 1, 0))},
-                    {windowVAO, glm::vec3(-5.25f, 0, -24.75f), glm::rotate(glm::translate(ViewMatrix, glm::vec3(-5.25f, 0, -24.75f)), glm::radians(90.f), glm::vec3(0, 1, 0))}};
-
-                glm::vec3 cameraPosition = camera.getPosition();
-
-                std::sort(transparentObjects.begin(), transparentObjects.end(), [&cameraPosition](const TransparentObject &a, const TransparentObject &b)
-                          { return calculateDistance(cameraPosition, a.position) > calculateDistance(cameraPosition, b.position); });
-
-                glEnable(GL_BLEND);
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-                for (const auto &obj : transparentObjects)
-                {
-                    drawRec2(obj.vao, obj.modelMatrix, ProjMatrix, room2MVPMatrixLocation);
-                }
-                glDisable(GL_BLEND);
+                std::cerr << "Invalid object counts " << argv[i] << std::endl;
+                return -1;
             }
         }
-
-        /* Swap front and back buffers */
-        glfwSwapBuffers(window);
-        /* Poll for and process events */
-        glfwPollEvents();
+        else if (!std::strcmp(argv[i], "--check") && i + 1 < argc)
+        {
+            options.check = argv[++i];
+        }
+        else if (!std::strcmp(argv[i], "--update-golden"))
+        {
+            options.updateGolden = true;
+        }
+        else if (!std::strcmp(argv[i], "--no-budget"))
+        {
+            options.noBudget = true;
+        }
+        else if (!std::strcmp(argv[i], "--capture") && i + 1 < argc)
+        {
+            options.capture = argv[++i];
+        }
+        else if (!std::strcmp(argv[i], "--capture-frames") && i + 1 < argc)
+        {
+            options.captureFrames = std::atoi(argv[++i]);
+        }
+        else if (!std::strcmp(argv[i], "--capture-start") && i + 1 < argc)
+        {
+            options.captureStart = std::atoi(argv[++i]);
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--record FILE | --replay FILE [--fps F]] [--profile-csv FILE] [--trace FILE] [--capture FILE [--capture-frames N] [--capture-start N]] [--debug-view VIEW] [--zero-alloc] [--vertex-pulling] [--no-dsa]" << std::endl
+                      << "       " << argv[0] << " --headless [--replay FILE] [--frames N] [--warmup N] [--width W] [--height H] [--fps F] [--profile-csv FILE] [--trace FILE] [--capture FILE [--capture-frames N] [--capture-start N]] [--debug-view VIEW] [--zero-alloc] [--vertex-pulling] [--no-dsa]" << std::endl
+                      << "       " << argv[0] << " --stress [--stress-rooms N] [--stress-objects N,N,...] [--frames N] [--warmup N] [--width W] [--height H] [--no-dsa]" << std::endl
+                      << "       " << argv[0] << " --check DIR [--update-golden] [--no-budget] [--frames N] [--warmup N] [--width W] [--height H] [--no-dsa]" << std::endl;
+            return -1;
+        }
     }
-    glDeleteBuffers(1, &skyboxVAO);
-    glDeleteVertexArrays(1, &skyboxVBO);
-
-    glDeleteBuffers(1, &floorVBO);
-    glDeleteVertexArrays(1, &floorVAO);
-
-    glDeleteBuffers(1, &backWallVBO);
-    glDeleteVertexArrays(1, &backWallVAO);
-
-    glDeleteBuffers(1, &leftWallVBO);
-    glDeleteVertexArrays(1, &leftWallVAO);
-
-    glDeleteBuffers(1, &rightWallVBO);
-    glDeleteVertexArrays(1, &rightWallVAO);
-
-    glDeleteBuffers(1, &smallWallVBO);
-    glDeleteVertexArrays(1, &smallWallVAO);
-
-    glDeleteBuffers(1, &leftPassageWallVBO);
-    glDeleteVertexArrays(1, &leftPassageWallVAO);
-
-    glDeleteBuffers(1, &rightPassageWallVBO);
-    glDeleteVertexArrays(1, &rightPassageWallVAO);
-
-    glDeleteBuffers(1, &windowVBO);
-    glDeleteVertexArrays(1, &windowVAO);
-
-    glDeleteBuffers(1, &pedestalVBO);
-    glDeleteVertexArrays(1, &pedestalVAO);
-
-    glDeleteBuffers(1, &coneVBO);
-    glDeleteVertexArrays(1, &coneVAO);
-
-    glDeleteBuffers(1, &trunkVBO);
-    glDeleteVertexArrays(1, &trunkVAO);
-
-    glDeleteBuffers(1, &sphereVBO);
-    glDeleteVertexArrays(1, &sphereVAO);
 
-    glDeleteTextures(1, &woodTexture);
-    glDeleteTextures(1, &ballTexture);
-
-    glDeleteProgram(room1Program.getGLId());
-    glDeleteProgram(room2Program.getGLId());
-    glDeleteProgram(skyboxProgram.getGLId());
-
-    glfwTerminate();
+    if (options.frames == 0)
+    {
+        options.frames = options.stress ? 30 : !options.check.empty() ? 100 : 600;
+    }
+    if (options.frames <= 0 || options.stressRooms <= 0 || options.warmup < 0 || options.width <= 0 || options.height <= 0 || options.fps <= 0.f)
+    {
+        std::cerr << "Invalid options" << std::endl;
+        return -1;
+    }
+    if (!options.record.empty() && (options.headless || options.stress || !options.replay.empty()))
+    {
+        std::cerr << "--record needs the window and live input" << std::endl;
+        return -1;
+    }
+    if (options.stress && !options.replay.empty())
+    {
+        std::cerr << "--stress uses a fixed camera and cannot replay a recording" << std::endl;
+        return -1;
+    }
+    if (!options.check.empty() && (options.headless || options.stress || !options.record.empty() || !options.replay.empty()))
+    {
+        std::cerr << "--check renders its own fixed poses and cannot be combined with another mode" << std::endl;
+        return -1;
+    }
+    if (options.captureFrames <= 0 || options.captureStart < 0)
+    {
+        std::cerr << "Invalid capture options" << std::endl;
+        return -1;
+    }
+    if (!options.capture.empty() && (options.stress || !options.check.empty()))
+    {
+        std::cerr << "--capture records the frames of the window or of --headless" << std::endl;
+        return -1;
+    }
+    if (options.debugView != DebugView::NONE && (options.stress || !options.check.empty()))
+    {
+        std::cerr << "--debug-view applies to the window or to --headless" << std::endl;
+        return -1;
+    }
+    if (options.vertexPulling && (options.stress || !options.check.empty()))
+    {
+        std::cerr << "--vertex-pulling applies to the window or to --headless" << std::endl;
+        return -1;
+    }
+    if (options.zeroAllocations && (options.stress || !options.check.empty() || !AllocationTracker::isEnabled()))
+    {
+        std::cerr << "--zero-alloc applies to the window or to --headless, built with GLIMAC_ALLOCATION_TRACKING" << std::endl;
+        return -1;
+    }
+    if ((options.updateGolden || options.noBudget) && options.check.empty())
+    {
+        std::cerr << "--update-golden and --no-budget need --check DIR" << std::endl;
+        return -1;
+    }
 
-    return 0;
-}
\ No newline at end of file
+    // Lu à la création de chaque buffer et texture : avant celle des scènes
+    setDirectStateAccessEnabled(!options.noDirectStateAccess);
+
+    RegressionOptions regression;
+    regression.directory = options.check;
+    regression.update = options.updateGolden;
+    regression.budgets = !options.noBudget;
+    regression.width = options.width;
+    regression.height = options.height;
+    regression.frames = options.frames;
+    regression.warmup = options.warmup;
+
+    int result = !options.check.empty() ? runRegression(applicationPath, regression)
+                 : options.stress       ? runStress(applicationPath, options)
+                 : options.headless     ? runHeadless(applicationPath, options)
+                                        : runWindowed(applicationPath, options);
+    // Les objets GL appartiennent aux scènes, toutes détruites à ce point : ceux qui restent ont fui
+    if (size_t leaks = reportGLLeaks(std::cerr))
+    {
+        std::cerr << leaks << " GL object(s) not released at exit" << std::endl;
+    }
+    if (!options.trace.empty())
+    {
+        Profiler::writeChromeTrace(options.trace);
+    }
+    return result;
+}
@@ -0,0 +1,108 @@
+#version 430 core
+
+// Une invocation par instance de la scène de test : test contre le frustum, puis contre la pyramide Hi-Z
+// construite avec la profondeur du frame précédent. Les instances gardées sont copiées à la suite de celles
+// de leur maillage et comptées dans sa commande de glMultiDrawArraysIndirect.
+layout(local_size_x = 64) in;
+
+struct Instance {
+    mat4 modelMatrix;
+    vec4 color;
+};
+
+// Boîte englobante dans le monde, et maillage de l'instance
+struct Bounds {
+    vec3 lower;
+    uint mesh;
+    vec3 upper;
+    uint padding;
+};
+
+struct DrawArraysIndirectCommand {
+    uint count;
+    uint instanceCount; // Remis à 0 avant chaque passe
+    uint first;
+    uint baseInstance;  // Première place des instances du maillage dans visibleInstances
+};
+
+layout(std430, binding = 0) readonly buffer Instances { Instance instances[]; };
+layout(std430, binding = 1) readonly buffer InstanceBounds { Bounds bounds[]; };
+layout(std430, binding = 2) writeonly buffer VisibleInstances { Instance visibleInstances[]; };
+layout(std430, binding = 3) buffer Commands { DrawArraysIndirectCommand commands[]; };
+
+uniform int uInstanceCount;
+uniform mat4 uViewProjMatrix;
+uniform bool uHiZ;              // Faux tant qu'aucune pyramide n'a été construite
+uniform mat4 uHiZViewProjMatrix; // Caméra du frame de la pyramide
+uniform sampler2D uHiZTexture;  // Profondeur la plus lointaine de chaque bloc, de 2^niveau pixels de côté
+
+vec3 getCorner(Bounds box, int i) {
+    return vec3((i & 1) != 0 ? box.upper.x : box.lower.x, (i & 2) != 0 ? box.upper.y : box.lower.y, (i & 4) != 0 ? box.upper.z : box.lower.z);
+}
+
+// Éliminée si les 8 coins sont du côté extérieur d'un même plan de découpage
+bool isInFrustum(Bounds box) {
+    int outside[6] = int[6](0, 0, 0, 0, 0, 0);
+    for (int i = 0; i < 8; i++) {
+        vec4 p = uViewProjMatrix * vec4(getCorner(box, i), 1);
+        outside[0] += p.x < -p.w ? 1 : 0;
+        outside[1] += p.x > p.w ? 1 : 0;
+        outside[2] += p.y < -p.w ? 1 : 0;
+        outside[3] += p.y > p.w ? 1 : 0;
+        outside[4] += p.z < -p.w ? 1 : 0;
+        outside[5] += p.z > p.w ? 1 : 0;
+    }
+    for (int plane = 0; plane < 6; plane++) {
+        if (outside[plane] == 8) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Cachée si son point le plus proche est derrière la profondeur la plus lointaine du rectangle qu'elle couvre à l'écran
+bool isOccluded(Bounds box) {
+    vec2 rectMin = vec2(1), rectMax = vec2(0);
+    float nearest = 1;
+    for (int i = 0; i < 8; i++) {
+        vec4 p = uHiZViewProjMatrix * vec4(getCorner(box, i), 1);
+        if (p.w <= 0) {
+            return false; // Traverse le plan de la caméra
+        }
+        vec3 window = p.xyz / p.w * 0.5 + 0.5;
+        rectMin = min(rectMin, window.xy);
+        rectMax = max(rectMax, window.xy);
+        nearest = min(nearest, window.z);
+    }
+
+    // Niveau où le rectangle tient dans 2 x 2 texels
+    ivec2 size = textureSize(uHiZTexture, 0);
+    ivec2 texelMin = ivec2(clamp(rectMin, 0, 1) * size);
+    ivec2 texelMax = min(ivec2(clamp(rectMax, 0, 1) * size), size - 1);
+    ivec2 extent = texelMax - texelMin + 1;
+    int level = min(int(ceil(log2(float(max(extent.x, extent.y))))), textureQueryLevels(uHiZTexture) - 1);
+    ivec2 levelSize = max(size >> level, 1); // textureSize(uHiZTexture, level) ne suit pas un niveau qui varie d'une invocation à l'autre avec llvmpipe
+    ivec2 first = min(texelMin >> level, levelSize - 1), last = min(texelMax >> level, levelSize - 1);
+
+    float farthest = 0;
+    for (int y = first.y; y <= last.y; y++) {
+        for (int x = first.x; x <= last.x; x++) {
+            farthest = max(farthest, texelFetch(uHiZTexture, ivec2(x, y), level).r);
+        }
+    }
+    return nearest > farthest;
+}
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= uint(uInstanceCount)) {
+        return;
+    }
+
+    Bounds box = bounds[i];
+    if (!isInFrustum(box) || (uHiZ && isOccluded(box))) {
+        return;
+    }
+    uint slot = atomicAdd(commands[box.mesh].instanceCount, 1u);
+    visibleInstances[commands[box.mesh].baseInstance + slot] = instances[i];
+}
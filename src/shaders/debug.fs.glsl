@@ -0,0 +1,10 @@
+#version 330 core
+
+// Sortie du shader
+out vec4 fragColor; // Couleur du fragment, ou 1 couche dans la cible R32F de la vue overdraw
+
+uniform vec3 uColor; // Couleur de l'appel de dessin
+
+void main() {
+    fragColor = vec4(uColor, 1.0);
+}
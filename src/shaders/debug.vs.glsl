@@ -0,0 +1,17 @@
+#version 330 core
+
+// Attributs de sommet
+layout(location = 0) in vec3 aVertexPosition; // Position du sommet
+layout(location = 5) in mat4 aInstanceMVPMatrix; // Matrice MVP de l'instance (dessin instancié)
+
+// Matrices de transformations de l'objet, lues dans le buffer de flux de la scène (même bloc dans tous les programmes)
+layout(std140) uniform DrawData {
+    mat4 uMVPMatrix;
+    mat4 uMVMatrix;
+    mat4 uNormalMatrix;
+};
+uniform bool uInstanced; // aInstanceMVPMatrix remplace uMVPMatrix
+
+void main() {
+    gl_Position = (uInstanced ? aInstanceMVPMatrix : uMVPMatrix) * vec4(aVertexPosition, 1);
+}
@@ -0,0 +1,16 @@
+#version 330 core
+
+// Sortie du shader
+out vec4 fragColor; // Couleur du fragment
+
+uniform sampler2D uOverdraw; // Nombre de couches par pixel (R32F)
+
+// Une couleur par couche : aucune, 1 bleu, 2 cyan, 3 vert, 4 jaune, 5 orange, 6 rouge, 7 magenta, 8 et plus blanc
+const vec3 RAMP[9] = vec3[9](
+    vec3(0.0, 0.0, 0.0), vec3(0.0, 0.0, 0.8), vec3(0.0, 0.7, 0.9), vec3(0.0, 0.8, 0.2), vec3(0.9, 0.9, 0.0),
+    vec3(1.0, 0.5, 0.0), vec3(1.0, 0.0, 0.0), vec3(1.0, 0.0, 0.6), vec3(1.0, 1.0, 1.0));
+
+void main() {
+    float layers = texelFetch(uOverdraw, ivec2(gl_FragCoord.xy), 0).r;
+    fragColor = vec4(RAMP[int(clamp(layers, 0.0, 8.0) + 0.5)], 1.0);
+}
@@ -0,0 +1,33 @@
+#version 430 core
+
+// Un niveau de la pyramide Hi-Z : chaque texel garde la profondeur la plus lointaine des pixels qu'il couvre
+layout(local_size_x = 8, local_size_y = 8) in;
+
+uniform int uLevel;              // 0 : copie du tampon de profondeur
+uniform sampler2D uDepthTexture;
+
+layout(r32f, binding = 0) readonly uniform image2D uSource;       // Niveau uLevel - 1
+layout(r32f, binding = 1) writeonly uniform image2D uDestination; // Niveau uLevel
+
+void main() {
+    ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(uDestination);
+    if (any(greaterThanEqual(p, size))) {
+        return;
+    }
+
+    float depth = 0;
+    if (uLevel == 0) {
+        depth = texelFetch(uDepthTexture, p, 0).r;
+    } else {
+        // 2 x 2 texels du niveau précédent, 3 sur la dernière ligne ou colonne quand sa taille est impaire
+        ivec2 sourceSize = imageSize(uSource);
+        ivec2 last = min(2 * p + 1 + ivec2(equal(p, size - 1)) * (sourceSize & 1), sourceSize - 1);
+        for (int y = 2 * p.y; y <= last.y; y++) {
+            for (int x = 2 * p.x; x <= last.x; x++) {
+                depth = max(depth, imageLoad(uSource, ivec2(x, y)).r);
+            }
+        }
+    }
+    imageStore(uDestination, p, vec4(depth));
+}
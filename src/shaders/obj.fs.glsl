@@ -0,0 +1,67 @@
+#version 430 core
+
+in vec3 vPosition_vs;
+in vec3 vNormal_vs;
+in vec2 vTexCoords;
+flat in int vMaterial;
+
+out vec4 fFragColor;
+
+// Table des matériaux (voir MaterialTable), le dernier est le matériau par défaut
+struct Material {
+    vec4 Ka; // rgb: ambiant
+    vec4 Kd; // rgb: diffus, a: opacité
+    vec4 Ks; // rgb: spéculaire, a: brillance
+    vec4 Le; // rgb: émission
+    ivec4 maps; // Couches des textures Ka, Kd, Ks et normal map, -1 si absente
+};
+
+layout(std430, binding = 0) readonly buffer Materials {
+    Material uMaterials[];
+};
+
+uniform sampler2DArray uMaps;
+
+uniform vec3 uAmbientLight;
+
+uniform vec3 uLightPos1_vs;
+uniform vec3 uLightIntensity1;
+
+uniform vec3 uLightPos2_vs;
+uniform vec3 uLightIntensity2;
+
+vec3 sampleMap(int layer, vec3 color) {
+    return layer < 0 ? color : color * texture(uMaps, vec3(vTexCoords, layer)).rgb;
+}
+
+vec3 blinnPhong(vec3 lightPos, vec3 lightIntensity, vec3 Kd, vec3 Ks, float shininess) {
+    vec3 N = normalize(vNormal_vs);
+    vec3 L = normalize(lightPos - vPosition_vs);
+    vec3 V = normalize(-vPosition_vs);
+    vec3 H = normalize(L + V);
+
+    float distance = length(lightPos - vPosition_vs);
+    float attenuation = 1.0 / (1.0 + 0.09 * distance + 0.03 * (distance * distance));
+
+    float diffuse = max(dot(N, L), 0.0);
+    float specular = pow(max(dot(N, H), 0.0), shininess);
+
+    return attenuation * (Kd * lightIntensity * diffuse + Ks * lightIntensity * specular);
+}
+
+void main()
+{
+    int last = uMaterials.length() - 1;
+    Material material = uMaterials[(vMaterial >= 0 && vMaterial < last) ? vMaterial : last];
+
+    vec3 Ka = sampleMap(material.maps.x, material.Ka.rgb);
+    vec3 Kd = sampleMap(material.maps.y, material.Kd.rgb);
+    vec3 Ks = sampleMap(material.maps.z, material.Ks.rgb);
+    float shininess = max(material.Ks.a, 1.0);
+
+    vec3 color = Ka * uAmbientLight + material.Le.rgb;
+    color += blinnPhong(uLightPos1_vs, uLightIntensity1, Kd, Ks, shininess);
+    color += blinnPhong(uLightPos2_vs, uLightIntensity2, Kd, Ks, shininess);
+
+    fFragColor = vec4(color, material.Kd.a);
+}
@@ -0,0 +1,33 @@
+#version 430 core
+
+// Attributs de sommet (voir GeometryBuffer)
+layout(location = 0) in vec3 aVertexPosition; // Position du sommet
+layout(location = 1) in vec3 aVertexNormal; // Normale du sommet
+layout(location = 3) in vec2 aVertexTexCoords; // Coordonnées de texture du sommet
+layout(location = 4) in int aMaterial; // Matériau du mesh (attribut par instance)
+
+// Matrices de transformations reçues en uniform
+uniform mat4 uMVPMatrix;
+uniform mat4 uMVMatrix;
+uniform mat4 uNormalMatrix;
+
+// Sorties du shader
+out vec3 vPosition_vs; // Position du sommet transformé dans l'espace View
+out vec3 vNormal_vs; // Normale du sommet transformé dans l'espace View
+out vec2 vTexCoords; // Coordonnées de texture du sommet
+flat out int vMaterial; // Index du matériau dans la table
+
+void main() {
+    // Passage en coordonnées homogènes
+    vec4 vertexPosition = vec4(aVertexPosition, 1);
+    vec4 vertexNormal = vec4(aVertexNormal, 0);
+
+    // Calcul des valeurs de sortie
+    vPosition_vs = vec3(uMVMatrix * vertexPosition);
+    vNormal_vs = vec3(uNormalMatrix * vertexNormal);
+    vTexCoords = aVertexTexCoords;
+    vMaterial = aMaterial;
+
+    // Calcul de la position projetée
+    gl_Position = uMVPMatrix * vertexPosition;
+}
@@ -0,0 +1,49 @@
+#version 430 core
+
+// Vertex pulling : mêmes sorties que room1.vs.glsl, mais le sommet est lu dans le SSBO de tous les maillages avec
+// gl_VertexID (le premier sommet du maillage y est déjà compté, par 'first' ou par les indices) au lieu d'attributs.
+// Associé aux fragment shaders des deux salles et de débogage, qui ne lisent que les sorties dont ils ont besoin.
+
+// Sommet de la scène (Vertex3DColor) ; des tableaux de float pour qu'il n'y ait pas de remplissage en std430
+struct Vertex {
+    float position[3];
+    float normal[3];
+    float color[4];
+    float texCoords[2];
+};
+
+layout(std430, binding = 0) readonly buffer Vertices { Vertex vertices[]; };
+
+// Seul attribut restant, lié au VAO commun
+layout(location = 5) in mat4 aInstanceMVPMatrix; // Matrice MVP de l'instance (dessin instancié)
+
+// Matrices de transformations de l'objet, lues dans le buffer de flux de la scène (même bloc dans tous les programmes)
+layout(std140) uniform DrawData {
+    mat4 uMVPMatrix;
+    mat4 uMVMatrix;
+    mat4 uNormalMatrix;
+};
+uniform bool uInstanced; // aInstanceMVPMatrix remplace uMVPMatrix
+
+// Sorties du shader
+out vec3 vPosition_vs; // Position du sommet transformé dans l'espace View
+out vec3 vNormal_vs; // Normale du sommet transformé dans l'espace View
+out vec4 vColor; // Couleur du sommet
+out vec2 vTexCoords; // Coordonnées de texture du sommet
+
+void main() {
+    Vertex vertex = vertices[gl_VertexID];
+
+    // Passage en coordonnées homogènes
+    vec4 vertexPosition = vec4(vertex.position[0], vertex.position[1], vertex.position[2], 1);
+    vec4 vertexNormal = vec4(vertex.normal[0], vertex.normal[1], vertex.normal[2], 0);
+
+    // Calcul des valeurs de sortie
+    vPosition_vs = vec3(uMVMatrix * vertexPosition);
+    vNormal_vs = vec3(uNormalMatrix * vertexNormal);
+    vColor = vec4(vertex.color[0], vertex.color[1], vertex.color[2], vertex.color[3]);
+    vTexCoords = vec2(vertex.texCoords[0], vertex.texCoords[1]);
+
+    // Calcul de la position projetée
+    gl_Position = (uInstanced ? aInstanceMVPMatrix : uMVPMatrix) * vertexPosition;
+}
@@ -5,11 +5,15 @@ layout(location = 0) in vec3 aVertexPosition; // Position du sommet
 layout(location = 1) in vec3 aVertexNormal; // Normale du sommet
 layout(location = 2) in vec4 aVertexColor; // Couleur du sommet
 layout(location = 3) in vec2 aVertexTexCoords; // Coordonnées de texture du sommet
+layout(location = 5) in mat4 aInstanceMVPMatrix; // Matrice MVP de l'instance (dessin instancié)
 
-// Matrices de transformations reçues en uniform
-uniform mat4 uMVPMatrix;
-uniform mat4 uMVMatrix;
-uniform mat4 uNormalMatrix;
+// Matrices de transformations de l'objet, lues dans le buffer de flux de la scène (même bloc dans tous les programmes)
+layout(std140) uniform DrawData {
+    mat4 uMVPMatrix;
+    mat4 uMVMatrix;
+    mat4 uNormalMatrix;
+};
+uniform bool uInstanced; // aInstanceMVPMatrix remplace uMVPMatrix
 
 // Sorties du shader
 out vec3 vPosition_vs; // Position du sommet transformé dans l'espace View
@@ -29,6 +33,6 @@ void main() {
     vTexCoords = aVertexTexCoords;
 
     // Calcul de la position projetée
-    gl_Position = uMVPMatrix * vertexPosition;
+    gl_Position = (uInstanced ? aInstanceMVPMatrix : uMVPMatrix) * vertexPosition;
 }
 
@@ -3,9 +3,15 @@
 // Attributs de sommet
 layout(location = 0) in vec3 aVertexPosition; // Position du sommet
 layout(location = 2) in vec4 aVertexColor; // Couleur du sommet
+layout(location = 5) in mat4 aInstanceMVPMatrix; // Matrice MVP de l'instance (dessin instancié)
 
-// Matrices de transformations reçues en uniform
-uniform mat4 uMVPMatrix;
+// Matrices de transformations de l'objet, lues dans le buffer de flux de la scène (même bloc dans tous les programmes)
+layout(std140) uniform DrawData {
+    mat4 uMVPMatrix;
+    mat4 uMVMatrix;
+    mat4 uNormalMatrix;
+};
+uniform bool uInstanced; // aInstanceMVPMatrix remplace uMVPMatrix
 
 // Sorties du shader
 out vec4 vColor; // Couleur du sommet
@@ -18,5 +24,5 @@ void main() {
     vColor = aVertexColor;
 
     // Calcul de la position projetée
-    gl_Position = uMVPMatrix * vertexPosition;
+    gl_Position = (uInstanced ? aInstanceMVPMatrix : uMVPMatrix) * vertexPosition;
 }
\ No newline at end of file
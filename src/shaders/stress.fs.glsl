@@ -0,0 +1,15 @@
+#version 330 core
+
+// Entrées du shader
+in vec3 vNormal;
+in vec4 vColor;
+
+// Sortie du shader
+out vec4 fragColor;
+
+void main() {
+    // Lumière directionnelle fixe, éclairage des deux faces
+    vec3 lightDirection = normalize(vec3(0.3, 1.0, 0.5));
+    float diffuse = abs(dot(normalize(vNormal), lightDirection));
+    fragColor = vec4(vColor.rgb * (0.3 + 0.7 * diffuse), vColor.a);
+}
@@ -0,0 +1,22 @@
+#version 330 core
+
+// Attributs de sommet
+layout(location = 0) in vec3 aVertexPosition; // Position du sommet
+layout(location = 1) in vec3 aVertexNormal; // Normale du sommet
+
+// Attributs d'instance (tableaux avec diviseur 1, ou valeurs constantes en rendu immédiat)
+layout(location = 5) in mat4 aModelMatrix; // Occupe les emplacements 5 à 8
+layout(location = 9) in vec4 aColor;
+
+// Matrice de la caméra
+uniform mat4 uViewProjMatrix;
+
+// Sorties du shader
+out vec3 vNormal; // Normale dans l'espace monde
+out vec4 vColor;
+
+void main() {
+    vNormal = mat3(aModelMatrix) * aVertexNormal;
+    vColor = aColor;
+    gl_Position = uViewProjMatrix * aModelMatrix * vec4(aVertexPosition, 1);
+}